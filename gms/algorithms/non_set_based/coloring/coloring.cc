@@ -1,8 +1,10 @@
 #include <iostream>
 #include "gms/third_party/gapbs/gapbs.h"
 #include <gms/algorithms/preprocessing/preprocessing.h>
+#include "coloring_balance.h"
 #include "coloring_barenboim.h"
 #include "coloring_dense_sparse.h"
+#include "coloring_distance_two.h"
 #include "coloring_elkin.h"
 #include "coloring_johansson.h"
 #include "coloring_jones_v1.h"
@@ -10,6 +12,7 @@
 #include "coloring_jones_v3.h"
 #include "coloring_jones_v4.h"
 #include <gms/common/cli/cli.h>
+#include <gms/common/benchmark.h>
 
 using namespace GMS;
 using namespace GMS::Coloring;
@@ -29,103 +32,53 @@ std::vector<NodeId> Reorder(const CSRGraph& g)
     return ranking;
 }
 
+template <class CGraph>
+void graph_coloring_jones_v2_balanced(const CGraph &g, std::vector<int32_t> &coloring) {
+    JonesV2::graph_coloring_jones(g, coloring);
+    balance_coloring(g, coloring);
+}
+
 template<typename GraphT_, typename GAPBSFunc, typename PPFunc, typename VerifierFunc, typename...PrintInfos>
 void benchmarkGraphColoringWithPreprocess(const CLI::Args &args, GraphT_ &g, PPFunc preprocess, GAPBSFunc graph_coloring_f, VerifierFunc verify, PrintInfos... printInfos) {
     g.PrintStats();
 
-    double total_seconds = 0;
-    double pp_total_seconds = 0;
-    int64_t total_colors = 0;
-    Timer trial_timer;
-    Printer printer;
-
-    for (int i = 0; i < args.num_trials; i++) {
-        std::vector<int32_t> coloring(g.num_nodes(), 0);
-
-        trial_timer.Start();
-        auto ppG = preprocess(g);
-        trial_timer.Stop();
-        PrintTime("Preprocess Time", trial_timer.Seconds());
-        const double preprocTime = trial_timer.Seconds();
-        printer << preprocTime;
-        pp_total_seconds += preprocTime;
-
-        trial_timer.Start();
-        graph_coloring_f(g, coloring);  // coloring
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        printer << trial_timer.Seconds();
-
-        total_seconds += trial_timer.Seconds();
-
-        int nCol = uniqueColorsCount(coloring);
-        total_colors += nCol;
-
-        PrintLabel("Colors", std::to_string(nCol));
-        printer << nCol;
-
-        if (args.verify) {
-            std::string passMark = verify(g, coloring, nCol) ? "PASS" : "FAIL";
-            PrintLabel("Verification", passMark);  // verify
-            printer << passMark;
-        }
-
-        printer.Enqueue(printInfos...);
-        std::cout << printer << std::endl;
-    }
-
-    PrintTime("Average Time", total_seconds / args.num_trials);
-    PrintTime("Average pp Time", pp_total_seconds/ args.num_trials);
-    PrintTime("Average colors", (total_colors * 1.0)/args.num_trials);
+    std::vector<int32_t> coloring;
+    int nCol = 0;
+    Benchmark bench(args);
+    bench.set_type<GraphT_>().graph(g).info(printInfos...)
+        .preprocess([&]() {
+            coloring.assign(g.num_nodes(), 0);
+            auto ppG = preprocess(g);
+        });
+    bench.run([&]() { graph_coloring_f(g, coloring); },
+              [&]() { return verify(g, coloring, nCol); },
+              [&]() {
+                  nCol = uniqueColorsCount(coloring);
+                  PrintLabel("Colors", std::to_string(nCol));
+                  bench.metric("colors", nCol);
+              });
 }
 
 template<typename GraphT_, typename GAPBSFunc, typename PPFunc, typename VerifierFunc, typename...PrintInfos>
 void benchmarkGraphColoringWithReordering(const CLI::Args &args, GraphT_ &g, PPFunc reordering, GAPBSFunc graph_coloring_f, VerifierFunc verify, PrintInfos...printInfos) {
     g.PrintStats();
 
-    double total_seconds = 0;
-    double pp_total_seconds = 0;
-    int64_t total_colors = 0;
-    Timer trial_timer;
-    Printer  printer;
-
-    for (int i = 0; i < args.num_trials; i++) {
-        std::vector<int32_t> coloring(g.num_nodes(), 0);
-
-        trial_timer.Start();
-        auto order = reordering(g);
-        trial_timer.Stop();
-        PrintTime("Preprocess Time", trial_timer.Seconds());
-        const double preprocTime = trial_timer.Seconds();
-        printer << preprocTime;
-        pp_total_seconds += preprocTime;
-
-        trial_timer.Start();
-        graph_coloring_f(g, coloring, order);  // coloring
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        printer << trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-
-        int nCol = uniqueColorsCount(coloring);
-        total_colors += nCol;
-
-        PrintLabel("Colors", std::to_string(nCol));
-        printer << nCol;
-
-        if (args.verify) {
-            std::string passMark = verify(g, coloring, nCol) ? "PASS" : "FAIL";
-            PrintLabel("Verification", passMark);  // verify
-            printer << passMark;
-        }
-
-        printer.Enqueue(printInfos...);
-        std::cout << printer << std::endl;
-    }
-
-    PrintTime("Average Time", total_seconds / args.num_trials);
-    PrintTime("Average pp Time", pp_total_seconds/ args.num_trials);
-    PrintTime("Average colors", (total_colors * 1.0)/args.num_trials);
+    std::vector<int32_t> coloring;
+    std::vector<NodeId> order;
+    int nCol = 0;
+    Benchmark bench(args);
+    bench.set_type<GraphT_>().graph(g).info(printInfos...)
+        .preprocess([&]() {
+            coloring.assign(g.num_nodes(), 0);
+            order = reordering(g);
+        });
+    bench.run([&]() { graph_coloring_f(g, coloring, order); },
+              [&]() { return verify(g, coloring, nCol); },
+              [&]() {
+                  nCol = uniqueColorsCount(coloring);
+                  PrintLabel("Colors", std::to_string(nCol));
+                  bench.metric("colors", nCol);
+              });
 }
 
 int main(int argc, char *argv[]) {
@@ -149,5 +102,11 @@ int main(int argc, char *argv[]) {
     benchmarkGraphColoringWithReordering(args, g, Reorder, JonesV3::graph_coloring_jones<CGraph>, GCVerifierMaxColor<CGraph>, "coloring", "jones_v3", "pp:simpleId");
 
     benchmarkGraphColoringWithReordering(args, g, Reorder, JonesV4::graph_coloring_jones<CGraph>, GCVerifierMaxColor<CGraph>, "coloring", "jones_v4", "pp:simpleId");
+
+    benchmarkGraphColoringWithPreprocess(args, g, Preprocess, graph_coloring_jones_v2_balanced<CGraph>, GCVerifierBalanced<CGraph>, "coloring", "jones_v2_balanced", "pp:simpleId");
+
+    benchmarkGraphColoringWithPreprocess(args, g, Preprocess, graph_coloring_distance_two<CGraph>, GCVerifierDistanceTwo<CGraph>, "coloring", "distance_two", "pp:simpleId");
+
+    benchmarkGraphColoringWithPreprocess(args, g, Preprocess, graph_coloring_distance_two_balanced<CGraph>, GCVerifierBalanced<CGraph, 2>, "coloring", "distance_two_balanced", "pp:simpleId");
     return 0;
 }
@@ -0,0 +1,143 @@
+#ifndef COLORING_BALANCE_H_
+#define COLORING_BALANCE_H_
+#include <omp.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gms/third_party/gapbs/benchmark.h"
+#include "gms/third_party/gapbs/graph.h"
+
+#include "coloring_common.h"
+#include "coloring_distance_two.h"
+
+namespace GMS::Coloring {
+
+// Atomically increments size if it is still below target.
+inline bool reserve_class_slot(int64_t &size, const int64_t target) {
+    int64_t current = __atomic_load_n(&size, __ATOMIC_RELAXED);
+    while (current < target) {
+        if (__atomic_compare_exchange_n(&size, &current, current + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Atomically decrements size if it is still above target.
+inline bool leave_class(int64_t &size, const int64_t target) {
+    int64_t current = __atomic_load_n(&size, __ATOMIC_RELAXED);
+    while (current > target) {
+        if (__atomic_compare_exchange_n(&size, &current, current - 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Balancing post-pass for an existing valid distance-1 (Distance = 1) or distance-2 (Distance = 2) coloring.
+//
+// The number of colors C is kept, the target class size is ceil(n / C). Over-full classes are processed one
+// after the other; the vertices of a single class are moved in parallel to the lowest-numbered under-full class
+// that is not used within Distance hops. Vertices of the same class are never within Distance hops of each other and
+// vertices of other classes do not move meanwhile, so the parallel moves cannot create conflicts.
+// Moves into a class only ever make that class less attractive, hence after one sweep no vertex of an over-full
+// class can be moved into an under-full one anymore (see GCVerifierBalanced).
+template <class CGraph, int Distance = 1>
+void balance_coloring(const CGraph &g, std::vector<int32_t> &coloring) {
+    static_assert(Distance == 1 || Distance == 2, "only distance-1 and distance-2 colorings are supported");
+    const int64_t n = g.num_nodes();
+    DetailTimer detailTimer;
+
+    int32_t maxColor = 0;
+#pragma omp parallel for reduction(max : maxColor)
+    for (NodeId v = 0; v < n; v++) {
+        maxColor = std::max(maxColor, coloring[v]);
+    }
+    if (maxColor == 0) {
+        return;
+    }
+    const int64_t target = (n + maxColor - 1) / maxColor;
+
+    // bucket the vertices by color (counting sort)
+    std::vector<int64_t> classOffset(maxColor + 2, 0);
+    for (NodeId v = 0; v < n; v++) {
+        classOffset[coloring[v] + 1]++;
+    }
+    for (int32_t c = 0; c <= maxColor; c++) {
+        classOffset[c + 1] += classOffset[c];
+    }
+    std::vector<int64_t> classSize(maxColor + 1);
+    for (int32_t c = 0; c <= maxColor; c++) {
+        classSize[c] = classOffset[c + 1] - classOffset[c];
+    }
+    std::vector<NodeId> classMembers(n);
+    {
+        std::vector<int64_t> insertPos(classOffset.begin(), classOffset.end() - 1);
+        for (NodeId v = 0; v < n; v++) {
+            classMembers[insertPos[coloring[v]]++] = v;
+        }
+    }
+    detailTimer.endPhase("init");
+
+    std::vector<std::vector<NodeId>> forbidden(omp_get_max_threads(), std::vector<NodeId>(maxColor + 1, -1));
+    for (int32_t source = 1; source <= maxColor; source++) {
+        if (classSize[source] <= target) {
+            continue;
+        }
+#pragma omp parallel
+        {
+            // forbidden[c] == v marks color c as taken for vertex v, avoids clearing between vertices
+            std::vector<NodeId> &taken = forbidden[omp_get_thread_num()];
+
+#pragma omp for schedule(dynamic, 64)
+            for (int64_t i = classOffset[source]; i < classOffset[source + 1]; i++) {
+                int64_t sourceSize;
+#pragma omp atomic read
+                sourceSize = classSize[source];
+                if (sourceSize <= target) {
+                    continue;
+                }
+
+                NodeId v = classMembers[i];
+                for (NodeId w : g.out_neigh(v)) {
+                    taken[coloring[w]] = v;
+                    if (Distance == 2) {
+                        for (NodeId u : g.out_neigh(w)) {
+                            taken[coloring[u]] = v;
+                        }
+                    }
+                }
+
+                for (int32_t c = 1; c <= maxColor; c++) {
+                    if (taken[c] == v) {
+                        continue;
+                    }
+                    // reserve a slot in the target class first, then leave the source class
+                    if (!reserve_class_slot(classSize[c], target)) {
+                        continue;
+                    }
+                    if (!leave_class(classSize[source], target)) {
+#pragma omp atomic
+                        classSize[c]--;
+                        break;
+                    }
+                    coloring[v] = c;
+                    break;
+                }
+            }
+        }
+        detailTimer.endPhase("class");
+    }
+    detailTimer.print();
+}
+
+template <class CGraph>
+void graph_coloring_distance_two_balanced(const CGraph &g, std::vector<int32_t> &coloring) {
+    graph_coloring_distance_two(g, coloring);
+    balance_coloring<CGraph, 2>(g, coloring);
+}
+
+} // namespace GMS::Coloring
+
+#endif // COLORING_BALANCE_H_
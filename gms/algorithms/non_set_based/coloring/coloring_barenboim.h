@@ -6,7 +6,7 @@
 namespace GMS::Coloring {
 
 template <class CGraph>
-std::size_t one_shot_coloring(const CGraph &g, const VN &nodes_to_color, VC &coloring, VVC &palettes, VRS selectors,
+std::size_t one_shot_coloring(const CGraph &g, const VN &nodes_to_color, VC &coloring, VVC &palettes, uint64_t round,
                               VC &chosen_color, VC &new_color, std::size_t n_colored) {
     std::size_t n = g.num_nodes();
 
@@ -17,7 +17,7 @@ std::size_t one_shot_coloring(const CGraph &g, const VN &nodes_to_color, VC &col
         if (coloring[v] != 0) {
             continue;
         }
-        auto selector = selectors[omp_get_thread_num()];
+        random_selector<> selector(Random::DefaultSeed, v, round);
         chosen_color[v] = selector(palettes[v]);
     }
 
@@ -89,10 +89,8 @@ std::size_t one_shot_coloring(const CGraph &g, const VN &nodes_to_color, VC &col
 
 template <class CGraph>
 int coloring_barenboim(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n_colored) {
-    VRS selectors(omp_get_max_threads());
-    for (std::size_t i = 0; i < selectors.size(); i++) {
-        selectors[i] = random_selector<>();
-    }
+    // every call of one_shot_coloring draws from fresh per-vertex streams
+    uint64_t round = 0;
 
     std::size_t n = g.num_nodes();
     VC chosen_color(n, 0);
@@ -105,7 +103,7 @@ int coloring_barenboim(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n
     std::size_t iterations = std::ceil(std::log(delta) / std::log((double)16 / 15));
 
     for (std::size_t i = 0; i < iterations && n_colored != n; i++) {
-        n_colored = one_shot_coloring(g, g_nodes, coloring, palettes, selectors, chosen_color, new_color, n_colored);
+        n_colored = one_shot_coloring(g, g_nodes, coloring, palettes, round++, chosen_color, new_color, n_colored);
     }
     if (n_colored == n) {
         return 0;
@@ -157,14 +155,14 @@ int coloring_barenboim(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n
     if (g_hi_nodes.size() > 0) {
         for (std::size_t i = 0; i < iterations && n_colored < n; i++) {
             n_colored =
-                    one_shot_coloring(g, g_hi_nodes, coloring, palettes, selectors, chosen_color, new_color, n_colored);
+                    one_shot_coloring(g, g_hi_nodes, coloring, palettes, round++, chosen_color, new_color, n_colored);
         }
     }
 
     if (g_lo_nodes.size() > 0) {
         for (std::size_t i = 0; i < iterations && n_colored < n; i++) {
             n_colored =
-                    one_shot_coloring(g, g_lo_nodes, coloring, palettes, selectors, chosen_color, new_color, n_colored);
+                    one_shot_coloring(g, g_lo_nodes, coloring, palettes, round++, chosen_color, new_color, n_colored);
         }
     }
 
@@ -172,7 +170,7 @@ int coloring_barenboim(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n
 
     while (n_colored < n) {
         n_colored =
-                one_shot_coloring(g, g_uncolored, coloring, palettes, selectors, chosen_color, new_color, n_colored);
+                one_shot_coloring(g, g_uncolored, coloring, palettes, round++, chosen_color, new_color, n_colored);
     }
 
     return n_colored;
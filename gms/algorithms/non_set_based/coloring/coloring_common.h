@@ -7,6 +7,7 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 #include "gms/third_party/gapbs/benchmark.h"
@@ -17,6 +18,7 @@
 #include <gms/common/types.h>
 #include <gms/common/printer.h>
 #include <gms/common/detail_timer.h>
+#include <gms/common/instrumentation.h>
 
 namespace GMS::Coloring {
 
@@ -202,6 +204,99 @@ bool GCVerifierDeltaPlusOneWeak(const CGraph &g, const std::vector<int32_t> &col
     return isCorrect;
 }
 
+template <class CGraph>
+bool GCVerifierDistanceTwo(const CGraph &g, const std::vector<int32_t> &coloring, const int32_t nColor) {
+    // every vertex must be colored and differ from all vertices within two hops
+    (void) nColor; // Unused argument
+    const int64_t n = g.num_nodes();
+    bool isCorrect = true;
+
+#pragma omp parallel for schedule(dynamic, 64) reduction(&& : isCorrect)
+    for (NodeId v = 0; v < n; v++) {
+        int32_t c = coloring[v];
+        if (c <= 0) {
+            isCorrect = false;
+            continue;
+        }
+        bool conflict = false;
+        for (NodeId w : g.out_neigh(v)) {
+            if (coloring[w] == c) {
+                conflict = true;
+                break;
+            }
+            for (NodeId u : g.out_neigh(w)) {
+                if (u != v && coloring[u] == c) {
+                    conflict = true;
+                    break;
+                }
+            }
+            if (conflict) {
+                break;
+            }
+        }
+        if (conflict) {
+            isCorrect = false;
+        }
+    }
+    return isCorrect;
+}
+
+// Checks that the coloring is valid (distance-1 or distance-2) and that it is balanced in the sense of the
+// balancing pass in coloring_balance.h: no vertex in a color class larger than ceil(n / C) could be moved to a
+// class smaller than ceil(n / C) without creating a conflict.
+template <class CGraph, int Distance = 1>
+bool GCVerifierBalanced(const CGraph &g, const std::vector<int32_t> &coloring, const int32_t nColor) {
+    static_assert(Distance == 1 || Distance == 2, "only distance-1 and distance-2 colorings are supported");
+    (void) nColor; // Unused argument, the number of classes is derived from the largest color
+    if (Distance == 1 ? !GCVerifierMaxColor(g, coloring, std::numeric_limits<int32_t>::max())
+                      : !GCVerifierDistanceTwo(g, coloring, nColor)) {
+        return false;
+    }
+
+    const int64_t n = g.num_nodes();
+    int32_t maxColor = 0;
+#pragma omp parallel for reduction(max : maxColor)
+    for (NodeId v = 0; v < n; v++) {
+        maxColor = std::max(maxColor, coloring[v]);
+    }
+    if (maxColor == 0) {
+        return true;
+    }
+
+    std::vector<int64_t> classSize(maxColor + 1, 0);
+    for (NodeId v = 0; v < n; v++) {
+        classSize[coloring[v]]++;
+    }
+    const int64_t target = (n + maxColor - 1) / maxColor;
+
+    bool isBalanced = true;
+#pragma omp parallel reduction(&& : isBalanced)
+    {
+        std::vector<NodeId> forbidden(maxColor + 1, -1);
+#pragma omp for schedule(dynamic, 64)
+        for (NodeId v = 0; v < n; v++) {
+            if (classSize[coloring[v]] <= target) {
+                continue;
+            }
+            for (NodeId w : g.out_neigh(v)) {
+                forbidden[coloring[w]] = v;
+                if (Distance == 2) {
+                    for (NodeId u : g.out_neigh(w)) {
+                        forbidden[coloring[u]] = v;
+                    }
+                }
+            }
+            for (int32_t c = 1; c <= maxColor; c++) {
+                if (classSize[c] < target && forbidden[c] != v) {
+                    isBalanced = false;
+                    break;
+                }
+            }
+        }
+    }
+    return isBalanced;
+}
+
 int uniqueColorsCount(std::vector<int32_t> &coloring) {
     std::vector<int32_t> unique_colors(coloring);
     std::sort(unique_colors.begin(), unique_colors.end());
@@ -233,111 +328,6 @@ bool is_sorted(CGraph& g) {
 }
 
 
-
-template<typename GraphT_, typename GAPBSFunc, typename PPFunc, typename VerifierFunc, typename...PrintInfos>
-void benchmarkGraphColoringWithPreprocess(BenchCLApp cli, GraphT_ &g, PPFunc preprocess, GAPBSFunc graph_coloring_f, VerifierFunc verify, PrintInfos... printInfos) {
-    g.PrintStats();
-
-    double total_seconds = 0;
-    double pp_total_seconds = 0;
-    int64_t total_colors = 0;
-    Timer trial_timer;
-    Printer printer;
-
-    for (int i = 0; i < cli.num_trials(); i++) {
-        std::vector<int32_t> coloring(g.num_nodes(), 0);
-
-        trial_timer.Start();
-        auto ppG = preprocess(g, cli);
-        trial_timer.Stop();
-        PrintTime("Preprocess Time", trial_timer.Seconds());
-        const double preprocTime = trial_timer.Seconds();
-        printer << preprocTime;
-        pp_total_seconds += preprocTime;
-
-        trial_timer.Start();
-        graph_coloring_f(g, coloring);  // coloring
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        printer << trial_timer.Seconds();
-
-        total_seconds += trial_timer.Seconds();
-
-        int nCol = uniqueColorsCount(coloring);
-        total_colors += nCol;
-
-        PrintLabel("Colors", std::to_string(nCol));
-        printer << nCol;
-
-        if (cli.do_verify()) {
-            std::string passMark = verify(g, coloring, nCol) ? "PASS" : "FAIL";
-            PrintLabel("Verification", passMark);  // verify
-            printer << passMark;
-        }
-
-        printer.Enqueue(printInfos...);
-        std::cout << printer << std::endl;
-    }
-
-    PrintTime("Average Time", total_seconds / cli.num_trials());
-    PrintTime("Average pp Time", pp_total_seconds/ cli.num_trials());
-    PrintTime("Average colors", (total_colors * 1.0)/cli.num_trials());
-}
-
-
-
-
-
-
-template<typename GraphT_, typename GAPBSFunc, typename PPFunc, typename VerifierFunc, typename...PrintInfos>
-void benchmarkGraphColoringWithReordering(BenchCLApp cli, GraphT_ &g, PPFunc reordering, GAPBSFunc graph_coloring_f, VerifierFunc verify, PrintInfos...printInfos) {
-    g.PrintStats();
-
-    double total_seconds = 0;
-    double pp_total_seconds = 0;
-    int64_t total_colors = 0;
-    Timer trial_timer;
-    Printer  printer;
-
-    for (int i = 0; i < cli.num_trials(); i++) {
-        std::vector<int32_t> coloring(g.num_nodes(), 0);
-
-        trial_timer.Start();
-        auto order = reordering(g, cli);
-        trial_timer.Stop();
-        PrintTime("Preprocess Time", trial_timer.Seconds());
-        const double preprocTime = trial_timer.Seconds();
-        printer << preprocTime;
-        pp_total_seconds += preprocTime;
-
-        trial_timer.Start();
-        graph_coloring_f(g, coloring, order);  // coloring
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        printer << trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-
-        int nCol = uniqueColorsCount(coloring);
-        total_colors += nCol;
-
-        PrintLabel("Colors", std::to_string(nCol));
-        printer << nCol;
-
-        if (cli.do_verify()) {
-            std::string passMark = verify(g, coloring, nCol) ? "PASS" : "FAIL";
-            PrintLabel("Verification", passMark);  // verify
-            printer << passMark;
-        }
-
-        printer.Enqueue(printInfos...);
-        std::cout << printer << std::endl;
-    }
-
-    PrintTime("Average Time", total_seconds / cli.num_trials());
-    PrintTime("Average pp Time", pp_total_seconds/ cli.num_trials());
-    PrintTime("Average colors", (total_colors * 1.0)/cli.num_trials());
-}
-
 } // namespace GMS::Coloring
 
 #endif  // COLORING_COMMON_H_
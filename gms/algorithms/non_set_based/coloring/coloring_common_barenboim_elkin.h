@@ -10,8 +10,6 @@ typedef std::vector<NodeId> VN;
 typedef std::vector<ColorID> VC;
 typedef std::vector<VC> VVC;
 
-typedef std::vector<random_selector<>> VRS;
-
 typedef std::vector<int32_t> VI32;
 
 
@@ -32,6 +32,11 @@ private:
     double epsilon;
     double alpha = 0.01; // initial coloring probability
 
+    // rounds of the counter-based RNG streams (keyed by vertex or component) used by the phases
+    static constexpr uint64_t FriendEdgeRound = 0;
+    static constexpr uint64_t InitialColoringRound = 1;
+    static constexpr uint64_t DenseColoringRound = 2;
+
     // our own constants
     double friendBeta = 0.01; // prob: if check for friendEdge
     double friendBetaThreashold = 0.5; // for density
@@ -70,7 +75,9 @@ private:
     std::vector<NodeId> componentCount; // componentID -> count, decreases over time as get colored
     std::vector<NodeId> componentMembersOffset; // componentID -> where list starts
 public:
-    Coloring_Dense_Sparse(CGraph& _g, std::vector<ColorID> &_coloring)
+    // epsilon > 0 replaces the epsilon from the paper, which is so small that only components close to cliques of
+    // the maximum degree are dense
+    Coloring_Dense_Sparse(CGraph& _g, std::vector<ColorID> &_coloring, double epsilonOverride = 0)
     : g(_g), coloring(_coloring)
     {
 	    n = g.num_nodes();
@@ -117,7 +124,7 @@ public:
 
         // std::cout << "-- Parameters (set with -p 'n1=v1,n2=v2'):" << std::endl;
 
-        double epsilonApplied = epsilon;//algoParams.getDouble("epsilon",epsilon);
+        double epsilonApplied = epsilonOverride > 0 ? epsilonOverride : epsilon;
         // std::cout << "epsilon applied: " << epsilonApplied << std::endl;
 
         // if(epsilonApplied > 0.2) {std::cout << "  WARNING: epsilon should not be higher than 0.2, according to paper!" << std::endl;}
@@ -200,18 +207,16 @@ public:
 
         #pragma omp parallel
 	    {
-            std::mt19937 rng(omp_get_thread_num());
-            std::bernoulli_distribution coin(friendBeta);
-
             #pragma omp for schedule(dynamic,8)
             for (NodeId v = 0; v < n; v++) {
     	        [[maybe_unused]] NodeId lastU = 0;
 
                 if(g.out_degree(v)>=friendNumber) {
+                    Random::CounterRng rng(Random::DefaultSeed, v, FriendEdgeRound);
                     auto N = g.out_neigh(v);
                     for(NodeId* it = N.begin(); it<N.end(); it++) {
                         const NodeId u = *it;
-                        if(v<u && g.out_degree(u)>=friendNumber && coin(rng)) {
+                        if(v<u && g.out_degree(u)>=friendNumber && rng.bernoulli(friendBeta)) {
                             assert(lastU<=u); // guard against multiple edges
                             lastU = u+1;
 
@@ -497,40 +502,48 @@ public:
         if(nDense == 0){return;}
 
         std::vector<ColorID> tmpColoring(n,0);
+        std::vector<ColorID> keptColoring(n,0);
 
         uint64_t successes = 0;
         // Idea: dynamic for better balance?
         #pragma omp parallel reduction(+:successes)
         {
-            std::mt19937 rng(omp_get_thread_num());
-            std::uniform_int_distribution<NodeId> udist(1, delta+1);
-            std::bernoulli_distribution shouldColor(alpha);
-
             // tentative coloring round
             #pragma omp for
             for (NodeId v = 0; v < n; v++) {
-                if(shouldColor(rng)) {
-                    tmpColoring[v] = udist(rng);
+                Random::CounterRng rng(Random::DefaultSeed, v, InitialColoringRound);
+                if(rng.bernoulli(alpha)) {
+                    tmpColoring[v] = rng.uniform_int(1, delta+1);
                 }
+                keptColoring[v] = tmpColoring[v];
             }
 
-            // conflict resolution round
+            // conflict resolution round: only reads the coloring before this round and the tentative colors,
+            // the kept colors are committed afterwards, so the result does not depend on the schedule
             #pragma omp for
             for (NodeId v = 0; v < n; v++) {
                 ColorID c = tmpColoring[v];
                 if(c>0) {
             	    bool keepColor = true;
                     for (NodeId u : g.out_neigh(v)) {
-                        if(coloring[u] == c) {
+                        if(coloring[u] == c || (u != v && tmpColoring[u] == c)) {
                             keepColor = false;
                             break;
                         }
                     }
             	    if(keepColor) {
-                        coloring[v] = c;
                         successes++;
-                        //std::cout << "init col: " << v << " " << graphToDense[v] << std::endl;
-                    } // commit if no conflict
+                    } else {
+                        keptColoring[v] = 0;
+                    }
+                }
+            }
+
+            // commit if no conflict
+            #pragma omp for
+            for (NodeId v = 0; v < n; v++) {
+                if(keptColoring[v] > 0) {
+                    coloring[v] = keptColoring[v];
                 }
             }
         }
@@ -638,12 +651,10 @@ public:
 
             #pragma omp parallel
 	        {
-                int stride = std::max(omp_get_num_threads(), (int)nStepsDenseColoring);
-                std::mt19937 rng(omp_get_thread_num()*stride + i);
-
                 // IDEA: make dynamic!
                 #pragma omp for schedule(dynamic,8)
 		        for(NodeId comp = 0; comp < nComponent; comp++) {
+                    Random::CounterRng rng(Random::DefaultSeed, comp, DenseColoringRound + i);
                     // find Di and Zi
                     NodeId Di = 1;
                     NodeId Zi = delta;
@@ -698,7 +709,7 @@ public:
                         bool retry = true;
                         while(retry) {
                                 retry = false;
-                            const NodeId palIndex = std::uniform_int_distribution<NodeId>{0, palettes[vD].size()-1}(rng);
+                            const NodeId palIndex = rng.bounded(palettes[vD].size());
                             const ColorID cCandidate = palettes[vD][palIndex];
 
                             // for all neighbors in comp:
@@ -863,6 +874,9 @@ public:
 
     int n_colors() {return n;}
 
+    // number of vertices in dense components, the dense phases only run if it is positive
+    NodeId n_dense() const {return nDense;}
+
     // void print_nColored() {
     // 	// debug counting below:
 	//     uint64_t nColored = 0;
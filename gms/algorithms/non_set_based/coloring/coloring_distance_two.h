@@ -0,0 +1,139 @@
+#ifndef COLORING_DISTANCE_TWO_H_
+#define COLORING_DISTANCE_TWO_H_
+#include <omp.h>
+
+#include <vector>
+
+#include "gms/third_party/gapbs/benchmark.h"
+#include "gms/third_party/gapbs/graph.h"
+
+#include "coloring_common.h"
+
+namespace GMS::Coloring {
+
+// Smallest color not used within two hops of v. taken[c] == stamp marks color c as taken, so the marks need no
+// clearing as long as every call uses a new stamp; marks of earlier calls for v would block colors that are free
+// by now.
+template <class CGraph>
+int32_t smallest_free_color_distance_two(const CGraph &g, NodeId v, const std::vector<int32_t> &coloring,
+                                         std::vector<int64_t> &taken, int64_t stamp) {
+    // a vertex has fewer than this many distinct vertices within two hops, so its color is at most bound and
+    // colors above it need no mark
+    int64_t bound = 2;
+    for (NodeId w : g.out_neigh(v)) {
+        bound += g.out_degree(w) + 1;
+    }
+    if (int64_t(taken.size()) < bound + 1) {
+        taken.resize(bound + 1, -1);
+    }
+
+    for (NodeId w : g.out_neigh(v)) {
+        int32_t cw = coloring[w];
+        if (cw > 0 && cw <= bound) {
+            taken[cw] = stamp;
+        }
+        for (NodeId u : g.out_neigh(w)) {
+            int32_t cu = coloring[u];
+            if (u != v && cu > 0 && cu <= bound) {
+                taken[cu] = stamp;
+            }
+        }
+    }
+    int32_t c = 1;
+    while (taken[c] == stamp) {
+        c++;
+    }
+    return c;
+}
+
+// Parallel distance-2 coloring: no two vertices that are adjacent or share a neighbour get the same color.
+//
+// Speculative iterative scheme: every round all uncolored vertices pick, in parallel, the smallest color that is
+// not used within two hops (the forbidden set is collected by scanning the neighbourhood arrays of all
+// neighbours). Because neighbours may pick concurrently, a second parallel sweep detects conflicts and the vertex
+// with the larger id of each conflicting pair is recolored in the next round.
+template <class CGraph>
+int32_t graph_coloring_distance_two(const CGraph &g, std::vector<int32_t> &coloring) {
+    const int64_t n = g.num_nodes();
+    DetailTimer detailTimer;
+
+    std::vector<NodeId> worklist(n);
+#pragma omp parallel for
+    for (NodeId v = 0; v < n; v++) {
+        coloring[v] = 0;
+        worklist[v] = v;
+    }
+    std::vector<NodeId> conflicts(n);
+    std::vector<std::vector<int64_t>> forbidden(omp_get_max_threads());
+
+    detailTimer.endPhase("init");
+
+    int32_t maxColor = 0;
+    for (int64_t round = 0; !worklist.empty(); round++) {
+        const int64_t size = worklist.size();
+        int64_t nConflicts = 0;
+
+#pragma omp parallel
+        {
+            // the stamp round * n + v is unique per vertex and round, a recolored vertex must not see the marks of
+            // its earlier rounds
+            std::vector<int64_t> &taken = forbidden[omp_get_thread_num()];
+
+#pragma omp for schedule(dynamic, 64)
+            for (int64_t i = 0; i < size; i++) {
+                NodeId v = worklist[i];
+                coloring[v] = smallest_free_color_distance_two(g, v, coloring, taken, round * n + v);
+            }
+
+#pragma omp for schedule(dynamic, 64)
+            for (int64_t i = 0; i < size; i++) {
+                NodeId v = worklist[i];
+                const int32_t c = coloring[v];
+                bool conflict = false;
+                for (NodeId w : g.out_neigh(v)) {
+                    if (coloring[w] == c && w < v) {
+                        conflict = true;
+                        break;
+                    }
+                    for (NodeId u : g.out_neigh(w)) {
+                        if (coloring[u] == c && u < v) {
+                            conflict = true;
+                            break;
+                        }
+                    }
+                    if (conflict) {
+                        break;
+                    }
+                }
+                if (conflict) {
+                    int64_t pos;
+#pragma omp atomic capture
+                    pos = nConflicts++;
+                    conflicts[pos] = v;
+                }
+            }
+        }
+
+        // conflicting vertices must not block colors for each other in the next round
+#pragma omp parallel for
+        for (int64_t i = 0; i < nConflicts; i++) {
+            coloring[conflicts[i]] = 0;
+        }
+        conflicts.resize(nConflicts);
+        std::swap(worklist, conflicts);
+        conflicts.resize(worklist.size());
+        detailTimer.endPhase("round");
+    }
+
+#pragma omp parallel for reduction(max : maxColor)
+    for (NodeId v = 0; v < n; v++) {
+        maxColor = std::max(maxColor, coloring[v]);
+    }
+    detailTimer.endPhase("maxColor");
+    detailTimer.print();
+    return maxColor;
+}
+
+} // namespace GMS::Coloring
+
+#endif // COLORING_DISTANCE_TWO_H_
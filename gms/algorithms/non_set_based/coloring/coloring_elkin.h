@@ -10,10 +10,9 @@ template <class CGraph>
 int coloring_elkin(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n_colored) {
     NodeId n = g.num_nodes();
 
-    VRS selectors(omp_get_max_threads());
-    for (std::size_t i = 0; i < selectors.size(); i++) {
-        selectors[i] = random_selector<>();
-    }
+    // streams are keyed by (vertex, round), the seed keeps them apart from the ones of the Barenboim fallback
+    const uint64_t seed = Random::mix64(Random::DefaultSeed);
+    uint64_t round = 0;
 
     ColorID delta = get_delta(g);
 
@@ -63,7 +62,7 @@ int coloring_elkin(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n_col
                 continue;
             }
 
-            auto selector = selectors[omp_get_thread_num()];
+            random_selector<> selector(seed, v, 2 * round);
 
             auto palette_v_size = palettes[v].size();
             double p_i = p_i_precompute / palette_v_size;
@@ -90,7 +89,7 @@ int coloring_elkin(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n_col
                 continue;
             }
 
-            auto selector = selectors[omp_get_thread_num()];
+            random_selector<> selector(seed, v, 2 * round + 1);
 
             VC difference = std::move(VC(chosen_colors[v]));
             VC temp(chosen_colors[v].size());
@@ -143,6 +142,7 @@ int coloring_elkin(const CGraph &g, VC &coloring, VN &g_nodes, std::size_t n_col
             new_color[v] = 0;
             chosen_colors[v].clear();
         }
+        round++;
     }
 
     return n_colored;
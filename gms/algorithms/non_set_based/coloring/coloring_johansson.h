@@ -118,12 +118,6 @@ int graph_coloring_johansson_no_updates(const CGraph& g, vector<int32_t>& colors
         }
     }
 
-    // initialize multiple random selectors for concurrent access
-    vector<random_selector<>> randoms(omp_get_max_threads());
-    for (int32_t i = 0; i < randoms.size(); i++) {
-        randoms[i] = random_selector<>();
-    }
-
     // keep track of hom many nodes are colored
     vector<int32_t> nodes_colored(omp_get_max_threads(), 0);
     int32_t nodes_remaining = n;
@@ -134,36 +128,50 @@ int graph_coloring_johansson_no_updates(const CGraph& g, vector<int32_t>& colors
     int iter = 0;
     // until all nodes are colored...
     while (nodes_remaining > 0) {
+        GMS_INSTR_EVENT("johansson/rounds");
+        GMS_INSTR_REGION();
 #pragma omp parallel
         {
             // select a random color from the node's palette,
             // remember which element that was s.t. we can later see if the coloring took place this round
-#pragma omp for schedule(static)
-            for (NodeId v = 0; v < n; v++) {
-                // move on if this node is already colored
-                if (colors[v] > 0)
-                    continue;
-                // negate the color to indicate that it has been picked this turn
-                colors[v] = - randoms[omp_get_thread_num()].select_num(1, max_degree + 1);
+            // (the busy time covers the thread's whole chunk, the barrier is idle time)
+            {
+                GMS_INSTR_BUSY();
+#pragma omp for schedule(static) nowait
+                for (NodeId v = 0; v < n; v++) {
+                    // move on if this node is already colored
+                    if (colors[v] > 0)
+                        continue;
+                    // negate the color to indicate that it has been picked this turn
+                    random_selector<> selector(Random::DefaultSeed, v, iter);
+                    colors[v] = - selector.select_num(1, max_degree + 1);
+                }
             }
+#pragma omp barrier
 
             // check if the neighbours also picked that color,
-            // if so we don't want to pick the color this round
-#pragma omp for schedule(static)
-            for (NodeId v = 0; v < n; v++) {
-                if (colors[v] > 0)
-                    continue;
-                for (NodeId u : g.out_neigh(v)) {
-                    if (abs(colors[v]) == abs(colors[u])) {
-                        colors[v] = 0;
-                        break;
+            // if so we don't want to pick the color this round.
+            // Losers keep their negated pick until the next round, so that concurrent checks of their neighbours
+            // see the same value regardless of the schedule.
+            {
+                GMS_INSTR_BUSY();
+#pragma omp for schedule(static) nowait
+                for (NodeId v = 0; v < n; v++) {
+                    if (colors[v] > 0)
+                        continue;
+                    bool conflict = false;
+                    for (NodeId u : g.out_neigh(v)) {
+                        if (abs(colors[v]) == abs(colors[u])) {
+                            conflict = true;
+                            break;
+                        }
                     }
-                }
 
-                if(colors[v] != 0){
-                    nodes_colored[omp_get_thread_num()]++;
-                    colors[v] = abs(colors[v]);
-                    continue;
+                    if(!conflict){
+                        nodes_colored[omp_get_thread_num()]++;
+                        colors[v] = abs(colors[v]);
+                        continue;
+                    }
                 }
             }
         } // END PARALLEL SECTION
@@ -54,6 +54,7 @@ public:
 
     // Only called by the owner thread, spins until a ready vertex is available
     void dequeue(std::vector<NodeId> &color_queue) {
+        GMS_INSTR_PHASE("jones/wait");
         // Wait until at least one ready vertex is available
         size_t cur_write_pos;
         do {
@@ -187,6 +188,7 @@ int32_t sequential_coloring_unordered(const CGraph& g, std::vector<int32_t> &col
                                       std::vector<int32_t> &n_wait, const node_queue_list &send_queues,
                                       std::vector<ready_queue> &ready_queues, const int64_t part_max_size,
                                       std::vector<bool> &color_palette) {
+    GMS_INSTR_BUSY();
     int32_t max_color = 0;
     for (NodeId v : color_queue) {
         int32_t color = pick_lowest_consistent_color(g, coloring, v, color_palette);
@@ -201,6 +203,7 @@ int32_t sequential_coloring_ldo(const CGraph& g, std::vector<int32_t> &coloring,
                                 std::vector<int32_t> &n_wait, const node_queue_list &send_queues,
                                 std::vector<ready_queue> &ready_queues, const int64_t part_max_size,
                                 std::vector<bool> &color_palette) {
+    GMS_INSTR_BUSY();
     struct idx_and_degree {
         size_t index;
         int64_t degree;
@@ -238,6 +241,7 @@ int32_t sequential_coloring_ido(const CGraph& g, std::vector<int32_t> &coloring,
                                 std::vector<int32_t> &n_wait, const node_queue_list &send_queues,
                                 std::vector<ready_queue> &ready_queues, const int64_t part_max_size,
                                 std::vector<bool> &color_palette) {
+    GMS_INSTR_BUSY();
     int32_t max_color = 0;
 
     size_t n_to_color = color_queue.size();
@@ -297,6 +301,7 @@ int32_t sequential_coloring_sdo(const CGraph& g, std::vector<int32_t> &coloring,
                                 std::vector<int32_t> &n_wait, const node_queue_list &send_queues,
                                 std::vector<ready_queue> &ready_queues, const int64_t part_max_size,
                                 std::vector<bool> &color_palette) {
+    GMS_INSTR_BUSY();
     // Sort the vertices by decreasing order of degrees
     struct idx_and_degree {
         size_t index1;
@@ -426,6 +431,8 @@ template <class CGraph>
 size_t partition_graph(const CGraph &g, const int64_t part_start, const int64_t part_end, const uint32_t rho_seed,
                        std::vector<int32_t> &n_wait, node_queue_list &send_queue,
                        std::vector<NodeId> &color_queue, std::vector<NodeId> &local_vertices) {
+    GMS_INSTR_BUSY();
+    GMS_INSTR_PHASE("jones/partition");
     int64_t max_degree = 0;
 
     for (NodeId v = part_start; v < part_end; ++v) {
@@ -477,13 +484,14 @@ int32_t graph_coloring_jones(const CGraph &g, std::vector<int32_t> &coloring) {
     int32_t num_colors = 0;
     size_t shared_vertices_count = 0;
 
-    std::random_device rd;
-    const uint32_t rho_seed = rd();
+    // fixed seed: the priorities, and hence the coloring, are reproducible across runs and thread counts
+    const uint32_t rho_seed = (uint32_t) Random::DefaultSeed;
 
     std::cout << omp_get_max_threads() << " " << omp_get_num_threads() << std::endl;
 
 //    timer.endPhase("init");
 
+    GMS_INSTR_REGION();
 #pragma omp parallel shared(g, coloring, ready_queues, n_wait) reduction(max: num_colors) reduction(+: shared_vertices_count)
     {
         const int tcount = omp_get_num_threads();
@@ -339,8 +339,8 @@ int32_t graph_coloring_jones(const CGraph &g, std::vector<int32_t> &coloring, st
     int32_t num_colors = 0;
     size_t shared_vertices_count = 0;
 
-    std::random_device rd;
-    const uint32_t rho_seed = rd();
+    // fixed seed: the priorities, and hence the coloring, are reproducible across runs and thread counts
+    const uint32_t rho_seed = (uint32_t) Random::DefaultSeed;
 
     std::cout << omp_get_max_threads() << " " << omp_get_num_threads() << std::endl;
 
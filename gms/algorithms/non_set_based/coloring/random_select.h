@@ -2,37 +2,36 @@
 #define RAMDOM_SELECT_H_
 
 #include <iterator>
-#include <random>
+
+#include <gms/common/random.h>
 
 namespace GMS::Coloring {
 
 // https://gist.github.com/cbsmith/5538174
-template <typename RandomGenerator = std::default_random_engine>
+// The default generator is counter-based: construct one selector per (vertex, round) to get results that do not
+// depend on the number of threads.
+template <typename RandomGenerator = Random::CounterRng>
 struct random_selector {
-    // On most platforms, you probably want to use std::random_device("/dev/urandom")()
-    random_selector(RandomGenerator g = RandomGenerator(std::random_device()())) : gen(g) {
-        unif_0_1 = std::uniform_real_distribution<double>(0,1);
-    }
+    random_selector(uint64_t seed, uint64_t key, uint64_t round = 0) : gen(seed, key, round) {}
+
+    explicit random_selector(RandomGenerator g) : gen(g) {}
 
     double rand_0_1() {
-        return unif_0_1(gen);
+        return (double) (gen() >> 11) * 0x1.0p-53;
     }
 
     int32_t select_num(int start, int end) {
-        std::uniform_int_distribution<> dis(start, end);
-        return dis(gen);
+        return start + (int32_t) Random::bounded(gen, (uint64_t) (end - start) + 1);
     }
 
     template <typename Iter>
     Iter select(Iter start, Iter end) {
-        std::uniform_int_distribution<> dis(0, std::distance(start, end) - 1);
-        std::advance(start, dis(gen));
+        std::advance(start, Random::bounded(gen, std::distance(start, end)));
         return start;
     }
 
     int32_t* select_array(int32_t* array_begin, size_t range) {
-        std::uniform_int_distribution<> dis(0, range - 1);
-        return array_begin + dis(gen);
+        return array_begin + Random::bounded(gen, range);
     }
 
     // convenience function
@@ -50,7 +49,6 @@ struct random_selector {
 
 private:
     RandomGenerator gen;
-    std::uniform_real_distribution<double> unif_0_1;
 };
 
 } // namespace GMS::Coloring
@@ -28,7 +28,9 @@ public:
     double epsilon;
 
     CliqueCountPipeline(const CLApp& clapp) : clApp(clapp), originalGraph(nullptr), danischGraph(nullptr), count(0), epsilon(1.)
-    {}
+    {
+        SetStageNames("preprocess", "kernel", "verify_setup", "verify", "verify_teardown");
+    }
 
     void Preprocess()
     {
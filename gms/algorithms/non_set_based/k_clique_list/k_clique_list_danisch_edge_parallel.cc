@@ -13,6 +13,7 @@ void benchmark_suite(BenchCLApp &cli, CGraph &g) {
 
     P pipeline(cli);
     pipeline.originalGraph = &g;
+    pipeline.SetInputGraph(g);
 
     pipeline.SetPrintInfo("ep", "kclisting", "degeneracy");
     pipeline.template Run<P>(cli, &P::Preprocess, &P::kclisting, &P::verifierSetup, &P::verify, &P::verifierTearDown);
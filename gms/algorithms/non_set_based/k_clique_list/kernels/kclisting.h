@@ -6,6 +6,7 @@
 #include <algorithm>
 
 
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 #include "gms/third_party/gapbs/gapbs.h"
 
@@ -91,6 +92,7 @@ namespace GMS::KClique
 
         void listing(CGraph& g, const uint level)
         {
+            GMS_INSTR_DEPTH();
             // count cliques
             if(level == 2 || level == 1)
             {
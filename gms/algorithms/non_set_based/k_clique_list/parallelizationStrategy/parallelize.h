@@ -3,6 +3,7 @@
 #include <vector>
 #include <omp.h>
 
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 #include "gms/third_party/gapbs/gapbs.h"
 
@@ -50,6 +51,7 @@ namespace Parallelize
         }
 
         unsigned long long count = 0;
+        GMS_INSTR_REGION();
         #pragma omp parallel reduction(+:count)
         {
             Builder_T builder(g, (uint)coreNumber);
@@ -58,6 +60,7 @@ namespace Parallelize
             #pragma omp for schedule(dynamic, 1) nowait
             for(NodeId node = 0; node < g.num_nodes(); node++)
             {
+                GMS_INSTR_BUSY();
                 CGraph graph = builder.buildSubGraph(node);
                 count += counter.count(graph);
             }
@@ -97,6 +100,7 @@ namespace Parallelize
         const NodeId first = 0;
         const NodeId last = g.num_nodes() -1;
 
+        GMS_INSTR_REGION();
         #pragma omp parallel reduction(+:count)
         {
             Builder_T builder(g, coreNumber);
@@ -107,6 +111,7 @@ namespace Parallelize
             #pragma omp for schedule(dynamic, 1) nowait
             for(auto it = g.out_neigh(first).begin(); it < g.out_neigh(last).end(); it++)
             {
+                GMS_INSTR_BUSY();
                 while(it >= g.out_neigh(u_counter).end())
                 {
                     u_counter++;
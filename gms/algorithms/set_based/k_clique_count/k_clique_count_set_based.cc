@@ -43,5 +43,13 @@ int main(int argc, char *argv[]) {
                     CliqueCountVerifier<SortedSet, SortedSetGraph, SortedSet>, k,
                     "SortedSet", "SortedNeighGraph");
 
+    BenchmarkKernel(args, g, CliqueCount<KbitSet, KbitSetGraph, KbitSet>,
+                    CliqueCountVerifier<KbitSet, KbitSetGraph, KbitSet>, k,
+                    "KbitSet", "KbitSetGraph");
+
+    BenchmarkKernel(args, g, CliqueCount<VarintSet, VarintSetGraph, VarintSet>,
+                    CliqueCountVerifier<VarintSet, VarintSetGraph, VarintSet>, k,
+                    "VarintSet", "VarintSetGraph");
+
     return 0;
 }
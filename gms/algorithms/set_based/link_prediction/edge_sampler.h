@@ -2,11 +2,14 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <omp.h>
 
 #include <gms/common/types.h>
-#include <gms/representations/sets/sorted_set.h>
-#include <gms/third_party/fast_range.h>
+#include <gms/common/random.h>
+#include <gms/third_party/robin_hood.h>
 #include "undirected_edge.h"
 
 namespace GMS::LinkPrediction {
@@ -14,6 +17,14 @@ namespace GMS::LinkPrediction {
 /**
  * @brief Provides sampling of undirected edges from a graph and its complement respectively.
  *
+ * The undirected edges are kept in a flat array, so an edge is sampled in O(1) by drawing an index.
+ * A hash map from the edges to their positions in the array serves as membership structure:
+ * complement edges are sampled by rejection of uniformly drawn vertex pairs, which takes O(1) expected time
+ * for sparse graphs, and edges can be removed from or added to the sampler in O(1).
+ * The map is built in parallel when the sampler is (re)built for complement sampling, outside of the parallel
+ * loops which draw the samples, where its parallel regions would be nested and run on one thread. Otherwise it is
+ * built the first time it is needed, so samplers which only draw edges of the graph never pay for it.
+ *
  * This class assumes an undirected and sparse graph.
  *
  * Several modifications might be necessary to make it work with a directed graph,
@@ -23,7 +34,6 @@ namespace GMS::LinkPrediction {
  */
 template <class SGraph>
 class EdgeSampler {
-    using Set = typename SGraph::Set;
 public:
     EdgeSampler(const SGraph &graph, bool initialize_primary=true, bool initialize_complement=true) :
         graph(graph)
@@ -32,126 +42,280 @@ public:
     }
 
     /**
-     * Rebuild cumulative sums of neighborhood degrees.
+     * Rebuild the edge array and the membership structure from the graph.
      *
      * In most cases you should prefer the `rebuild()` method without arguments,
-     * as this will already make sure that the correct sums are rebuilt.
+     * as this will already make sure that the correct structures are rebuilt.
      *
-     * @param primary    whether to rebuild primary sums
-     * @param complement whether to rebuild complement sums
+     * @param primary    whether edges of the graph will be sampled
+     * @param complement whether edges of the complement will be sampled
      */
     void rebuild(bool primary, bool complement) {
-        uint64_t num_nodes = graph.num_nodes();
-
-        uint64_t num_edges = 0;
-        uint64_t num_compl = 0;
-        if (primary) { cumulative_degree.resize(num_nodes); }
-        if (complement) { cumulative_complement_degree.resize(num_nodes); }
-
-        for (uint64_t u = 0; u < num_nodes; ++u) {
-            uint64_t c = graph.out_degree(u);
-            if (primary) {
-                num_edges += c;
-                cumulative_degree[u] = num_edges;
+        this->primary = primary;
+        this->complement = complement;
+        num_nodes = graph.num_nodes();
+
+        // Collect the edges (u, v) with u <= v in parallel, the order is that of the neighborhoods.
+        std::vector<int64_t> offsets(num_nodes + 1, 0);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeId u = 0; u < num_nodes; ++u) {
+            int64_t count = 0;
+            for (NodeId v : graph.out_neigh(u)) {
+                count += u <= v;
             }
-            if (complement) {
-                assert(std::numeric_limits<uint64_t>::max() - (num_nodes - c) > num_compl);
-                num_compl += num_nodes - c;
-                cumulative_complement_degree[u] = num_compl;
+            offsets[u + 1] = count;
+        }
+        for (NodeId u = 0; u < num_nodes; ++u) {
+            offsets[u + 1] += offsets[u];
+        }
+
+        edges.clear();
+        edges.resize(offsets[num_nodes]);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeId u = 0; u < num_nodes; ++u) {
+            int64_t pos = offsets[u];
+            for (NodeId v : graph.out_neigh(u)) {
+                if (u <= v) {
+                    edges[pos++] = UndirectedEdge(u, v);
+                }
             }
         }
+
+        for (auto &shard : position) {
+            shard.clear();
+        }
+        position_built.store(false, std::memory_order_release);
+        num_complement_pairs = uint64_t(num_nodes) * (num_nodes - 1) / 2 - num_edges();
+        if (complement) {
+            build_position();
+        }
     }
 
     /**
-     * Rebuild cumulative sums of neighborhood degrees.
+     * Rebuild the edge array and the membership structure from the graph.
      *
-     * This method should be called if the input graph is changed an further edges are to be sampled.
+     * This method should be called if the input graph is changed an further edges are to be sampled,
+     * unless the changes have been applied to the sampler with add_edge and remove_edge as well.
      */
     void rebuild() {
-        rebuild(!cumulative_degree.empty(), !cumulative_complement_degree.empty());
+        rebuild(primary, complement);
+    }
+
+    /**
+     * Number of undirected edges, self loops included.
+     */
+    int64_t num_edges() const {
+        return edges.size();
+    }
+
+    /**
+     * Whether the membership structure is built, it is only built on demand for samplers of the graph's edges.
+     */
+    bool membership_built() const {
+        return position_built.load(std::memory_order_acquire);
+    }
+
+    bool contains(const UndirectedEdge &edge) const {
+        const uint64_t k = key(edge);
+        const auto &shard = positions(k);
+        return shard.find(k) != shard.end();
+    }
+
+    /**
+     * Adds an edge to the sampled graph in O(1), it has to be added to the graph separately.
+     */
+    void add_edge(const UndirectedEdge &edge) {
+        assert(!contains(edge));
+        const uint64_t k = key(edge);
+        positions(k)[k] = edges.size();
+        edges.push_back(edge);
+        num_complement_pairs -= edge.first != edge.second;
+    }
+
+    /**
+     * Removes an edge from the sampled graph in O(1), it has to be removed from the graph separately.
+     */
+    void remove_edge(const UndirectedEdge &edge) {
+        const uint64_t k = key(edge);
+        auto &shard = positions(k);
+        auto it = shard.find(k);
+        assert(it != shard.end());
+        int64_t index = it->second;
+        shard.erase(it);
+        if (index != (int64_t) edges.size() - 1) {
+            edges[index] = edges.back();
+            const uint64_t moved = key(edges[index]);
+            positions(moved)[moved] = index;
+        }
+        edges.pop_back();
+        num_complement_pairs += edge.first != edge.second;
     }
 
     /**
      * Sample a random edge of the graph uniformly.
      *
-     * @tparam Rng STL compatible RNG class
+     * @tparam Rng STL compatible RNG class producing 64-bit words, e.g. Random::CounterRng
      * @param rng the random number generator to be used
      * @return
      */
     template <class Rng>
     UndirectedEdge sample(Rng &rng) const {
-        // Find the first vertex associated with this edge.
-        auto [edge_index, u] = sample_weighted(cumulative_degree, rng);
-
-        // Now find the second node of the edge.
-        auto neigh = graph.out_neigh(u).begin();
-        uint64_t offset = edge_index - ((u > 0) ? cumulative_degree[u - 1] : 0);
-        std::advance(neigh, offset);
-        NodeId v = *neigh;
-
-        return UndirectedEdge(std::min(u, v), std::max(u, v));
+        assert(primary && num_edges() > 0);
+        return edges[Random::bounded(rng, edges.size())];
     }
 
     /**
-     * Sample a random edge of the complement graph uniformly, i.e. an edge which doesn't exist.
+     * Sample a random edge of the complement graph uniformly, i.e. a pair of distinct vertices which isn't an edge.
      *
-     * @tparam Rng STL compatible RNG class
+     * @tparam Rng STL compatible RNG class producing 64-bit words, e.g. Random::CounterRng
      * @param rng the random number generator to be used
      * @return
      */
     template <class Rng>
     UndirectedEdge sample_complement(Rng &rng) const {
-        // Sample a complement edge.
-        auto [edge_index, u] = sample_weighted(cumulative_complement_degree, rng);
-        assert(u < graph.num_nodes());
-#ifndef NDEBUG
-        int64_t num_complement_u = graph.num_nodes() - graph.out_degree(u);
-#endif
-        assert(0 < num_complement_u);
-        assert(num_complement_u < graph.num_nodes());
-
-        // Now find the second node of the complement edge.
-        uint64_t offset = edge_index - ((u > 0) ? cumulative_complement_degree[u - 1] : 0);
-        assert(offset < num_complement_u);
-
-        NodeId v = offset;
-        if constexpr (std::is_same_v<Set, SortedSet>) {
-            for (NodeId k : graph.out_neigh(u)) {
-                if (k <= v) { v++; } else { break; }
+        assert(complement && num_complement_pairs > 0);
+        while (true) {
+            NodeId u = Random::bounded(rng, num_nodes);
+            NodeId v = Random::bounded(rng, num_nodes);
+            if (u == v) {
+                continue;
             }
-        } else {
-            const auto &neigh = graph.out_neigh(u);
-            std::vector<NodeId> indices(neigh.cardinality());
-            std::sort(indices.begin(), indices.end());
-            for (NodeId k : indices) {
-                if (k <= v) { v++; } else { break; }
+            UndirectedEdge edge(std::min(u, v), std::max(u, v));
+            if (!contains(edge)) {
+                return edge;
             }
         }
+    }
 
-        auto edge = UndirectedEdge(std::min(u, v), std::max(u, v));
-        if (graph.out_neigh(edge.first).contains(edge.second)) {
-            const auto &neigh = graph.out_neigh(edge.first);
-            neigh.contains(edge.second);
+    /**
+     * Samples edges of the graph in parallel, each sample uses its own random stream.
+     *
+     * The result only depends on the seed and the round, not on the number of threads.
+     *
+     * @param count number of samples, drawn with replacement
+     * @param seed
+     * @param round distinguishes several batches drawn with the same seed
+     * @return
+     */
+    std::vector<UndirectedEdge> sample_batch(int64_t count, uint64_t seed = Random::DefaultSeed,
+                                             uint64_t round = 0) const {
+        std::vector<UndirectedEdge> result(count);
+        #pragma omp parallel for
+        for (int64_t i = 0; i < count; ++i) {
+            Random::CounterRng rng(seed, i, round);
+            result[i] = sample(rng);
+        }
+        return result;
+    }
+
+    /**
+     * Samples edges of the complement graph in parallel, see sample_batch.
+     */
+    std::vector<UndirectedEdge> sample_complement_batch(int64_t count, uint64_t seed = Random::DefaultSeed,
+                                                        uint64_t round = 0) const {
+        std::vector<UndirectedEdge> result(count);
+        build_position();
+        #pragma omp parallel for
+        for (int64_t i = 0; i < count; ++i) {
+            Random::CounterRng rng(seed, i, round);
+            result[i] = sample_complement(rng);
         }
-        assert(!graph.out_neigh(edge.first).contains(edge.second));
-        return edge;
+        return result;
     }
 
 private:
     const SGraph &graph;
+    bool primary;
+    bool complement;
+    int64_t num_nodes;
+    uint64_t num_complement_pairs;
 
-    std::vector<uint64_t> cumulative_degree;
-    std::vector<uint64_t> cumulative_complement_degree;
+    std::vector<UndirectedEdge> edges;
 
-    template <class Rng>
-    std::tuple<uint64_t, NodeId> sample_weighted(const std::vector<uint64_t> &c_degree, Rng &rng) const {
-        assert(c_degree.size() > 0);
-        int64_t num_candidates = c_degree.back();
-        assert(num_candidates > 0);
-        uint64_t edge_index = fastrange64(rng(), num_candidates);
-        auto iterator = std::upper_bound(c_degree.begin(), c_degree.end(), edge_index);
-        return std::tuple(edge_index, std::distance(c_degree.begin(), iterator));
+    // edge key -> index in edges, split into shards by the high bits of the mixed key so that the shards
+    // can be filled by different threads
+    static constexpr int PositionShardBits = 6;
+    static constexpr int PositionShards = 1 << PositionShardBits;
+    using PositionMap = robin_hood::unordered_flat_map<uint64_t, int64_t>;
+    mutable std::vector<PositionMap> position = std::vector<PositionMap>(PositionShards);
+    mutable std::atomic<bool> position_built{false};
+    mutable std::mutex position_mutex;
+
+    uint64_t key(const UndirectedEdge &edge) const {
+        return uint64_t(edge.first) * uint64_t(num_nodes) + uint64_t(edge.second);
+    }
+
+    static int shard_of(uint64_t key) {
+        return Random::mix64(key) >> (64 - PositionShardBits);
+    }
+
+    PositionMap &positions(uint64_t key) const {
+        build_position();
+        return position[shard_of(key)];
+    }
+
+    /**
+     * Builds the membership structure if it hasn't been built since the last rebuild.
+     *
+     * The edge indices are bucketed by shard with a counting sort, then every shard is filled by one thread.
+     */
+    void build_position() const {
+        if (position_built.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(position_mutex);
+        if (position_built.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const int64_t m = edges.size();
+        const int num_threads = omp_get_max_threads();
+        std::vector<int64_t> counts(int64_t(num_threads) * PositionShards, 0);
+        std::vector<uint8_t> shards(m);
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int64_t *local = &counts[int64_t(omp_get_thread_num()) * PositionShards];
+            #pragma omp for schedule(static)
+            for (int64_t i = 0; i < m; ++i) {
+                shards[i] = shard_of(key(edges[i]));
+                local[shards[i]]++;
+            }
+        }
+
+        // offsets ordered by shard, then by thread
+        std::vector<int64_t> offsets(int64_t(num_threads) * PositionShards, 0);
+        std::vector<int64_t> shard_begin(PositionShards + 1, 0);
+        int64_t sum = 0;
+        for (int s = 0; s < PositionShards; ++s) {
+            shard_begin[s] = sum;
+            for (int t = 0; t < num_threads; ++t) {
+                offsets[int64_t(t) * PositionShards + s] = sum;
+                sum += counts[int64_t(t) * PositionShards + s];
+            }
+        }
+        shard_begin[PositionShards] = sum;
+
+        std::vector<int64_t> order(m);
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int64_t *local = &offsets[int64_t(omp_get_thread_num()) * PositionShards];
+            #pragma omp for schedule(static)
+            for (int64_t i = 0; i < m; ++i) {
+                order[local[shards[i]]++] = i;
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int s = 0; s < PositionShards; ++s) {
+            PositionMap &shard = position[s];
+            shard.clear();
+            shard.reserve(shard_begin[s + 1] - shard_begin[s]);
+            for (int64_t j = shard_begin[s]; j < shard_begin[s + 1]; ++j) {
+                shard[key(edges[order[j]])] = order[j];
+            }
+        }
+        position_built.store(true, std::memory_order_release);
     }
 };
 
-}
\ No newline at end of file
+}
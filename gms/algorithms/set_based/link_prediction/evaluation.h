@@ -2,24 +2,35 @@
 
 #include <random>
 #include <algorithm>
+#include <parallel/algorithm>
 
 #include <gms/representations/sets/roaring_set.h>
 #include <gms/algorithms/set_based/vertex_similarity/vertex_similarity.h>
 #include "undirected_edge.h"
 #include "link_prediction.h"
 #include "edge_sampler.h"
-#include <gms/third_party/fast_statistics.h>
+#include <gms/common/random.h>
+#include <gms/third_party/gapbs/graph.h>
 #include <omp.h>
 
 /// Implementation for evaluation of link prediction.
 
 namespace GMS::LinkPrediction {
 
+template <class SGraph>
+void invalidate_degree_weights(SGraph &g)
+{
+    if constexpr (VertexSim::detail::has_degree_weights<SGraph>::value) {
+        g.invalidate_degree_weights();
+    }
+}
+
 template <class SGraph>
 void add_undirected_edge(SGraph &g, NodeId u, NodeId v)
 {
     g.out_neigh(u).add(v);
     g.out_neigh(v).add(u);
+    invalidate_degree_weights(g);
 }
 
 template <class SGraph>
@@ -27,6 +38,7 @@ void remove_undirected_edge(SGraph &g, NodeId u, NodeId v)
 {
     g.out_neigh(u).remove(v);
     g.out_neigh(v).remove(u);
+    invalidate_degree_weights(g);
 }
 
 template <class SGraph>
@@ -34,52 +46,137 @@ void extract_random_test_edges(SGraph &g_train, SGraph &g_test, int64_t test_edg
     assert(count_undirected_edges(g_test) == 0);
     assert(count_undirected_edges(g_train) >= test_edges_required);
 
-    EdgeSampler sampler(g_train);
-    FastStatistics::WyRandRng rng(0);
+    EdgeSampler sampler(g_train, true, false);
+    Random::CounterRng rng(Random::DefaultSeed);
 
-    auto remove_test_edges = [&](){
-        // Remove the test edges from the train graph.
-        // Note that we do this in two steps for now since otherwise EdgeSampler would be invalidated.
-        int64_t num_nodes = g_train.num_nodes();
-        for (NodeId u = 0; u < num_nodes; ++u) {
-            for (NodeId v : g_test.out_neigh(u)) {
-                remove_undirected_edge(g_train, u, v);
-            }
-        }
-    };
-
-    int64_t num_edges = 0;
-#ifndef NDEBUG
-    int accepted = 0;
-#endif
-    int rejections = 0;
-    while (num_edges < test_edges_required) {
+    // Sampled edges are removed from the sampler right away, so no edge is drawn twice.
+    for (int64_t num_edges = 0; num_edges < test_edges_required; ++num_edges) {
         UndirectedEdge edge = sampler.sample(rng);
-        if (!g_test.out_neigh(edge.first).contains(edge.second)) {
-            add_undirected_edge(g_test, edge.first, edge.second);
-            ++num_edges;
-#ifndef NDEBUG
-            ++accepted;
-#endif
-        } else {
-            ++rejections;
+        sampler.remove_edge(edge);
+        add_undirected_edge(g_test, edge.first, edge.second);
+    }
+
+    // Remove the test edges from the train graph.
+    int64_t num_nodes = g_train.num_nodes();
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        for (NodeId v : g_test.out_neigh(u)) {
+            remove_undirected_edge(g_train, u, v);
         }
-        if (rejections > 100) {
-            remove_test_edges();
-            sampler.rebuild();
-            rejections = 0;
+    }
+}
+
+/**
+ * Train and test graphs of a link prediction experiment, the test graph holds the removed edges.
+ */
+struct TrainTestSplit {
+    CSRGraph train;
+    CSRGraph test;
+    int64_t num_test_edges;
+};
+
+namespace detail {
+
+// Builds an undirected CSR graph from the slots of g for which keep(slot) holds, the order of neighbors is preserved.
+template <class Keep>
+CSRGraph filter_csr(const CSRGraph &g, const std::vector<int64_t> &offsets, Keep &&keep) {
+    const int64_t num_nodes = g.num_nodes();
+    pvector<SGOffset> new_offsets(num_nodes + 1);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        SGOffset degree = 0;
+        for (int64_t slot = offsets[u]; slot < offsets[u + 1]; ++slot) {
+            degree += keep(slot);
         }
-        /*
-#ifndef NDEBUG
-        if (num_edges % 32 == 0) {
-            std::cout << "sampled " << num_edges << "/" << test_edges_required << std::endl;
-            std::cout << " acc " << accepted << ", rej " << rejections << "\n";
+        new_offsets[u] = degree;
+    }
+    SGOffset total = 0;
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        SGOffset degree = new_offsets[u];
+        new_offsets[u] = total;
+        total += degree;
+    }
+    new_offsets[num_nodes] = total;
+
+    NodeId *neighs = new NodeId[total];
+    NodeId **index = CSRGraph::GenIndex(new_offsets, neighs);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        NodeId *out = index[u];
+        const NodeId *neigh = g.out_neigh(u).begin();
+        for (int64_t slot = offsets[u]; slot < offsets[u + 1]; ++slot) {
+            if (keep(slot)) {
+                *out++ = neigh[slot - offsets[u]];
+            }
         }
-#endif
-        */
     }
+    return CSRGraph(num_nodes, index, neighs);
+}
 
-    remove_test_edges();
+} // namespace detail
+
+/**
+ * Splits the edges of a graph into a train and a test graph.
+ *
+ * The test edges are the first ones of a random permutation of all undirected edges. The permutation is obtained
+ * from a single parallel sort by counter based random keys, so the split depends on the seed only and not on
+ * the number of threads. In contrast to extract_random_test_edges no graph is mutated incrementally.
+ *
+ * @param g undirected input graph with sorted neighborhoods and without self loops
+ * @param num_test_edges the number of undirected edges moved to the test graph
+ * @param seed
+ * @return
+ */
+inline TrainTestSplit split_train_test(const CSRGraph &g, int64_t num_test_edges,
+                                       uint64_t seed = Random::DefaultSeed) {
+    assert(!g.directed());
+    const int64_t num_nodes = g.num_nodes();
+
+    // Slot i is the i-th entry of the concatenated neighborhoods.
+    std::vector<int64_t> offsets(num_nodes + 1, 0);
+    std::vector<int64_t> upper_offsets(num_nodes + 1, 0);
+    #pragma omp parallel for
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        auto neigh = g.out_neigh(u);
+        offsets[u + 1] = g.out_degree(u);
+        upper_offsets[u + 1] = neigh.end() - std::upper_bound(neigh.begin(), neigh.end(), u);
+    }
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        offsets[u + 1] += offsets[u];
+        upper_offsets[u + 1] += upper_offsets[u];
+    }
+    const int64_t num_edges = upper_offsets[num_nodes];
+    assert(0 <= num_test_edges && num_test_edges <= num_edges);
+
+    // Shuffle the undirected edges, i.e. their slots (u, v) with u < v.
+    std::vector<std::pair<uint64_t, int64_t>> order(num_edges);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeId u = 0; u < num_nodes; ++u) {
+        const int64_t lower = (offsets[u + 1] - offsets[u]) - (upper_offsets[u + 1] - upper_offsets[u]);
+        for (int64_t i = upper_offsets[u]; i < upper_offsets[u + 1]; ++i) {
+            Random::CounterRng rng(seed, i);
+            order[i] = std::make_pair(rng(), offsets[u] + lower + (i - upper_offsets[u]));
+        }
+    }
+    __gnu_parallel::sort(order.begin(), order.end());
+
+    // Mark both slots of every test edge.
+    std::vector<uint8_t> is_test(offsets[num_nodes], 0);
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_test_edges; ++i) {
+        const int64_t slot = order[i].second;
+        NodeId u = std::upper_bound(offsets.begin(), offsets.end(), slot) - offsets.begin() - 1;
+        NodeId v = g.out_neigh(u).begin()[slot - offsets[u]];
+        auto neigh_v = g.out_neigh(v);
+        is_test[slot] = 1;
+        is_test[offsets[v] + (std::lower_bound(neigh_v.begin(), neigh_v.end(), u) - neigh_v.begin())] = 1;
+    }
+    std::vector<std::pair<uint64_t, int64_t>>().swap(order);
+
+    TrainTestSplit split;
+    split.train = detail::filter_csr(g, offsets, [&](int64_t slot) { return !is_test[slot]; });
+    split.test = detail::filter_csr(g, offsets, [&](int64_t slot) { return is_test[slot] != 0; });
+    split.num_test_edges = num_test_edges;
+    return split;
 }
 
 struct LinkPredictionScore {
@@ -137,36 +234,39 @@ LinkPredictionScore score_link_prediction_precision(const EdgeSet &e_predicted,
 template <VertexSim::Metric SimilarityMeasure, class SGraph>
 double score_link_prediction_auc(const SGraph &g_true, const SGraph &g_train, const SGraph &g_test, const int64_t num_trials)
 {
-    double higher_score = 0;
-    double equal_score = 0;
+    // Counted as integers, so the reduction is exact and the result doesn't depend on the schedule.
+    int64_t higher_score = 0;
+    int64_t equal_score = 0;
 
+    // The complement sampler builds its membership map here, in parallel, not nested in the sampling loop.
     EdgeSampler true_sampler(g_true, false, true);
     EdgeSampler test_sampler(g_test, true, false);
 
-    #pragma omp parallel
-    {
-        FastStatistics::WyRandRng rng(omp_get_thread_num());
-
-        #pragma omp for reduction(+:higher_score) reduction(+:equal_score)
-        for (int64_t i = 0; i < num_trials; ++i) {
-            // Sample a true and a false edge.
-            UndirectedEdge true_edge = test_sampler.sample(rng);
-            UndirectedEdge false_edge;
-            do {
-                false_edge = true_sampler.sample_complement(rng);
-                // Repeat until we find a complement edge of g_test which isn't an actual true edge which was removed
-                // for train/test split.
-            } while (g_test.out_neigh(false_edge.first).contains(false_edge.second));
-
-            // Score the edges.
-            double score_t = VertexSim::vertex_similarity<SimilarityMeasure>(true_edge.first, true_edge.second, g_train);
-            double score_f = VertexSim::vertex_similarity<SimilarityMeasure>(false_edge.first, false_edge.second, g_train);
-
-            if (score_t > score_f) {
-                higher_score += 1.0;
-            } else if (score_t == score_f) {
-                equal_score += 1.0;
-            }
+    DegreeWeights local_weights;
+    const DegreeWeights &weights = VertexSim::degree_weights_of(g_train, local_weights);
+
+    #pragma omp parallel for reduction(+:higher_score) reduction(+:equal_score)
+    for (int64_t i = 0; i < num_trials; ++i) {
+        // One stream per sample, the drawn edges do not depend on the number of threads.
+        Random::CounterRng rng(Random::DefaultSeed, i);
+
+        // Sample a true and a false edge.
+        UndirectedEdge true_edge = test_sampler.sample(rng);
+        UndirectedEdge false_edge;
+        do {
+            false_edge = true_sampler.sample_complement(rng);
+            // Repeat until we find a complement edge of g_test which isn't an actual true edge which was removed
+            // for train/test split.
+        } while (g_test.out_neigh(false_edge.first).contains(false_edge.second));
+
+        // Score the edges.
+        double score_t = VertexSim::vertex_similarity<SimilarityMeasure>(true_edge.first, true_edge.second, g_train, weights);
+        double score_f = VertexSim::vertex_similarity<SimilarityMeasure>(false_edge.first, false_edge.second, g_train, weights);
+
+        if (score_t > score_f) {
+            ++higher_score;
+        } else if (score_t == score_f) {
+            ++equal_score;
         }
     }
 
@@ -183,7 +283,7 @@ double score_link_prediction_auc(const SGraph &g_true, const SGraph &g_train, co
  */
 template <class SGraph>
 void add_false_links(SGraph &train_graph, int64_t mutations, const SGraph &test_graph) {
-    FastStatistics::WyRandRng rng(42);
+    Random::CounterRng rng(Random::DefaultSeed, 42);
     EdgeSampler sampler(train_graph);
     for (int64_t i = 0; i < mutations; ++i) {
         UndirectedEdge edge_remove = sampler.sample(rng);
@@ -192,10 +292,11 @@ void add_false_links(SGraph &train_graph, int64_t mutations, const SGraph &test_
             edge_create = sampler.sample_complement(rng);
         } while (test_graph.out_neigh(edge_create.first).contains(edge_create.second));
 
-        // perform the mutation
+        // perform the mutation, the sampler is updated in place
         remove_undirected_edge(train_graph, edge_remove.first, edge_remove.second);
         add_undirected_edge(train_graph, edge_create.first, edge_create.second);
-        sampler.rebuild();
+        sampler.remove_edge(edge_remove);
+        sampler.add_edge(edge_create);
     }
 }
 }
\ No newline at end of file
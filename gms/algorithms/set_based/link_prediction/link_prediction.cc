@@ -2,6 +2,7 @@
 
 #include "evaluation.h"
 #include "link_prediction.h"
+#include <gms/algorithms/set_based/vertex_similarity/common_neighbors.h>
 
 #include <gms/common/benchmark.h>
 #include <gms/common/cli/cli.h>
@@ -11,40 +12,55 @@ using namespace GMS::VertexSim;
 using namespace GMS::LinkPrediction;
 
 
-template <class SGraph, class CGraph>
+template <class SGraph>
 std::tuple<SGraph, SGraph, size_t>
-prepare_graphs(const CGraph &g, double test_rate) {
+prepare_graphs(const CSRGraph &g, double test_rate) {
     assert(0.0 < test_rate && test_rate < 1.0);
     assert(!g.directed());
-    SGraph g_train = SGraph::FromCGraph(g);
     const double num_edges = g.num_edges();
-    SGraph g_test(g.num_nodes());
     size_t num_test_edges = test_rate * num_edges;
     std::cout << "extracting test edges" << std::endl;
-    extract_random_test_edges(g_train, g_test, num_test_edges);
+    auto split = split_train_test(g, num_test_edges);
+    SGraph g_train = SGraph::FromCGraph(split.train);
+    SGraph g_test = SGraph::FromCGraph(split.test);
     std::cout << "extracted test edges" << std::endl;
 
     return std::tuple(std::move(g_train), std::move(g_test), num_test_edges);
 }
 
+template <class SGraph>
+void report_precision(const ScoredEdges &scoring, const SGraph &g_test) {
+    std::cout << "scoring" << std::endl;
+
+    using EdgeSet = SortedSetBase<UndirectedEdge>;
+    EdgeSet ES_scored(scoring.edges.data(), scoring.edges.size());
+
+    auto score = score_link_prediction_precision(ES_scored, g_test);
+    std::cout << "precision = " << score.precision << std::endl;
+    std::cout << "recall    = " << score.recall << std::endl;
+}
+
 template <class SGraph = RoaringGraph>
 int bench_ranking(const CSRGraph &g, double test_rate) {
     auto [g_train, g_test, num_test_edges] = prepare_graphs<SGraph>(g, test_rate);
 
     // Find the 25% best test edges.
     std::cout << "prediction" << std::endl;
-    auto scoring = link_prediction_similarity<Metric::Jaccard>(g_train, num_test_edges);
+    auto scoring = link_prediction_similarity_parallel<Metric::Jaccard>(g_train, num_test_edges);
     //auto scoring = link_prediction_similarity<Similarity::Jaccard>(g_train, num_test_edges * 3);
 
-    std::cout << "scoring" << std::endl;
+    report_precision(scoring, g_test);
+    return 0;
+}
 
-    using EdgeSet = SortedSetBase<UndirectedEdge>;
-    EdgeSet ES_scored(scoring.edges.data(), scoring.edges.size());
+template <class SGraph = RoaringGraph>
+int bench_ranking_minhash(const CSRGraph &g, double test_rate) {
+    auto [g_train, g_test, num_test_edges] = prepare_graphs<SGraph>(g, test_rate);
 
-    auto score = score_link_prediction_precision(ES_scored, g_test);
-    std::cout << "precision = " << score.precision << std::endl;
-    std::cout << "recall    = " << score.recall << std::endl;
+    std::cout << "prediction (minhash candidates)" << std::endl;
+    auto scoring = link_prediction_minhash(g_train, num_test_edges);
 
+    report_precision(scoring, g_test);
     return 0;
 }
 
@@ -58,6 +74,9 @@ double bench_auc(const CSRGraph &g, double test_rate, double false_link_rate, in
         add_false_links(g_train, num_false_links, g_test);
     }
 
+    // The train graph is final now, so its degree weights can be cached.
+    g_train.build_degree_weights();
+
     // Compute the AUC.
     std::cout << "scoring auc" << std::endl;
     double auc = score_link_prediction_auc<TMetric>(SGraph::FromCGraph(g), g_train, g_test, num_samples);
@@ -65,6 +84,42 @@ double bench_auc(const CSRGraph &g, double test_rate, double false_link_rate, in
     return auc;
 }
 
+template <class SGraph = SortedSetGraph>
+size_t bench_all_pairs_similarity(const CSRGraph &g) {
+    SGraph sg = SGraph::FromCGraph(g);
+    // all metrics for all two-hop non-edges in one pass
+    auto pairs = all_pairs_similarity(sg, PairMask::NonEdges);
+    std::cout << "scored pairs = " << pairs.size() << std::endl;
+    return pairs.size();
+}
+
+template <class SGraph = SortedSetGraph>
+double bench_minhash_quality(const CSRGraph &g, double threshold, int bits) {
+    SGraph sg = SGraph::FromCGraph(g);
+    MinHashParams params;
+    params.bits = bits;
+    auto quality = evaluate_minhash(sg, threshold, params);
+    std::cout << "minhash k = " << params.num_hashes << ", b = " << bits << ", threshold = " << threshold << std::endl;
+    std::cout << "exact pairs     = " << quality.exact_pairs << std::endl;
+    std::cout << "candidate pairs = " << quality.candidate_pairs << std::endl;
+    std::cout << "recall          = " << quality.recall << std::endl;
+    std::cout << "precision       = " << quality.precision << std::endl;
+    std::cout << "mean abs error  = " << quality.mean_abs_error << std::endl;
+    return quality.recall;
+}
+
+constexpr auto bind_minhash_quality(double threshold, int bits) {
+    return [=](const CSRGraph &g) {
+        return bench_minhash_quality(g, threshold, bits);
+    };
+}
+
+constexpr auto bind_ranking_minhash(double test_rate) {
+    return [=](const CSRGraph &g) {
+        return bench_ranking_minhash(g, test_rate);
+    };
+}
+
 constexpr auto bind_ranking(double test_rate) {
     return [=](const CSRGraph &g) {
         return bench_ranking(g, test_rate);
@@ -81,6 +136,10 @@ constexpr auto bind_auc(double test_rate, double false_link_rate, int64_t num_sa
 int main(int argc, char *argv[]) {
     CLI::Parser parser;
     auto param_num_samples = parser.add_param("samples", std::nullopt, "100000", "Number of samples for AUC computation");
+    auto param_all_pairs = parser.add_param("all-pairs", std::nullopt, "0",
+                                            "Also compute the exact similarity of all non-adjacent pairs (O(sum deg^2))");
+    auto param_minhash_quality = parser.add_param("minhash-quality", std::nullopt, "0",
+                                                  "Also compare the minhash candidates with the exact all-pairs result");
     auto [args, g] = parser.parse_and_load(argc, argv);
 
     int64_t num_samples = param_num_samples.to_int();
@@ -94,7 +153,22 @@ int main(int argc, char *argv[]) {
     BenchmarkKernel(args, g, bind_auc<Metric::Overlap>(0.25, 0.0, num_samples), VerifyUnimplemented);
     BenchmarkKernel(args, g, bind_auc<Metric::PrefAtt>(0.25, 0.0, num_samples), VerifyUnimplemented);
 
+    // the compressed neighborhoods, which are decoded block by block while intersecting
+    BenchmarkKernel(args, g, bind_auc<Metric::Jaccard, KbitSetGraph>(0.25, 0.01, num_samples), VerifyUnimplemented);
+    BenchmarkKernel(args, g, bind_auc<Metric::Jaccard, VarintSetGraph>(0.25, 0.01, num_samples), VerifyUnimplemented);
+
     BenchmarkKernel(args, g, bind_ranking(0.25), VerifyUnimplemented);
 
+    BenchmarkKernel(args, g, bind_ranking_minhash(0.25), VerifyUnimplemented);
+
+    if (param_all_pairs.to_int()) {
+        BenchmarkKernel(args, g, bench_all_pairs_similarity<>, VerifyUnimplemented);
+    }
+
+    if (param_minhash_quality.to_int()) {
+        BenchmarkKernel(args, g, bind_minhash_quality(0.5, 32), VerifyUnimplemented);
+        BenchmarkKernel(args, g, bind_minhash_quality(0.5, 4), VerifyUnimplemented);
+    }
+
     return 0;
 }
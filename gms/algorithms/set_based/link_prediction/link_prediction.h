@@ -6,8 +6,12 @@
 #include <vector>
 #include <random>
 
+#include <omp.h>
+
 #include <gms/common/types.h>
 #include <gms/algorithms/set_based/vertex_similarity/vertex_similarity.h>
+#include <gms/algorithms/set_based/vertex_similarity/common_neighbors.h>
+#include <gms/algorithms/set_based/vertex_similarity/minhash.h>
 #include <gms/representations/graphs/set_graph.h>
 
 #include <gms/common/format.h>
@@ -52,6 +56,10 @@ ScoredEdges link_prediction_similarity(
     // The q best edges in G's
     std::vector<UndirectedEdge> best_edges(q_best_edges);
 
+    // Degree weights for Adamic Adar and Resource Allocation, looked up instead of recomputed per common neighbor.
+    DegreeWeights local_weights;
+    const DegreeWeights &weights = VertexSim::degree_weights_of(graph, local_weights);
+
     // Iterate over all non-existent edges in the graph.
     int64_t num_nodes = graph.num_nodes();
     for (NodeId u = 0; u < num_nodes; ++u) {
@@ -59,7 +67,7 @@ ScoredEdges link_prediction_similarity(
         for (NodeId v = u + 1; v < num_nodes; ++v) {
             if (!neigh.contains(v)) {
                 // Compute the similarity score of the vertices along the edge.
-                double cur_score = VertexSim::vertex_similarity<SimilarityMeasure>(u, v, graph);
+                double cur_score = VertexSim::vertex_similarity<SimilarityMeasure>(u, v, graph, weights);
 
                 // And now determine the best q edges.
                 int64_t cur_rank = 0;
@@ -99,4 +107,145 @@ ScoredEdges link_prediction_similarity(
 
     return se;
 }
+
+namespace detail {
+
+struct ScoredEdge {
+    double score;
+    UndirectedEdge edge;
+
+    // Orders by score, ties are broken by the edge, such that the result does not depend on the schedule.
+    bool operator>(const ScoredEdge &other) const {
+        if (score != other.score) {
+            return score > other.score;
+        }
+        return edge < other.edge;
+    }
+};
+
+/**
+ * Keeps the q best scored edges seen so far in a min-heap (the worst retained edge is at the front).
+ */
+class TopEdges {
+public:
+    explicit TopEdges(int64_t q) : q(q) {
+        heap.reserve(q);
+    }
+
+    void offer(const ScoredEdge &candidate) {
+        if (heap.size() < q) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        } else if (q > 0 && candidate > heap.front()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        }
+    }
+
+    std::vector<ScoredEdge> &edges() {
+        return heap;
+    }
+
+private:
+    size_t q;
+    std::vector<ScoredEdge> heap;
+};
+
+/**
+ * Merges per-thread candidates and returns the q best in ascending order, as link_prediction_similarity does.
+ */
+inline ScoredEdges merge_top_edges(std::vector<TopEdges> &best, int64_t q_best_edges) {
+    std::vector<ScoredEdge> merged;
+    for (TopEdges &local_best : best) {
+        merged.insert(merged.end(), local_best.edges().begin(), local_best.edges().end());
+    }
+    std::sort(merged.begin(), merged.end(), std::greater<>());
+    if (merged.size() > q_best_edges) {
+        merged.resize(q_best_edges);
+    }
+
+    ScoredEdges se;
+    se.edges.reserve(merged.size());
+    se.scores.reserve(merged.size());
+    for (auto it = merged.rbegin(); it != merged.rend(); ++it) {
+        se.edges.push_back(it->edge);
+        se.scores.push_back(it->score);
+    }
+    return se;
+}
+
+} // namespace detail
+
+/**
+ * Parallel variant of link_prediction_similarity for metrics based on common neighbors.
+ *
+ * Instead of scoring all O(n^2) vertex pairs, only pairs within distance two are generated as candidates, since all
+ * other pairs have a score of zero. The scores of all two-hop non-edges (u, v), v > u, are produced row by row by
+ * VertexSim::common_neighbor_product, then each thread keeps its q best non-edges in a bounded min-heap.
+ * The per-thread heaps are merged at the end.
+ *
+ * In contrast to link_prediction_similarity, pairs with a score of zero are never reported, so fewer than q edges
+ * can be returned. The result is independent of the number of threads.
+ *
+ * @tparam SimilarityMeasure a metric with VertexSim::is_common_neighbor_metric
+ * @tparam SGraph
+ * @param graph an undirected graph
+ * @param q_best_edges
+ * @return the q best edges and their scores, in ascending order of the score
+ */
+template <VertexSim::Metric SimilarityMeasure, class SGraph>
+ScoredEdges link_prediction_similarity_parallel(
+        const SGraph &graph,
+        int64_t q_best_edges) {
+    static_assert(VertexSim::is_common_neighbor_metric<SimilarityMeasure>,
+                  "two-hop candidate generation requires a metric based on common neighbors");
+    using detail::ScoredEdge;
+    using detail::TopEdges;
+
+    std::vector<TopEdges> best(omp_get_max_threads(), TopEdges(q_best_edges));
+    VertexSim::common_neighbor_product(graph, VertexSim::PairMask::NonEdges,
+            [&](NodeId u, NodeId v, const VertexSim::CommonNeighborSums &sums) {
+        VertexSim::PairSimilarity pair{u, v, sums, graph.out_degree(u), graph.out_degree(v)};
+        best[omp_get_thread_num()].offer(ScoredEdge{pair.get<SimilarityMeasure>(), UndirectedEdge(u, v)});
+    });
+
+    return detail::merge_top_edges(best, q_best_edges);
+}
+
+/**
+ * Link prediction with Jaccard similarity on LSH candidates.
+ *
+ * Instead of all two-hop pairs only the candidate pairs of VertexSim::MinHashSignatures are scored (exactly).
+ * This misses some pairs, mostly ones with a low similarity, but the work is proportional to the number of
+ * candidates, which is controlled by the banding parameters.
+ *
+ * @tparam SGraph
+ * @param graph an undirected graph
+ * @param q_best_edges
+ * @param params MinHash and banding parameters
+ * @return the q best candidate non-edges and their Jaccard scores, in ascending order of the score
+ */
+template <class SGraph>
+ScoredEdges link_prediction_minhash(
+        const SGraph &graph,
+        int64_t q_best_edges,
+        const VertexSim::MinHashParams &params = VertexSim::MinHashParams()) {
+    using detail::ScoredEdge;
+    using detail::TopEdges;
+
+    auto candidates = VertexSim::MinHashSignatures::Build(graph, params).candidate_pairs();
+
+    std::vector<TopEdges> best(omp_get_max_threads(), TopEdges(q_best_edges));
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t i = 0; i < (int64_t) candidates.size(); ++i) {
+        auto [u, v] = candidates[i];
+        if (!graph.out_neigh(u).contains(v)) {
+            double score = VertexSim::vertex_similarity_jaccard(u, v, graph);
+            best[omp_get_thread_num()].offer(ScoredEdge{score, UndirectedEdge(u, v)});
+        }
+    }
+
+    return detail::merge_top_edges(best, q_best_edges);
+}
 }
\ No newline at end of file
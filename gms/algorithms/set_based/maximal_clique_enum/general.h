@@ -20,6 +20,7 @@
 #include <gms/representations/sets/sorted_set.h>
 #include <gms/representations/sets/roaring_set.h>
 #include <gms/common/types.h>
+#include <gms/common/instrumentation.h>
 
 #include "helper.h"
 #include "sub_graph/sub_graph.h"
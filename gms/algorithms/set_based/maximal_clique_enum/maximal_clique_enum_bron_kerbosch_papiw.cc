@@ -13,6 +13,9 @@ int main(int argc, char *argv[])
     CLI::Parser parser;
     // TODO formerly allow_relabel
     auto [args, g] = parser.parse_and_load(argc, argv);
+    // the counters of this benchmark, unless others are selected with --counters
+    if (args.report.counters.empty())
+        args.report.counters = "RES_STL,TOT_CYC";
 
     if (args.verify)
     {
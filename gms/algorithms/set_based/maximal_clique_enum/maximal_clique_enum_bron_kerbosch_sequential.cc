@@ -40,6 +40,8 @@ int main(int argc, char *argv[])
     benchmark_suite<RoaringGraph>(args, g, "RoaringSet");
     benchmark_suite<SortedSetGraph>(args, g, "SortedSet");
     benchmark_suite<RobinHoodGraph>(args, g, "RobinHoodSet");
+    benchmark_suite<KbitSetGraph>(args, g, "KbitSet");
+    benchmark_suite<VarintSetGraph>(args, g, "VarintSet");
 
     return 0;
 }
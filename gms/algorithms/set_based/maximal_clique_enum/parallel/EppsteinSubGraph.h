@@ -44,7 +44,7 @@ NodeId findPivot(const Set &cand, const Set &fini, const SGraph &graph)
 template <class SubGraph, class Set>
 void expand(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SubGraph &graph)
 {
-
+    GMS_INSTR_DEPTH();
     if (cand.cardinality() != 0)
     {
         auto pivot = findPivot(cand, fini, graph);
@@ -67,6 +67,7 @@ void expand(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SubGraph
     }
     else if (fini.cardinality() == 0)
     {
+        GMS_INSTR_EVENT("bk/maximal_cliques");
 #ifdef BK_COUNT
 #pragma omp atomic
         BK_CLIQUE_COUNTER++;
@@ -83,7 +84,7 @@ void expand(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SubGraph
 template <class SubGraph, class Set>
 void expandRelay(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SubGraph &graph)
 {
-
+    GMS_INSTR_DEPTH();
     if (cand.cardinality() != 0)
     {
         auto pivot = graph.findPivot(cand, fini);
@@ -106,6 +107,7 @@ void expandRelay(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SubG
     }
     else if (fini.cardinality() == 0)
     {
+        GMS_INSTR_EVENT("bk/maximal_cliques");
 #ifdef BK_COUNT
 #pragma omp atomic
         BK_CLIQUE_COUNTER++;
@@ -129,9 +131,11 @@ std::vector<Set> mceBench(const SGraph &rgraph, const pvector<NodeId> &ordering)
     auto vCount = rgraph.num_nodes();
     std::vector<Set> sol = {};
 
+    GMS_INSTR_REGION();
 #pragma omp parallel for schedule(dynamic) shared(rgraph, sol, ordering)
     for (int v = 0; v < vCount; v++)
     {
+        GMS_INSTR_BUSY();
         auto &neigh = rgraph.out_neigh(v);
         Set cand = {};
         Set fini = {};
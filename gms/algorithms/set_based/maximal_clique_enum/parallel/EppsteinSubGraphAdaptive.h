@@ -16,9 +16,11 @@ namespace BkEppsteinSubGraphAdaptive
         auto vCount = rgraph.num_nodes();
         std::vector<Set> sol = {};
 
+        GMS_INSTR_REGION();
 #pragma omp parallel for schedule(dynamic) shared(rgraph, sol, ordering)
         for (int v = 0; v < vCount; v++)
         {
+            GMS_INSTR_BUSY();
             auto &neigh = rgraph.out_neigh(v);
             Set cand = {};
             Set fini = {};
@@ -10,7 +10,6 @@
 #include <gms/third_party/fast_range.h>
 #include <gms/third_party/fast_statistics.h>
 #include <parallel/algorithm>
-#include <gms/common/papi/papiw.h>
 
 namespace BkEppsteinPar
 {
@@ -23,14 +22,13 @@ namespace BkEppsteinPar
         auto vCount = rgraph.num_nodes();
         std::vector<Set> sol = {};
 
-        PAPIW::INIT_PARALLEL(PAPI_RES_STL, PAPI_TOT_CYC); // Init PAPIW
-
+        GMS_INSTR_REGION();
 #pragma omp parallel shared(rgraph, sol, ordering)
         {
-            PAPIW::START();
 #pragma omp for schedule(dynamic)
             for (NodeId v = 0; v < vCount; v++)
             {
+                GMS_INSTR_BUSY();
                 auto &neigh = rgraph.out_neigh(v);
                 Set cand = {};
                 Set fini = {};
@@ -46,9 +44,7 @@ namespace BkEppsteinPar
 
                 BkTomita::expand(cand, fini, Q, sol, rgraph);
             }
-            PAPIW::STOP();
         }
-        PAPIW::PRINT();
         return sol;
     }
 
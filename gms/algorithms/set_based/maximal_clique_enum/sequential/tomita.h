@@ -11,6 +11,7 @@ namespace BkTomita
 template <class SGraph, class Set>
 NodeId findPivot(const Set &cand, const Set &fini, const SGraph &graph)
 {
+    GMS_INSTR_PHASE("bk/pivot");
     auto vPtr = cand.begin();
     auto end = cand.end();
     NodeId pivot = *vPtr;
@@ -50,6 +51,7 @@ grap:   Input graph
 template <class SGraph, class Set>
 void expand(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SGraph &graph)
 {
+    GMS_INSTR_DEPTH();
     if (cand.cardinality() != 0)
     {
         auto pivot = findPivot(cand, fini, graph);
@@ -72,6 +74,7 @@ void expand(Set &cand, Set &fini, Set &Q, std::vector<Set> &sol, const SGraph &g
     }
     else if (fini.cardinality() == 0)
     {
+        GMS_INSTR_EVENT("bk/maximal_cliques");
 #ifdef BK_COUNT
 #pragma omp atomic
         BK_CLIQUE_COUNTER++;
@@ -1,4 +1,5 @@
 #pragma once
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 #include <cassert>
 
@@ -9,8 +10,10 @@ size_t count_total(const SGraph &graph) {
     size_t n = graph.num_nodes();
 
     size_t total = 0;
+    GMS_INSTR_REGION();
 #pragma omp parallel for schedule(static, 17) reduction(+:total)
     for (NodeId u = 0; u < n; ++u) {
+        GMS_INSTR_BUSY();
         const auto &neigh_u = graph.out_neigh(u);
         for (NodeId v : neigh_u) {
             if (u < v) {
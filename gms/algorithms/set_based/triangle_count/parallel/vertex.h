@@ -1,4 +1,5 @@
 #pragma once
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 
 namespace GMS::TriangleCount::Par {
@@ -15,8 +16,10 @@ template<class SGraph, class Output = std::vector<int64_t>>
 void vertex_count2(const SGraph &graph, Output &counts) {
     int64_t num_nodes = graph.num_nodes();
     counts.resize(num_nodes);
+    GMS_INSTR_REGION();
 #pragma omp parallel for schedule(static, 9)
     for (NodeId u = 0; u < num_nodes; ++u) {
+        GMS_INSTR_BUSY();
         int64_t count = 0;
         const auto &neigh_u = graph.out_neigh(u);
         for (NodeId v : neigh_u) {
@@ -31,8 +34,10 @@ template<class SGraph, class Output = std::vector<int64_t>>
 void vertex_count2_once(const SGraph &graph, Output &counts) {
     int64_t num_nodes = graph.num_nodes();
     counts.resize(num_nodes);
+    GMS_INSTR_REGION();
 #pragma omp parallel for schedule(dynamic, 9)
     for (NodeId u = 0; u < num_nodes; ++u) {
+        GMS_INSTR_BUSY();
         int64_t count = 0;
         const auto &neigh_u = graph.out_neigh(u);
         for (NodeId v : neigh_u) {
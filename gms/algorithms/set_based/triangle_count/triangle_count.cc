@@ -43,6 +43,8 @@ int main(int argc, char *argv[])
     benchmark_suite<RoaringGraph>(args, g, "RoaringGraph");
     benchmark_suite<SortedSetGraph>(args, g, "SortedSetGraph");
     benchmark_suite<RobinHoodGraph>(args, g, "RobinHoodGraph");
+    benchmark_suite<KbitSetGraph>(args, g, "KbitSetGraph");
+    benchmark_suite<VarintSetGraph>(args, g, "VarintSetGraph");
 
     return 0;
 }
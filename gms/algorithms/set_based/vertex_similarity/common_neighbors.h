@@ -0,0 +1,270 @@
+#pragma once
+#include <gms/common/types.h>
+#include <gms/third_party/robin_hood.h>
+#include <gms/algorithms/set_based/vertex_similarity/vertex_similarity.h>
+#include <omp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Batched computation of common neighbor based vertex similarities.
+ *
+ * All common neighbor metrics of vertex_similarity.h are (weighted) entries of the sparse matrix product A·A.
+ * Instead of intersecting neighborhoods pair by pair, the product is formed row by row (Gustavson's algorithm):
+ * for a row u, all two-hop paths u - w - v add the weights of w to the accumulator entry of v.
+ * One pass computes the sums for all metrics at once.
+ */
+namespace GMS::VertexSim {
+
+/**
+ * Accumulated weights of the common neighbors of a vertex pair.
+ */
+struct CommonNeighborSums {
+    double count = 0;       ///< number of common neighbors
+    double adamic_adar = 0; ///< sum of 1 / log(deg(w))
+    double resource = 0;    ///< sum of 1 / deg(w)
+
+    void add(const CommonNeighborSums &weights) {
+        count += weights.count;
+        adamic_adar += weights.adamic_adar;
+        resource += weights.resource;
+    }
+
+    static CommonNeighborSums of_neighbor(int64_t degree) {
+        CommonNeighborSums weights;
+        weights.count = 1.0;
+        // a common neighbor always has degree >= 2
+        weights.adamic_adar = common_neighbor_weight<Metric::AdamicAdar>(degree);
+        weights.resource = common_neighbor_weight<Metric::Resource>(degree);
+        return weights;
+    }
+};
+
+/**
+ * Similarity scores of a vertex pair for all metrics.
+ */
+struct PairSimilarity {
+    NodeId u;
+    NodeId v;
+    CommonNeighborSums sums;
+    int64_t degree_u;
+    int64_t degree_v;
+
+    template <Metric metric>
+    double get() const {
+        if constexpr (metric == Metric::TotalNeigh) {
+            return degree_u + degree_v - sums.count;
+        } else if constexpr (metric == Metric::PrefAtt) {
+            return double(degree_u) * degree_v;
+        } else if constexpr (metric == Metric::AdamicAdar) {
+            return sums.adamic_adar;
+        } else if constexpr (metric == Metric::Resource) {
+            return sums.resource;
+        } else {
+            return vertex_similarity_from_common<metric>(sums.count, degree_u, degree_v);
+        }
+    }
+};
+
+/**
+ * Which entries of the row u of A·A are produced.
+ */
+enum class PairMask {
+    UpperTriangle, ///< all pairs (u, v) with u < v and at least one common neighbor
+    NonEdges       ///< as UpperTriangle, but without the pairs which are edges of the graph
+};
+
+/**
+ * Dense sparse-accumulator: O(n) memory per thread, O(1) updates. Best for graphs with up to some 10^8 vertices.
+ */
+class DenseAccumulator {
+public:
+    explicit DenseAccumulator(int64_t num_nodes) : sums(num_nodes), used(num_nodes, false) {}
+
+    void add(NodeId v, const CommonNeighborSums &weights) {
+        if (!used[v]) {
+            used[v] = true;
+            touched.push_back(v);
+        }
+        sums[v].add(weights);
+    }
+
+    // Calls f(v, sums) for all touched entries and resets the accumulator.
+    template <class F>
+    void drain(F &&f) {
+        for (NodeId v : touched) {
+            f(v, sums[v]);
+            sums[v] = CommonNeighborSums();
+            used[v] = false;
+        }
+        touched.clear();
+    }
+
+private:
+    std::vector<CommonNeighborSums> sums;
+    std::vector<bool> used;
+    std::vector<NodeId> touched;
+};
+
+/**
+ * Hash based sparse-accumulator: memory proportional to the largest row instead of n.
+ */
+class HashAccumulator {
+public:
+    explicit HashAccumulator(int64_t num_nodes) {}
+
+    void add(NodeId v, const CommonNeighborSums &weights) {
+        sums[v].add(weights);
+    }
+
+    template <class F>
+    void drain(F &&f) {
+        for (auto &entry : sums) {
+            f(entry.first, entry.second);
+        }
+        sums.clear();
+    }
+
+private:
+    robin_hood::unordered_flat_map<NodeId, CommonNeighborSums> sums;
+};
+
+/**
+ * Computes the rows of the masked product A·A in parallel.
+ *
+ * @tparam Accumulator DenseAccumulator or HashAccumulator
+ * @tparam SGraph SetGraph compatible graph representation type, must be undirected
+ * @tparam Visitor callable as visit(u, v, const CommonNeighborSums &), invoked concurrently by several threads
+ *                 (omp_get_thread_num() can be used to address thread-local state)
+ * @param g the input graph
+ * @param mask which pairs are produced
+ * @param visit
+ */
+template <class Accumulator = DenseAccumulator, class SGraph, class Visitor>
+void common_neighbor_product(const SGraph &g, PairMask mask, Visitor &&visit) {
+    const int64_t num_nodes = g.num_nodes();
+
+#pragma omp parallel
+    {
+        Accumulator accumulator(num_nodes);
+        // adjacent[v] == u iff v is a neighbor of the current row u
+        std::vector<NodeId> adjacent(mask == PairMask::NonEdges ? num_nodes : 0, -1);
+
+#pragma omp for schedule(dynamic, 64)
+        for (NodeId u = 0; u < num_nodes; ++u) {
+            if (mask == PairMask::NonEdges) {
+                for (NodeId w : g.out_neigh(u)) {
+                    adjacent[w] = u;
+                }
+            }
+            for (NodeId w : g.out_neigh(u)) {
+                const CommonNeighborSums weights = CommonNeighborSums::of_neighbor(g.out_degree(w));
+                for (NodeId v : g.out_neigh(w)) {
+                    if (v > u) {
+                        accumulator.add(v, weights);
+                    }
+                }
+            }
+            accumulator.drain([&](NodeId v, const CommonNeighborSums &sums) {
+                if (mask != PairMask::NonEdges || adjacent[v] != u) {
+                    visit(u, v, sums);
+                }
+            });
+        }
+    }
+}
+
+/**
+ * Computes all metrics for all pairs selected by the mask.
+ *
+ * @return the pairs with at least one common neighbor, ordered by (u, v)
+ */
+template <class Accumulator = DenseAccumulator, class SGraph>
+std::vector<PairSimilarity> all_pairs_similarity(const SGraph &g, PairMask mask = PairMask::NonEdges) {
+    std::vector<std::vector<PairSimilarity>> local(omp_get_max_threads());
+    common_neighbor_product<Accumulator>(g, mask, [&](NodeId u, NodeId v, const CommonNeighborSums &sums) {
+        local[omp_get_thread_num()].push_back(PairSimilarity{u, v, sums, g.out_degree(u), g.out_degree(v)});
+    });
+
+    std::vector<PairSimilarity> result;
+    for (auto &pairs : local) {
+        result.insert(result.end(), pairs.begin(), pairs.end());
+    }
+    std::sort(result.begin(), result.end(), [](const PairSimilarity &a, const PairSimilarity &b) {
+        return std::make_pair(a.u, a.v) < std::make_pair(b.u, b.v);
+    });
+    return result;
+}
+
+/**
+ * Computes all metrics for a list of candidate pairs, e.g. the test edges of a link prediction experiment.
+ *
+ * Only the rows of A·A which contain a candidate are formed, and only the candidate columns are accumulated.
+ *
+ * @tparam Pair a std::pair<NodeId, NodeId> compatible type, e.g. LinkPrediction::UndirectedEdge
+ * @return the similarities in the order of the candidates
+ */
+template <class SGraph, class Pair>
+std::vector<PairSimilarity> candidate_pairs_similarity(const SGraph &g, const std::vector<Pair> &candidates) {
+    const int64_t num_nodes = g.num_nodes();
+    const int64_t num_candidates = candidates.size();
+
+    // Group the candidates by their first vertex (counting sort).
+    std::vector<int64_t> row_offset(num_nodes + 1, 0);
+    for (const Pair &p : candidates) {
+        row_offset[p.first + 1]++;
+    }
+    for (int64_t u = 0; u < num_nodes; ++u) {
+        row_offset[u + 1] += row_offset[u];
+    }
+    std::vector<int64_t> row_candidates(num_candidates);
+    {
+        std::vector<int64_t> insert_pos(row_offset.begin(), row_offset.end() - 1);
+        for (int64_t i = 0; i < num_candidates; ++i) {
+            row_candidates[insert_pos[candidates[i].first]++] = i;
+        }
+    }
+
+    std::vector<PairSimilarity> result(num_candidates);
+#pragma omp parallel
+    {
+        // column[v] is the accumulator slot of candidate (u, v) in the current row, -1 if v is masked out
+        std::vector<int64_t> column(num_nodes, -1);
+        std::vector<CommonNeighborSums> sums;
+
+#pragma omp for schedule(dynamic, 64)
+        for (NodeId u = 0; u < num_nodes; ++u) {
+            const int64_t begin = row_offset[u];
+            const int64_t end = row_offset[u + 1];
+            if (begin == end) {
+                continue;
+            }
+            sums.assign(end - begin, CommonNeighborSums());
+            for (int64_t i = begin; i < end; ++i) {
+                column[candidates[row_candidates[i]].second] = i - begin;
+            }
+            for (NodeId w : g.out_neigh(u)) {
+                const CommonNeighborSums weights = CommonNeighborSums::of_neighbor(g.out_degree(w));
+                for (NodeId v : g.out_neigh(w)) {
+                    if (column[v] >= 0) {
+                        sums[column[v]].add(weights);
+                    }
+                }
+            }
+            for (int64_t i = begin; i < end; ++i) {
+                const int64_t c = row_candidates[i];
+                const NodeId v = candidates[c].second;
+                result[c] = PairSimilarity{u, v, sums[column[v]], g.out_degree(u), g.out_degree(v)};
+            }
+            for (int64_t i = begin; i < end; ++i) {
+                column[candidates[row_candidates[i]].second] = -1;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace GMS::VertexSim
@@ -0,0 +1,383 @@
+#pragma once
+#include <gms/common/types.h>
+#include <gms/common/random.h>
+#include <gms/algorithms/set_based/vertex_similarity/vertex_similarity.h>
+#include <gms/algorithms/set_based/vertex_similarity/common_neighbors.h>
+#include <omp.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <parallel/algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Approximate Jaccard similarity with MinHash signatures and locality-sensitive hashing.
+ *
+ * The signature of a neighborhood N(u) holds min_{x in N(u)} h_j(x) for k hash functions h_j. Two signatures agree
+ * in a position with probability J(N(u), N(v)), so the fraction of agreeing positions estimates the Jaccard index.
+ * b-bit MinHash [1] only stores the lowest b bits of every minimum, the estimate is corrected for accidental
+ * collisions of the truncated values.
+ *
+ * LSH banding splits the full signatures into bands of r rows. Pairs which agree in all rows of at least one band
+ * become candidates, which selects pairs with J >= (1/bands)^(1/r) with high probability. The candidates are then
+ * verified with the exact set kernels.
+ *
+ * [1] P. Li and A. C. König, “b-Bit minwise hashing,” in Proceedings of WWW 2010, doi: 10.1145/1772690.1772759.
+ */
+namespace GMS::VertexSim {
+
+/**
+ * Parameters of the MinHash signatures and the LSH banding.
+ */
+struct MinHashParams {
+    int num_hashes = 128;            ///< signature length k, rounded up to a multiple of 64 / bits
+    int bits = 32;                   ///< b of b-bit MinHash, one of 1, 2, 4, 8, 16, 32
+    int rows_per_band = 4;           ///< r, the signature is split into k / r bands
+    int64_t max_bucket_size = 1024;  ///< larger LSH buckets are skipped, they would emit quadratically many pairs
+    uint64_t seed = Random::DefaultSeed;
+};
+
+/**
+ * A vertex pair and its (exact) Jaccard similarity.
+ */
+struct SimilarPair {
+    NodeId u;
+    NodeId v;
+    double similarity;
+};
+
+namespace detail {
+
+// 32 bit finalizer of MurmurHash3, only uses operations which vectorize with SSE4.1 / AVX2.
+inline uint32_t fmix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+} // namespace detail
+
+/**
+ * MinHash signatures of all neighborhoods of a graph, stored as packed b-bit values, and the keys of their LSH bands.
+ */
+class MinHashSignatures {
+public:
+    /**
+     * Computes the signatures of all neighborhoods in parallel.
+     *
+     * @tparam SGraph SetGraph compatible graph representation type
+     * @param g The input graph
+     * @param params
+     * @return
+     */
+    template <class SGraph>
+    static MinHashSignatures Build(const SGraph &g, const MinHashParams &params = MinHashParams()) {
+        assert(params.bits > 0 && params.bits <= 32 && (params.bits & (params.bits - 1)) == 0);
+        assert(params.rows_per_band > 0);
+
+        MinHashSignatures s;
+        s.params = params;
+        s.num_nodes = g.num_nodes();
+        const int fields_per_word = 64 / params.bits;
+        s.words_per_vertex = (params.num_hashes + fields_per_word - 1) / fields_per_word;
+        s.params.num_hashes = s.words_per_vertex * fields_per_word;
+        s.bands = s.params.num_hashes / params.rows_per_band;
+
+        const int k = s.params.num_hashes;
+        const int r = params.rows_per_band;
+        const uint64_t value_mask = params.bits == 32 ? 0xffffffffULL : (1ULL << params.bits) - 1;
+
+        // One salt per hash function, h_j(x) = fmix32(hash(x) ^ salt_j).
+        std::vector<uint32_t> salts(k);
+        for (int j = 0; j < k; ++j) {
+            salts[j] = (uint32_t) Random::mix64(params.seed + j + 1);
+        }
+        const uint32_t *salt = salts.data();
+
+        s.signatures.assign(s.num_nodes * s.words_per_vertex, 0);
+        s.band_keys.assign(s.num_nodes * s.bands, 0);
+        s.empty.assign(s.num_nodes, 0);
+
+#pragma omp parallel
+        {
+            std::vector<uint32_t> minima(k);
+            uint32_t *min = minima.data();
+
+#pragma omp for schedule(dynamic, 64)
+            for (NodeId u = 0; u < s.num_nodes; ++u) {
+                std::fill(minima.begin(), minima.end(), std::numeric_limits<uint32_t>::max());
+                for (NodeId x : g.out_neigh(u)) {
+                    const uint32_t hx = (uint32_t) Random::mix64(params.seed ^ uint64_t(x));
+#pragma omp simd
+                    for (int j = 0; j < k; ++j) {
+                        min[j] = std::min(min[j], detail::fmix32(hx ^ salt[j]));
+                    }
+                }
+                s.empty[u] = g.out_degree(u) == 0;
+
+                uint64_t *words = &s.signatures[u * s.words_per_vertex];
+                for (int j = 0; j < k; ++j) {
+                    words[j / fields_per_word] |= (min[j] & value_mask) << ((j % fields_per_word) * params.bits);
+                }
+                uint64_t *keys = &s.band_keys[u * s.bands];
+                for (int64_t band = 0; band < s.bands; ++band) {
+                    uint64_t key = band;
+                    for (int row = 0; row < r; ++row) {
+                        key = Random::mix64(key ^ min[band * r + row]);
+                    }
+                    keys[band] = key;
+                }
+            }
+        }
+        return s;
+    }
+
+    /**
+     * Estimates the Jaccard index of the neighborhoods of two vertices.
+     *
+     * @param u
+     * @param v
+     * @return
+     */
+    double estimate_jaccard(NodeId u, NodeId v) const {
+        if (empty[u] || empty[v]) {
+            // same convention as vertex_similarity_jaccard
+            return empty[u] && empty[v] ? 1.0 : 0.0;
+        }
+        const int b = params.bits;
+        const uint64_t field_low_bits = low_bit_pattern(b);
+        const uint64_t *a = &signatures[u * words_per_vertex];
+        const uint64_t *c = &signatures[v * words_per_vertex];
+
+        int64_t different = 0;
+        for (int64_t w = 0; w < words_per_vertex; ++w) {
+            // Fold every b-bit field onto its lowest bit, which is then set iff the field differs.
+            uint64_t x = a[w] ^ c[w];
+            for (int shift = 1; shift < b; shift <<= 1) {
+                x |= x >> shift;
+            }
+            different += __builtin_popcountll(x & field_low_bits);
+        }
+
+        const double agree = 1.0 - double(different) / params.num_hashes;
+        if (b == 32) {
+            return agree;
+        }
+        // Two different minima collide in b bits with probability 2^-b.
+        const double collision = std::ldexp(1.0, -b);
+        return std::clamp((agree - collision) / (1.0 - collision), 0.0, 1.0);
+    }
+
+    /**
+     * Computes the LSH candidate pairs, i.e. the pairs which agree in at least one band.
+     *
+     * Vertices with an empty neighborhood are never candidates.
+     *
+     * @return the candidate pairs (u, v) with u < v, sorted and without duplicates
+     */
+    std::vector<std::pair<NodeId, NodeId>> candidate_pairs() const {
+        std::vector<std::vector<std::pair<NodeId, NodeId>>> local(omp_get_max_threads());
+
+#pragma omp parallel
+        {
+            std::vector<std::pair<uint64_t, NodeId>> buckets;
+            auto &pairs = local[omp_get_thread_num()];
+
+#pragma omp for schedule(dynamic, 1)
+            for (int64_t band = 0; band < bands; ++band) {
+                buckets.clear();
+                for (NodeId u = 0; u < num_nodes; ++u) {
+                    if (!empty[u]) {
+                        buckets.emplace_back(band_keys[u * bands + band], u);
+                    }
+                }
+                std::sort(buckets.begin(), buckets.end());
+
+                for (size_t begin = 0; begin < buckets.size();) {
+                    size_t end = begin + 1;
+                    while (end < buckets.size() && buckets[end].first == buckets[begin].first) {
+                        ++end;
+                    }
+                    if (end - begin <= (size_t) params.max_bucket_size) {
+                        for (size_t i = begin; i < end; ++i) {
+                            for (size_t j = i + 1; j < end; ++j) {
+                                pairs.emplace_back(buckets[i].second, buckets[j].second);
+                            }
+                        }
+                    }
+                    begin = end;
+                }
+            }
+        }
+
+        std::vector<std::pair<NodeId, NodeId>> result;
+        for (auto &pairs : local) {
+            result.insert(result.end(), pairs.begin(), pairs.end());
+            std::vector<std::pair<NodeId, NodeId>>().swap(pairs);
+        }
+        __gnu_parallel::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    int num_hashes() const {
+        return params.num_hashes;
+    }
+
+    int bits() const {
+        return params.bits;
+    }
+
+    int64_t num_bands() const {
+        return bands;
+    }
+
+    /**
+     * Memory used by the packed signatures in bytes, the band keys are not included.
+     */
+    size_t signature_bytes() const {
+        return signatures.size() * sizeof(uint64_t);
+    }
+
+private:
+    MinHashParams params;
+    int64_t num_nodes = 0;
+    int64_t words_per_vertex = 0;
+    int64_t bands = 0;
+    std::vector<uint64_t> signatures;
+    std::vector<uint64_t> band_keys;
+    std::vector<uint8_t> empty;
+
+    // The lowest bit of every b-bit field of a word.
+    static uint64_t low_bit_pattern(int b) {
+        uint64_t pattern = 0;
+        for (int offset = 0; offset < 64; offset += b) {
+            pattern |= 1ULL << offset;
+        }
+        return pattern;
+    }
+};
+
+/**
+ * Estimates the Jaccard similarity of two vertices from their MinHash signatures.
+ *
+ * @param a ID of the first vertex
+ * @param b ID of the second vertex
+ * @param signatures signatures of the graph
+ * @return
+ */
+inline double vertex_similarity_jaccard_minhash(NodeId a, NodeId b, const MinHashSignatures &signatures)
+{
+    return signatures.estimate_jaccard(a, b);
+}
+
+/**
+ * Finds the vertex pairs with a Jaccard similarity of at least `threshold` using LSH.
+ *
+ * All reported pairs are verified with vertex_similarity_jaccard, pairs can be missed but never reported falsely.
+ *
+ * @tparam SGraph SetGraph compatible graph representation type
+ * @param g The input graph
+ * @param threshold a similarity in (0, 1]
+ * @param params
+ * @return the pairs (u, v) with u < v, sorted by (u, v)
+ */
+template <class SGraph>
+std::vector<SimilarPair> similar_pairs_minhash(const SGraph &g, double threshold,
+                                               const MinHashParams &params = MinHashParams())
+{
+    auto candidates = MinHashSignatures::Build(g, params).candidate_pairs();
+
+    std::vector<SimilarPair> verified(candidates.size());
+    std::vector<uint8_t> keep(candidates.size());
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t i = 0; i < (int64_t) candidates.size(); ++i) {
+        auto [u, v] = candidates[i];
+        double similarity = vertex_similarity_jaccard(u, v, g);
+        verified[i] = SimilarPair{u, v, similarity};
+        keep[i] = similarity >= threshold;
+    }
+
+    std::vector<SimilarPair> result;
+    for (size_t i = 0; i < verified.size(); ++i) {
+        if (keep[i]) {
+            result.push_back(verified[i]);
+        }
+    }
+    return result;
+}
+
+/**
+ * Finds all vertex pairs with a Jaccard similarity of at least `threshold` exactly, see all_pairs_similarity.
+ *
+ * @return the pairs (u, v) with u < v, sorted by (u, v)
+ */
+template <class SGraph>
+std::vector<SimilarPair> similar_pairs_exact(const SGraph &g, double threshold)
+{
+    assert(threshold > 0.0);
+    std::vector<SimilarPair> result;
+    for (const PairSimilarity &pair : all_pairs_similarity(g, PairMask::UpperTriangle)) {
+        double similarity = pair.get<Metric::Jaccard>();
+        if (similarity >= threshold) {
+            result.push_back(SimilarPair{pair.u, pair.v, similarity});
+        }
+    }
+    return result;
+}
+
+/**
+ * Quality of the MinHash estimates and of the LSH candidates compared to the exact Jaccard similarity.
+ */
+struct MinHashQuality {
+    int64_t exact_pairs;      ///< pairs with a similarity of at least the threshold
+    int64_t candidate_pairs;  ///< pairs emitted by LSH
+    int64_t found_pairs;      ///< candidates with a similarity of at least the threshold
+    double recall;            ///< found_pairs / exact_pairs
+    double precision;         ///< found_pairs / candidate_pairs, i.e. the fraction of useful verifications
+    double mean_abs_error;    ///< mean absolute error of the estimates over the exact pairs
+};
+
+/**
+ * Compares MinHash to the exact metric, this computes all similar pairs exactly and is meant for small graphs.
+ *
+ * @tparam SGraph SetGraph compatible graph representation type
+ * @param g The input graph
+ * @param threshold a similarity in (0, 1]
+ * @param params
+ * @return
+ */
+template <class SGraph>
+MinHashQuality evaluate_minhash(const SGraph &g, double threshold, const MinHashParams &params = MinHashParams())
+{
+    auto signatures = MinHashSignatures::Build(g, params);
+    auto candidates = signatures.candidate_pairs();
+    auto exact = similar_pairs_exact(g, threshold);
+
+    MinHashQuality quality;
+    quality.exact_pairs = exact.size();
+    quality.candidate_pairs = candidates.size();
+
+    int64_t found = 0;
+    double error = 0;
+#pragma omp parallel for reduction(+: found, error)
+    for (int64_t i = 0; i < (int64_t) exact.size(); ++i) {
+        auto pair = std::make_pair(exact[i].u, exact[i].v);
+        found += std::binary_search(candidates.begin(), candidates.end(), pair);
+        error += std::abs(signatures.estimate_jaccard(exact[i].u, exact[i].v) - exact[i].similarity);
+    }
+    quality.found_pairs = found;
+    quality.recall = exact.empty() ? 1.0 : double(found) / exact.size();
+    quality.precision = candidates.empty() ? 1.0 : double(found) / candidates.size();
+    quality.mean_abs_error = exact.empty() ? 0.0 : error / exact.size();
+    return quality;
+}
+
+} // namespace GMS::VertexSim
@@ -1,6 +1,10 @@
 #pragma once
 #include <gms/common/types.h>
+#include <gms/representations/graphs/degree_weights.h>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <type_traits>
 
 /**
  * @brief Implementation of several vertex similarity measures.
@@ -32,7 +36,7 @@ inline double vertex_similarity_jaccard(const SetA &A, const SetB &B) {
         return 1.0;
     } else {
         double count = A.intersect_count(B);
-        return count / (A.cardinality() + B.cardinality() + count);
+        return count / (A.cardinality() + B.cardinality() - count);
     }
 }
 
@@ -80,10 +84,62 @@ inline double vertex_similarity_overlap(NodeId a, NodeId b, const SGraph &g)
     return vertex_similarity_overlap(g.out_neigh(a), g.out_neigh(b));
 }
 
+namespace detail {
+
+template <class SGraph, class = void>
+struct has_degree_weights : std::false_type {};
+
+template <class SGraph>
+struct has_degree_weights<SGraph, std::void_t<decltype(std::declval<const SGraph &>().degree_weights())>>
+        : std::true_type {};
+
+} // namespace detail
+
+/**
+ * Returns the degree weight table owned by the graph, or computes it into `fallback` if the graph has none.
+ *
+ * @tparam SGraph SetGraph compatible graph representation type
+ * @param g The input graph
+ * @param fallback storage for the table if the graph doesn't provide one
+ * @return
+ */
+template <class SGraph>
+const DegreeWeights &degree_weights_of(const SGraph &g, DegreeWeights &fallback)
+{
+    if constexpr (detail::has_degree_weights<SGraph>::value) {
+        if (g.has_degree_weights()) {
+            return g.degree_weights();
+        }
+    }
+    fallback = DegreeWeights::FromGraph(g);
+    return fallback;
+}
+
+/**
+ * Computes the Adamic Adar vertex similarity index for two vertices, using precomputed weights.
+ *
+ * @tparam SGraph SetGraph compatible graph representation type
+ * @param a ID of the first vertex
+ * @param b ID of the second vertex
+ * @param g The input graph
+ * @param weights degree weights of g
+ * @return
+ */
+template <class SGraph>
+inline double vertex_similarity_adamic_adar(NodeId a, NodeId b, const SGraph &g, const DegreeWeights &weights)
+{
+    assert(weights.num_nodes() == g.num_nodes());
+    const double *inv_log_degree = weights.inv_log_degree();
+    return g.out_neigh(a).intersect_sum(g.out_neigh(b), [inv_log_degree](NodeId u) {
+        return inv_log_degree[u];
+    });
+}
+
 /**
  * Computes the Adamic Adar vertex similarity index for two vertices.
  *
  * Originally described in https://doi.org/10.1016/S0378-8733(03)00009-1.
+ * Uses the degree weights of the graph if they have been built.
  *
  * @tparam SGraph SetGraph compatible graph representation type
  * @param a ID of the first vertex
@@ -94,20 +150,41 @@ inline double vertex_similarity_overlap(NodeId a, NodeId b, const SGraph &g)
 template <class SGraph>
 inline double vertex_similarity_adamic_adar(NodeId a, NodeId b, const SGraph &g)
 {
-    double sum = 0;
-    auto intersection = g.out_neigh(a).intersect(g.out_neigh(b));
-
-    for (NodeId u : intersection) {
-        double count = g.out_degree(u);
-        sum += 1. / std::log(count);
+    if constexpr (detail::has_degree_weights<SGraph>::value) {
+        if (g.has_degree_weights()) {
+            return vertex_similarity_adamic_adar(a, b, g, g.degree_weights());
+        }
     }
+    return g.out_neigh(a).intersect_sum(g.out_neigh(b), [&g](NodeId u) {
+        return 1. / std::log(double(g.out_degree(u)));
+    });
+}
 
-    return sum;
+/**
+ * Computes the Resource Allocation vertex similarity for two vertices, using precomputed weights.
+ *
+ * @tparam SGraph SetGraph compatible graph representation type
+ * @param a ID of the first vertex
+ * @param b ID of the second vertex
+ * @param g The input graph
+ * @param weights degree weights of g
+ * @return
+ */
+template <class SGraph>
+inline double vertex_similarity_resource(NodeId a, NodeId b, const SGraph &g, const DegreeWeights &weights)
+{
+    assert(weights.num_nodes() == g.num_nodes());
+    const double *inv_degree = weights.inv_degree();
+    return g.out_neigh(a).intersect_sum(g.out_neigh(b), [inv_degree](NodeId u) {
+        return inv_degree[u];
+    });
 }
 
 /**
  * Computes the Resource Allocation vertex similarity for two vertices.
  *
+ * Uses the degree weights of the graph if they have been built.
+ *
  * @tparam SGraph SetGraph compatible graph representation type
  * @param a ID of the first vertex
  * @param b ID of the second vertex
@@ -117,12 +194,14 @@ inline double vertex_similarity_adamic_adar(NodeId a, NodeId b, const SGraph &g)
 template <class SGraph>
 inline double vertex_similarity_resource(NodeId a, NodeId b, const SGraph &g)
 {
-    auto intersection = g.out_neigh(a).intersect(g.out_neigh(b));
-    double s = 0;
-    for (auto w : intersection) {
-        s += 1.0/ g.out_degree(w);
+    if constexpr (detail::has_degree_weights<SGraph>::value) {
+        if (g.has_degree_weights()) {
+            return vertex_similarity_resource(a, b, g, g.degree_weights());
+        }
     }
-    return s;
+    return g.out_neigh(a).intersect_sum(g.out_neigh(b), [&g](NodeId u) {
+        return 1.0 / g.out_degree(u);
+    });
 }
 
 /**
@@ -186,6 +265,61 @@ inline double vertex_similarity_preferential_attachment(NodeId a, NodeId b, cons
     return vertex_similarity_preferential_attachment(g.out_neigh(a), g.out_neigh(b));
 }
 
+/**
+ * Whether the metric is a (weighted) sum over the common neighbors of two vertices, normalized by their degrees.
+ *
+ * For these metrics the similarity of two vertices at distance larger than two is zero, which allows to restrict
+ * the candidates to two-hop neighborhoods.
+ */
+template <Metric metric>
+constexpr bool is_common_neighbor_metric = metric == Metric::Jaccard || metric == Metric::Overlap ||
+        metric == Metric::AdamicAdar || metric == Metric::Resource || metric == Metric::CommNeigh;
+
+/**
+ * Contribution of a single common neighbor with the given degree to a common neighbor based metric.
+ *
+ * @tparam metric a metric with is_common_neighbor_metric<metric>
+ * @param degree the degree of the common neighbor, at least 2
+ * @return
+ */
+template <Metric metric>
+inline double common_neighbor_weight(int64_t degree)
+{
+    static_assert(is_common_neighbor_metric<metric>, "metric is not based on common neighbors");
+    if constexpr (metric == Metric::AdamicAdar) {
+        return 1.0 / std::log(double(degree));
+    } else if constexpr (metric == Metric::Resource) {
+        return 1.0 / degree;
+    } else {
+        return 1.0;
+    }
+}
+
+/**
+ * Computes a common neighbor based metric from the accumulated weights of the common neighbors.
+ *
+ * @tparam metric a metric with is_common_neighbor_metric<metric>
+ * @param common the sum of common_neighbor_weight<metric> over all common neighbors
+ * @param degree_a the degree of the first vertex
+ * @param degree_b the degree of the second vertex
+ * @return the same value as vertex_similarity<metric> for the pair
+ */
+template <Metric metric>
+inline double vertex_similarity_from_common(double common, int64_t degree_a, int64_t degree_b)
+{
+    static_assert(is_common_neighbor_metric<metric>, "metric is not based on common neighbors");
+    if constexpr (metric == Metric::Jaccard) {
+        if (degree_a == 0 && degree_b == 0) {
+            return 1.0;
+        }
+        return common / (degree_a + degree_b - common);
+    } else if constexpr (metric == Metric::Overlap) {
+        return common / std::min(degree_a, degree_b);
+    } else {
+        return common;
+    }
+}
+
 /**
  * Generic helper method to invoke any of the vertex_similarity functions on a pair of vertices,
  * given its `Metric` descriptor.
@@ -220,4 +354,22 @@ inline double vertex_similarity(NodeId a, NodeId b, const SGraph &g)
     }
 }
 
+/**
+ * Same as vertex_similarity, but takes the degree weights of the graph explicitly.
+ *
+ * This is used by kernels which evaluate many pairs on a graph which doesn't own a weight table,
+ * see degree_weights_of.
+ */
+template <Metric metric, class SGraph>
+inline double vertex_similarity(NodeId a, NodeId b, const SGraph &g, const DegreeWeights &weights)
+{
+    if constexpr (metric == Metric::AdamicAdar) {
+        return vertex_similarity_adamic_adar(a, b, g, weights);
+    } else if constexpr (metric == Metric::Resource) {
+        return vertex_similarity_resource(a, b, g, weights);
+    } else {
+        return vertex_similarity<metric>(a, b, g);
+    }
+}
+
 } // namespace GMS::VertexSim
\ No newline at end of file
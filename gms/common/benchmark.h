@@ -1,20 +1,269 @@
 #pragma once
 
+#include <functional>
+#include <optional>
 #include <string>
+#include <type_traits>
+#include <vector>
 #include <gms/third_party/gapbs/util.h>
 #include <gms/third_party/gapbs/timer.h>
 
+#include "benchmark_report.h"
+#include "instrumentation.h"
+#include "papi/counters.h"
+#include "printer.h"
 #include "cli/args.h"
+#include "cli/compat.h"
 
-// This file contains various versions of BenchmarkKernel functions, inspired by the original GAPBS BenchmarkKernel
-// function, which has been renamed to BenchmarkKernelLegacy (in `third_party/gapbs/benchmark.h`), but with several
-// extensions depending on the function:
+// This file contains the benchmark harness (GMS::Benchmark) and the BenchmarkKernel functions built on it,
+// inspired by the original GAPBS BenchmarkKernel function, which has been renamed to BenchmarkKernelLegacy
+// (at the end of this file, still with the GAPBS interface), but with several extensions depending on the function:
 // - use CLI::Args for parameters
 // - support for SetGraph
 // - support for different preprocessing functions
+// - warmup runs, summary statistics and JSON/CSV records (see benchmark_report.h)
 
 namespace GMS {
 
+/**
+ * @brief Benchmark harness which runs a kernel in the stages setup, preprocess, kernel, verify and teardown.
+ *
+ * The stages are passed as callables and share their state through their captures; only the result of the
+ * kernel is passed on to the verifier. Setup and teardown run once, the preprocess and kernel stages run for
+ * every warmup run and trial, the verifier for every trial if requested on the command line.
+ *
+ * Every stage is timed and reported through a BenchmarkReport. For every trial, a line
+ *
+ *     @@@ <kernel time> [<PASS|FAIL> <verify time>] [<preprocess time>] [<metrics>...] <info>...
+ *
+ * is printed for `scripts/collectData.bash`. The hardware counters selected with --counters are read around the
+ * kernel stage and reported as the metrics counter.<event> (see papi/counters.h).
+ *
+ * Example:
+ *
+ *     Benchmark(args).set_type<SGraph>().graph(g).info("tc", "total")
+ *         .setup([&] { sg = SGraph::FromCGraph(g); })
+ *         .run([&] { return count_total(sg); }, [&](int64_t count) { return verify(g, count); });
+ */
+class Benchmark {
+public:
+    explicit Benchmark(const CLI::Args &args) :
+        report_(args.report), num_trials_(args.num_trials), verify_(args.verify) {}
+
+    /// For the benchmarks which still use a CLApp, the records are only configurable if it is a ReportOptions.
+    explicit Benchmark(const CLApp &cli) :
+        report_(report_spec_of(cli)), num_trials_(cli.num_trials()), verify_(cli.do_verify()) {}
+
+    Benchmark &setup(std::function<void()> f) {
+        setup_ = std::move(f);
+        return *this;
+    }
+
+    Benchmark &preprocess(std::function<void()> f) {
+        preprocess_ = std::move(f);
+        return *this;
+    }
+
+    Benchmark &teardown(std::function<void()> f) {
+        teardown_ = std::move(f);
+        return *this;
+    }
+
+    /// The input graph, which is fingerprinted for the records.
+    template <class Graph>
+    Benchmark &graph(const Graph &g) {
+        report_.set_graph(g);
+        return *this;
+    }
+
+    /// The (set) graph type the kernel runs on.
+    template <class SGraph>
+    Benchmark &set_type() {
+        report_.set_type(type_name<SGraph>());
+        return *this;
+    }
+
+    /// Strings identifying the benchmark, appended to the @@@ lines and joined into the label of the records.
+    template <class... Infos>
+    Benchmark &info(const Infos &... infos) {
+        std::vector<std::string> strings;
+        (strings.push_back(to_string(infos)), ...);
+        report_.set_info(std::move(strings));
+        return *this;
+    }
+
+    /// Records a value of the current trial, e.g. the quality of a result. Call from within the stages.
+    void metric(const std::string &name, double value) {
+        report_.add_metric(name, value);
+        if (!report_.warmup()) {
+            metrics_.push_back(value);
+        }
+    }
+
+    /// Runs the benchmark without verification.
+    template <class KernelF>
+    BenchmarkReport run(KernelF kernel) {
+        return run(kernel, nullptr);
+    }
+
+    /**
+     * Runs the benchmark.
+     *
+     * @param kernel Called without arguments, its result is passed to the verifier.
+     * @param verify Called with the result of the kernel (or without arguments if it returns void), returns
+     *   whether the result is correct. Nullptr if there is no verifier.
+     * @param inspect Called like the verifier after every trial, but untimed and regardless of the command
+     *   line, e.g. to record metrics of the result. Nullptr if not needed.
+     * @return the report, e.g. to look at the statistics.
+     */
+    template <class KernelF, class VerifyF, class InspectF = std::nullptr_t>
+    BenchmarkReport run(KernelF kernel, VerifyF verify, InspectF inspect = nullptr) {
+        Timer timer;
+        if (setup_) {
+            timer.Start();
+            setup_();
+            timer.Stop();
+            PrintTime("Setup Time", timer.Seconds());
+            report_.add_time("setup", timer.Seconds());
+        }
+
+        PAPIW::CounterSet counters(report_.spec().counters);
+        for (int64_t iter = 0; iter < report_.spec().warmup_trials + num_trials_; iter++) {
+            report_.begin_trial();
+            const bool warmup = report_.warmup();
+            metrics_.clear();
+            Printer printer;
+
+            double preprocess_time = 0;
+            if (preprocess_) {
+                timer.Start();
+                preprocess_();
+                timer.Stop();
+                preprocess_time = timer.Seconds();
+                report_.add_time("preprocess", preprocess_time);
+                if (!warmup) {
+                    PrintTime("Preprocess Time", preprocess_time);
+                }
+            }
+
+#ifdef GMS_INSTRUMENTATION
+            Instrumentation::reset();
+#endif
+            if constexpr (std::is_void_v<std::invoke_result_t<KernelF>>) {
+                counters.start();
+                timer.Start();
+                kernel();
+                timer.Stop();
+                counters.stop();
+                trial_done(timer, counters, warmup, printer,
+                           [&]() { inspect_stage(inspect); }, [&]() { return verify_stage(verify); });
+            } else {
+                counters.start();
+                timer.Start();
+                auto result = kernel();
+                timer.Stop();
+                counters.stop();
+                trial_done(timer, counters, warmup, printer,
+                           [&]() { inspect_stage(inspect, result); }, [&]() { return verify_stage(verify, result); });
+            }
+
+            if (!warmup) {
+                if (preprocess_) {
+                    printer << preprocess_time;
+                }
+                for (double m : metrics_) {
+                    printer << m;
+                }
+                for (const std::string &i : report_.info()) {
+                    printer << i;
+                }
+                std::cout << printer << std::endl;
+            }
+            report_.end_trial();
+        }
+
+        if (teardown_) {
+            timer.Start();
+            teardown_();
+            timer.Stop();
+            report_.add_time("teardown", timer.Seconds());
+        }
+        report_.finish();
+        return report_;
+    }
+
+private:
+    BenchmarkReport report_;
+    int64_t num_trials_;
+    bool verify_;
+    std::function<void()> setup_;
+    std::function<void()> preprocess_;
+    std::function<void()> teardown_;
+    std::vector<double> metrics_;
+
+    static ReportSpec report_spec_of(const CLApp &cli) {
+        auto options = dynamic_cast<const ReportOptions *>(&cli);
+        return options ? options->report_spec : ReportSpec();
+    }
+
+    template <class T>
+    static std::string to_string(const T &value) {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    }
+
+    // Reports the kernel time and counters and runs the verifier, which returns "" if there is none.
+    template <class InspectStage, class VerifyStage>
+    void trial_done(const Timer &kernel_timer, const PAPIW::CounterSet &counters, bool warmup, Printer &printer,
+                    InspectStage inspect_stage, VerifyStage verify_stage) {
+        const double kernel_time = kernel_timer.Seconds();
+        report_.add_time("kernel", kernel_time);
+        if (warmup) {
+            return;
+        }
+        PrintTime("Trial Time", kernel_time);
+        printer << kernel_time;
+        counters.report_to(report_);
+#ifdef GMS_INSTRUMENTATION
+        Instrumentation::report_to(report_);
+#endif
+        inspect_stage();
+        if (!verify_) {
+            return;
+        }
+        Timer timer;
+        timer.Start();
+        std::string mark = verify_stage();
+        timer.Stop();
+        if (mark.empty()) {
+            return;
+        }
+        PrintLabel("Verification", mark);
+        PrintTime("Verification Time", timer.Seconds());
+        report_.add_time("verify", timer.Seconds());
+        report_.set_verification(mark == "PASS");
+        printer << mark;
+        printer << timer.Seconds();
+    }
+
+    template <class InspectF, class... Result>
+    static void inspect_stage(InspectF &inspect, Result &... result) {
+        if constexpr (!std::is_null_pointer_v<InspectF>) {
+            inspect(result...);
+        }
+    }
+
+    template <class VerifyF, class... Result>
+    static std::string verify_stage(VerifyF &verify, Result &... result) {
+        if constexpr (std::is_null_pointer_v<VerifyF>) {
+            return "";
+        } else {
+            return verify(result...) ? "PASS" : "FAIL";
+        }
+    }
+};
+
 // Calls (and times) GAPBSF according to command line arguments
 template <typename GraphT_, typename GAPBSFunc,
         typename VerifierFunc, class... print_T>
@@ -24,32 +273,9 @@ void BenchmarkKernel(const CLI::Args &args, const GraphT_ &g,
 {
     static_assert(string_check<std::is_convertible<print_T, std::string>::value...>::value, "printInfo not convertible to string!");
     g.PrintStats();
-    double total_seconds = 0;
-    Timer trial_timer;
-    for (int iter = 0; iter < args.num_trials; iter++) {
-        trial_timer.Start();
-        auto result = GAPBSF(g);
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        const double trialTime = trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-        if (args.verify) {
-            trial_timer.Start();
-            std::string verifyMark = verify(std::ref(g), std::ref(result)) ? "PASS" : "FAIL";
-            PrintLabel("Verification",
-                       verifyMark);
-            trial_timer.Stop();
-            PrintTime("Verification Time", trial_timer.Seconds());
-            const double verifyTime = trial_timer.Seconds();
-
-            PrintBenchmarkOutput("@@@", trialTime, verifyMark, verifyTime, printInfo...);
-        }
-        else
-        {
-            PrintBenchmarkOutput("@@@", trialTime, printInfo...);
-        }
-    }
-    PrintTime("Average Time", total_seconds / args.num_trials);
+    Benchmark(args).set_type<GraphT_>().graph(g).info(printInfo...).run(
+        [&]() { return GAPBSF(g); },
+        [&](auto &result) { return verify(std::ref(g), std::ref(result)); });
 }
 
 //benchmarking kernels with additional integer parameter (e.g., clique size)
@@ -64,29 +290,9 @@ void BenchmarkKernel(const CLI::Args &args, GraphT_ &g,
 {
     static_assert(string_check<std::is_convertible<print_T, std::string>::value...>::value, "printInfo not convertible to string!");
     g.PrintStats();
-    double total_seconds = 0;
-    Timer trial_timer;
-    for (int iter = 0; iter < args.num_trials; iter++) {
-        trial_timer.Start();
-        auto result = GraphF(g, param);
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        const double trialTime = trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-        if (args.verify) {
-            trial_timer.Start();
-            std::string verifyMark = verify(std::ref(g), std::ref(result), param) ? "PASS" : "FAIL";
-            PrintLabel("Verification", verifyMark);
-            trial_timer.Stop();
-            PrintTime("Verification Time", trial_timer.Seconds());
-            const double verifyTime = trial_timer.Seconds();
-
-            PrintBenchmarkOutput("@@@", trialTime, verifyMark, verifyTime, printInfo...);
-        } else {
-            PrintBenchmarkOutput("@@@", trialTime, printInfo...);
-        }
-    }
-    PrintTime("Average Time", total_seconds / args.num_trials);
+    Benchmark(args).set_type<GraphT_>().graph(g).info(printInfo...).run(
+        [&]() { return GraphF(g, param); },
+        [&](auto &result) { return verify(std::ref(g), std::ref(result), param); });
 }
 
 //Added by Zur 11.01.2019 for better controlling of RoaringGraph building
@@ -99,41 +305,12 @@ void BenchmarkKernelBk(const CLI::Args &args, const GraphT_ &g,
 {
     static_assert(string_check<std::is_convertible<print_T, std::string>::value...>::value, "printInfo not convertible to string!");
     g.PrintStats();
-    double total_seconds = 0;
-    Timer trial_timer;
-
-    //Building Roaring Graph
-    trial_timer.Start();
-    GraphExec rgraph = GraphExec::FromCGraph(g);
-    trial_timer.Stop();
-    PrintTime("GraphExec buildTime", trial_timer.Seconds());
-
-    for (int iter = 0; iter < args.num_trials; iter++)
-    {
-        trial_timer.Start();
-        auto result = GAPBSF(rgraph);
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        const double trialTime = trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-        if (args.verify)
-        {
-            trial_timer.Start();
-            std::string verifyMark = verify(std::ref(g), std::ref(result)) ? "PASS" : "FAIL";
-            PrintLabel("Verification",
-                       verifyMark);
-            trial_timer.Stop();
-            PrintTime("Verification Time", trial_timer.Seconds());
-            const double verifyTime = trial_timer.Seconds();
-
-            PrintBenchmarkOutput("@@@", trialTime, verifyMark, verifyTime, printInfo...);
-        }
-        else
-        {
-            PrintBenchmarkOutput("@@@", trialTime, printInfo...);
-        }
-    }
-    PrintTime("Average Time", total_seconds / args.num_trials);
+    std::optional<GraphExec> rgraph;
+    Benchmark(args).set_type<GraphExec>().graph(g).info(printInfo...)
+        .setup([&]() { rgraph = GraphExec::FromCGraph(g); })
+        .teardown([&]() { rgraph.reset(); })
+        .run([&]() { return GAPBSF(*rgraph); },
+             [&](auto &result) { return verify(std::ref(g), std::ref(result)); });
 }
 
 //Added by Zur 11.02.2020,
@@ -148,51 +325,17 @@ void BenchmarkKernelBkPP(const CLI::Args &args, const GraphT_ &g,
 {
     static_assert(string_check<std::is_convertible<print_T, std::string>::value...>::value, "printInfo not convertible to string!");
     g.PrintStats();
-    double total_seconds = 0;
-    double pp_total_seconds = 0;
-    double vv_total_seconds = 0;
-    Timer trial_timer;
-
-    //Building Roaring Graph
-    trial_timer.Start();
-    GraphExec rgraph = GraphExec::FromCGraph(g);
-    trial_timer.Stop();
-    PrintTime("GraphExec buildTime", trial_timer.Seconds());
-
-    for (int iter = 0; iter < args.num_trials; iter++) {
-        // do preprocessing
-        trial_timer.Start();
-        pvector<NodeId> order(rgraph.num_nodes());
-        preprocess(rgraph, order);
-        trial_timer.Stop();
-        PrintTime("Preprocess Time", trial_timer.Seconds());
-        const double preprocTime = trial_timer.Seconds();
-        pp_total_seconds += trial_timer.Seconds();
-
-        trial_timer.Start();
-        auto result = GAPBSF(rgraph, order);
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        const double trialTime = trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-        if (args.verify) {
-            trial_timer.Start();
-            std::string verifyMark = verify(std::ref(g), std::ref(result)) ? "PASS" : "FAIL";
-            PrintLabel("Verification",
-                       verifyMark);
-            trial_timer.Stop();
-            PrintTime("Verification Time", trial_timer.Seconds());
-            const double verifyTime = trial_timer.Seconds();
-            vv_total_seconds += trial_timer.Seconds();
-
-            PrintBenchmarkOutput("@@@", trialTime, verifyMark, verifyTime, preprocTime, printInfo...);
-        } else {
-            PrintBenchmarkOutput("@@@", trialTime, preprocTime, printInfo...);
-        }
-    }
-    PrintTime("Average pp Time", pp_total_seconds / args.num_trials);
-    PrintTime("Average Time", total_seconds / args.num_trials);
-    PrintTime("Average Verification Time", vv_total_seconds / args.num_trials);
+    std::optional<GraphExec> rgraph;
+    pvector<NodeId> order;
+    Benchmark(args).set_type<GraphExec>().graph(g).info(printInfo...)
+        .setup([&]() { rgraph = GraphExec::FromCGraph(g); })
+        .preprocess([&]() {
+            order = pvector<NodeId>(rgraph->num_nodes());
+            preprocess(*rgraph, order);
+        })
+        .teardown([&]() { rgraph.reset(); })
+        .run([&]() { return GAPBSF(*rgraph, order); },
+             [&](auto &result) { return verify(std::ref(g), std::ref(result)); });
 }
 
 // Calls (and times) GAPBSF according to command line arguments
@@ -208,112 +351,32 @@ void BenchmarkKernelPP(const CLApp &cli, const GraphT_ &g,
 {
     static_assert(string_check<std::is_convertible<print_T, std::string>::value...>::value, "printInfo not convertible to string!");
     g.PrintStats();
-    double total_seconds = 0;
-    double pp_total_seconds = 0;
-    double vv_total_seconds = 0;
-    Timer trial_timer;
-    for (int iter = 0; iter < cli.num_trials(); iter++)
-    {
-        // do preprocessing
-        trial_timer.Start();
-        auto ppG = preprocess(g, cli);
-        trial_timer.Stop();
-        PrintTime("Preprocess Time", trial_timer.Seconds());
-        const double preprocTime = trial_timer.Seconds();
-        pp_total_seconds += trial_timer.Seconds();
-
-        trial_timer.Start();
-        auto result = GAPBSF(ppG, cli);
-        trial_timer.Stop();
-        PrintTime("Trial Time", trial_timer.Seconds());
-        const double trialTime = trial_timer.Seconds();
-        total_seconds += trial_timer.Seconds();
-        // if (cli.do_analysis() && (iter == (cli.num_trials()-1)))
-        //   gapbsF(g, result);
-        if (cli.do_verify())
-        {
-            trial_timer.Start();
-            std::string verifyMark = verify(std::ref(ppG), std::ref(result), cli) ? "PASS" : "FAIL";
-            PrintLabel("Verification",
-                       verifyMark);
-            trial_timer.Stop();
-            PrintTime("Verification Time", trial_timer.Seconds());
-            const double verifyTime = trial_timer.Seconds();
-            vv_total_seconds += trial_timer.Seconds();
-
-            PrintBenchmarkOutput("@@@", trialTime, verifyMark, verifyTime, preprocTime, printInfo...);
-        }
-        else
-        {
-            PrintBenchmarkOutput("@@@", trialTime, preprocTime, printInfo...);
-        }
-    }
-    PrintTime("Average pp Time", pp_total_seconds / cli.num_trials());
-    PrintTime("Average Time", total_seconds / cli.num_trials());
-    PrintTime("Average Verification Time", vv_total_seconds / cli.num_trials());
+    std::optional<std::invoke_result_t<PPFunc, const GraphT_ &, const CLApp &>> ppG;
+    Benchmark(cli).set_type<GraphT_>().graph(g).info(printInfo...)
+        .preprocess([&]() { ppG.emplace(preprocess(g, cli)); })
+        .run([&]() { return GAPBSF(*ppG, cli); },
+             [&](auto &result) { return verify(std::ref(*ppG), std::ref(result), cli); });
 }
 
-/*
-// Calls (and times) kernel according to command line arguments
-// and performs preprocessing specified in preprocess
-// added by Yannick Schaffner, 4.11.2019
-template<typename GraphT_,
-          typename KernelFunc, typename KernelSetupFunc,
-         typename VerifyFunc, typename VerifySetupFunc, typename VerifyTearDownFunc,
-         class ... print_T>
-void BenchmarkKernelPPP(const CLI::Args &args, const GraphT_ &g,
-                     KernelSetupFunc kernelSetup,
-                     KernelFunc kernel,
-                     VerifySetupFunc verifySetup,
-                     VerifyFunc verify,
-                     VerifyTearDownFunc verifyTeardown,
-                     print_T ... printInfo) {
-  static_assert( string_check<std::is_convertible<print_T, std::string>::value...>::value, "printInfo not convertible to string!");
-  g.PrintStats();
-  double total_seconds = 0;
-  double pp_total_seconds = 0;
-  double vv_total_seconds = 0;
-  Timer trial_timer;
-  for (int iter=0; iter < args.num_trials; iter++) {
-    // do preprocessing
-    trial_timer.Start();
-    auto ppG = kernelSetup(g, args);
-    trial_timer.Stop();
-    PrintTime("Preprocess Time", trial_timer.Seconds());
-    const double setupTime = trial_timer.Seconds();
-    pp_total_seconds += trial_timer.Seconds();
-
-    trial_timer.Start();
-    auto result = kernel(ppG, args);
-    trial_timer.Stop();
-    PrintTime("Trial Time", trial_timer.Seconds());
-    const double trialTime = trial_timer.Seconds();
-    total_seconds += trial_timer.Seconds();
-
-    if (args.verify) {
-      auto vppG = verifySetup(ppG, g, args);
-
-      trial_timer.Start();
-      std::string verifyMark = verify(vppG, std::ref(result), args) ? "PASS" : "FAIL";
-      PrintLabel("Verification",
-                 verifyMark);
-      trial_timer.Stop();
-      PrintTime("Verification Time", trial_timer.Seconds());
-      const double verifyTime = trial_timer.Seconds();
-      vv_total_seconds += trial_timer.Seconds();
-
-      verifyTeardown(vppG, args);
-
-      PrintBenchmarkOutput("@@@", trialTime, verifyMark, verifyTime, setupTime, printInfo...);
-    }
-    else {
-      PrintBenchmarkOutput("@@@", trialTime, setupTime, printInfo...);
-    }
-  }
-  PrintTime("Average pp Time", pp_total_seconds/ args.num_trials);
-  PrintTime("Average Time", total_seconds / args.num_trials);
-  PrintTime("Average Verification Time", vv_total_seconds/ args.num_trials);
 }
-*/
 
-}
\ No newline at end of file
+// Calls (and times) kernel according to command line arguments, with the interface of the original GAPBS
+// BenchmarkKernel. The stats are printed for the result of the last trial if analysis was requested (-a).
+//
+// This function shouldn't be used for new code.
+template<typename GraphT_, typename GraphFunc, typename AnalysisFunc,
+        typename VerifierFunc, class... print_T>
+void BenchmarkKernelLegacy(const CLApp &cli, const GraphT_ &g,
+                           GraphFunc kernel, AnalysisFunc stats,
+                           VerifierFunc verify, print_T... printInfo) {
+    g.PrintStats();
+    int64_t trial = 0;
+    GMS::Benchmark(cli).set_type<GraphT_>().graph(g).info(printInfo...).run(
+        [&]() { return kernel(g); },
+        [&](auto &result) { return verify(std::ref(g), std::ref(result)); },
+        [&](auto &result) {
+            if (cli.do_analysis() && ++trial == cli.num_trials()) {
+                stats(g, result);
+            }
+        });
+}
@@ -0,0 +1,458 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <cxxabi.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <gms/third_party/gapbs/util.h>
+#include "format.h"
+
+// The git revision is passed by the build (see gms_benchmark in the top-level CMakeLists.txt)
+#ifndef GMS_GIT_SHA
+#define GMS_GIT_SHA "unknown"
+#endif
+
+namespace GMS {
+
+/**
+ * Settings of the benchmark records, set with the --warmup, --format and --output options of CLI::Parser.
+ */
+struct ReportSpec {
+    // untimed runs of the preprocess and kernel stages before the trials
+    int64_t warmup_trials = 0;
+    // "text" (human readable summary only), "json" (one object per line) or "csv"
+    std::string format = "text";
+    // the records are appended to this file, or printed to stdout if empty
+    std::string file;
+    // name of the input file or generator, copied into the records
+    std::string graph_name;
+    // hardware counters of the kernel stage, see gms/common/papi/counters.h
+    std::string counters;
+
+    bool structured() const {
+        return format == "json" || format == "csv";
+    }
+
+    static bool valid_format(const std::string &format) {
+        return format == "text" || format == "json" || format == "csv";
+    }
+};
+
+/**
+ * Base of the command line classes of the benchmarks which still use a CLApp, it passes their ReportSpec on to
+ * Benchmark(const CLApp &).
+ */
+struct ReportOptions {
+    ReportSpec report_spec;
+
+    virtual ~ReportOptions() = default;
+};
+
+/**
+ * Summary statistics of the samples of one stage.
+ *
+ * The confidence interval is the 95% interval of the mean, using Student's t-distribution,
+ * as the number of trials is usually small.
+ */
+struct BenchmarkStats {
+    int64_t count = 0;
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    double ci95_low = 0;
+    double ci95_high = 0;
+
+    static BenchmarkStats From(std::vector<double> samples) {
+        BenchmarkStats stats;
+        stats.count = samples.size();
+        if (samples.empty()) {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+        const size_t n = samples.size();
+        stats.min = samples.front();
+        stats.median = (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        double sum = 0;
+        for (double s : samples) {
+            sum += s;
+        }
+        stats.mean = sum / n;
+        double squares = 0;
+        for (double s : samples) {
+            squares += (s - stats.mean) * (s - stats.mean);
+        }
+        stats.stddev = (n > 1) ? std::sqrt(squares / (n - 1)) : 0;
+        const double half_width = (n > 1) ? t_quantile_975(n - 1) * stats.stddev / std::sqrt((double) n) : 0;
+        stats.ci95_low = stats.mean - half_width;
+        stats.ci95_high = stats.mean + half_width;
+        return stats;
+    }
+
+    /// The 0.975 quantile of Student's t-distribution with the given degrees of freedom.
+    static double t_quantile_975(int64_t df) {
+        static const double table[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        if (df < 1) {
+            return 0;
+        }
+        return (df <= 30) ? table[df - 1] : 1.960;
+    }
+};
+
+/**
+ * Identifies the input of a benchmark: FNV-1a over the number of vertices and the degree sequence.
+ * A relabelled or otherwise modified graph thus gets a different fingerprint, while only taking O(n).
+ */
+template <class Graph>
+uint64_t graph_fingerprint(const Graph &g) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(g.num_nodes());
+    for (int64_t u = 0; u < (int64_t) g.num_nodes(); u++) {
+        mix(g.out_degree(u));
+    }
+    return hash;
+}
+
+/// Readable name of a type, e.g. of the set graph a kernel runs on.
+template <class T>
+std::string type_name() {
+    int status = 0;
+    std::unique_ptr<char, void (*)(void *)> name(abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status), std::free);
+    return (status == 0) ? std::string(name.get()) : std::string(typeid(T).name());
+}
+
+/**
+ * Collects the timings of the stages of one benchmark over its trials and reports them when finished:
+ * as a summary on stdout, and as a JSON or CSV record if requested by the ReportSpec.
+ *
+ * Stages are identified by name, in the order they were first timed. Times added outside of a trial
+ * (e.g. of a setup stage) are single samples. Times and metrics of warmup trials are dropped.
+ */
+class BenchmarkReport {
+public:
+    BenchmarkReport(ReportSpec spec, std::vector<std::string> info = {}) :
+        spec_(std::move(spec)), info_(std::move(info)) {}
+
+    template <class Graph>
+    void set_graph(const Graph &g) {
+        fingerprint_ = graph_fingerprint(g);
+        num_nodes_ = g.num_nodes();
+        num_edges_ = 0;
+        for (int64_t u = 0; u < (int64_t) g.num_nodes(); u++) {
+            num_edges_ += g.out_degree(u);
+        }
+    }
+
+    const ReportSpec &spec() const {
+        return spec_;
+    }
+
+    void set_type(std::string name) {
+        set_type_ = std::move(name);
+    }
+
+    void set_info(std::vector<std::string> info) {
+        info_ = std::move(info);
+    }
+
+    const std::vector<std::string> &info() const {
+        return info_;
+    }
+
+    void begin_trial() {
+        in_trial_ = true;
+        warmup_ = trial_index_ < spec_.warmup_trials;
+        trial_index_++;
+    }
+
+    void end_trial() {
+        in_trial_ = false;
+        if (!warmup_) {
+            trials_++;
+        }
+    }
+
+    /// Whether the current trial is a warmup trial.
+    bool warmup() const {
+        return in_trial_ && warmup_;
+    }
+
+    void add_time(const std::string &stage, double seconds) {
+        if (warmup()) {
+            return;
+        }
+        samples_of(stages_, stage).push_back(seconds);
+    }
+
+    void add_metric(const std::string &name, double value) {
+        if (warmup()) {
+            return;
+        }
+        samples_of(metrics_, name).push_back(value);
+    }
+
+    void set_verification(bool pass) {
+        if (warmup()) {
+            return;
+        }
+        verified_ = true;
+        failed_ = failed_ || !pass;
+    }
+
+    BenchmarkStats stats(const std::string &stage) const {
+        for (const auto &s : stages_) {
+            if (s.first == stage) {
+                return BenchmarkStats::From(s.second);
+            }
+        }
+        return BenchmarkStats();
+    }
+
+    /// Prints the summary and writes the record.
+    void finish() const {
+        print_summary();
+        write_record();
+    }
+
+    /// Writes the JSON or CSV record if requested, without the summary.
+    void write_record() const {
+        if (spec_.format == "json") {
+            write(json_record(), "");
+        } else if (spec_.format == "csv") {
+            write(csv_rows(), csv_header());
+        }
+    }
+
+    std::string label() const {
+        return iter2str(info_.begin(), info_.end(), " ");
+    }
+
+    std::string json_record() const {
+        std::ostringstream out;
+        out << std::setprecision(9);
+        out << "{\"label\":" << json_string(label())
+            << ",\"info\":[";
+        for (size_t i = 0; i < info_.size(); i++) {
+            out << (i > 0 ? "," : "") << json_string(info_[i]);
+        }
+        out << "],\"graph\":{\"name\":" << json_string(spec_.graph_name)
+            << ",\"fingerprint\":" << json_string(fingerprint_string())
+            << ",\"nodes\":" << num_nodes_
+            << ",\"edges\":" << num_edges_ << "}"
+            << ",\"threads\":" << num_threads()
+            << ",\"set_type\":" << json_string(set_type_)
+            << ",\"git_sha\":" << json_string(GMS_GIT_SHA)
+            << ",\"warmup_trials\":" << spec_.warmup_trials
+            << ",\"trials\":" << trials_
+            << ",\"verification\":" << (verified_ ? json_string(verification()) : "null")
+            << ",\"stages\":{";
+        write_json_samples(out, stages_);
+        out << "},\"metrics\":{";
+        write_json_samples(out, metrics_);
+        out << "}}\n";
+        return out.str();
+    }
+
+    static std::string csv_header() {
+        return "label,graph,fingerprint,nodes,edges,threads,set_type,git_sha,warmup_trials,trials,"
+               "kind,name,min,median,mean,stddev,ci95_low,ci95_high,verification\n";
+    }
+
+    /// One row per stage (kind "stage", in seconds) followed by one row per metric (kind "metric").
+    std::string csv_rows() const {
+        std::ostringstream out;
+        out << std::setprecision(9);
+        write_csv_rows(out, "stage", stages_);
+        write_csv_rows(out, "metric", metrics_);
+        return out.str();
+    }
+
+private:
+    using Samples = std::vector<std::pair<std::string, std::vector<double>>>;
+
+    ReportSpec spec_;
+    std::vector<std::string> info_;
+    uint64_t fingerprint_ = 0;
+    int64_t num_nodes_ = 0;
+    int64_t num_edges_ = 0;
+    std::string set_type_;
+    Samples stages_;
+    Samples metrics_;
+    int64_t trial_index_ = 0;
+    int64_t trials_ = 0;
+    bool in_trial_ = false;
+    bool warmup_ = false;
+    bool verified_ = false;
+    bool failed_ = false;
+
+    static std::vector<double> &samples_of(Samples &samples, const std::string &name) {
+        for (auto &s : samples) {
+            if (s.first == name) {
+                return s.second;
+            }
+        }
+        samples.emplace_back(name, std::vector<double>());
+        return samples.back().second;
+    }
+
+    static int num_threads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    std::string verification() const {
+        return verified_ ? (failed_ ? "FAIL" : "PASS") : "";
+    }
+
+    std::string fingerprint_string() const {
+        std::ostringstream out;
+        out << std::hex << std::setw(16) << std::setfill('0') << fingerprint_;
+        return out.str();
+    }
+
+    void write_csv_rows(std::ostringstream &out, const char *kind, const Samples &samples) const {
+        for (const auto &sample : samples) {
+            const BenchmarkStats s = BenchmarkStats::From(sample.second);
+            out << csv_string(label()) << ","
+                << csv_string(spec_.graph_name) << ","
+                << fingerprint_string() << ","
+                << num_nodes_ << ","
+                << num_edges_ << ","
+                << num_threads() << ","
+                << csv_string(set_type_) << ","
+                << csv_string(GMS_GIT_SHA) << ","
+                << spec_.warmup_trials << ","
+                << trials_ << ","
+                << kind << ","
+                << csv_string(sample.first) << ","
+                << s.min << "," << s.median << "," << s.mean << "," << s.stddev << ","
+                << s.ci95_low << "," << s.ci95_high << ","
+                << verification() << "\n";
+        }
+    }
+
+    void print_summary() const {
+        for (const auto &stage : stages_) {
+            const BenchmarkStats s = BenchmarkStats::From(stage.second);
+            if (stage.first == "kernel") {
+                // kept from the former BenchmarkKernel functions
+                PrintTime("Average Time", s.mean);
+                PrintTime("Min Time", s.min);
+                PrintTime("Median Time", s.median);
+                PrintTime("Stddev Time", s.stddev);
+                std::ostringstream ci;
+                ci << std::fixed << std::setprecision(5) << "[" << s.ci95_low << ", " << s.ci95_high << "]";
+                PrintLabel("95% CI Time", ci.str());
+            } else if (stage.first == "preprocess") {
+                PrintTime("Average pp Time", s.mean);
+            } else if (stage.first == "verify") {
+                PrintTime("Average Verification Time", s.mean);
+            } else if (s.count > 1) {
+                PrintTime("Average " + stage.first + " Time", s.mean);
+            }
+        }
+        for (const auto &metric : metrics_) {
+            PrintTime("Average " + metric.first, BenchmarkStats::From(metric.second).mean);
+        }
+    }
+
+    void write(const std::string &record, const std::string &header) const {
+        if (spec_.file.empty()) {
+            static bool header_written = false;
+            if (!header_written) {
+                std::cout << header;
+                header_written = true;
+            }
+            std::cout << record << std::flush;
+            return;
+        }
+        std::ofstream out(spec_.file, std::ios::app);
+        if (!out) {
+            std::cerr << "cannot open " << spec_.file << " to write the benchmark record" << std::endl;
+            return;
+        }
+        out.seekp(0, std::ios::end);
+        if (out.tellp() == 0) {
+            out << header;
+        }
+        out << record;
+    }
+
+    static void write_json_samples(std::ostringstream &out, const Samples &samples) {
+        for (size_t i = 0; i < samples.size(); i++) {
+            const BenchmarkStats s = BenchmarkStats::From(samples[i].second);
+            out << (i > 0 ? "," : "") << json_string(samples[i].first)
+                << ":{\"min\":" << s.min
+                << ",\"median\":" << s.median
+                << ",\"mean\":" << s.mean
+                << ",\"stddev\":" << s.stddev
+                << ",\"ci95\":[" << s.ci95_low << "," << s.ci95_high << "]"
+                << ",\"samples\":[";
+            for (size_t j = 0; j < samples[i].second.size(); j++) {
+                out << (j > 0 ? "," : "") << samples[i].second[j];
+            }
+            out << "]}";
+        }
+    }
+
+    static std::string json_string(const std::string &s) {
+        std::ostringstream out;
+        out << '"';
+        for (char c : s) {
+            switch (c) {
+                case '"': out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\t': out << "\\t"; break;
+                default:
+                    if ((unsigned char) c < 0x20) {
+                        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+                    } else {
+                        out << c;
+                    }
+            }
+        }
+        out << '"';
+        return out.str();
+    }
+
+    static std::string csv_string(const std::string &s) {
+        if (s.find_first_of(",\"\n") == std::string::npos) {
+            return s;
+        }
+        std::string quoted = "\"";
+        for (char c : s) {
+            quoted += (c == '"') ? "\"\"" : std::string(1, c);
+        }
+        return quoted + "\"";
+    }
+};
+
+} // namespace GMS
@@ -2,6 +2,8 @@
 
 #include "parameter.h"
 #include "../format.h"
+#include "../benchmark_report.h"
+#include "../generators.h"
 #include <gms/third_party/gapbs/benchmark.h>
 #include <cassert>
 
@@ -12,6 +14,8 @@ namespace GMS::CLI {
         // generator specific values
         int64_t gen_scale = -1;
         int64_t gen_avgdeg = -1;
+        // parameters of the generators of gms/common/generators.h, scale and degree are taken from above
+        Generators::Params gen_params;
     };
 
     class Args {
@@ -37,6 +41,7 @@ namespace GMS::CLI {
         int64_t num_trials;
         int64_t threads;
         GraphSpec graph_spec;
+        ReportSpec report;
         int error;
 
         void print() const {
@@ -48,6 +53,10 @@ namespace GMS::CLI {
                 << "    Verify: " << (verify ? "true" : "false") << "\n"
                 << "    Num trials: " << num_trials << "\n"
                 << "    Num threads: " << msg_num_threads << "\n"
+                << "    Warmup trials: " << report.warmup_trials << "\n"
+                << "    Record format: " << report.format
+                << (report.file.empty() ? "" : " (appended to " + report.file + ")") << "\n"
+                << "    Counters: " << (report.counters.empty() ? "none" : report.counters) << "\n"
                 << "  Input:" << "\n"
                 << "    Source: " << (graph_spec.is_generator ? "Generator" : "File") << "\n"
                 << "    Name: " << graph_spec.name << std::endl;
@@ -57,6 +66,7 @@ namespace GMS::CLI {
                     << "    Generator Arguments:" << "\n"
                     << "      Scale: " << graph_spec.gen_scale << "\n"
                     << "      Average Degree: " << graph_spec.gen_avgdeg << std::endl;
+                print_generator_params();
             } else {
                 std::cout
                     << std::boolalpha
@@ -92,6 +102,27 @@ namespace GMS::CLI {
         CSRGraph load_graph() const;
 
     private:
+        void print_generator_params() const {
+            const std::string &name = graph_spec.name;
+            const Generators::Params &params = graph_spec.gen_params;
+            if (!Generators::has_generator(name)) {
+                return;
+            }
+            std::cout << "      Seed: " << params.seed << "\n";
+            if (name == "chung-lu" && !params.degrees.empty()) {
+                std::cout << "      Degrees: " << params.degrees << "\n";
+            } else if (name == "chung-lu" || name == "lfr") {
+                std::cout << "      Exponent: " << params.exponent << "\n";
+            }
+            if (name == "lfr") {
+                std::cout << "      Mixing: " << params.mu << "\n";
+            }
+            if (name == "planted-clique") {
+                std::cout << "      Clique Size: " << (params.clique_size > 0 ? std::to_string(params.clique_size) : "2 * scale") << "\n";
+            }
+            std::cout << std::flush;
+        }
+
         void print_environment() const {
             std::cout
                 << "Compile time settings:" << "\n"
@@ -79,11 +79,16 @@ namespace GMS::CLI
             std::string gen_name;
             int64_t gen_scale;
             int64_t gen_avgdeg = 16;
+            Generators::Params gen_params;
 
             auto cli = (
                 option("-v", "--verify").set(args.verify).doc("perform a basic verification of the computation"),
                 option("-t", "--threads").doc("specify the number of threads used") & value("threads", args.threads),
-                option("-n", "--num-trials").doc("number of iterations for the benchmark") & value("trials", args.num_trials)
+                option("-n", "--num-trials").doc("number of iterations for the benchmark") & value("trials", args.num_trials),
+                option("-w", "--warmup").doc("number of untimed warmup iterations before the trials") & value("warmup", args.report.warmup_trials),
+                option("--format").doc("format of the benchmark records: text, json or csv") & value("format", args.report.format),
+                option("--output").doc("append the benchmark records to this file instead of stdout") & value("file", args.report.file),
+                option("--counters", "--counters=").doc("hardware counters of the kernel, comma separated PAPI preset events (e.g. L2_TCM,TOT_INS) or groups: cache, branch, stall, ipc") & value("events", args.report.counters)
             );
 
             if (custom_params.size() > 0) {
@@ -111,13 +116,28 @@ namespace GMS::CLI
                     option("-g", "--gen").required(true).doc("generate graph with the specified generator")
                     & ( option("uniform").required(true).set(gen_name, std::string("uniform"))
                         | option("kronecker").required(true).set(gen_name, std::string("kronecker"))
+                        | option("barabasi-albert").required(true).set(gen_name, std::string("barabasi-albert"))
+                        | option("chung-lu").required(true).set(gen_name, std::string("chung-lu"))
+                        | option("lfr").required(true).set(gen_name, std::string("lfr"))
+                        | option("geometric").required(true).set(gen_name, std::string("geometric"))
+                        | option("planted-clique").required(true).set(gen_name, std::string("planted-clique"))
                       )
                     & value("scale", gen_scale).doc("size of the generated graph = 2^scale"),
-                            option("--deg") & value("average_degree", gen_avgdeg)
+                            option("--deg") & value("average_degree", gen_avgdeg),
+                            option("--seed").doc("seed of the generators other than uniform and kronecker")
+                                & value("seed", gen_params.seed),
+                            option("--exponent").doc("power law exponent of the degrees of chung-lu and lfr (default: 2.5)")
+                                & value("exponent", gen_params.exponent),
+                            option("--degrees").doc("expected degrees of chung-lu, one per vertex, instead of a power law")
+                                & value("file", gen_params.degrees),
+                            option("--mu").doc("fraction of the edges of lfr between communities (default: 0.2)")
+                                & value("mu", gen_params.mu),
+                            option("--clique").doc("size of the planted clique (default: 2 * scale)")
+                                & value("size", gen_params.clique_size)
             );
             cli.push_back(cli_read_file | cli_generate);
 
-            if (!clipp::parse(argc, argv, cli)) {
+            if (!clipp::parse(argc, argv, cli) || !ReportSpec::valid_format(args.report.format)) {
                 std::cout << make_man_page(cli, argv[0]);
                 args.error = 100;
                 return args;
@@ -125,12 +145,15 @@ namespace GMS::CLI
 
             if (!file_name.empty()) {
                 args.graph_spec.name = file_name;
+                args.report.graph_name = file_name;
                 args.graph_spec.is_generator = false;
             } else if (!gen_name.empty()) {
                 args.graph_spec.name = gen_name;
                 args.graph_spec.is_generator = true;
                 args.graph_spec.gen_scale = gen_scale;
                 args.graph_spec.gen_avgdeg = gen_avgdeg;
+                args.graph_spec.gen_params = gen_params;
+                args.report.graph_name = gen_name + "-" + std::to_string(gen_scale) + "-" + std::to_string(gen_avgdeg);
             } else {
                 args.error = 101;
                 return args;
@@ -3,9 +3,11 @@
 #include "args.h"
 
 namespace GMS::CLI {
-    class GapbsCompat : public BenchCLApp {
+    // for the benchmarks which are run with a CLApp, see BenchmarkKernelPP and Pipeline
+    class GapbsCompat : public BenchCLApp, public ReportOptions {
     public:
         GapbsCompat(const Args &args) : BenchCLApp(0, {}, "dummy") {
+            report_spec = args.report;
             symmetrize_ = args.symmetrize;
             num_trials_ = args.num_trials;
             do_verify_ = args.verify;
@@ -33,6 +35,18 @@ namespace GMS::CLI {
     CSRGraph Args::load_graph() const {
         GapbsCompat compat(*this);
         Builder b(compat);
+        if (graph_spec.is_generator && Generators::has_generator(graph_spec.name)) {
+            Generators::Params params = graph_spec.gen_params;
+            params.scale = graph_spec.gen_scale;
+            // --deg is the number of edges per vertex, as for the GAPBS generators
+            params.average = 2.0 * graph_spec.gen_avgdeg;
+            Timer t;
+            t.Start();
+            Generators::EdgeList el = Generators::generate(graph_spec.name, params);
+            t.Stop();
+            PrintTime("Generate Time", t.Seconds());
+            return b.SquishGraph(b.MakeGraphFromEL(el));
+        }
         return b.MakeGraph();
     }
 }
\ No newline at end of file
@@ -0,0 +1,432 @@
+#pragma once
+#ifndef GMS_COMMON_GENERATORS_H_
+#define GMS_COMMON_GENERATORS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <gms/third_party/gapbs/pvector.h>
+#include "random.h"
+#include "types.h"
+
+/**
+ * Synthetic graphs in addition to the uniform and Kronecker graphs of GAPBS, selected with --gen.
+ *
+ * Every generator is a pure function of its parameters and the seed: the random numbers are drawn from
+ * Random::CounterRng streams keyed by the vertex or edge they decide, so the output does not depend on the number
+ * of threads. The edge lists are written in parallel into a single pvector, which is handed to the parallel CSR
+ * construction of the Builder (see CLI::Args::load_graph). The edges are undirected and may contain duplicates and
+ * self loops, both are removed by the Builder.
+ *
+ * The degree parameters are expected average degrees of the resulting graph.
+ */
+namespace GMS::Generators {
+
+using Edge = EdgePair<NodeId, NodeId>;
+using EdgeList = pvector<Edge>;
+
+/**
+ * Writes the edges which edges_of(u, emit) emits for every vertex u into one edge list, in the order of the
+ * vertices. edges_of is called twice per vertex, first to count the edges, and has to emit the same edges both
+ * times, i.e. draw them from a stream keyed by u.
+ */
+template <class EdgesOf>
+EdgeList edges_per_vertex(int64_t num_nodes, const EdgesOf &edges_of) {
+    pvector<int64_t> offsets(num_nodes + 1);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int64_t u = 0; u < num_nodes; u++) {
+        int64_t count = 0;
+        edges_of(u, [&count](NodeId) { count++; });
+        offsets[u] = count;
+    }
+    int64_t total = 0;
+    for (int64_t u = 0; u <= num_nodes; u++) {
+        int64_t count = (u < num_nodes) ? offsets[u] : 0;
+        offsets[u] = total;
+        total += count;
+    }
+
+    EdgeList el(total);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int64_t u = 0; u < num_nodes; u++) {
+        int64_t k = offsets[u];
+        edges_of(u, [&el, &k, u](NodeId v) { el[k++] = Edge(NodeId(u), v); });
+    }
+    return el;
+}
+
+/**
+ * Barabási–Albert preferential attachment, every vertex attaches to m earlier vertices.
+ *
+ * The edges are resolved independently of each other with the algorithm of Sanders and Schulz: the target of
+ * an edge is a uniformly drawn entry of the edge array before it, which is either a source (known from its
+ * position) or again a target, which is resolved in the same way.
+ *
+ * P. Sanders and C. Schulz, "Scalable generation of scale-free graphs", Information Processing Letters 116(7), 2016.
+ * V. Batagelj and U. Brandes, "Efficient generation of large random networks", Physical Review E 71(3), 2005.
+ */
+inline EdgeList barabasi_albert(int64_t num_nodes, int64_t m, uint64_t seed) {
+    const int64_t num_edges = num_nodes * m;
+    EdgeList el(num_edges);
+    #pragma omp parallel for schedule(static)
+    for (int64_t k = 0; k < num_edges; k++) {
+        // entry 2i of the edge array is the source of edge i, entry 2i + 1 its target
+        uint64_t position = 2 * k + 1;
+        while (position % 2 == 1) {
+            Random::CounterRng rng(seed, position / 2);
+            position = rng.bounded(position);
+        }
+        el[k] = Edge(NodeId(k / m), NodeId((position / 2) / m));
+    }
+    return el;
+}
+
+/**
+ * Expected degrees following a power law with the given exponent (> 2) and average, capped at the number of
+ * vertices.
+ */
+inline std::vector<double> power_law_degrees(int64_t num_nodes, double average, double exponent, uint64_t seed) {
+    std::vector<double> degrees(num_nodes);
+    #pragma omp parallel for schedule(static)
+    for (int64_t u = 0; u < num_nodes; u++) {
+        Random::CounterRng rng(seed, u, 1);
+        degrees[u] = std::pow(1 - rng.uniform_01(), -1 / (exponent - 1));
+    }
+    // sequential, the sum is part of the output and must not depend on the number of threads
+    const double scale = average * num_nodes / std::accumulate(degrees.begin(), degrees.end(), 0.0);
+    for (double &d : degrees) {
+        d = std::min(d * scale, double(num_nodes - 1));
+    }
+    return degrees;
+}
+
+/**
+ * The neighbours of order[i] among order[i + 1, end) in the Chung–Lu model: order[j] is adjacent with probability
+ * min(w(order[i]) * w(order[j]) / total, 1). The order has to be sorted by decreasing weight, then the
+ * probabilities are decreasing as well and the non-neighbours are skipped geometrically.
+ *
+ * J. C. Miller and A. Hagberg, "Efficient generation of networks with given expected degrees", WAW 2011.
+ */
+template <class Weight, class Emit>
+void chung_lu_neighbours(const std::vector<NodeId> &order, int64_t i, int64_t end, const Weight &weight,
+                         double total, Random::CounterRng &rng, const Emit &emit) {
+    const double wi = weight(order[i]);
+    int64_t j = i + 1;
+    if (j >= end || total <= 0) {
+        return;
+    }
+    double p = std::min(wi * weight(order[j]) / total, 1.0);
+    while (j < end && p > 0) {
+        if (p < 1) {
+            j += (int64_t) std::floor(std::log(1 - rng.uniform_01()) / std::log(1 - p));
+        }
+        if (j >= end) {
+            break;
+        }
+        const double q = std::min(wi * weight(order[j]) / total, 1.0);
+        if (rng.uniform_01() < q / p) {
+            emit(order[j]);
+        }
+        p = q;
+        j++;
+    }
+}
+
+/// Vertices sorted by decreasing weight, ties by id.
+inline std::vector<NodeId> by_decreasing_weight(const std::vector<double> &weights, NodeId first, NodeId last) {
+    std::vector<NodeId> order(last - first);
+    std::iota(order.begin(), order.end(), first);
+    std::sort(order.begin(), order.end(), [&weights](NodeId a, NodeId b) {
+        return weights[a] > weights[b] || (weights[a] == weights[b] && a < b);
+    });
+    return order;
+}
+
+/// Chung–Lu graph, vertex u has the expected degree degrees[u].
+inline EdgeList chung_lu(const std::vector<double> &degrees, uint64_t seed) {
+    const int64_t num_nodes = degrees.size();
+    const std::vector<NodeId> order = by_decreasing_weight(degrees, 0, num_nodes);
+    std::vector<int64_t> position(num_nodes);
+    for (int64_t i = 0; i < num_nodes; i++) {
+        position[order[i]] = i;
+    }
+    const double total = std::accumulate(degrees.begin(), degrees.end(), 0.0);
+    auto weight = [&degrees](NodeId v) { return degrees[v]; };
+
+    return edges_per_vertex(num_nodes, [&](int64_t u, const auto &emit) {
+        Random::CounterRng rng(seed, u, 2);
+        chung_lu_neighbours(order, position[u], num_nodes, weight, total, rng, emit);
+    });
+}
+
+/**
+ * Sizes of consecutive communities covering all vertices, following a power law with exponent 1.5 between
+ * min_size and max_size. The last community absorbs the remainder.
+ */
+inline std::vector<int64_t> community_sizes(int64_t num_nodes, int64_t min_size, int64_t max_size, uint64_t seed) {
+    Random::CounterRng rng(seed, 0, 3);
+    std::vector<int64_t> sizes;
+    int64_t covered = 0;
+    while (covered < num_nodes) {
+        // inverse transform of the power law truncated to [min_size, max_size]
+        const double a = std::pow(double(min_size), -0.5), b = std::pow(double(max_size), -0.5);
+        int64_t size = (int64_t) std::pow(a - rng.uniform_01() * (a - b), -2.0);
+        size = std::clamp(size, min_size, max_size);
+        if (num_nodes - covered - size < min_size) {
+            size = num_nodes - covered;
+        }
+        sizes.push_back(size);
+        covered += size;
+    }
+    return sizes;
+}
+
+/**
+ * LFR-like community graph: power law degrees with the given exponent, power law community sizes, and a fraction
+ * mu of the edges of each vertex leaving its community.
+ *
+ * Unlike the LFR benchmark, which rewires a configuration model until the mixing is exact, the intra and inter
+ * community edges are Chung–Lu graphs with the expected degrees (1 - mu) * d and mu * d, inside each community and
+ * over the whole graph. The communities are consecutive ranges of vertices.
+ *
+ * A. Lancichinetti, S. Fortunato and F. Radicchi, "Benchmark graphs for testing community detection algorithms",
+ * Physical Review E 78(4), 2008.
+ */
+inline EdgeList lfr(int64_t num_nodes, double average, double exponent, double mu, uint64_t seed) {
+    const std::vector<double> degrees = power_law_degrees(num_nodes, average, exponent, seed);
+    const int64_t min_size = std::min<int64_t>(num_nodes, std::max<int64_t>(8, std::llround(2 * average)));
+    const int64_t max_size = std::min<int64_t>(num_nodes, std::max<int64_t>(min_size, std::llround(20 * average)));
+    const std::vector<int64_t> sizes = community_sizes(num_nodes, min_size, max_size, seed);
+
+    // every vertex with the range of its community and its position in the orders by decreasing degree
+    std::vector<int64_t> begin(sizes.size() + 1, 0);
+    std::partial_sum(sizes.begin(), sizes.end(), begin.begin() + 1);
+    std::vector<int64_t> community(num_nodes);
+    std::vector<NodeId> community_order(num_nodes);
+    std::vector<double> community_total(sizes.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t c = 0; c < sizes.size(); c++) {
+        std::vector<NodeId> order = by_decreasing_weight(degrees, begin[c], begin[c + 1]);
+        std::copy(order.begin(), order.end(), community_order.begin() + begin[c]);
+        community_total[c] = 0;
+        for (int64_t u = begin[c]; u < begin[c + 1]; u++) {
+            community[u] = c;
+            community_total[c] += (1 - mu) * degrees[u];
+        }
+    }
+    const std::vector<NodeId> global_order = by_decreasing_weight(degrees, 0, num_nodes);
+    std::vector<int64_t> community_position(num_nodes), global_position(num_nodes);
+    for (int64_t i = 0; i < num_nodes; i++) {
+        community_position[community_order[i]] = i;
+        global_position[global_order[i]] = i;
+    }
+    const double global_total = mu * std::accumulate(degrees.begin(), degrees.end(), 0.0);
+    auto intra = [&degrees, mu](NodeId v) { return (1 - mu) * degrees[v]; };
+    auto inter = [&degrees, mu](NodeId v) { return mu * degrees[v]; };
+
+    return edges_per_vertex(num_nodes, [&](int64_t u, const auto &emit) {
+        const int64_t c = community[u];
+        Random::CounterRng rng_intra(seed, u, 4);
+        chung_lu_neighbours(community_order, community_position[u], begin[c + 1], intra, community_total[c],
+                            rng_intra, emit);
+        Random::CounterRng rng_inter(seed, u, 5);
+        chung_lu_neighbours(global_order, global_position[u], num_nodes, inter, global_total, rng_inter, emit);
+    });
+}
+
+/// Radius of a random geometric graph in the unit square with the given expected average degree.
+inline double geometric_radius(int64_t num_nodes, double average) {
+    return std::sqrt(average / (M_PI * num_nodes));
+}
+
+/// Position of vertex u of a random geometric graph in the unit square.
+inline std::pair<double, double> geometric_position(int64_t u, uint64_t seed) {
+    Random::CounterRng rng(seed, u, 6);
+    const double x = rng.uniform_01();
+    return {x, rng.uniform_01()};
+}
+
+/**
+ * Random geometric graph: uniformly distributed points in the unit square, adjacent if their distance is less than
+ * the radius for the expected average degree (fewer near the border). The points are bucketed into a grid of
+ * cells of the size of the radius, so only the neighbouring cells are searched.
+ */
+inline EdgeList random_geometric(int64_t num_nodes, double average, uint64_t seed) {
+    const double radius = geometric_radius(num_nodes, average);
+    // at most about one cell per vertex
+    const int64_t cells = std::clamp<int64_t>((int64_t) (1 / radius), 1, (int64_t) std::sqrt(num_nodes) + 1);
+    std::vector<double> x(num_nodes), y(num_nodes);
+    std::vector<int64_t> cell_of(num_nodes);
+    #pragma omp parallel for schedule(static)
+    for (int64_t u = 0; u < num_nodes; u++) {
+        std::tie(x[u], y[u]) = geometric_position(u, seed);
+        cell_of[u] = std::min<int64_t>(x[u] * cells, cells - 1) * cells + std::min<int64_t>(y[u] * cells, cells - 1);
+    }
+    // counting sort of the vertices by cell, keeping the order of the ids
+    std::vector<int64_t> cell_begin(cells * cells + 1, 0);
+    for (int64_t u = 0; u < num_nodes; u++) {
+        cell_begin[cell_of[u] + 1]++;
+    }
+    std::partial_sum(cell_begin.begin(), cell_begin.end(), cell_begin.begin());
+    std::vector<NodeId> by_cell(num_nodes);
+    std::vector<int64_t> fill(cell_begin.begin(), cell_begin.end() - 1);
+    for (int64_t u = 0; u < num_nodes; u++) {
+        by_cell[fill[cell_of[u]]++] = u;
+    }
+
+    const double radius2 = radius * radius;
+    return edges_per_vertex(num_nodes, [&](int64_t u, const auto &emit) {
+        const int64_t cx = cell_of[u] / cells, cy = cell_of[u] % cells;
+        for (int64_t nx = std::max<int64_t>(cx - 1, 0); nx <= std::min(cx + 1, cells - 1); nx++) {
+            for (int64_t ny = std::max<int64_t>(cy - 1, 0); ny <= std::min(cy + 1, cells - 1); ny++) {
+                const int64_t cell = nx * cells + ny;
+                for (int64_t i = cell_begin[cell]; i < cell_begin[cell + 1]; i++) {
+                    const NodeId v = by_cell[i];
+                    const double dx = x[u] - x[v], dy = y[u] - y[v];
+                    if (v > u && dx * dx + dy * dy < radius2) {
+                        emit(v);
+                    }
+                }
+            }
+        }
+    });
+}
+
+/// The vertices of the clique planted by planted_clique(), sorted.
+inline std::vector<NodeId> planted_clique_vertices(int64_t num_nodes, int64_t clique_size, uint64_t seed) {
+    // Floyd's algorithm
+    Random::CounterRng rng(seed, 0, 7);
+    std::unordered_set<NodeId> sample;
+    for (int64_t j = num_nodes - clique_size; j < num_nodes; j++) {
+        NodeId t = rng.bounded(j + 1);
+        if (!sample.insert(t).second) {
+            sample.insert(j);
+        }
+    }
+    std::vector<NodeId> clique(sample.begin(), sample.end());
+    std::sort(clique.begin(), clique.end());
+    return clique;
+}
+
+/**
+ * Uniform random graph G(n, m) with the expected average degree, with a clique on clique_size random vertices.
+ * For benchmarking the clique kernels on an input with a known maximum clique (if clique_size is larger than the
+ * cliques of the random part, about 2 log(n) / log(n / average)).
+ */
+inline EdgeList planted_clique(int64_t num_nodes, double average, int64_t clique_size, uint64_t seed) {
+    const int64_t random_edges = std::llround(num_nodes * average / 2);
+    const std::vector<NodeId> clique = planted_clique_vertices(num_nodes, clique_size, seed);
+    EdgeList el(random_edges + clique_size * (clique_size - 1) / 2);
+    #pragma omp parallel for schedule(static)
+    for (int64_t k = 0; k < random_edges; k++) {
+        Random::CounterRng rng(seed, k, 8);
+        const NodeId u = rng.bounded(num_nodes);
+        el[k] = Edge(u, NodeId(rng.bounded(num_nodes)));
+    }
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int64_t i = 0; i < clique_size; i++) {
+        // the edges to the later members, after the ones of the earlier members
+        int64_t k = random_edges + i * clique_size - i * (i + 1) / 2;
+        for (int64_t j = i + 1; j < clique_size; j++) {
+            el[k++] = Edge(clique[i], clique[j]);
+        }
+    }
+    return el;
+}
+
+/// Expected degrees for chung-lu, one per vertex (separated by whitespace).
+inline std::vector<double> read_degrees(const std::string &file) {
+    std::ifstream in(file);
+    if (!in) {
+        std::cerr << "cannot open the degree sequence " << file << std::endl;
+        std::exit(-31);
+    }
+    std::vector<double> degrees;
+    double d;
+    while (in >> d) {
+        degrees.push_back(d);
+    }
+    return degrees;
+}
+
+/// Parameters of the generators, see the options of --gen in CLI::Parser.
+struct Params {
+    int64_t scale = -1;
+    double average = 16;
+    uint64_t seed = Random::DefaultSeed;
+    // power law exponent of the degrees of chung-lu and lfr
+    double exponent = 2.5;
+    // fraction of the inter-community edges of lfr
+    double mu = 0.2;
+    // size of the clique of planted-clique, 0 for 2 * scale
+    int64_t clique_size = 0;
+    // expected degrees of chung-lu instead of a power law, the number of vertices is their number
+    std::string degrees;
+};
+
+/// The generators of this file, in addition to the uniform and kronecker generators of GAPBS.
+inline const std::vector<std::string> &names() {
+    static const std::vector<std::string> names = {
+        "barabasi-albert", "chung-lu", "lfr", "geometric", "planted-clique"
+    };
+    return names;
+}
+
+inline bool has_generator(const std::string &name) {
+    return std::find(names().begin(), names().end(), name) != names().end();
+}
+
+/// Generates the edge list of the named generator, exits on invalid parameters.
+inline EdgeList generate(const std::string &name, const Params &params) {
+    auto fail = [](const std::string &message) {
+        std::cerr << "invalid generator parameters: " << message << std::endl;
+        std::exit(-31);
+    };
+    if (name == "chung-lu" && !params.degrees.empty()) {
+        return chung_lu(read_degrees(params.degrees), params.seed);
+    }
+    if (params.scale < 0 || params.scale > 30) {
+        fail("the scale has to be in [0, 30]");
+    }
+    const int64_t num_nodes = int64_t(1) << params.scale;
+    if (params.average <= 0 || params.average >= num_nodes) {
+        fail("the average degree has to be in (0, 2^scale)");
+    }
+
+    if (name == "barabasi-albert") {
+        return barabasi_albert(num_nodes, std::max<int64_t>(1, std::llround(params.average / 2)), params.seed);
+    } else if (name == "chung-lu") {
+        if (params.exponent <= 2) {
+            fail("the power law exponent has to be > 2");
+        }
+        return chung_lu(power_law_degrees(num_nodes, params.average, params.exponent, params.seed), params.seed);
+    } else if (name == "lfr") {
+        if (params.exponent <= 2 || params.mu < 0 || params.mu > 1) {
+            fail("the power law exponent has to be > 2 and mu in [0, 1]");
+        }
+        return lfr(num_nodes, params.average, params.exponent, params.mu, params.seed);
+    } else if (name == "geometric") {
+        return random_geometric(num_nodes, params.average, params.seed);
+    } else if (name == "planted-clique") {
+        const int64_t clique_size = (params.clique_size > 0) ? params.clique_size : 2 * std::max<int64_t>(params.scale, 1);
+        if (clique_size > num_nodes) {
+            fail("the clique is larger than the graph");
+        }
+        return planted_clique(num_nodes, params.average, clique_size, params.seed);
+    }
+    fail("unknown generator " + name);
+    return EdgeList();
+}
+
+} // namespace GMS::Generators
+
+#endif // GMS_COMMON_GENERATORS_H_
@@ -0,0 +1,444 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Low-overhead instrumentation of the hot paths: set operations, recursion depths, per-thread busy time and
+ * named phases, without attaching a profiler.
+ *
+ * Everything is recorded through the GMS_INSTR_* macros, which compile to nothing unless GMS_INSTRUMENTATION
+ * is defined (CMake option INSTRUMENTATION), so the instrumented kernels run unchanged in regular builds.
+ *
+ * Every thread counts into its own cache line aligned ThreadData, indexed by omp_get_thread_num(), so the
+ * counters need neither atomics nor locks. Times are taken with rdtsc and converted to seconds with a
+ * frequency calibrated once against std::chrono::steady_clock.
+ *
+ * The benchmark harness (benchmark.h) resets the counters before every kernel run and adds the summary to the
+ * metrics of its report afterwards.
+ *
+ *     GMS_INSTR_REGION();                  // serial, around a parallel region: its wall time
+ *     #pragma omp parallel for
+ *     for (...) {
+ *         GMS_INSTR_BUSY();                // time of this thread doing work, the rest of the region is idle
+ *         GMS_INSTR_PHASE("bk/pivot");     // named, nestable phase timer
+ *         GMS_INSTR_DEPTH();               // recursion depth, at the start of a recursive function
+ *         GMS_INSTR_SET_OP(Intersect, a.cardinality(), b.cardinality());
+ *         GMS_INSTR_EVENT("bk/cliques");   // named event counter
+ *     }
+ */
+
+namespace GMS::Instrumentation {
+
+enum SetOp : int {
+    Intersect,
+    IntersectCount,
+    Union,
+    UnionCount,
+    Difference,
+    Insert,
+    Erase,
+    Contains,
+    NumSetOps
+};
+
+constexpr const char *set_op_names[NumSetOps] = {
+    "intersect", "intersect_count", "union", "union_count", "difference", "insert", "erase", "contains"
+};
+
+constexpr int kMaxThreads = 256;
+constexpr int kMaxDepth = 64;
+constexpr int kSizeBuckets = 32;
+constexpr int kMaxNames = 32;
+
+inline uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/// Frequency of cycles(), measured once.
+inline double cycles_per_second() {
+    static const double frequency = []() {
+        auto start_time = std::chrono::steady_clock::now();
+        uint64_t start = cycles();
+        while (std::chrono::steady_clock::now() - start_time < std::chrono::milliseconds(20)) {
+        }
+        uint64_t end = cycles();
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start_time;
+        return (end - start) / seconds.count();
+    }();
+    return frequency;
+}
+
+struct alignas(64) ThreadData {
+    uint64_t set_ops[NumSetOps];
+    // sum of the cardinalities of both inputs
+    uint64_t set_op_elements[NumSetOps];
+    // histogram of the smaller input
+    uint64_t set_op_sizes[NumSetOps][kSizeBuckets];
+    uint64_t depths[kMaxDepth];
+    int32_t depth;
+    uint64_t busy_cycles;
+    uint64_t phase_cycles[kMaxNames];
+    uint64_t phase_calls[kMaxNames];
+    uint64_t events[kMaxNames];
+};
+
+struct State {
+    ThreadData threads[kMaxThreads];
+    uint64_t region_cycles = 0;
+    std::mutex names_mutex;
+    std::vector<std::string> phase_names;
+    std::vector<std::string> event_names;
+};
+
+inline State &state() {
+    static State s;
+    return s;
+}
+
+inline ThreadData &local() {
+#ifdef _OPENMP
+    return state().threads[std::min(omp_get_thread_num(), kMaxThreads - 1)];
+#else
+    return state().threads[0];
+#endif
+}
+
+inline int register_name(std::vector<std::string> &names, const char *name) {
+    std::lock_guard<std::mutex> lock(state().names_mutex);
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end()) {
+        return it - names.begin();
+    }
+    if ((int) names.size() == kMaxNames) {
+        return kMaxNames - 1;
+    }
+    names.emplace_back(name);
+    return names.size() - 1;
+}
+
+inline int phase_id(const char *name) {
+    return register_name(state().phase_names, name);
+}
+
+inline int event_id(const char *name) {
+    return register_name(state().event_names, name);
+}
+
+/// Clears the counters of all threads, the registered names are kept.
+inline void reset() {
+    State &s = state();
+    for (ThreadData &t : s.threads) {
+        int32_t depth = t.depth;
+        std::memset(&t, 0, sizeof(ThreadData));
+        t.depth = depth;
+    }
+    s.region_cycles = 0;
+}
+
+/// floor(log2(size)), where sizes 0 and 1 share the first bucket.
+inline int size_bucket(uint64_t size) {
+    return size < 2 ? 0 : std::min(kSizeBuckets - 1, 63 - __builtin_clzll(size));
+}
+
+inline void count_set_op(SetOp op, uint64_t size_a, uint64_t size_b) {
+    ThreadData &t = local();
+    t.set_ops[op]++;
+    t.set_op_elements[op] += size_a + size_b;
+    t.set_op_sizes[op][size_bucket(std::min(size_a, size_b))]++;
+}
+
+inline void count_event(int id) {
+    local().events[id]++;
+}
+
+/// Records the depth of a recursive call for its lifetime.
+class DepthScope {
+public:
+    DepthScope() : data_(local()) {
+        data_.depths[std::min(data_.depth, kMaxDepth - 1)]++;
+        data_.depth++;
+    }
+    ~DepthScope() {
+        data_.depth--;
+    }
+private:
+    ThreadData &data_;
+};
+
+/// Adds its lifetime to the busy time of the calling thread.
+class BusyScope {
+public:
+    BusyScope() : data_(local()), start_(cycles()) {}
+    ~BusyScope() {
+        data_.busy_cycles += cycles() - start_;
+    }
+private:
+    ThreadData &data_;
+    uint64_t start_;
+};
+
+/// Adds its lifetime to the time of a phase of the calling thread. Nested phases are included in the outer ones.
+class PhaseScope {
+public:
+    explicit PhaseScope(int id) : data_(local()), id_(id), start_(cycles()) {}
+    ~PhaseScope() {
+        data_.phase_cycles[id_] += cycles() - start_;
+        data_.phase_calls[id_]++;
+    }
+private:
+    ThreadData &data_;
+    int id_;
+    uint64_t start_;
+};
+
+/// Adds its lifetime to the wall time of the parallel regions, the idle time of a thread is this minus its busy time.
+class ParallelRegion {
+public:
+    ParallelRegion() : start_(cycles()) {}
+    ~ParallelRegion() {
+        state().region_cycles += cycles() - start_;
+    }
+private:
+    uint64_t start_;
+};
+
+/**
+ * The counters of all threads, summed up.
+ */
+struct Summary {
+    struct SetOpSummary {
+        const char *name;
+        uint64_t calls = 0;
+        uint64_t elements = 0;
+        uint64_t sizes[kSizeBuckets] = {};
+    };
+    std::vector<SetOpSummary> set_ops;
+    std::vector<uint64_t> depths;
+    // per thread, in seconds
+    std::vector<double> busy;
+    double region_seconds = 0;
+    std::vector<std::pair<std::string, double>> phase_seconds;
+    std::vector<std::pair<std::string, uint64_t>> phase_calls;
+    std::vector<std::pair<std::string, uint64_t>> events;
+
+    int max_depth() const {
+        return depths.empty() ? 0 : (int) depths.size() - 1;
+    }
+
+    double mean_depth() const {
+        uint64_t calls = 0, sum = 0;
+        for (size_t d = 0; d < depths.size(); d++) {
+            calls += depths[d];
+            sum += d * depths[d];
+        }
+        return calls > 0 ? (double) sum / calls : 0;
+    }
+
+    /// Maximum over mean busy time of the threads, 1 if perfectly balanced.
+    double imbalance() const {
+        double max = 0, sum = 0;
+        for (double b : busy) {
+            max = std::max(max, b);
+            sum += b;
+        }
+        return sum > 0 ? max * busy.size() / sum : 0;
+    }
+
+    /// Share of the parallel regions the threads did not spend in busy scopes.
+    double idle_fraction() const {
+        double sum = 0;
+        for (double b : busy) {
+            sum += b;
+        }
+        const double total = region_seconds * busy.size();
+        return total > 0 ? std::max(0.0, 1 - sum / total) : 0;
+    }
+
+    /// The nonzero counters as (name, value), named instr.<counter>.
+    std::vector<std::pair<std::string, double>> metrics() const {
+        std::vector<std::pair<std::string, double>> result;
+        for (const SetOpSummary &o : set_ops) {
+            if (o.calls == 0) {
+                continue;
+            }
+            const std::string prefix = std::string("instr.") + o.name;
+            result.emplace_back(prefix + ".calls", o.calls);
+            result.emplace_back(prefix + ".elements", o.elements);
+            for (int b = 0; b < kSizeBuckets; b++) {
+                if (o.sizes[b] > 0) {
+                    result.emplace_back(prefix + ".size.2^" + std::to_string(b), o.sizes[b]);
+                }
+            }
+        }
+        if (!depths.empty()) {
+            result.emplace_back("instr.depth.max", max_depth());
+            result.emplace_back("instr.depth.mean", mean_depth());
+            for (size_t d = 0; d < depths.size(); d++) {
+                if (depths[d] > 0) {
+                    result.emplace_back("instr.depth." + std::to_string(d), depths[d]);
+                }
+            }
+        }
+        if (!busy.empty()) {
+            result.emplace_back("instr.region.seconds", region_seconds);
+            result.emplace_back("instr.busy.max", *std::max_element(busy.begin(), busy.end()));
+            result.emplace_back("instr.imbalance", imbalance());
+            result.emplace_back("instr.idle_fraction", idle_fraction());
+        }
+        for (size_t i = 0; i < phase_seconds.size(); i++) {
+            result.emplace_back("instr.phase." + phase_seconds[i].first + ".seconds", phase_seconds[i].second);
+            result.emplace_back("instr.phase." + phase_calls[i].first + ".calls", phase_calls[i].second);
+        }
+        for (const auto &[name, count] : events) {
+            result.emplace_back("instr.event." + name, count);
+        }
+        return result;
+    }
+
+    void print(std::ostream &out) const {
+        for (const SetOpSummary &o : set_ops) {
+            if (o.calls > 0) {
+                out << "Set Op " << o.name << ": " << o.calls << " calls, "
+                    << (double) o.elements / o.calls << " elements/call" << std::endl;
+            }
+        }
+        if (!depths.empty()) {
+            out << "Recursion Depth: max " << max_depth() << ", mean " << mean_depth() << std::endl;
+        }
+        if (!busy.empty()) {
+            out << "Parallel Regions: " << region_seconds << " s, imbalance " << imbalance()
+                << ", idle " << 100 * idle_fraction() << "%" << std::endl;
+        }
+        for (const auto &[name, seconds] : phase_seconds) {
+            out << "Phase " << name << ": " << seconds << " s (summed over threads)" << std::endl;
+        }
+        for (const auto &[name, count] : events) {
+            out << "Event " << name << ": " << count << std::endl;
+        }
+    }
+};
+
+inline Summary collect() {
+    State &s = state();
+    const double frequency = cycles_per_second();
+#ifdef _OPENMP
+    const int num_threads = std::min(omp_get_max_threads(), kMaxThreads);
+#else
+    const int num_threads = 1;
+#endif
+    Summary summary;
+    for (int op = 0; op < NumSetOps; op++) {
+        Summary::SetOpSummary o;
+        o.name = set_op_names[op];
+        for (const ThreadData &t : s.threads) {
+            o.calls += t.set_ops[op];
+            o.elements += t.set_op_elements[op];
+            for (int b = 0; b < kSizeBuckets; b++) {
+                o.sizes[b] += t.set_op_sizes[op][b];
+            }
+        }
+        summary.set_ops.push_back(o);
+    }
+    for (int d = kMaxDepth - 1; d >= 0; d--) {
+        uint64_t calls = 0;
+        for (const ThreadData &t : s.threads) {
+            calls += t.depths[d];
+        }
+        if (calls > 0 && summary.depths.empty()) {
+            summary.depths.resize(d + 1);
+        }
+        if (!summary.depths.empty()) {
+            summary.depths[d] = calls;
+        }
+    }
+    if (s.region_cycles > 0) {
+        for (int i = 0; i < num_threads; i++) {
+            summary.busy.push_back(s.threads[i].busy_cycles / frequency);
+        }
+        summary.region_seconds = s.region_cycles / frequency;
+    }
+    std::lock_guard<std::mutex> lock(s.names_mutex);
+    for (size_t id = 0; id < s.phase_names.size(); id++) {
+        uint64_t cycles = 0, calls = 0;
+        for (const ThreadData &t : s.threads) {
+            cycles += t.phase_cycles[id];
+            calls += t.phase_calls[id];
+        }
+        if (calls > 0) {
+            summary.phase_seconds.emplace_back(s.phase_names[id], cycles / frequency);
+            summary.phase_calls.emplace_back(s.phase_names[id], calls);
+        }
+    }
+    for (size_t id = 0; id < s.event_names.size(); id++) {
+        uint64_t count = 0;
+        for (const ThreadData &t : s.threads) {
+            count += t.events[id];
+        }
+        if (count > 0) {
+            summary.events.emplace_back(s.event_names[id], count);
+        }
+    }
+    return summary;
+}
+
+/**
+ * Adds the counters since the last reset to the metrics of a report (see BenchmarkReport::add_metric) and
+ * prints them.
+ */
+template <class Report>
+void report_to(Report &report) {
+    Summary summary = collect();
+    for (const auto &[name, value] : summary.metrics()) {
+        report.add_metric(name, value);
+    }
+    summary.print(std::cout);
+}
+
+} // namespace GMS::Instrumentation
+
+#define GMS_INSTR_CONCAT_(a, b) a##b
+#define GMS_INSTR_CONCAT(a, b) GMS_INSTR_CONCAT_(a, b)
+
+#ifdef GMS_INSTRUMENTATION
+#define GMS_INSTR_SET_OP(op, size_a, size_b) \
+    ::GMS::Instrumentation::count_set_op(::GMS::Instrumentation::op, (size_a), (size_b))
+#define GMS_INSTR_DEPTH() \
+    ::GMS::Instrumentation::DepthScope GMS_INSTR_CONCAT(gms_instr_depth_, __LINE__)
+#define GMS_INSTR_BUSY() \
+    ::GMS::Instrumentation::BusyScope GMS_INSTR_CONCAT(gms_instr_busy_, __LINE__)
+#define GMS_INSTR_REGION() \
+    ::GMS::Instrumentation::ParallelRegion GMS_INSTR_CONCAT(gms_instr_region_, __LINE__)
+#define GMS_INSTR_PHASE(name) \
+    static const int GMS_INSTR_CONCAT(gms_instr_phase_id_, __LINE__) = ::GMS::Instrumentation::phase_id(name); \
+    ::GMS::Instrumentation::PhaseScope GMS_INSTR_CONCAT(gms_instr_phase_, __LINE__)(GMS_INSTR_CONCAT(gms_instr_phase_id_, __LINE__))
+#define GMS_INSTR_EVENT(name) \
+    do { \
+        static const int gms_instr_event_id = ::GMS::Instrumentation::event_id(name); \
+        ::GMS::Instrumentation::count_event(gms_instr_event_id); \
+    } while (0)
+#else
+#define GMS_INSTR_SET_OP(op, size_a, size_b) ((void) 0)
+#define GMS_INSTR_DEPTH() ((void) 0)
+#define GMS_INSTR_BUSY() ((void) 0)
+#define GMS_INSTR_REGION() ((void) 0)
+#define GMS_INSTR_PHASE(name) ((void) 0)
+#define GMS_INSTR_EVENT(name) ((void) 0)
+#endif
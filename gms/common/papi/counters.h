@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(NOPAPIW) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "papiw.h"
+
+namespace PAPIW
+{
+    /**
+     * Named groups of events, which can be given instead of the single events, e.g. --counters=cache,TOT_INS.
+     */
+    inline const std::vector<std::pair<std::string, std::vector<std::string>>> &counter_presets()
+    {
+        static const std::vector<std::pair<std::string, std::vector<std::string>>> presets = {
+            {"cache", {"L1_DCM", "L2_TCM", "L3_TCM", "TLB_DM"}},
+            {"branch", {"BR_INS", "BR_MSP"}},
+            {"stall", {"TOT_CYC", "RES_STL", "STL_ICY"}},
+            {"ipc", {"TOT_INS", "TOT_CYC"}},
+        };
+        return presets;
+    }
+
+    /**
+     * Splits a comma separated list of PAPI preset events (with or without the PAPI_ prefix) and presets into
+     * the event names without prefix, in the given order and without duplicates.
+     */
+    inline std::vector<std::string> parse_counters(const std::string &spec)
+    {
+        std::vector<std::string> names;
+        auto add = [&names](const std::string &name) {
+            if (std::find(names.begin(), names.end(), name) == names.end())
+                names.push_back(name);
+        };
+
+        std::istringstream in(spec);
+        std::string token;
+        while (std::getline(in, token, ','))
+        {
+            if (token.empty())
+                continue;
+            auto preset = std::find_if(counter_presets().begin(), counter_presets().end(),
+                                       [&token](const auto &p) { return p.first == token; });
+            if (preset != counter_presets().end())
+            {
+                for (const std::string &name : preset->second)
+                    add(name);
+            }
+            else
+            {
+                add(token.rfind("PAPI_", 0) == 0 ? token.substr(5) : token);
+            }
+        }
+        return names;
+    }
+
+    /**
+     * Hardware counters of the kernel stage of a benchmark, selected with --counters.
+     *
+     * The events are counted on every thread of the OpenMP team, summed up between start() and stop(). They are
+     * read with PAPIW in parallel mode if the benchmark is linked with PAPI. Otherwise the PAPI preset names are
+     * mapped to the generic events of perf_event_open (Linux), which has no equivalent for some of them, e.g.
+     * L2_TCM, and which additionally provides the software events PAGE_FAULTS, CTX_SWITCHES and CPU_MIGRATIONS.
+     * Events which are not available are skipped with a warning.
+     *
+     * start() and stop() are called outside of parallel regions, an empty CounterSet does nothing.
+     */
+    class CounterSet
+    {
+    public:
+        CounterSet() = default;
+        CounterSet(const CounterSet &) = delete;
+        CounterSet &operator=(const CounterSet &) = delete;
+
+        explicit CounterSet(const std::string &spec)
+        {
+            std::vector<std::string> requested = parse_counters(spec);
+            if (requested.empty())
+                return;
+#if !defined(NOPAPIW)
+            int retval = PAPI_library_init(PAPI_VER_CURRENT);
+            if (retval != PAPI_VER_CURRENT && retval != PAPI_OK)
+            {
+                std::cerr << "PAPIW WARNING: PAPI library init error, no counters" << std::endl;
+                return;
+            }
+            for (const std::string &name : requested)
+            {
+                int code;
+                std::string papi_name = "PAPI_" + name;
+                if (PAPI_event_name_to_code(papi_name.c_str(), &code) != PAPI_OK || PAPI_query_event(code) != PAPI_OK)
+                {
+                    std::cerr << "PAPIW WARNING: counter " << name << " is not available" << std::endl;
+                    continue;
+                }
+                names_.push_back(name);
+                codes_.push_back(code);
+            }
+            if (!codes_.empty())
+                INIT_PARALLEL(codes_);
+#elif defined(__linux__)
+            open_perf_events(requested);
+#else
+            std::cerr << "PAPIW WARNING: neither PAPI nor perf_event_open is available, no counters" << std::endl;
+#endif
+            values_.assign(names_.size(), 0);
+        }
+
+        ~CounterSet()
+        {
+#if defined(NOPAPIW) && defined(__linux__)
+            for (const std::vector<int> &fds : thread_fds_)
+            {
+                for (int fd : fds)
+                    close(fd);
+            }
+#endif
+        }
+
+        bool empty() const
+        {
+            return names_.empty();
+        }
+
+        /// The events which are counted, without the PAPI_ prefix.
+        const std::vector<std::string> &names() const
+        {
+            return names_;
+        }
+
+        /// The values of the last start() and stop(), in the order of names().
+        const std::vector<long long> &values() const
+        {
+            return values_;
+        }
+
+        void start()
+        {
+            if (empty())
+                return;
+#if !defined(NOPAPIW)
+            RESET();
+            START();
+#elif defined(__linux__)
+            for (const std::vector<int> &fds : thread_fds_)
+            {
+                for (int fd : fds)
+                {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        void stop()
+        {
+            if (empty())
+                return;
+#if !defined(NOPAPIW)
+            STOP();
+            for (size_t i = 0; i < codes_.size(); i++)
+                values_[i] = GET_RESULT(codes_[i]);
+#elif defined(__linux__)
+            std::fill(values_.begin(), values_.end(), 0);
+            for (const std::vector<int> &fds : thread_fds_)
+            {
+                for (size_t i = 0; i < fds.size(); i++)
+                {
+                    ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                    values_[i] += read_perf_event(fds[i]);
+                }
+            }
+#endif
+        }
+
+        /**
+         * Adds the values of the last start() and stop() to the metrics of a report (see
+         * BenchmarkReport::add_metric) as counter.<event> and prints them.
+         */
+        template <class Report>
+        void report_to(Report &report) const
+        {
+            for (size_t i = 0; i < names_.size(); i++)
+            {
+                report.add_metric("counter." + names_[i], values_[i]);
+                std::cout << "Counter " << names_[i] << ": " << values_[i] << std::endl;
+            }
+        }
+
+    private:
+        std::vector<std::string> names_;
+        std::vector<long long> values_;
+#if !defined(NOPAPIW)
+        std::vector<int> codes_;
+#elif defined(__linux__)
+        // the events of every thread of the team, in the order of names_
+        std::vector<std::vector<int>> thread_fds_;
+
+        static bool perf_event_of(const std::string &name, uint32_t &type, uint64_t &config)
+        {
+            auto cache = [](uint64_t id, uint64_t result) {
+                return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+            };
+            static const std::vector<std::pair<std::string, std::pair<uint32_t, uint64_t>>> events = {
+                {"TOT_CYC", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}},
+                {"REF_CYC", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES}},
+                {"TOT_INS", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS}},
+                {"BR_INS", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS}},
+                {"BR_MSP", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}},
+                {"RES_STL", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND}},
+                {"STL_ICY", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND}},
+                {"L3_TCA", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES}},
+                {"L3_TCM", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}},
+                {"L1_DCA", {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS)}},
+                {"L1_DCM", {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+                {"L1_ICM", {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1I, PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+                {"TLB_DM", {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+                {"TLB_IM", {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_ITLB, PERF_COUNT_HW_CACHE_RESULT_MISS)}},
+                // software events, which are available without a PMU, e.g. in virtual machines
+                {"PAGE_FAULTS", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}},
+                {"CTX_SWITCHES", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}},
+                {"CPU_MIGRATIONS", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS}},
+            };
+            for (const auto &[n, event] : events)
+            {
+                if (n == name)
+                {
+                    type = event.first;
+                    config = event.second;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // an event of the calling thread, -1 on failure
+        static int open_perf_event(uint32_t type, uint64_t config)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+
+        // the value, scaled up if the event was multiplexed with others
+        static long long read_perf_event(int fd)
+        {
+            uint64_t data[3] = {0, 0, 0};
+            if (read(fd, data, sizeof(data)) != sizeof(data) || data[2] == 0)
+                return 0;
+            return (long long) ((double) data[0] * data[1] / data[2]);
+        }
+
+        void open_perf_events(const std::vector<std::string> &requested)
+        {
+            std::vector<std::pair<uint32_t, uint64_t>> events;
+            for (const std::string &name : requested)
+            {
+                uint32_t type;
+                uint64_t config;
+                if (!perf_event_of(name, type, config))
+                {
+                    std::cerr << "PAPIW WARNING: counter " << name << " is not available through perf_event_open"
+                              << std::endl;
+                    continue;
+                }
+                // probe on this thread first, the counters of the other threads are opened below
+                int fd = open_perf_event(type, config);
+                if (fd < 0)
+                {
+                    std::cerr << "PAPIW WARNING: counter " << name << " is not available: " << std::strerror(errno)
+                              << std::endl;
+                    continue;
+                }
+                close(fd);
+                names_.push_back(name);
+                events.emplace_back(type, config);
+            }
+            if (events.empty())
+                return;
+
+#ifdef _OPENMP
+            thread_fds_.resize(omp_get_max_threads());
+#pragma omp parallel
+            {
+                std::vector<int> &fds = thread_fds_[omp_get_thread_num()];
+#else
+            thread_fds_.resize(1);
+            {
+                std::vector<int> &fds = thread_fds_[0];
+#endif
+                for (const auto &[type, config] : events)
+                {
+                    int fd = open_perf_event(type, config);
+                    if (fd < 0)
+                    {
+                        // keeps the order of the events, this thread just isn't counted
+                        for (int opened : fds)
+                            close(opened);
+                        fds.clear();
+                        break;
+                    }
+                    fds.push_back(fd);
+                }
+            }
+        }
+#endif
+    };
+} // namespace PAPIW
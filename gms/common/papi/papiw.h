@@ -1,6 +1,7 @@
 #ifndef PAPIW
 #define PAPIW
 
+#include <vector>
 #include "./papiw_util.h"
 
 #pragma GCC diagnostic push
@@ -77,6 +78,27 @@ namespace PAPIW
 #endif
         }
 
+        /**
+     * Initialize Papi wrapper module for parallel use with events chosen at runtime
+     *
+     * @param eventcodes a list of PAPI eventcodes
+     * @warning Exits with an error if called in a parallel region
+     */
+        inline void INIT_PARALLEL(const std::vector<int> &eventcodes)
+        {
+#if !defined(NOPAPIW)
+                delete papiwrapper;
+#if defined(_OPENMP)
+                papiwrapper = static_cast<PapiWrapper *>(new PapiWrapperParallel());
+#else
+                papiwrapper = static_cast<PapiWrapper *>(new PapiWrapperSingle());
+#endif
+                papiwrapper->InitEvents(eventcodes);
+#else
+                sink{eventcodes};
+#endif
+        }
+
         /* Start the counters */
         void START()
         {
@@ -116,6 +138,21 @@ namespace PAPIW
 #endif
         }
 
+        /**
+     * The value of an initialized PAPI Event, 0 if PAPIW is not used
+     *
+     * @warning Exits with an error if the counters are running while calling GET_RESULT
+     */
+        long long GET_RESULT(const int eventCode)
+        {
+#if !defined(NOPAPIW)
+                return papiwrapper->GetResult(eventCode);
+#else
+                sink{eventCode};
+                return 0;
+#endif
+        }
+
         /**
      * Print the values for all initialized PAPI Events
      *
@@ -38,19 +38,29 @@ public:
     template <typename... PapiCodes>
     void Init(PapiCodes const... eventcodes)
     {
-        /* Initialize the PAPI library */
+        static_assert(std::conjunction<std::is_integral<PapiCodes>...>(),
+                      "All parameters to Init must be of integral type");
+        InitEvents({static_cast<int>(eventcodes)...});
+    }
+
+    /**
+     * Same as Init, with the events chosen at runtime
+     *
+     * @param eventcodes a list of PAPI eventcodes
+     * @warning Exits with an error if called in a parallel region
+     */
+    void InitEvents(const std::vector<int> &eventcodes)
+    {
+        /* Initialize the PAPI library, it might have been initialized already to look up the events */
         retval = PAPI_library_init(PAPI_VER_CURRENT);
-        if (retval != PAPI_VER_CURRENT)
+        if (retval != PAPI_VER_CURRENT && !PAPI_is_initialized())
             handle_error("Init", "PAPI library init error!\n", retval);
 
         /* Some more initialization inside the specialization classes*/
         localInit();
 
         /* Prepare Events */
-        static_assert(std::conjunction<std::is_integral<PapiCodes>...>(),
-                      "All parameters to Init must be of integral type");
-        int args[]{eventcodes...}; //unpack
-        for (auto eventcode : args)
+        for (auto eventcode : eventcodes)
             AddEvent(eventcode);
     }
 
@@ -2,6 +2,7 @@
 #ifndef GMS_PIPELINE_H
 #define GMS_PIPELINE_H
 
+#include <functional>
 #include <tuple>
 #include <vector>
 #include <string>
@@ -11,6 +12,11 @@
 #include <gms/third_party/gapbs/command_line.h>
 
 #include "printer.h"
+#include "benchmark_report.h"
+#include "instrumentation.h"
+#include "papi/counters.h"
+#include "cli/args.h"
+#include "cli/compat.h"
 
 
 namespace GMS {
@@ -21,6 +27,10 @@ namespace GMS {
  * The output of the functions are chained. Functions must return a tuple (an empty tuple if no output) that
  * will be used as input for the next function in the chain. Each function-execution is timed and reported at the end
  * by the printer. Outputs of the functions are not reported.
+ *
+ * The timings are also collected in a BenchmarkReport, under the names given with SetStageNames, which
+ * provides the warmup runs, the summary and the JSON/CSV records of the other benchmarks (see benchmark.h).
+ * The stage named "kernel" is also measured with the hardware counters selected with --counters.
  * 
  * If your time measurements are extremely sensitive or your memory requirements are very tight, it might be better
  * to use a custom benchmarking function.
@@ -37,15 +47,35 @@ private:
     struct PipeIt
     {
         template<typename Functions>
-        static void Pipe(Pipeline *pl, Functions functions)
+        static void Pipe(Pipeline *pl, Functions functions, BenchmarkReport &report, PAPIW::CounterSet &counters)
         {
             auto func = std::get<I>(functions);
+            const bool kernel = pl->StageName(I) == "kernel";
+#ifdef GMS_INSTRUMENTATION
+            Instrumentation::reset();
+#endif
+            if (kernel)
+            {
+                counters.start();
+            }
             pl->LocalTimer.Start();
             (pl->*func)();
             //decltype(auto) result = std::apply(func, params);
             pl->LocalTimer.Stop();
             pl->LocalPrinter << pl->LocalTimer.Seconds();
-            PipeIt<N-1,I+1,Pipeline>::Pipe(pl, functions);
+            report.add_time(pl->StageName(I), pl->LocalTimer.Seconds());
+            if (kernel)
+            {
+                counters.stop();
+                if (!report.warmup())
+                {
+                    counters.report_to(report);
+#ifdef GMS_INSTRUMENTATION
+                    Instrumentation::report_to(report);
+#endif
+                }
+            }
+            PipeIt<N-1,I+1,Pipeline>::Pipe(pl, functions, report, counters);
         }
 
         // static void Pipe(Pipeline_t& pl)
@@ -63,7 +93,7 @@ private:
     struct PipeIt<0, I, Pipeline>
     {
         template<typename Functions>
-        static void Pipe(Pipeline *pl, Functions functions)
+        static void Pipe(Pipeline *pl, Functions functions, BenchmarkReport &report, PAPIW::CounterSet &counters)
         {}
 
         // static void Pipe(Pipeline_t  &pl)
@@ -82,6 +112,48 @@ private:
     void BufferInfo()
     {}
 
+    std::vector<std::string> _stageNames;
+    std::function<void(BenchmarkReport&)> _describeGraph;
+
+    static ReportSpec ReportSpecOf(const CLApp &cli)
+    {
+        auto compat = dynamic_cast<const CLI::GapbsCompat*>(&cli);
+        return compat ? compat->report_spec : ReportSpec();
+    }
+
+    template<typename DerivedType, typename...Functions>
+    void RunTrials(const ReportSpec &spec, int64_t numTrials, Functions...functions)
+    {
+        BenchmarkReport report(spec, _printInfos);
+        PAPIW::CounterSet counters(spec.counters);
+        if (_describeGraph)
+        {
+            _describeGraph(report);
+        }
+        std::tuple<Functions...> tfuncs(functions...);
+        for(int64_t i = 0; i < spec.warmup_trials + numTrials; i++)
+        {
+            report.begin_trial();
+            DerivedType *derived = static_cast<DerivedType*>(this);
+            PipeIt<std::tuple_size<std::tuple<Functions...>>::value, 0, DerivedType>::Pipe(derived, tfuncs, report, counters);
+            if (report.warmup())
+            {
+                std::ostringstream discard;
+                discard << LocalPrinter;
+            }
+            else
+            {
+                for( std::string info : _printInfos)
+                {
+                    LocalPrinter << info;
+                }
+                std::cout << LocalPrinter << std::endl;
+            }
+            report.end_trial();
+        }
+        report.finish();
+    }
+
 public:
     /**
      * @brief Simple timer instance. Relies on std::high_resolution_clock.
@@ -129,36 +201,40 @@ public:
         BufferInfo(printInfos...);
     }
 
+    /**
+     * @brief Names of the functions passed to Run, in order, for the report. Unnamed functions are
+     * called "stage<i>". Name the kernel "kernel" to get its statistics printed.
+     */
+    template<typename...Names>
+    void SetStageNames(Names...names)
+    {
+        _stageNames = {names...};
+    }
+
+    std::string StageName(unsigned int i) const
+    {
+        return i < _stageNames.size() ? _stageNames[i] : "stage" + std::to_string(i + 1);
+    }
+
+    /**
+     * @brief The input graph, which is fingerprinted for the records. Must outlive the calls to Run.
+     */
+    template<typename Graph>
+    void SetInputGraph(const Graph &g)
+    {
+        _describeGraph = [&g](BenchmarkReport &report) { report.set_graph(g); };
+    }
+
     template<typename DerivedType, typename...Functions>
     void Run(BenchCLApp &cli, Functions...functions)
     {
-        std::tuple<Functions...> tfuncs(functions...);
-        for(int i = 0; i < cli.num_trials(); i++)
-        {
-            DerivedType *derived = static_cast<DerivedType*>(this);
-            PipeIt<std::tuple_size<std::tuple<Functions...>>::value, 0, DerivedType>::Pipe(derived, tfuncs);
-            for( std::string info : _printInfos)
-            {
-                LocalPrinter << info;
-            }
-            std::cout << LocalPrinter << std::endl;
-        }
+        RunTrials<DerivedType>(ReportSpecOf(cli), cli.num_trials(), functions...);
     }
 
     template<typename DerivedType, typename...Functions>
     void Run(const CLI::Args &args, Functions...functions)
     {
-        std::tuple<Functions...> tfuncs(functions...);
-        for(int i = 0; i < args.num_trials; i++)
-        {
-            DerivedType *derived = static_cast<DerivedType*>(this);
-            PipeIt<std::tuple_size<std::tuple<Functions...>>::value, 0, DerivedType>::Pipe(derived, tfuncs);
-            for( std::string info : _printInfos)
-            {
-                LocalPrinter << info;
-            }
-            std::cout << LocalPrinter << std::endl;
-        }
+        RunTrials<DerivedType>(args.report, args.num_trials, functions...);
     }
 };
 
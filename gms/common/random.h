@@ -0,0 +1,101 @@
+#pragma once
+#ifndef GMS_COMMON_RANDOM_H_
+#define GMS_COMMON_RANDOM_H_
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace GMS::Random {
+
+/// Seed used by the randomized kernels unless another one is given explicitly.
+constexpr uint64_t DefaultSeed = UINT64_C(0x2545F4914F6CDD1D);
+
+/**
+ * SplitMix64 finalizer, a bijective 64-bit mixing function.
+ *
+ * Steele Jr, Guy L., Doug Lea, and Christine H. Flood. "Fast splittable pseudorandom number generators."
+ * ACM SIGPLAN Notices 49.10 (2014): 453-472.
+ */
+inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+/**
+ * Unbiased sample from [0, range) with Lemire's nearly divisionless method.
+ *
+ * D. Lemire, "Fast Random Integer Generation in an Interval", ACM TOMACS 29(1), 2019.
+ *
+ * @tparam Rng STL compatible RNG producing uniform 64-bit words
+ * @param range must be > 0
+ */
+template <class Rng>
+inline uint64_t bounded(Rng &rng, uint64_t range) {
+    static_assert(std::is_same_v<typename Rng::result_type, uint64_t>, "bounded() requires a 64-bit generator");
+    __uint128_t m = (__uint128_t) rng() * range;
+    uint64_t low = (uint64_t) m;
+    if (low < range) {
+        // only here the (rare) division is required to determine the rejection threshold
+        const uint64_t threshold = -range % range;
+        while (low < threshold) {
+            m = (__uint128_t) rng() * range;
+            low = (uint64_t) m;
+        }
+    }
+    return (uint64_t) (m >> 64);
+}
+
+/**
+ * Counter-based random number generator.
+ *
+ * Each (seed, key, round) triple selects an independent SplitMix64 stream. Kernels key the stream by the entity that
+ * consumes the randomness (usually a vertex id) and by the current round. The drawn numbers are thus a pure function
+ * of the input and do not depend on the number of threads or on the schedule.
+ *
+ * Satisfies the UniformRandomBitGenerator requirements, so it can be used with std::shuffle etc.
+ */
+class CounterRng {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit CounterRng(uint64_t seed, uint64_t key = 0, uint64_t round = 0) {
+        state = mix64(mix64(seed + Gamma * (key + 1)) ^ (round * UINT64_C(0xD1B54A32D192ED03)));
+    }
+
+    result_type operator()() {
+        state += Gamma;
+        return mix64(state);
+    }
+
+    /// Uniform integer in [0, range), range must be > 0.
+    uint64_t bounded(uint64_t range) {
+        return Random::bounded(*this, range);
+    }
+
+    /// Uniform integer in [lo, hi] (both inclusive).
+    int64_t uniform_int(int64_t lo, int64_t hi) {
+        return lo + (int64_t) bounded((uint64_t) (hi - lo) + 1);
+    }
+
+    /// Uniform double in [0, 1).
+    double uniform_01() {
+        return (double) ((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    /// True with probability p.
+    bool bernoulli(double p) {
+        return uniform_01() < p;
+    }
+
+private:
+    static constexpr uint64_t Gamma = UINT64_C(0x9E3779B97F4A7C15);
+    uint64_t state;
+};
+
+} // namespace GMS::Random
+
+#endif // GMS_COMMON_RANDOM_H_
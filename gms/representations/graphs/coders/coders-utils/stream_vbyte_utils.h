@@ -0,0 +1,149 @@
+#ifndef PROJECT_STREAM_VBYTE_UTILS_H
+#define PROJECT_STREAM_VBYTE_UTILS_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSSE3__)
+    #include <immintrin.h>
+#endif
+
+/*
+ * Stream VByte (Lemire, Kurz, Rupp): 32-bit integers are stored with 1 to 4 bytes each, but the lengths are not
+ * interleaved with the data as in varint. Instead, one control byte holds the 2-bit length codes of four integers
+ * and the control bytes form a separate stream. A group of four integers is decoded with one byte shuffle, the
+ * shuffle mask is looked up by the control byte.
+ *
+ * Decoding reads 16 bytes at a time from the data stream, so the buffer has to be padded by
+ * SVB_DATA_PADDING bytes after the last data byte.
+ */
+
+#define SVB_GROUP 4
+#define SVB_DATA_PADDING 16
+
+inline int svbLength(uint32_t x) {
+    return x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4;
+}
+
+inline uint32_t svbZigzag(int32_t x) {
+    return (uint32_t(x) << 1) ^ uint32_t(x >> 31);
+}
+
+inline int32_t svbUnzigzag(uint32_t x) {
+    return int32_t(x >> 1) ^ -int32_t(x & 1);
+}
+
+/* Number of control bytes for 'count' integers */
+inline uint64_t svbControlSize(uint64_t count) {
+    return (count + SVB_GROUP - 1) / SVB_GROUP;
+}
+
+/* Number of data bytes for the integers in [in, in + count) */
+inline uint64_t svbDataSize(const uint32_t* in, uint64_t count) {
+    uint64_t size = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        size += svbLength(in[i]);
+    }
+    return size;
+}
+
+/* Encodes 'count' integers, returns the number of data bytes written */
+inline uint64_t svbEncode(const uint32_t* in, uint64_t count, unsigned char* control, unsigned char* data) {
+    unsigned char* start = data;
+    std::memset(control, 0, svbControlSize(count));
+    for (uint64_t i = 0; i < count; i++) {
+        int length = svbLength(in[i]);
+        control[i / SVB_GROUP] |= (length - 1) << (2 * (i % SVB_GROUP));
+        uint32_t x = in[i];
+        std::memcpy(data, &x, length); // little endian
+        data += length;
+    }
+    return data - start;
+}
+
+struct SvbTables {
+    // data bytes of the four integers of a control byte
+    std::array<uint8_t, 256> length;
+    // byte shuffle which moves the data bytes into four 32-bit lanes, -1 zeroes a byte
+    std::array<std::array<int8_t, 16>, 256> shuffle;
+
+    SvbTables() : length(), shuffle() {
+        for (int c = 0; c < 256; c++) {
+            int byte = 0;
+            for (int lane = 0; lane < SVB_GROUP; lane++) {
+                int bytes = ((c >> (2 * lane)) & 3) + 1;
+                for (int b = 0; b < 4; b++) {
+                    shuffle[c][4 * lane + b] = b < bytes ? byte + b : -1;
+                }
+                byte += bytes;
+            }
+            length[c] = byte;
+        }
+    }
+
+    static const SvbTables& get() {
+        static const SvbTables tables;
+        return tables;
+    }
+};
+
+/* Decodes one group of four integers without SIMD, returns the number of data bytes read */
+inline int svbDecodeGroupScalar(unsigned char control, const unsigned char* data, uint32_t* out) {
+    int read = 0;
+    for (int lane = 0; lane < SVB_GROUP; lane++) {
+        int length = ((control >> (2 * lane)) & 3) + 1;
+        uint32_t x = 0;
+        std::memcpy(&x, data + read, length);
+        out[lane] = x;
+        read += length;
+    }
+    return read;
+}
+
+/*
+ * Decodes 'count' integers and adds them up, starting from 'prev': out[i] = prev + in[0] + ... + in[i].
+ * This is the inverse of gap encoding a sorted sequence. Returns the position after the last data byte read.
+ */
+inline const unsigned char* svbDecodeDelta(const unsigned char* control, const unsigned char* data, uint64_t count,
+                                           uint32_t prev, uint32_t* out) {
+    const uint64_t groups = count / SVB_GROUP;
+    uint64_t g = 0;
+#if defined(__SSSE3__)
+    const SvbTables& tables = SvbTables::get();
+    __m128i previous = _mm_set1_epi32(prev);
+    for (; g < groups; g++) {
+        const unsigned char c = control[g];
+        __m128i values = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data),
+                                          _mm_loadu_si128((const __m128i*) tables.shuffle[c].data()));
+        // inclusive prefix sum of the four lanes
+        values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+        values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+        values = _mm_add_epi32(values, previous);
+        _mm_storeu_si128((__m128i*) (out + SVB_GROUP * g), values);
+        previous = _mm_shuffle_epi32(values, 0xFF);
+        data += tables.length[c];
+    }
+    prev = _mm_cvtsi128_si32(previous);
+#else
+    for (; g < groups; g++) {
+        uint32_t* group = out + SVB_GROUP * g;
+        data += svbDecodeGroupScalar(control[g], data, group);
+        for (int lane = 0; lane < SVB_GROUP; lane++) {
+            prev += group[lane];
+            group[lane] = prev;
+        }
+    }
+#endif
+    // the last, partial group
+    for (uint64_t i = SVB_GROUP * groups; i < count; i++) {
+        int length = ((control[g] >> (2 * (i % SVB_GROUP))) & 3) + 1;
+        uint32_t x = 0;
+        std::memcpy(&x, data, length);
+        data += length;
+        prev += x;
+        out[i] = prev;
+    }
+    return data;
+}
+
+#endif //PROJECT_STREAM_VBYTE_UTILS_H
@@ -0,0 +1,419 @@
+#ifndef GRAPHSETS_COMPRESSED_STREAM_VBYTE_H
+#define GRAPHSETS_COMPRESSED_STREAM_VBYTE_H
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "coders-utils/stream_vbyte_utils.h"
+#include <gms/representations/graphs/prefetch.h>
+
+/*
+ * Graph whose sorted neighbourhoods are gap encoded with Stream VByte (see stream_vbyte_utils.h).
+ *
+ * The neighbourhood of vertex v with degree d is stored as
+ *   [skip pointers of the blocks 1, ..., B-1] [ceil(d/4) control bytes] [data bytes]
+ * where the values are zigzag(N(v, 0) - v) followed by the gaps N(v, i) - N(v, i-1).
+ * A block consists of SVB_BLOCK neighbours, i.e. SVB_BLOCK/4 control bytes, and its skip pointer holds the offset
+ * of its first data byte and the neighbour preceding it. Hence a block can be decoded on its own, which gives
+ * random access (get) and membership tests (contains) in O(log(d) + SVB_BLOCK).
+ *
+ * Whole neighbourhoods are best read with decode(), which decodes four neighbours per shuffle. The iterator
+ * decodes one group of four neighbours at a time.
+ */
+
+#define SVB_BLOCK 64
+
+class StreamVByteGraph {
+public:
+    struct SkipPointer {
+        uint32_t data_offset; // relative to the first data byte of the neighbourhood
+        uint32_t prev;        // the neighbour preceding the block
+    };
+
+    /* The encoded neighbourhoods of one direction */
+    struct Adjacency {
+        std::vector<uint64_t> offsets; // start of the neighbourhood of v in data
+        std::vector<NodeId> degrees;
+        std::vector<unsigned char> data;
+
+        /*
+         * Encodes the neighbourhoods neigh(0), ..., neigh(n-1), which have to be sorted, in parallel.
+         * A first pass computes the size of every neighbourhood, a second one encodes them at their offsets.
+         */
+        template <class NeighFunc>
+        static Adjacency Encode(int64_t n, NeighFunc neigh) {
+            Adjacency adj;
+            adj.offsets.assign(n + 1, 0);
+            adj.degrees.assign(n, 0);
+            #pragma omp parallel
+            {
+                std::vector<NodeId> neighbours;
+                std::vector<uint32_t> values;
+                #pragma omp for schedule(dynamic, 1024)
+                for (NodeId v = 0; v < n; v++) {
+                    gapValues(v, neigh(v), neighbours, values);
+                    adj.degrees[v] = values.size();
+                    adj.offsets[v + 1] = encodedSize(values);
+                }
+            }
+            for (int64_t v = 0; v < n; v++) {
+                adj.offsets[v + 1] += adj.offsets[v];
+            }
+            adj.data.assign(adj.offsets[n] + SVB_DATA_PADDING, 0);
+            #pragma omp parallel
+            {
+                std::vector<NodeId> neighbours;
+                std::vector<uint32_t> values;
+                #pragma omp for schedule(dynamic, 1024)
+                for (NodeId v = 0; v < n; v++) {
+                    gapValues(v, neigh(v), neighbours, values);
+                    encode(neighbours, values, &adj.data[adj.offsets[v]]);
+                }
+            }
+            return adj;
+        }
+
+        /*
+         * The number of bytes Encode() uses for the sorted neighbourhood 'range' of v. 'neighbours' and
+         * 'values' are scratch space, so that a thread can reuse them for all of its vertices.
+         */
+        template <class Range>
+        static uint64_t EncodedSize(NodeId v, Range&& range, std::vector<NodeId>& neighbours,
+                                    std::vector<uint32_t>& values) {
+            gapValues(v, std::forward<Range>(range), neighbours, values);
+            return encodedSize(values);
+        }
+
+        uint64_t size_in_bytes() const {
+            return offsets.size() * sizeof(uint64_t) + degrees.size() * sizeof(NodeId) + data.size();
+        }
+
+    private:
+        template <class Range>
+        static void gapValues(NodeId v, Range&& range, std::vector<NodeId>& neighbours,
+                              std::vector<uint32_t>& values) {
+            neighbours.clear();
+            values.clear();
+            for (NodeId u : range) {
+                if (neighbours.empty()) {
+                    values.push_back(svbZigzag(u - v));
+                } else {
+                    assert(u >= neighbours.back());
+                    values.push_back(u - neighbours.back());
+                }
+                neighbours.push_back(u);
+            }
+        }
+
+        static uint64_t numSkipPointers(uint64_t degree) {
+            return degree == 0 ? 0 : (degree - 1) / SVB_BLOCK;
+        }
+
+        static uint64_t encodedSize(const std::vector<uint32_t>& values) {
+            return numSkipPointers(values.size()) * sizeof(SkipPointer) + svbControlSize(values.size()) +
+                   svbDataSize(values.data(), values.size());
+        }
+
+        static void encode(const std::vector<NodeId>& neighbours, const std::vector<uint32_t>& values,
+                           unsigned char* out) {
+            const uint64_t degree = values.size();
+            unsigned char* skip = out;
+            unsigned char* control = skip + numSkipPointers(degree) * sizeof(SkipPointer);
+            unsigned char* data = control + svbControlSize(degree);
+            uint64_t data_offset = 0;
+            for (uint64_t start = 0; start < degree; start += SVB_BLOCK) {
+                if (start > 0) {
+                    SkipPointer pointer{uint32_t(data_offset), uint32_t(neighbours[start - 1])};
+                    std::memcpy(skip, &pointer, sizeof(pointer));
+                    skip += sizeof(pointer);
+                }
+                uint64_t count = std::min<uint64_t>(SVB_BLOCK, degree - start);
+                data_offset += svbEncode(&values[start], count, control + start / SVB_GROUP, data + data_offset);
+            }
+        }
+    };
+
+    class Neighbourhood {
+    public:
+        class iterator: public std::iterator<
+                std::input_iterator_tag, // iterator_category
+                NodeId,                  // value_type
+                NodeId,                  // difference_type
+                const NodeId*,           // pointer
+                NodeId                   // reference
+        >{
+            const unsigned char* control;
+            const unsigned char* data;
+            NodeId v;
+            int64_t index;
+            int64_t degree;
+            uint32_t group[SVB_GROUP];
+
+            void decodeGroup() {
+                uint32_t prev = group[SVB_GROUP - 1];
+                data += svbDecodeGroupScalar(control[index / SVB_GROUP], data, group);
+                int lane = 0;
+                if (index == 0) {
+                    // the first value is relative to v and zigzag encoded
+                    group[0] = v + svbUnzigzag(group[0]);
+                    prev = group[0];
+                    lane = 1;
+                }
+                for (; lane < SVB_GROUP; lane++) {
+                    prev += group[lane];
+                    group[lane] = prev;
+                }
+            }
+
+        public:
+            iterator(const unsigned char* control, const unsigned char* data, NodeId v, int64_t index,
+                     int64_t degree) : control(control), data(data), v(v), index(index), degree(degree), group() {
+                if (index < degree) {
+                    decodeGroup();
+                }
+            }
+
+            iterator& operator++() {
+                index++;
+                if (index % SVB_GROUP == 0 && index < degree) {
+                    decodeGroup();
+                }
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator retval = *this;
+                ++(*this);
+                return retval;
+            }
+
+            bool operator==(const iterator& other) const {
+                return index == other.index;
+            }
+
+            bool operator!=(const iterator& other) const {
+                return index != other.index;
+            }
+
+            reference operator*() const {
+                return group[index % SVB_GROUP];
+            }
+        };
+
+        /* A decoded neighbourhood, i.e. a range of plain vertex IDs */
+        class Decoded {
+            const NodeId* first;
+            const NodeId* last;
+        public:
+            Decoded(const NodeId* first, const NodeId* last) : first(first), last(last) {}
+            const NodeId* begin() const { return first; }
+            const NodeId* end() const { return last; }
+        };
+
+        Neighbourhood(NodeId v, const Adjacency& adj) : v(v), degree(adj.degrees[v]) {
+            skip = &adj.data[adj.offsets[v]];
+            control = skip + (degree == 0 ? 0 : (degree - 1) / SVB_BLOCK) * sizeof(SkipPointer);
+            data = control + svbControlSize(degree);
+        }
+
+        iterator begin() const {
+            return iterator(control, data, v, 0, degree);
+        }
+
+        iterator end() const {
+            return iterator(control, data, v, degree, degree);
+        }
+
+        int64_t size() const {
+            return degree;
+        }
+
+        /* Decodes the whole neighbourhood into 'out', which must have room for 'degree' + 3 vertices, and returns
+           the end of the decoded vertices */
+        NodeId* decode(NodeId* out) const {
+            if (degree > 0) {
+                decodeBlocks(0, numBlocks(), (uint32_t*) out);
+            }
+            return out + degree;
+        }
+
+        /* Decodes the whole neighbourhood into 'buffer', which is grown if needed */
+        Decoded decode(std::vector<NodeId>& buffer) const {
+            if (buffer.size() < (size_t) degree + SVB_GROUP - 1) {
+                buffer.resize(degree + SVB_GROUP - 1);
+            }
+            return Decoded(buffer.data(), decode(buffer.data()));
+        }
+
+        /* Decodes the neighbourhood block by block until a block ends with a vertex greater than 'bound'.
+           The returned range holds all neighbours up to 'bound', followed by some larger ones. */
+        Decoded decode(std::vector<NodeId>& buffer, NodeId bound) const {
+            if (buffer.size() < (size_t) degree + SVB_GROUP - 1) {
+                buffer.resize(degree + SVB_GROUP - 1);
+            }
+            NodeId* out = buffer.data();
+            int64_t decoded = 0;
+            for (int64_t block = 0; decoded < degree; block++) {
+                decodeBlocks(block, block + 1, (uint32_t*) out + decoded);
+                decoded = std::min<int64_t>(decoded + SVB_BLOCK, degree);
+                if (out[decoded - 1] > bound) {
+                    break;
+                }
+            }
+            return Decoded(out, out + decoded);
+        }
+
+        /* Returns the j'th neighbour, only its block is decoded */
+        NodeId get(int64_t j) const {
+            assert(j >= 0 && j < degree);
+            uint32_t block[SVB_BLOCK + SVB_GROUP];
+            decodeBlocks(j / SVB_BLOCK, j / SVB_BLOCK + 1, block);
+            return block[j % SVB_BLOCK];
+        }
+
+        /* Whether 'u' is a neighbour, only the block which may contain it is decoded */
+        bool contains(NodeId u) const {
+            if (degree == 0) {
+                return false;
+            }
+            // the last block whose preceding neighbour is smaller than u
+            int64_t lo = 0, hi = numBlocks() - 1;
+            while (lo < hi) {
+                int64_t mid = (lo + hi + 1) / 2;
+                if ((NodeId) skipPointer(mid).prev < u) {
+                    lo = mid;
+                } else {
+                    hi = mid - 1;
+                }
+            }
+            uint32_t block[SVB_BLOCK + SVB_GROUP];
+            decodeBlocks(lo, lo + 1, block);
+            int64_t count = std::min<int64_t>(SVB_BLOCK, degree - lo * SVB_BLOCK);
+            return std::binary_search((NodeId*) block, (NodeId*) block + count, u);
+        }
+
+    private:
+        NodeId v;
+        int64_t degree;
+        const unsigned char* skip;
+        const unsigned char* control;
+        const unsigned char* data;
+
+        int64_t numBlocks() const {
+            return (degree + SVB_BLOCK - 1) / SVB_BLOCK;
+        }
+
+        SkipPointer skipPointer(int64_t block) const {
+            SkipPointer pointer;
+            std::memcpy(&pointer, skip + (block - 1) * sizeof(SkipPointer), sizeof(pointer));
+            return pointer;
+        }
+
+        /* Decodes the blocks [first, last) into 'out', which must have room for a multiple of four vertices */
+        void decodeBlocks(int64_t first, int64_t last, uint32_t* out) const {
+            const int64_t start = first * SVB_BLOCK;
+            const int64_t count = std::min<int64_t>(last * SVB_BLOCK, degree) - start;
+            const unsigned char* c = control + start / SVB_GROUP;
+            if (first > 0) {
+                SkipPointer pointer = skipPointer(first);
+                svbDecodeDelta(c, data + pointer.data_offset, count, pointer.prev, out);
+                return;
+            }
+            // The first value is relative to v and zigzag encoded, so the first group is decoded on its own.
+            uint32_t group[SVB_GROUP];
+            const unsigned char* d = data + svbDecodeGroupScalar(c[0], data, group);
+            out[0] = v + svbUnzigzag(group[0]);
+            for (int lane = 1; lane < SVB_GROUP; lane++) {
+                out[lane] = out[lane - 1] + group[lane];
+            }
+            if (count > SVB_GROUP) {
+                svbDecodeDelta(c + 1, d, count - SVB_GROUP, out[SVB_GROUP - 1], out + SVB_GROUP);
+            }
+        }
+    };
+
+    StreamVByteGraph(int64_t num_nodes, int64_t num_edges, bool directed, Adjacency&& out, Adjacency&& in) :
+        out_(std::move(out)), in_(std::move(in)), directed_(directed), num_nodes_(num_nodes), num_edges_(num_edges)
+    {}
+
+    StreamVByteGraph(const StreamVByteGraph &) = delete;
+    StreamVByteGraph &operator=(const StreamVByteGraph &) = delete;
+    StreamVByteGraph(StreamVByteGraph &&) = default;
+    StreamVByteGraph &operator=(StreamVByteGraph &&) = default;
+
+    bool directed() const {
+        return directed_;
+    }
+
+    int64_t num_nodes() const {
+        return num_nodes_;
+    }
+
+    int64_t num_edges() const {
+        return num_edges_;
+    }
+
+    int64_t num_edges_directed() const {
+        return directed_ ? num_edges_ : 2*num_edges_;
+    }
+
+    int64_t out_degree(NodeId v) const {
+        return out_.degrees[v];
+    }
+
+    int64_t in_degree(NodeId v) const {
+        return in().degrees[v];
+    }
+
+    /* Requests the first cache lines of the out-neighbourhood of v, i.e. its skip pointers and control bytes */
+    void prefetch_neighbourhood(NodeId v) const {
+        prefetch_bytes(&out_.data[out_.offsets[v]], out_.offsets[v + 1] - out_.offsets[v]);
+    }
+
+    Neighbourhood out_neigh(NodeId n) const {
+        return Neighbourhood(n, out_);
+    }
+
+    Neighbourhood in_neigh(NodeId n) const {
+        return Neighbourhood(n, in());
+    }
+
+    /* Size of the encoded graph, the in-neighbourhoods are only stored for directed graphs */
+    uint64_t size_in_bytes() const {
+        return out_.size_in_bytes() + (directed_ ? in_.size_in_bytes() : 0);
+    }
+
+    void PrintStats() const {
+        std::cout << "Stream VByte graph has " << num_nodes() << " nodes and "
+                  << num_edges() << " ";
+        if (!directed()){
+            std::cout << "un";
+        }
+        std::cout << "directed edges for degree: ";
+        std::cout << (num_edges()/num_nodes()) << " and " << (8.0 * size_in_bytes() / num_edges_directed())
+                  << " bits per edge" << std::endl;
+    }
+
+    void PrintTopology() const {
+    }
+
+    Range<NodeId> vertices() const {
+        return Range<NodeId>(num_nodes());
+    }
+
+private:
+    Adjacency out_;
+    Adjacency in_;
+    bool directed_;
+    int64_t num_nodes_;
+    int64_t num_edges_;
+
+    const Adjacency& in() const {
+        return directed_ ? in_ : out_;
+    }
+};
+
+#endif //GRAPHSETS_COMPRESSED_STREAM_VBYTE_H
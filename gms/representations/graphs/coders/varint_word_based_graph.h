@@ -3,6 +3,7 @@
 #define GRAPHSETS_COMPRESSED_VARINT_WORD_BASED_H
 
 #include "coders-utils/varint_utils.h"
+#include <gms/representations/graphs/prefetch.h>
 
 
 class VarintWordBasedGraph {
@@ -185,6 +186,12 @@ public:
         return (int64_t)nr_neighs;
     }
 
+    /* Requests the first cache lines of the out-neighbourhood of v */
+    void prefetch_neighbourhood(NodeId v) const {
+        int64_t bytes = v + 1 < num_nodes_ ? new_offsets_out[v + 1] - new_offsets_out[v] : 1;
+        prefetch_bytes(&new_adj_data_out[new_offsets_out[v]], bytes);
+    }
+
     CompressedNeighbourhood out_neigh(NodeId n) const {
         return CompressedNeighbourhood(n, new_adj_data_out, new_offsets_out);
     }
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <gms/common/types.h>
+
+/**
+ * @brief Precomputed per-vertex weights for degree weighted vertex similarity measures.
+ *
+ * Adamic Adar and Resource Allocation weight each common neighbor w by 1 / log(deg(w)) and 1 / deg(w).
+ * Looking them up in a table avoids a division and a logarithm per common neighbor.
+ *
+ * The table is only valid as long as the degrees of the graph it was built from don't change.
+ */
+class DegreeWeights
+{
+public:
+    DegreeWeights() = default;
+
+    /**
+     * Computes the weights of all vertices of a graph.
+     *
+     * @tparam Graph any graph type with num_nodes() and out_degree(u)
+     * @param g
+     * @return
+     */
+    template <class Graph>
+    static DegreeWeights FromGraph(const Graph &g)
+    {
+        DegreeWeights weights;
+        int64_t num_nodes = g.num_nodes();
+        weights.inv_log_degree_.resize(num_nodes);
+        weights.inv_degree_.resize(num_nodes);
+        #pragma omp parallel for
+        for (NodeId u = 0; u < num_nodes; ++u) {
+            double degree = g.out_degree(u);
+            // vertices of degree 0 and 1 are never common neighbors in undirected graphs, their weights are infinite
+            weights.inv_log_degree_[u] = 1.0 / std::log(degree);
+            weights.inv_degree_[u] = 1.0 / degree;
+        }
+        return weights;
+    }
+
+    /**
+     * @return 1 / log(deg(u)) for every vertex u
+     */
+    const double *inv_log_degree() const
+    {
+        return inv_log_degree_.data();
+    }
+
+    /**
+     * @return 1 / deg(u) for every vertex u
+     */
+    const double *inv_degree() const
+    {
+        return inv_degree_.data();
+    }
+
+    int64_t num_nodes() const
+    {
+        return inv_degree_.size();
+    }
+
+    bool empty() const
+    {
+        return inv_degree_.empty();
+    }
+
+private:
+    std::vector<double> inv_log_degree_;
+    std::vector<double> inv_degree_;
+};
@@ -0,0 +1,127 @@
+#ifndef Afforest_H
+#define Afforest_H
+
+#include <cinttypes>
+#include <unordered_map>
+
+#include <gms/common/random.h>
+#include <gms/third_party/gapbs/platform_atomics.h>
+#include <gms/third_party/gapbs/pvector.h>
+#include "compressed_graph.h"
+
+/* Connected components with Afforest [1].
+
+   Every vertex is first linked to a few sampled neighbours (the first
+   'neighbor_rounds' ones), which on most real-world graphs already merges the
+   giant component. Its label is then estimated from a random sample of
+   vertices, and the remaining edges are only linked for vertices outside of
+   it, so most edges of the graph are never looked at again.
+
+   The components are kept as a forest in 'comp', where comp[v] <= v, and
+   linked with compare_and_swap on the roots. The graph is accessed through
+   compressed_graph.h, so this runs on every representation. Directed graphs
+   only provide their out-neighbourhoods there, thus an edge from the giant
+   component to another vertex would only be seen from its source. For them,
+   the remaining edges of all vertices are linked, giving the weakly
+   connected components.
+
+   [1] Michael Sutton, Tal Ben-Nun, and Amnon Barak. "Optimizing Parallel Graph
+       Connectivity Computation via Subgraph Sampling." International Parallel
+       and Distributed Processing Symposium (IPDPS), 2018.
+   */
+
+/* Merges the trees of u and v, the larger root is hooked under the smaller one */
+inline void afforest_link(NodeId u, NodeId v, pvector<NodeId>& comp) {
+	NodeId p1 = comp[u];
+	NodeId p2 = comp[v];
+	while (p1 != p2) {
+		NodeId high = p1 > p2 ? p1 : p2;
+		NodeId low = p1 + (p2 - high);
+		NodeId p_high = comp[high];
+		// already linked, or 'high' is a root that could be hooked
+		if ((p_high == low) || (p_high == high && compare_and_swap(comp[high], high, low))) {
+			break;
+		}
+		p1 = comp[comp[high]];
+		p2 = comp[low];
+	}
+}
+
+/* Points every vertex directly to the root of its tree */
+inline void afforest_compress(pvector<NodeId>& comp) {
+	#pragma omp parallel for schedule(dynamic, 16384)
+	for (NodeId n = 0; n < (NodeId) comp.size(); n++) {
+		while (comp[n] != comp[comp[n]]) {
+			comp[n] = comp[comp[n]];
+		}
+	}
+}
+
+/* The most frequent label of a random sample of vertices, an estimate of the
+   label of the largest component. Ties go to the smaller label, so the result
+   only depends on the seed. */
+inline NodeId afforest_sample_frequent_label(const pvector<NodeId>& comp, int64_t num_samples = 1024,
+                                             uint64_t seed = GMS::Random::DefaultSeed) {
+	std::unordered_map<NodeId, int> sample_counts(32);
+	GMS::Random::CounterRng rng(seed);
+	for (int64_t i = 0; i < num_samples; i++) {
+		sample_counts[comp[rng.bounded(comp.size())]]++;
+	}
+	auto most_frequent = sample_counts.begin();
+	for (auto it = sample_counts.begin(); it != sample_counts.end(); ++it) {
+		if (it->second > most_frequent->second ||
+		    (it->second == most_frequent->second && it->first < most_frequent->first)) {
+			most_frequent = it;
+		}
+	}
+	return most_frequent->first;
+}
+
+template <class G>
+pvector<NodeId> Afforest(const G& g, int32_t neighbor_rounds = 2) {
+	pvector<NodeId> comp(g.num_nodes());
+	#pragma omp parallel for
+	for (NodeId n = 0; n < g.num_nodes(); n++) {
+		comp[n] = n;
+	}
+	if (g.num_nodes() == 0) {
+		return comp;
+	}
+
+	// link the r-th neighbour of every vertex in round r
+	for (int32_t r = 0; r < neighbor_rounds; r++) {
+		#pragma omp parallel for schedule(dynamic, 16384)
+		for (NodeId u = 0; u < g.num_nodes(); u++) {
+			int32_t index = 0;
+			for_each_out_neigh(g, u, [&](NodeId v) {
+				if (index++ == r) {
+					afforest_link(u, v, comp);
+					return false;
+				}
+				return true;
+			});
+		}
+		afforest_compress(comp);
+	}
+
+	NodeId c = afforest_sample_frequent_label(comp);
+
+	// the sampled neighbours have been linked already
+	const bool skip_giant = !g.directed();
+	#pragma omp parallel for schedule(dynamic, 16384)
+	for (NodeId u = 0; u < g.num_nodes(); u++) {
+		if (skip_giant && comp[u] == c) {
+			continue;
+		}
+		int32_t index = 0;
+		for_each_out_neigh(g, u, [&](NodeId v) {
+			if (index++ >= neighbor_rounds) {
+				afforest_link(u, v, comp);
+			}
+		});
+	}
+	afforest_compress(comp);
+	return comp;
+}
+
+#endif // Afforest_H
@@ -3,8 +3,10 @@
 
 #include <functional>
 #include <iostream>
+#include <optional>
 #include <vector>
 
+#include <gms/common/benchmark.h>
 #include <gms/third_party/gapbs/benchmark.h>
 #include <gms/third_party/gapbs/bitmap.h>
 #include <gms/third_party/gapbs/builder.h>
@@ -241,12 +243,15 @@ int main(int argc, char* argv[]) {
   Builder b(cli);
   CSRGraph g = b.MakeGraph();
   SourcePicker<CSRGraph> sp(g, cli.start_vertex());
-  auto BCBound =
-	[&sp, &cli] (const CSRGraph &g) { return Brandes(g, sp, cli.num_iters()); };
-  SourcePicker<CSRGraph> vsp(g, cli.start_vertex());
+  // warmup trials draw sources as well, so the verifier replays the sources of the trial it follows
+  std::optional<SourcePicker<CSRGraph>> vsp;
+  auto BCBound = [&sp, &vsp, &cli] (const CSRGraph &g) {
+	vsp.emplace(sp);
+	return Brandes(g, sp, cli.num_iters());
+  };
   auto VerifierBound = [&vsp, &cli] (const CSRGraph &g,
 									 const pvector<ScoreT> &scores) {
-	return BCVerifier(g, vsp, cli.num_iters(), scores);
+	return BCVerifier(g, *vsp, cli.num_iters(), scores);
   };
   BenchmarkKernelLegacy(cli, g, BCBound, PrintTopScores, VerifierBound);
   return 0;
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <vector>
 
+#include <gms/common/benchmark.h>
 #include <gms/third_party/gapbs/benchmark.h>
 #include <gms/third_party/gapbs/bitmap.h>
 #include <gms/third_party/gapbs/command_line.h>
@@ -265,10 +266,14 @@ int main(int argc, char* argv[]) {
   Builder b(cli);
   CSRGraph g = b.MakeGraph();
   SourcePicker<CSRGraph> sp(g, cli.start_vertex());
-  auto BFSBound = [&sp] (const CSRGraph &g) { return DOBFS(g, sp.PickNext()); };
-  SourcePicker<CSRGraph> vsp(g, cli.start_vertex());
-  auto VerifierBound = [&vsp] (const CSRGraph &g, const pvector<NodeId> &parent) {
-	return BFSVerifier(g, vsp.PickNext(), parent);
+  // warmup trials draw sources as well, so the verifier checks the source of the trial it follows
+  NodeId source = -1;
+  auto BFSBound = [&sp, &source] (const CSRGraph &g) {
+	source = sp.PickNext();
+	return DOBFS(g, source);
+  };
+  auto VerifierBound = [&source] (const CSRGraph &g, const pvector<NodeId> &parent) {
+	return BFSVerifier(g, source, parent);
   };
   BenchmarkKernelLegacy(cli, g, BFSBound, PrintBFSStats, VerifierBound);
   return 0;
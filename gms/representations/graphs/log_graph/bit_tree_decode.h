@@ -0,0 +1,167 @@
+#ifndef Bit_Tree_Decode_H
+#define Bit_Tree_Decode_H
+
+#include <inttypes.h>
+#if defined(__BMI__) || defined(__BMI2__) || defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+#include "kbit_decode.h"
+
+/* Table-driven decoding of the bit trees written by bit_tree_encode.h.
+
+   A node is identified by its smallest ID with the bit of its level set as a
+   marker, e.g. the root of a tree over k-bit IDs is 1 << (k-1). The nodes
+   above level 3 are decoded two bits at a time with an explicit stack. A
+   node of level 3 spans eight IDs, its whole subtree takes at most 7 nodes,
+   i.e. 14 bits, which index a table holding the set of leaves as an 8-bit
+   mask and the number of bits used. The lower levels have their own, smaller
+   tables, for trees over IDs of fewer than three bits.
+
+   The bulk decoder expands an 8-bit mask with one more table, which holds
+   the positions of its set bits, and writes eight IDs with one AVX2 store.
+   The output may thus be written up to BIT_TREE_DECODE_SLACK values past
+   the last neighbour.
+   */
+
+#define BIT_TREE_TABLE_LEVEL 3
+#define BIT_TREE_DECODE_SLACK 8
+
+struct Bit_Tree_Tables {
+	// subtree[first[l] + bits] for a node of level l: leaves in the low 8 bits, bits used above
+	uint16_t subtree[4 + 64 + (1 << 14)];
+	int32_t first[BIT_TREE_TABLE_LEVEL + 1];
+	uint8_t expand[256][8]; // positions of the set bits of a mask, in ascending order
+
+	Bit_Tree_Tables() {
+		first[1] = 0;
+		first[2] = 4;
+		first[3] = 4 + 64;
+		for (int level = 1; level <= BIT_TREE_TABLE_LEVEL; level++) {
+			int index_bits = 2 * ((1 << level) - 1);
+			for (uint32_t bits = 0; bits < (1u << index_bits); bits++) {
+				int pos = 0;
+				uint32_t mask = parse(level, 0, bits, pos);
+				subtree[first[level] + bits] = (uint16_t) (mask | (pos << 8));
+			}
+		}
+		for (int mask = 0; mask < 256; mask++) {
+			int count = 0;
+			for (int i = 0; i < 8; i++) {
+				expand[mask][i] = 0;
+				if (mask & (1 << i)) {
+					expand[mask][count++] = i;
+				}
+			}
+		}
+	}
+
+	/* The leaves of the subtree of a node of the given level, which spans the
+	   IDs offset, offset+1, ... of its tree, encoded at bit 'pos' of 'bits' */
+	static uint32_t parse(int level, int offset, uint32_t bits, int& pos) {
+		uint32_t code = (bits >> pos) & 3;
+		pos += 2;
+		int span = 1 << level;
+		if (code == 0) {
+			return ((1u << span) - 1) << offset;
+		}
+		if (level == 1) {
+			return ((code & 2) ? 1u << offset : 0) | ((code & 1) ? 2u << offset : 0);
+		}
+		uint32_t mask = 0;
+		if (code & 2) {
+			mask |= parse(level - 1, offset, bits, pos);
+		}
+		if (code & 1) {
+			mask |= parse(level - 1, offset + span / 2, bits, pos);
+		}
+		return mask;
+	}
+};
+
+inline const Bit_Tree_Tables& bit_tree_tables() {
+	static const Bit_Tree_Tables tables;
+	return tables;
+}
+
+/* The table entry for the subtree of a node of level <= BIT_TREE_TABLE_LEVEL at bit 'bitOffset' */
+inline uint16_t bit_tree_lookup(const Bit_Tree_Tables& tables, const void* array, int64_t bitOffset, int level) {
+	return tables.subtree[tables.first[level] + kbit_extract(array, bitOffset, 2 * ((1 << level) - 1))];
+}
+
+/* Writes base + i for every bit i set in 'mask', returns the end of the written IDs */
+inline int32_t* bit_tree_expand(const Bit_Tree_Tables& tables, uint32_t mask, int32_t base, int32_t* out) {
+	#if defined(__AVX2__)
+		__m256i offsets = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) tables.expand[mask]));
+		_mm256_storeu_si256((__m256i*) out, _mm256_add_epi32(offsets, _mm256_set1_epi32(base)));
+		return out + __builtin_popcount(mask);
+	#else
+		for (int i = 0; mask != 0; i++) {
+			*out++ = base + tables.expand[mask][i];
+			mask &= mask - 1;
+		}
+		return out;
+	#endif
+}
+
+/* Writes the IDs first, ..., last - 1, returns the end of the written IDs */
+inline int32_t* bit_tree_interval(int32_t first, int32_t last, int32_t* out) {
+	#if defined(__AVX2__)
+		// intervals above the table level are a multiple of 8 long
+		__m256i ids = _mm256_add_epi32(_mm256_set1_epi32(first), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+		for (; first + 8 <= last; first += 8) {
+			_mm256_storeu_si256((__m256i*) out, ids);
+			ids = _mm256_add_epi32(ids, _mm256_set1_epi32(8));
+			out += 8;
+		}
+	#endif
+	for (; first < last; first++) {
+		*out++ = first;
+	}
+	return out;
+}
+
+/* Decodes the bit tree over k-bit IDs at bit 'bitOffset' into 'out', which
+   needs room for BIT_TREE_DECODE_SLACK values past its 'degree' neighbours.
+   Stops early after the first subtree that yields a neighbour greater than
+   'bound'. Returns the end of the decoded neighbours. */
+inline int32_t* bit_tree_decode(const void* array, int64_t bitOffset, int k, int64_t degree, int32_t* out,
+		int32_t bound = INT32_MAX) {
+	if (degree == 0) {
+		return out;
+	}
+	const Bit_Tree_Tables& tables = bit_tree_tables();
+	int32_t* const begin = out;
+	uint32_t stack[32];
+	int top = 0;
+	stack[top++] = 1u << (k - 1);
+	int64_t pos = bitOffset;
+	while (top > 0 && (out == begin || out[-1] <= bound)) {
+		uint32_t node = stack[--top];
+		uint32_t marker = node & -node;
+		int32_t base = node ^ marker;
+		int level = __builtin_ctz(node) + 1;
+		if (level <= BIT_TREE_TABLE_LEVEL) {
+			uint16_t entry = bit_tree_lookup(tables, array, pos, level);
+			pos += entry >> 8;
+			out = bit_tree_expand(tables, entry & 0xff, base, out);
+			continue;
+		}
+		uint32_t code = kbit_extract(array, pos, 2);
+		pos += 2;
+		if (code == 0) {
+			out = bit_tree_interval(base, base + 2 * (int32_t) marker, out);
+			continue;
+		}
+		// the left child is popped first
+		if (code & 1) {
+			stack[top++] = node | (marker >> 1);
+		}
+		if (code & 2) {
+			stack[top++] = base | (marker >> 1);
+		}
+	}
+	return out;
+}
+
+#endif // Bit_Tree_Decode_H
@@ -0,0 +1,86 @@
+#ifndef Bit_Tree_Encode_H
+#define Bit_Tree_Encode_H
+
+#include <algorithm>
+#include <inttypes.h>
+
+#include <gms/common/types.h>
+#include "kbit_encode.h"
+
+/* Bit tree encoding of a sorted neighbourhood, the decoder is in
+   bit_tree_decode.h.
+
+   The neighbours are the leaves of a binary trie of height k over their k-bit
+   IDs. Every inner node is stored with two bits in depth-first order, left
+   subtree first: the first bit is set if the node has a right child, the
+   second one if it has a left child. A subtree whose leaves are all
+   neighbours is stored as a node without children (00) and not descended
+   into.
+
+   The trie is not built: the neighbours below a node are a range of the
+   sorted neighbourhood, and the ranges of its children are found with a
+   binary search for the first neighbour with the bit of the node's level set.
+   One pass over the recursion counts the nodes, so that the bit trees of all
+   neighbourhoods can be laid out in one array, a second one writes the bits
+   with a Kbit_Writer, two per node.
+   */
+
+/* Splits the neighbours [first, last) below a node of the given level, the
+   subtree of which spans 2^level IDs, into its left and right child */
+inline const NodeId* bit_tree_split(const NodeId* first, const NodeId* last, int level){
+	uint32_t right = ((uint32_t) *first >> level << level) | (uint32_t(1) << (level - 1));
+	return std::lower_bound(first, last, (NodeId) right);
+}
+
+/* Whether the neighbours [first, last) are all leaves below a node of the given level */
+inline bool bit_tree_complete(const NodeId* first, const NodeId* last, int level){
+	return last - first == (int64_t(1) << level);
+}
+
+/* Number of nodes stored for the subtree with the neighbours [first, last) */
+inline int64_t bit_tree_nodes(const NodeId* first, const NodeId* last, int level){
+	if (level == 1 || bit_tree_complete(first, last, level)) {
+		return 1;
+	}
+	const NodeId* mid = bit_tree_split(first, last, level);
+	int64_t nodes = 1;
+	if (first != mid) {
+		nodes += bit_tree_nodes(first, mid, level - 1);
+	}
+	if (mid != last) {
+		nodes += bit_tree_nodes(mid, last, level - 1);
+	}
+	return nodes;
+}
+
+/* The number of bits of the bit tree of the sorted, distinct k-bit IDs [first, last) */
+inline int64_t bit_tree_bits(const NodeId* first, const NodeId* last, int k){
+	return first == last ? 0 : 2 * bit_tree_nodes(first, last, k);
+}
+
+inline void bit_tree_write(const NodeId* first, const NodeId* last, int level, Kbit_Writer& writer){
+	if (bit_tree_complete(first, last, level)) {
+		writer.put(0, 2);
+		return;
+	}
+	const NodeId* mid = bit_tree_split(first, last, level);
+	writer.put((mid != last ? 1 : 0) | (first != mid ? 2 : 0), 2);
+	if (level > 1) {
+		if (first != mid) {
+			bit_tree_write(first, mid, level - 1, writer);
+		}
+		if (mid != last) {
+			bit_tree_write(mid, last, level - 1, writer);
+		}
+	}
+}
+
+/* Encodes the sorted, distinct k-bit IDs [first, last) as a bit tree, which
+   occupies the next bit_tree_bits(first, last, k) bits of 'writer' */
+inline void encode_bit_tree(const NodeId* first, const NodeId* last, int k, Kbit_Writer& writer){
+	if (first != last) {
+		bit_tree_write(first, last, k, writer);
+	}
+}
+
+#endif // Bit_Tree_Encode_H
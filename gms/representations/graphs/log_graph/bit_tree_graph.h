@@ -6,29 +6,23 @@
 #include <inttypes.h>
 #include <mmintrin.h>
 #include <immintrin.h>
-#include "my_bitmap.h"
 
 #include "kbit_neighbourhood.h"
 #include <gms/third_party/gapbs/util.h>
+#include <gms/representations/graphs/prefetch.h>
 #include "bit_tree_neighbourhood.h"
 
 #define BYTE 8
 
 using namespace std;
 
-/* contains either the bit offset in the adjacency array or a pointer to the
-	bit tree depending on whether the corresponding vertex has been encoded
-	with the bit tree encoding */
-union Offset_Or_Address{
-	int64_t offset;
-	My_Bitmap* tree;
-};
-
+/* The bit trees are stored in the adjacency array next to the k-bit encoded
+	neighbourhoods, 'offset' is the bit offset of either */
 struct Offset_Array_Entry{
 	int32_t degree;
 	int8_t bitlength;
 	int8_t encoding; // 0 if k_bit, 1 if bit_tree
-	Offset_Or_Address offset_or_tree;
+	int64_t offset;
 };
 
 class Bit_Tree_Graph {
@@ -45,7 +39,7 @@ class Bit_Tree_Graph {
 
 	public:
         /* Creates an empty graph */
-        Bit_Tree_Graph(bool directed){
+        Bit_Tree_Graph(bool directed) : n(0), O(nullptr), offsetArray(nullptr), adjacencyArray(nullptr){
 		    isDirected = directed;
 		}
 
@@ -55,19 +49,30 @@ class Bit_Tree_Graph {
 		    n = nVertices;
 		    m = nEdges;
 			this->O = O;
+			this->offsetArray = nullptr;
 			this->adjacencyArray = adjacencyArray;
 		    isDirected = directed;
 		}
 
+		Bit_Tree_Graph(Bit_Tree_Graph &&graph) :
+		    n(graph.n),
+		    m(graph.m),
+		    isDirected(graph.isDirected),
+		    O(graph.O),
+		    offsetArray(graph.offsetArray),
+		    adjacencyArray(graph.adjacencyArray)
+        {
+            graph.O = nullptr;
+            graph.offsetArray = nullptr;
+            graph.adjacencyArray = nullptr;
+        }
+
 		// Destructor
 		~Bit_Tree_Graph() {
-			for(NodeId v=0; v < n; v ++) {
-				if(encoding(v)){
-					delete O[v].offset_or_tree.tree;
-				}
-			}
-			free(O);
-			free(adjacencyArray);
+			if (O != nullptr)
+				free(O);
+			if (adjacencyArray != nullptr)
+				free(adjacencyArray);
 		}
 
 		/* Returns the number of vertices */
@@ -125,7 +130,11 @@ class Bit_Tree_Graph {
 			return false;
 		}
 
+		/* Requests the first cache lines of the neighbourhood of v, whose size
+		   is estimated from its k-bit encoding if it is a bit tree */
 		void prefetch_neighbourhood(NodeId v) const{
+			int64_t ebo = O[v].offset;
+			prefetch_bytes((char*)adjacencyArray + (ebo >> 3), ((ebo & 7) + (int64_t) O[v].degree*O[v].bitlength + 7) >> 3);
 		}
 
 		bool encoding(NodeId v) const{
@@ -135,7 +144,7 @@ class Bit_Tree_Graph {
 		Kbit_Neighbourhood in_neigh(int64_t v) const {
 			NodeId degree =    O[v].degree;
 			int8_t bitlength = O[v].bitlength;
-			int64_t ebo =      O[v].offset_or_tree.offset;
+			int64_t ebo =      O[v].offset;
 			return Kbit_Neighbourhood(degree, ebo, adjacencyArray, bitlength);
 			// Bit_Tree_Neighbourhood B = Bit_Tree_Neighbourhood(degree, ebo, adjacencyArray, bitlength);
 			// return * (Kbit_Neighbourhood*) &B;
@@ -143,19 +152,14 @@ class Bit_Tree_Graph {
 		}
 
 		Bit_Tree_Neighbourhood bit_tree_neigh(int64_t v) const {
-		// Iterable in_neigh(int64_t v) const {
-		// cointainer_type in_neigh(int64_t v) const {
-			// return out_neigh(v);
-			int8_t bitlength =    O[v].bitlength;
-			My_Bitmap* tree  =    O[v].offset_or_tree.tree;
-			return Bit_Tree_Neighbourhood(tree, bitlength);
+			return Bit_Tree_Neighbourhood(adjacencyArray, O[v].offset, O[v].degree, O[v].bitlength);
 		}
 
 
 		Kbit_Neighbourhood out_neigh(int64_t v) const {
 			NodeId degree =    O[v].degree;
 			int8_t bitlength = O[v].bitlength;
-			int64_t ebo =       O[v].offset_or_tree.offset;
+			int64_t ebo =       O[v].offset;
 			return Kbit_Neighbourhood(degree, ebo, adjacencyArray, bitlength);
 		}
 
@@ -2,25 +2,22 @@
 #define Bit_Tree_Neighbourhood_H
 
 #include <inttypes.h>
-#include <xmmintrin.h>
-#include <ammintrin.h>
-#include <immintrin.h>
+#include <vector>
 #include <gms/third_party/gapbs/benchmark.h>
 #include "options.h"
+#include "bit_tree_decode.h"
 
 typedef int32_t NodeId;
 typedef int32_t WeightT;
 
 using namespace std;
 
-// int a = 0;
-// int b = 0;
-// int c = 0;
-// int d = 0;
-
-// template<class T, class Tag = void>
+/* A neighbourhood stored as a bit tree (see bit_tree_encode.h) at a bit
+   offset of the adjacency array of a Bit_Tree_Graph */
 class Bit_Tree_Neighbourhood {
 public:
+    /* Decodes one subtree of BIT_TREE_TABLE_LEVEL at a time with a table
+       lookup, its leaves are then returned from a bit mask */
     class iterator: public std::iterator<
                     std::input_iterator_tag, // iterator_category
                     NodeId,                  // value_type
@@ -29,122 +26,138 @@ public:
                     NodeId                  // reference
                                   >{
 
-		My_Bitmap* tree;
-        int64_t position;
-		// stack faster than heap:  http://stackoverflow.com/a/24057855
-		// NodeId* stack;
-		NodeId stack[32];
-		int8_t stack_top;
-        int8_t k;
-		bool interval_mode;
-		NodeId current_vertex;
-		NodeId interval_end;
+        const int32_t* adjacencyArray;
+        const Bit_Tree_Tables* tables;
+        int64_t position; // next bit of the tree
+        int64_t index; // number of the current neighbour
+        uint32_t stack[32];
+        int8_t stack_top;
+        uint32_t leaves; // pending leaves of a table lookup, relative to leaves_base
+        NodeId leaves_base;
+        NodeId interval_next; // pending IDs of a complete subtree
+        NodeId interval_end;
+        NodeId current;
+
+        void advance() {
+            if (interval_next < interval_end) {
+                current = interval_next++;
+                return;
+            }
+            while (leaves == 0) {
+                uint32_t node = stack[--stack_top];
+                uint32_t marker = node & -node;
+                NodeId base = node ^ marker;
+                int level = __builtin_ctz(node) + 1;
+                if (level <= BIT_TREE_TABLE_LEVEL) {
+                    uint16_t entry = bit_tree_lookup(*tables, adjacencyArray, position, level);
+                    position += entry >> 8;
+                    leaves = entry & 0xff;
+                    leaves_base = base;
+                    continue;
+                }
+                uint32_t code = kbit_extract(adjacencyArray, position, 2);
+                position += 2;
+                if (code == 0) {
+                    current = base;
+                    interval_next = base + 1;
+                    interval_end = base + 2 * (NodeId) marker;
+                    return;
+                }
+                if (code & 1) {
+                    stack[stack_top++] = node | (marker >> 1);
+                }
+                if (code & 2) {
+                    stack[stack_top++] = base | (marker >> 1);
+                }
+            }
+            current = leaves_base + __builtin_ctz(leaves);
+            leaves &= leaves - 1;
+        }
 
     public:
-        explicit iterator(My_Bitmap* tree){
-			this->position = tree->get_size();
-		}
-
-        explicit iterator(My_Bitmap* tree, int8_t k){
-            this->tree= tree;
-            this->k = k;
-			this->position = 0;
-			// stack = (NodeId*) malloc(k*sizeof(NodeId));
-			stack_top = 0;
-			stack[stack_top ++] = 1<<(k-1);
-
-			this->interval_mode = false;
-			this->interval_end = -1;
+        /* The end iterator of a neighbourhood with 'degree' neighbours */
+        explicit iterator(int64_t degree) : index(degree) {}
+
+        iterator(const int32_t* adjacencyArray, int64_t bitOffset, int8_t k, int64_t degree) :
+            adjacencyArray(adjacencyArray), tables(&bit_tree_tables()), position(bitOffset), index(0),
+            stack_top(0), leaves(0), leaves_base(0), interval_next(0), interval_end(0), current(0) {
+            if (degree > 0) {
+                stack[stack_top++] = 1u << (k - 1);
+                advance();
+            }
         }
 
         iterator& operator++() {
+            index++;
+            if (stack_top > 0 || leaves != 0 || interval_next < interval_end) {
+                advance();
+            }
             return *this;
         }
 
         iterator operator++(int) {
             iterator retval = *this;
+            ++(*this);
             return retval;
         }
 
-        bool operator==(iterator other) const {
-            return position == other.position;
+        bool operator==(const iterator& other) const {
+            return index == other.index;
         }
 
-        bool operator!=(iterator other) const {
-            return position != other.position;
+        bool operator!=(const iterator& other) const {
+            return index != other.index;
         }
 
-        reference operator*() {
-			if(interval_mode){
-				current_vertex ++;
-				if(current_vertex == interval_end){
-					interval_mode = false;
-					position += 2;
-				}
-				return current_vertex;
-			}
-
-			while(true){
-				int code = tree->get_2bits(position);
-				int output = stack[--stack_top];
-				switch(code){
-					case 0:  // very low probability
-						interval_mode = true;
-						current_vertex = _blsr_u32(output);
-						interval_end = output | _blsmsk_u32(output);
-						return current_vertex;
-					case 1: // 3/7 probability
-						position += 2;
-						if (output & 1) {
-							return output;
-						}
-						else{
-							uint32_t selector = _blsi_u32(output) >> 1;
-							stack[stack_top ++] = output | selector;
-						}
-					break;
-					case 2: // 3/7 probability
-						position += 2;
-						if (output & 1) {
-							return _blsr_u32(output);
-						}
-						else{
-							uint32_t selector = _blsi_u32(output) >> 1;
-							stack[stack_top ++] = _blsr_u32(output) | selector;
-						}
-					break;
-					case 3: // 1/7 probability
-					{
-						position += 2;
-						uint32_t selector = _blsi_u32(output) >> 1;
-						stack[stack_top] = output | selector;
-						stack[stack_top + 1] = _blsr_u32(output) | selector;
-						stack_top += 2;
-					}
-					break;
-				}
-			}
+        reference operator*() const {
+            return current;
         }
     };
 
 private:
-	My_Bitmap* tree;
+    const int32_t* adjacencyArray;
+    int64_t bitOffset;
+    int64_t degree;
     int8_t k;
 
-public	:
-    Bit_Tree_Neighbourhood(My_Bitmap* tree, int8_t k){
-		this->tree = tree;
-        this->k = k;
+public:
+    Bit_Tree_Neighbourhood(const int32_t* adjacencyArray, int64_t bitOffset, int64_t degree, int8_t k) :
+        adjacencyArray(adjacencyArray), bitOffset(bitOffset), degree(degree), k(k) {}
+
+    iterator begin() const {
+        return iterator(adjacencyArray, bitOffset, k, degree);
     }
 
-    iterator begin() {
-        return iterator(tree, k);
+    iterator end() const {
+        return iterator(degree);
     }
 
-   iterator end() {
-       return iterator(tree);
-   }
+    /* A decoded neighbourhood, i.e. a range of plain vertex IDs */
+    class Decoded {
+        const NodeId* first;
+        const NodeId* last;
+    public:
+        Decoded(const NodeId* first, const NodeId* last) : first(first), last(last) {}
+        const NodeId* begin() const { return first; }
+        const NodeId* end() const { return last; }
+    };
+
+    /* Decodes the whole neighbourhood into 'buffer', which is grown if needed.
+       Whole subtrees of eight IDs are expanded at once. */
+    Decoded decode(std::vector<NodeId>& buffer) const {
+        return decode(buffer, INT32_MAX);
+    }
 
+    /* Decodes the neighbourhood until a subtree yields a vertex greater than
+       'bound'. The returned range holds all neighbours up to 'bound',
+       followed by some larger ones. */
+    Decoded decode(std::vector<NodeId>& buffer, NodeId bound) const {
+        if (buffer.size() < (size_t) degree + BIT_TREE_DECODE_SLACK) {
+            buffer.resize(degree + BIT_TREE_DECODE_SLACK);
+        }
+        NodeId* out = bit_tree_decode(adjacencyArray, bitOffset, k, degree, buffer.data(), bound);
+        return Decoded(buffer.data(), out);
+    }
 };
 
 #endif // Bit_Tree_Neighbourhood_H
@@ -0,0 +1,320 @@
+#ifndef BRANDES_H
+#define BRANDES_H
+
+#include <algorithm>
+#include <cinttypes>
+#include <iostream>
+#include <vector>
+
+#include <gms/third_party/gapbs/benchmark.h>
+#include <gms/third_party/gapbs/bitmap.h>
+#include <gms/third_party/gapbs/platform_atomics.h>
+#include <gms/third_party/gapbs/pvector.h>
+#include <gms/third_party/gapbs/sliding_queue.h>
+#include <gms/third_party/gapbs/timer.h>
+#include "compressed_graph.h"
+
+/* Approximate betweenness centrality from a subset of the sources, on every
+   representation of compressed_graph.h.
+
+   This BC implementation makes use of the Brandes [1] algorithm with
+   implementation optimizations from Madduri et al. [2]. It is only an approximate
+   because it does not compute the paths from every start vertex, but only a small
+   subset of them. Additionally, the scores are normalized to the range [0,1].
+
+   As an optimization to save memory, this implementation uses a Bitmap to hold
+   succ (list of successors) found during the BFS phase that are used in the back-
+   propagation phase.
+
+   By default, the sources are processed in batches of up to 64 with a
+   multi-source BFS [3]: every vertex holds a 64-bit mask of the sources whose
+   search currently visits it, so one traversal of a neighbourhood advances all
+   searches of the batch at once. The dependencies are accumulated per source
+   lane in a batched back-propagation, which needs the per-level masks instead
+   of the succ bitmap. The scores are summed in source order, so they are equal
+   to those of the single-source kernel (-A brandes).
+
+   [1] Ulrik Brandes. "A faster algorithm for betweenness centrality." Journal of
+       Mathematical Sociology, 25(2):163–177, 2001.
+
+   [2] Kamesh Madduri, David Ediger, Karl Jiang, David A Bader, and Daniel
+       Chavarria-Miranda. "A faster parallel algorithm and efficient multithreaded
+       implementations for evaluating betweenness centrality on massive datasets."
+       International Symposium on Parallel & Distributed Processing (IPDPS), 2009.
+
+   [3] Manuel Then, Moritz Kaufmann, Fernando Chirigati, Tuan-Anh Hoang-Vu, Kien
+       Pham, Alfons Kemper, Thomas Neumann, and Huy T. Vo. "The More the Merrier:
+       Efficient Multi-Source Graph Traversal." Proceedings of the VLDB Endowment,
+       8(4):449–460, 2014.
+   */
+
+typedef float ScoreT;
+
+template <class G>
+void PBFS(const G &g, const pvector<int64_t> &edge_offsets, NodeId source, pvector<NodeId> &path_counts,
+    Bitmap &succ, std::vector<SlidingQueue<NodeId>::iterator> &depth_index,
+    SlidingQueue<NodeId> &queue
+	) {
+  pvector<NodeId> depths(g.num_nodes(), -1);
+  depths[source] = 0;
+  path_counts[source] = 1;
+  queue.push_back(source);
+  depth_index.push_back(queue.begin());
+  queue.slide_window();
+  #pragma omp parallel
+  {
+    int depth = 0;
+    QueueBuffer<NodeId> lqueue(queue);
+    while (!queue.empty()) {
+      #pragma omp single
+      depth_index.push_back(queue.begin());
+      depth++;
+      #pragma omp for schedule(dynamic, 64)
+      for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
+        NodeId u = *q_iter;
+        int64_t offset = edge_offsets[u];
+        // for (NodeId v : g.out_neigh(u)) {
+        for_each_out_neigh(g, u, [&](NodeId v) {
+          if ((depths[v] == -1) && (compare_and_swap(depths[v], -1, depth))) {
+            lqueue.push_back(v);
+          }
+          if (depths[v] == depth) {
+            // this is equal to the position of v in the adjacency array
+            // succ.set_bit_atomic(v - g_out_start);
+            succ.set_bit_atomic(offset);
+            // this works !!!
+            fetch_and_add(path_counts[v], path_counts[u]);
+          }
+          offset ++;
+        });
+      }
+      lqueue.flush();
+      #pragma omp barrier
+      #pragma omp single
+      queue.slide_window();
+    }
+  }
+  depth_index.push_back(queue.begin());
+}
+
+
+template <class G>
+pvector<ScoreT> Brandes(const G &g, SourcePicker<G> &sp,
+                        NodeId num_iters) {
+	#if PRINT_INFO
+		Timer t;
+		t.Start();
+	#endif
+	pvector<ScoreT> scores(g.num_nodes(), 0);
+	pvector<NodeId> path_counts(g.num_nodes());
+	Bitmap succ(g.num_edges_directed());
+	pvector<int64_t> edge_offsets = out_edge_offsets(g);
+	std::vector<SlidingQueue<NodeId>::iterator> depth_index;
+	SlidingQueue<NodeId> queue(g.num_nodes());
+	#if PRINT_INFO
+		t.Stop();
+		PrintStep("a", t.Seconds());
+	#endif
+  for (NodeId iter=0; iter < num_iters; iter++) {
+    NodeId source = sp.PickNext();
+	#if PRINT_INFO
+    	std::cout << "source: " << source << std::endl;
+    	t.Start();
+	#endif
+    path_counts.fill(0);
+    depth_index.resize(0);
+    queue.reset();
+    succ.reset();
+    PBFS(g, edge_offsets, source, path_counts, succ, depth_index, queue);
+	#if PRINT_INFO
+	    t.Stop();
+	    PrintStep("b", t.Seconds());
+	#endif
+    pvector<ScoreT> deltas(g.num_nodes(), 0);
+	#if PRINT_INFO
+    	t.Start();
+	#endif
+    for (int d=depth_index.size()-2; d >= 0; d--) {
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (auto it = depth_index[d]; it < depth_index[d+1]; it++) {
+        NodeId u = *it;
+        ScoreT delta_u = 0;
+        int64_t offset = edge_offsets[u];
+        // for (NodeId v : g.out_neigh(u)) {
+        for_each_out_neigh(g, u, [&](NodeId v) {
+          if (succ.get_bit(offset)) {
+            delta_u += static_cast<ScoreT>(path_counts[u]) /
+                       static_cast<ScoreT>(path_counts[v]) * (1 + deltas[v]);
+          }
+          offset ++;
+        });
+        deltas[u] = delta_u;
+        scores[u] += delta_u;
+      }
+    }
+	#if PRINT_INFO
+	    t.Stop();
+	    PrintStep("p", t.Seconds());
+	#endif
+  }
+  // normalize scores
+  ScoreT biggest_score = 0;
+  #pragma omp parallel for reduction(max : biggest_score)
+  for (NodeId n=0; n < g.num_nodes(); n++)
+    biggest_score = std::max(biggest_score, scores[n]);
+  #pragma omp parallel for
+  for (NodeId n=0; n < g.num_nodes(); n++)
+    scores[n] = scores[n] / biggest_score;
+  return scores;
+}
+
+
+const int kBatchSize = 64; // sources per multi-source BFS, one bit of a mask each
+
+/* The vertices of one level of a multi-source BFS, with the mask of the
+   sources for which they are at this depth */
+struct MSLevel {
+  std::vector<NodeId> vertices;
+  std::vector<uint64_t> masks;
+};
+
+// Multi-source BFS from sources[0..lanes), path_counts and deltas hold
+// 'lanes' values per vertex. 'visit' must be all zero, it is left so.
+template <class G>
+void MSPBFS(const G &g, const std::vector<NodeId> &sources, pvector<NodeId> &path_counts,
+            pvector<uint64_t> &seen, pvector<uint64_t> &visit, pvector<uint64_t> &next,
+            std::vector<MSLevel> &levels, SlidingQueue<NodeId> &queue) {
+  const int lanes = sources.size();
+  levels.resize(1);
+  levels[0].vertices.clear();
+  levels[0].masks.clear();
+  for (int s=0; s < lanes; s++) {
+    NodeId source = sources[s];
+    if (visit[source] == 0)
+      levels[0].vertices.push_back(source);
+    visit[source] |= uint64_t(1) << s;
+    seen[source] |= uint64_t(1) << s;
+    path_counts[int64_t(source) * lanes + s] = 1;
+  }
+  for (NodeId source : levels[0].vertices)
+    levels[0].masks.push_back(visit[source]);
+  while (!levels.back().vertices.empty()) {
+    const MSLevel &curr = levels.back();
+    // a vertex can be in several levels, for different sources
+    queue.reset();
+    #pragma omp parallel
+    {
+      QueueBuffer<NodeId> lqueue(queue);
+      #pragma omp for schedule(dynamic, 64)
+      for (size_t i=0; i < curr.vertices.size(); i++) {
+        NodeId u = curr.vertices[i];
+        uint64_t visit_u = curr.masks[i];
+        for_each_out_neigh(g, u, [&](NodeId v) {
+          // seen is only updated after the level, so these sources reach v
+          // at the next depth
+          uint64_t reached = visit_u & ~seen[v];
+          if (reached == 0)
+            return;
+          if ((next[v] & reached) != reached &&
+              __sync_fetch_and_or(&next[v], reached) == 0)
+            lqueue.push_back(v);
+          for (uint64_t m = reached; m != 0; m &= m - 1) {
+            int s = __builtin_ctzll(m);
+            fetch_and_add(path_counts[int64_t(v) * lanes + s],
+                          path_counts[int64_t(u) * lanes + s]);
+          }
+        });
+      }
+      lqueue.flush();
+    }
+    queue.slide_window();
+    // copied explicitly, vector::assign of an empty window trips -Wnonnull
+    MSLevel level;
+    level.vertices.resize(queue.size());
+    level.masks.resize(queue.size());
+    #pragma omp parallel for
+    for (size_t i=0; i < level.vertices.size(); i++) {
+      NodeId v = queue.begin()[i];
+      level.vertices[i] = v;
+      level.masks[i] = next[v];
+      seen[v] |= next[v];
+      next[v] = 0;
+    }
+    levels.push_back(std::move(level));
+  }
+  levels.pop_back();
+  for (NodeId source : levels[0].vertices)
+    visit[source] = 0;
+}
+
+// Brandes for batches of sources: a multi-source BFS followed by the
+// back-propagation of all source lanes of a level at once. path_counts and
+// deltas hold a value per vertex and lane, n * 64 * 8 bytes (512 bytes per
+// vertex) for full batches, 64 times the memory of the single-source kernel.
+template <class G>
+pvector<ScoreT> MSBrandes(const G &g, SourcePicker<G> &sp,
+                          NodeId num_iters) {
+  pvector<ScoreT> scores(g.num_nodes(), 0);
+  const int max_lanes = std::min<NodeId>(kBatchSize, std::max<NodeId>(num_iters, 1));
+  pvector<NodeId> path_counts(g.num_nodes() * int64_t(max_lanes));
+  pvector<ScoreT> deltas(g.num_nodes() * int64_t(max_lanes));
+  pvector<uint64_t> seen(g.num_nodes()), visit(g.num_nodes(), 0),
+                    next(g.num_nodes(), 0);
+  std::vector<MSLevel> levels;
+  SlidingQueue<NodeId> queue(g.num_nodes());
+  for (NodeId first=0; first < num_iters; first += max_lanes) {
+    std::vector<NodeId> sources;
+    for (NodeId iter=first; iter < std::min(first + max_lanes, num_iters); iter++)
+      sources.push_back(sp.PickNext());
+    const int lanes = sources.size();
+    const int64_t values = g.num_nodes() * int64_t(lanes);
+    std::fill(path_counts.begin(), path_counts.begin() + values, 0);
+    std::fill(deltas.begin(), deltas.begin() + values, 0);
+    seen.fill(0);
+    MSPBFS(g, sources, path_counts, seen, visit, next, levels, queue);
+    // visit holds the masks of the level below the current one
+    for (int d=levels.size()-2; d >= 0; d--) {
+      const MSLevel &below = levels[d+1];
+      #pragma omp parallel for
+      for (size_t i=0; i < below.vertices.size(); i++)
+        visit[below.vertices[i]] = below.masks[i];
+      const MSLevel &curr = levels[d];
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (size_t i=0; i < curr.vertices.size(); i++) {
+        NodeId u = curr.vertices[i];
+        uint64_t mask_u = curr.masks[i];
+        ScoreT *delta_u = &deltas[int64_t(u) * lanes];
+        const NodeId *path_counts_u = &path_counts[int64_t(u) * lanes];
+        for_each_out_neigh(g, u, [&](NodeId v) {
+          uint64_t succ = mask_u & visit[v];
+          for (uint64_t m = succ; m != 0; m &= m - 1) {
+            int s = __builtin_ctzll(m);
+            int64_t vs = int64_t(v) * lanes + s;
+            delta_u[s] += static_cast<ScoreT>(path_counts_u[s]) /
+                          static_cast<ScoreT>(path_counts[vs]) * (1 + deltas[vs]);
+          }
+        });
+      }
+      #pragma omp parallel for
+      for (size_t i=0; i < below.vertices.size(); i++)
+        visit[below.vertices[i]] = 0;
+    }
+    // in source order, as the single-source kernel
+    #pragma omp parallel for
+    for (NodeId n=0; n < g.num_nodes(); n++)
+      for (int s=0; s < lanes; s++)
+        if (seen[n] & (uint64_t(1) << s))
+          scores[n] += deltas[int64_t(n) * lanes + s];
+  }
+  // normalize scores
+  ScoreT biggest_score = 0;
+  #pragma omp parallel for reduction(max : biggest_score)
+  for (NodeId n=0; n < g.num_nodes(); n++)
+    biggest_score = std::max(biggest_score, scores[n]);
+  #pragma omp parallel for
+  for (NodeId n=0; n < g.num_nodes(); n++)
+    scores[n] = scores[n] / biggest_score;
+  return scores;
+}
+
+#endif // BRANDES_H
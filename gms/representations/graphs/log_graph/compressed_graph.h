@@ -0,0 +1,221 @@
+#ifndef Compressed_Graph_H
+#define Compressed_Graph_H
+
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gms/representations/graphs/prefetch.h>
+#include <gms/third_party/gapbs/pvector.h>
+#include "options.h"
+
+/* The common interface of the graph representations which the Log(Graph)
+   kernels run on: CSRGraph, Kbit_Adjacency_Array, Kbit_Adjacency_Array_Local,
+   Bit_Tree_Graph and the varint / Stream VByte graphs.
+
+   A compressed graph G provides num_nodes(), num_edges_directed(), directed(),
+   vertices(), out_degree(v) and out_neigh(v), a range over the sorted
+   neighbours of v. The kernels do not use out_neigh(v) directly but the two
+   access paths below, which hide the differences between the representations:
+
+   - for_each_out_neigh(g, u, f) streams the neighbours of u into f without
+     materializing them. If f returns bool, returning false stops the
+     iteration early (like 'break' in a loop).
+   - decoded_out_neigh(g, u, buffer) returns the neighbours of u as a
+     contiguous array. Neighbourhoods with a bulk decoder (decode(buffer)) are
+     decoded with it, plain arrays are returned as they are and everything else
+     is copied into 'buffer', a std::vector owned by the calling thread.
+
+   - for_each_weighted_out_neigh(g, u, f) calls f(v, w) for every neighbour
+     v of u and edge weight w of a weighted graph.
+   - prefetch_out_neigh(g, u) requests the first cache lines of the
+     neighbourhood of u, so that it can be decoded a few iterations later
+     without waiting for memory.
+   - out_edge_offsets(g) returns the position of the first out-edge of every
+     vertex, as not every representation stores edge offsets.
+
+   As the kernels are templates over G, every decode loop is compiled for the
+   representation it runs on.
+   */
+
+/* A contiguous range of decoded neighbours */
+class Neighbour_Span {
+	const NodeId* first;
+	const NodeId* last;
+
+	public:
+		Neighbour_Span(const NodeId* first, const NodeId* last) : first(first), last(last) {}
+
+		const NodeId* begin() const { return first; }
+		const NodeId* end() const { return last; }
+		int64_t size() const { return last - first; }
+};
+
+template <class G>
+using out_neighbourhood_t = decltype(std::declval<const G&>().out_neigh(NodeId()));
+
+template <class G, class = void>
+struct is_compressed_graph : std::false_type {};
+
+template <class G>
+struct is_compressed_graph<G, std::void_t<
+		decltype(std::declval<const G&>().num_nodes()),
+		decltype(std::declval<const G&>().num_edges_directed()),
+		decltype(std::declval<const G&>().directed()),
+		decltype(std::declval<const G&>().vertices()),
+		decltype(std::declval<const G&>().out_degree(NodeId())),
+		decltype(std::declval<out_neighbourhood_t<G>&>().begin())>> : std::true_type {};
+
+template <class G>
+constexpr bool is_compressed_graph_v = is_compressed_graph<G>::value;
+
+/* Whether the neighbourhoods can be decoded as a whole, the decoder may stop
+   after the neighbours up to a bound */
+template <class Neighbourhood, class = void>
+struct has_bulk_decode : std::false_type {};
+
+template <class Neighbourhood>
+struct has_bulk_decode<Neighbourhood, std::void_t<
+		decltype(std::declval<const Neighbourhood&>().decode(std::declval<std::vector<NodeId>&>())),
+		decltype(std::declval<const Neighbourhood&>().decode(std::declval<std::vector<NodeId>&>(), NodeId()))>>
+	: std::true_type {};
+
+/* Whether the neighbourhoods are plain arrays, as in a CSRGraph */
+template <class Neighbourhood>
+constexpr bool is_contiguous_neighbourhood_v =
+	std::is_pointer_v<decltype(std::declval<Neighbourhood&>().begin())>;
+
+/* Whether some neighbourhoods are stored as bit trees (Bit_Tree_Graph) */
+template <class G, class = void>
+struct has_bit_tree_neighbourhoods : std::false_type {};
+
+template <class G>
+struct has_bit_tree_neighbourhoods<G, std::void_t<
+		decltype(std::declval<const G&>().encoding(NodeId())),
+		decltype(std::declval<const G&>().bit_tree_neigh(NodeId()))>> : std::true_type {};
+
+template <class Range, class F>
+void for_each_in_neighbourhood(Range&& neighbourhood, F& f) {
+	for (NodeId v : neighbourhood) {
+		if constexpr (std::is_same_v<std::invoke_result_t<F&, NodeId>, bool>) {
+			if (!f(v)) {
+				return;
+			}
+		} else {
+			f(v);
+		}
+	}
+}
+
+/* Calls f(v) for every neighbour v of u in ascending order. If f returns
+   bool, the iteration stops as soon as f returns false. */
+template <class G, class F>
+void for_each_out_neigh(const G& g, NodeId u, F&& f) {
+	static_assert(is_compressed_graph_v<G>, "not a compressed graph");
+	if constexpr (has_bit_tree_neighbourhoods<G>::value) {
+		if (g.encoding(u)) {
+			for_each_in_neighbourhood(g.bit_tree_neigh(u), f);
+			return;
+		}
+	}
+	for_each_in_neighbourhood(g.out_neigh(u), f);
+}
+
+template <class Range>
+Neighbour_Span copy_neighbourhood(Range&& neighbourhood, std::vector<NodeId>& buffer, NodeId bound) {
+	buffer.clear();
+	for (NodeId v : neighbourhood) {
+		buffer.push_back(v);
+		if (v > bound) {
+			break;
+		}
+	}
+	return Neighbour_Span(buffer.data(), buffer.data() + buffer.size());
+}
+
+/* Returns the neighbours of u in ascending order as a contiguous array, which
+   is valid until 'buffer' is used again. If 'bound' is given, the array may end
+   after the first neighbour greater than bound. */
+template <class G>
+Neighbour_Span decoded_out_neigh(const G& g, NodeId u, std::vector<NodeId>& buffer,
+		NodeId bound = std::numeric_limits<NodeId>::max()) {
+	static_assert(is_compressed_graph_v<G>, "not a compressed graph");
+	using Neighbourhood = out_neighbourhood_t<G>;
+	if constexpr (has_bit_tree_neighbourhoods<G>::value) {
+		if (g.encoding(u)) {
+			auto decoded = g.bit_tree_neigh(u).decode(buffer, bound);
+			return Neighbour_Span(decoded.begin(), decoded.end());
+		}
+	}
+	if constexpr (has_bulk_decode<Neighbourhood>::value) {
+		auto decoded = bound == std::numeric_limits<NodeId>::max() ?
+			g.out_neigh(u).decode(buffer) : g.out_neigh(u).decode(buffer, bound);
+		return Neighbour_Span(decoded.begin(), decoded.end());
+	} else if constexpr (is_contiguous_neighbourhood_v<Neighbourhood>) {
+		auto neighbourhood = g.out_neigh(u);
+		return Neighbour_Span(neighbourhood.begin(), neighbourhood.end());
+	} else {
+		return copy_neighbourhood(g.out_neigh(u), buffer, bound);
+	}
+}
+
+/* Whether a weighted neighbour stores its ID as 'id' (Neighbour of the
+   weighted k-bit graphs) rather than as 'v' (NodeWeight of a CSRGraph) */
+template <class WeightedNeighbour, class = void>
+struct has_neighbour_id : std::false_type {};
+
+template <class WeightedNeighbour>
+struct has_neighbour_id<WeightedNeighbour, std::void_t<decltype(std::declval<WeightedNeighbour&>().id)>>
+	: std::true_type {};
+
+/* Calls f(v, w) for every neighbour v of u in ascending order, w is the
+   weight of the edge (u, v) */
+template <class G, class F>
+void for_each_weighted_out_neigh(const G& g, NodeId u, F&& f) {
+	static_assert(is_compressed_graph_v<G>, "not a compressed graph");
+	for (auto wn : g.out_neigh(u)) {
+		if constexpr (has_neighbour_id<decltype(wn)>::value) {
+			f(wn.id, wn.weight);
+		} else {
+			f(wn.v, wn.w);
+		}
+	}
+}
+
+/* Whether the graph can prefetch a neighbourhood itself */
+template <class G, class = void>
+struct has_prefetch_neighbourhood : std::false_type {};
+
+template <class G>
+struct has_prefetch_neighbourhood<G, std::void_t<
+		decltype(std::declval<const G&>().prefetch_neighbourhood(NodeId()))>> : std::true_type {};
+
+/* Prefetches the neighbourhood of u. Graphs without prefetch_neighbourhood(v)
+   and non-contiguous neighbourhoods are left to the hardware prefetcher. */
+template <class G>
+void prefetch_out_neigh(const G& g, NodeId u) {
+	static_assert(is_compressed_graph_v<G>, "not a compressed graph");
+	using Neighbourhood = out_neighbourhood_t<G>;
+	if constexpr (has_prefetch_neighbourhood<G>::value) {
+		g.prefetch_neighbourhood(u);
+	} else if constexpr (is_contiguous_neighbourhood_v<Neighbourhood>) {
+		auto neighbourhood = g.out_neigh(u);
+		prefetch_bytes(neighbourhood.begin(), (neighbourhood.end() - neighbourhood.begin()) * sizeof(NodeId));
+	}
+}
+
+/* The prefix sums of the out-degrees: the out-edges of u are at
+   [offsets[u], offsets[u+1]) of an array over all edges */
+template <class G>
+pvector<int64_t> out_edge_offsets(const G& g) {
+	static_assert(is_compressed_graph_v<G>, "not a compressed graph");
+	pvector<int64_t> offsets(g.num_nodes() + 1);
+	offsets[0] = 0;
+	for (NodeId n = 0; n < g.num_nodes(); n++) {
+		offsets[n + 1] = offsets[n] + g.out_degree(n);
+	}
+	return offsets;
+}
+
+#endif // Compressed_Graph_H
@@ -0,0 +1,70 @@
+#ifndef COMPRESSION_REPORT_H
+#define COMPRESSION_REPORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gms/third_party/gapbs/util.h>
+#include <gms/representations/graphs/coders/stream_vbyte_graph.h>
+
+/* Bits per edge of the encoders, so that permuters can be compared head to
+   head on the same graph. The sizes are the ones the builders allocate for
+   the out-neighbourhoods, computed in one parallel pass over the CSR without
+   encoding; offset arrays and the in-neighbourhoods of directed graphs are
+   not counted. The bit tree is left out, as its choice between a tree and
+   k-bit neighbours per vertex is heuristic. */
+
+namespace compression_report_detail {
+	inline uint64_t bits_for(int64_t max_value) {
+		return max_value == 0 ? 1 : std::ceil(std::log2(max_value + 1));
+	}
+}
+
+template <class Builder_, class CSR>
+void PrintBitsPerEdge(const CSR& csr) {
+	using namespace compression_report_detail;
+	const int64_t n = csr.num_nodes();
+	int64_t edges = 0;
+	int64_t max_gap = 0;
+	uint64_t kbit_local = 0, kbit_local_gap = 0;
+	uint64_t varint_byte = 0, varint_word = 0, stream_vbyte = 0;
+	#pragma omp parallel reduction(+ : edges, kbit_local, kbit_local_gap, varint_byte, varint_word, stream_vbyte) \
+	                     reduction(max : max_gap)
+	{
+		std::vector<NodeId> neighbours;
+		std::vector<uint32_t> values;
+		#pragma omp for schedule(dynamic, 1024)
+		for (NodeId u = 0; u < n; u++) {
+			int64_t degree = csr.out_degree(u);
+			int64_t max_neighbour = 0, max_local_gap = 0, prev = 0;
+			for (NodeId v : csr.out_neigh(u)) {
+				max_neighbour = std::max<int64_t>(max_neighbour, v);
+				max_local_gap = std::max<int64_t>(max_local_gap, v - prev);
+				prev = v;
+			}
+			edges += degree;
+			max_gap = std::max(max_gap, max_local_gap);
+			kbit_local += degree * bits_for(max_neighbour);
+			kbit_local_gap += degree * bits_for(max_local_gap);
+			uint64_t bytes = Builder_::encodeVarintNeighbourhood(u, degree, csr.out_neigh(u), nullptr);
+			varint_byte += 8 * bytes;
+			varint_word += 8 * ((bytes + 7) / 8 * 8);
+			stream_vbyte += 8 * StreamVByteGraph::Adjacency::EncodedSize(u, csr.out_neigh(u), neighbours, values);
+		}
+	}
+
+	auto print = [&](const std::string& encoder, double bits) {
+		printf("%-21s%3.5lf\n", ("Bits/Edge " + encoder + ":").c_str(), edges == 0 ? 0.0 : bits / edges);
+	};
+	print("kbit", double(edges) * std::ceil(std::log2(std::max<int64_t>(n, 2))));
+	print("kbit_gap", double(edges) * bits_for(max_gap));
+	print("kbit_local", kbit_local);
+	print("kbit_local_gap", kbit_local_gap);
+	print("varint_byte_based", varint_byte);
+	print("varint_word_based", varint_word);
+	print("stream_vbyte", stream_vbyte);
+}
+
+#endif // COMPRESSION_REPORT_H
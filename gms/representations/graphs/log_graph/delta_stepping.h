@@ -0,0 +1,190 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <algorithm>
+#include <cinttypes>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <gms/third_party/gapbs/benchmark.h>
+#include <gms/third_party/gapbs/platform_atomics.h>
+#include <gms/third_party/gapbs/pvector.h>
+#include <gms/third_party/gapbs/timer.h>
+#include "compressed_graph.h"
+
+/* Single-source shortest paths with delta-stepping, on every representation
+   with weighted neighbourhoods (for_each_weighted_out_neigh).
+
+   This SSSP implementation makes use of the ∆-stepping algorithm [1]. The type
+   used for weights and distances (WeightT) is typedefined in benchmark.h. The
+   delta parameter (-d) is picked from the edge weights (AutoDelta) unless it is
+   given.
+
+   The bins of width delta are actually all thread-local and of type std::vector
+   so they can grow but are otherwise capacity-proportional. Each iteration is
+   done in two phases separated by barriers. In the first phase, the current
+   shared bin is processed by all threads. As they find vertices whose distance
+   they are able to improve, they add them to their thread-local bins. During this
+   phase, each thread also votes on what the next bin should be (smallest
+   non-empty bin) with an atomic minimum. In the next phase, each thread copies
+   their selected thread-local bin into the shared bin.
+
+   Bucket fusion [2]: a thread keeps processing its local copy of the current
+   bin as long as it stays small, instead of waiting for the next iteration.
+   This removes most of the barriers on graphs with long, thin frontiers such as
+   road networks.
+
+   Distances only ever decrease, so they are lowered with a compare-and-swap
+   loop in relaxed memory order (atomic_min_relaxed) rather than a
+   sequentially consistent one. The barriers order the updates with respect
+   to the bins.
+
+   Once a vertex is added to a bin, it is not removed, even if its distance is
+   later updated and it now appears in a lower bin. We find ignoring vertices if
+   their current distance is less than the min distance for the bin to remove
+   enough redundant work that this is faster than removing the vertex from older
+   bins.
+
+   [1] Ulrich Meyer and Peter Sanders. "δ-stepping: a parallelizable shortest path
+       algorithm." Journal of Algorithms, 49(1):114–152, 2003.
+
+   [2] Yunming Zhang, Ajay Brahmakshatriya, Xinyi Chen, Laxman Dhulipala,
+       Shoaib Kamil, Saman Amarasinghe, and Julian Shun. "Optimizing Ordered
+       Graph Algorithms with GraphIt." International Symposium on Code
+       Generation and Optimization (CGO), 2020.
+   */
+
+const WeightT kDistInf = std::numeric_limits<WeightT>::max()/2;
+const size_t kMaxBin = std::numeric_limits<size_t>::max()/2;
+const size_t kBinSizeThreshold = 1000; // largest local bin which is fused
+const double kAutoDeltaFactor = 1.0;
+
+/* Lowers x to value, returns whether x was larger */
+inline bool atomic_min_relaxed(WeightT &x, WeightT value) {
+  WeightT old_value = __atomic_load_n(&x, __ATOMIC_RELAXED);
+  while (value < old_value) {
+    if (__atomic_compare_exchange_n(&x, &old_value, value, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      return true;
+  }
+  return false;
+}
+
+inline void atomic_min_relaxed(size_t &x, size_t value) {
+  size_t old_value = __atomic_load_n(&x, __ATOMIC_RELAXED);
+  while (value < old_value &&
+         !__atomic_compare_exchange_n(&x, &old_value, value, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+template <class G>
+void RelaxEdges(const G &g, NodeId u, WeightT delta, pvector<WeightT> &dist,
+                std::vector<std::vector<NodeId> > &local_bins) {
+  WeightT dist_u = __atomic_load_n(&dist[u], __ATOMIC_RELAXED);
+  for_each_weighted_out_neigh(g, u, [&](NodeId v, WeightT w) {
+    WeightT new_dist = dist_u + w;
+    if (atomic_min_relaxed(dist[v], new_dist)) {
+      size_t dest_bin = new_dist/delta;
+      if (dest_bin >= local_bins.size())
+        local_bins.resize(dest_bin+1);
+      local_bins[dest_bin].push_back(v);
+    }
+  });
+}
+
+template <class G>
+pvector<WeightT> DeltaStep(const G &g, NodeId source, WeightT delta) {
+  Timer t;
+  pvector<WeightT> dist(g.num_nodes(), kDistInf);
+  dist[source] = 0;
+  pvector<NodeId> frontier(g.num_edges_directed());
+  // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
+  size_t shared_indexes[2] = {0, kMaxBin};
+  size_t frontier_tails[2] = {1, 0};
+  frontier[0] = source;
+  t.Start();
+  #pragma omp parallel
+  {
+    std::vector<std::vector<NodeId> > local_bins(0);
+    size_t iter = 0;
+    while (shared_indexes[iter&1] != kMaxBin) {
+      size_t &curr_bin_index = shared_indexes[iter&1];
+      size_t &next_bin_index = shared_indexes[(iter+1)&1];
+      size_t &curr_frontier_tail = frontier_tails[iter&1];
+      size_t &next_frontier_tail = frontier_tails[(iter+1)&1];
+      #pragma omp for nowait schedule(dynamic, 64)
+      for (size_t i=0; i < curr_frontier_tail; i++) {
+        NodeId u = frontier[i];
+        if (dist[u] >= delta * static_cast<WeightT>(curr_bin_index))
+          RelaxEdges(g, u, delta, dist, local_bins);
+      }
+      // bucket fusion
+      while (curr_bin_index < local_bins.size() &&
+             !local_bins[curr_bin_index].empty() &&
+             local_bins[curr_bin_index].size() < kBinSizeThreshold) {
+        std::vector<NodeId> curr_bin_copy;
+        curr_bin_copy.swap(local_bins[curr_bin_index]);
+        for (NodeId u : curr_bin_copy)
+          RelaxEdges(g, u, delta, dist, local_bins);
+      }
+      for (size_t i=curr_bin_index; i < local_bins.size(); i++) {
+        if (!local_bins[i].empty()) {
+          atomic_min_relaxed(next_bin_index, i);
+          break;
+        }
+      }
+      #pragma omp barrier
+      #pragma omp single nowait
+      {
+		#if PRINT_INFO
+	        t.Stop();
+	        PrintStep(curr_bin_index, t.Millisecs(), curr_frontier_tail);
+	        t.Start();
+		#endif
+        curr_bin_index = kMaxBin;
+        curr_frontier_tail = 0;
+      }
+      if (next_bin_index < local_bins.size()) {
+        size_t copy_start = fetch_and_add(next_frontier_tail,
+                                          local_bins[next_bin_index].size());
+        std::copy(local_bins[next_bin_index].begin(),
+                  local_bins[next_bin_index].end(), frontier.data() + copy_start);
+        local_bins[next_bin_index].resize(0);
+      }
+      iter++;
+      #pragma omp barrier
+    }
+	#if PRINT_INFO
+    	#pragma omp single
+    	std::cout << "took " << iter << " iterations" << std::endl;
+	#endif
+  }
+  return dist;
+}
+
+/* Picks delta from a sample of the edge weights: the mean weight divided by
+   the average degree, so that a bin is expected to hold about as many light
+   edges as one vertex has. Taking the mean rather than the maximum weight
+   keeps a few heavy edges from blowing up the bins. */
+template <class G>
+WeightT AutoDelta(const G &g) {
+  const int64_t kSampleVertices = 1 << 12;
+  const int64_t stride = std::max<int64_t>(1, g.num_nodes() / kSampleVertices);
+  int64_t sampled_edges = 0;
+  double weight_sum = 0;
+  for (NodeId u = 0; u < g.num_nodes(); u += stride) {
+    for_each_weighted_out_neigh(g, u, [&](NodeId, WeightT w) {
+      weight_sum += w;
+      sampled_edges++;
+    });
+  }
+  if (sampled_edges == 0)
+    return 1;
+  double mean_weight = weight_sum / sampled_edges;
+  double average_degree = static_cast<double>(g.num_edges_directed()) / g.num_nodes();
+  return std::max<WeightT>(1, static_cast<WeightT>(kAutoDeltaFactor * mean_weight / average_degree));
+}
+
+
+#endif // DELTA_STEPPING_H
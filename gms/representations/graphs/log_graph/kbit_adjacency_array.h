@@ -9,6 +9,7 @@
 
 #include "kbit_neighbourhood.h"
 #include <gms/third_party/gapbs/util.h>
+#include <gms/representations/graphs/prefetch.h>
 
 #define BYTE 8
 
@@ -118,20 +119,10 @@ class Kbit_Adjacency_Array {
 			return false;
 		}
 
+		/* Requests the first cache lines of the neighbourhood of v */
 		void prefetch_neighbourhood(NodeId v) const{
 			int64_t exactBitOffset = k * (offsetArray[v]);
-			char* address = (char*)adjacencyArray + (exactBitOffset >> 3);
-			// does this introduce too much overhead ?
-			//int32_t cache_lines2 = ceil((degree(v)*k) / (64*8.0)) ;
-			int32_t cache_lines = 1 + ((degree(v)*k) >> 9); // (64*8.0)) ;
-			// cout << "degree" << degree(v)<< endl;
-			// cout << "cache_lines " << cache_lines << endl;
-			// cout << "cache_lines2 " << cache_lines2 << endl;
-			// cache line is 64 bytes
-			for(int i = 0; i < cache_lines; i++){
-				_mm_prefetch(address, _MM_HINT_T0);
-				address += 64;
-			}
+			prefetch_bytes((char*)adjacencyArray + (exactBitOffset >> 3), ((exactBitOffset & 7) + degree(v)*k + 7) >> 3);
 		}
 
 		Kbit_Neighbourhood in_neigh(NodeId v) const {
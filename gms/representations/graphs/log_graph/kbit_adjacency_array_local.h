@@ -9,6 +9,7 @@
 
 #include "kbit_neighbourhood.h"
 #include <gms/third_party/gapbs/util.h>
+#include <gms/representations/graphs/prefetch.h>
 
 #define BYTE 8
 
@@ -128,7 +129,12 @@ class Kbit_Adjacency_Array_Local {
 			return false;
 		}
 
+		/* Requests the first cache lines of the neighbourhood of v */
 		void prefetch_neighbourhood(NodeId v) const{
+			NodeId degree =    * (int32_t*) (O + 2 * v);
+			int8_t bitlength = *((int32_t*) (O + 2*v) + 1);
+			int64_t ebo =       * (int64_t*) (O + 2*v +1);
+			prefetch_bytes((char*)adjacencyArray + (ebo >> 3), ((ebo & 7) + (int64_t) degree*bitlength + 7) >> 3);
 		}
 
 		Kbit_Neighbourhood in_neigh(int64_t v) const {
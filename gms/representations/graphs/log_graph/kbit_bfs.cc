@@ -1,15 +1,20 @@
 // Copyright (c) 2015, The Regents of the University of California (Regents)
 // See LICENSE.txt for license details
 
+#include <array>
 #include <iostream>
 #include <vector>
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
 
+#include <gms/common/benchmark.h>
 #include <gms/third_party/gapbs/benchmark.h>
 #include <gms/third_party/gapbs/bitmap.h>
 #include <gms/third_party/gapbs/builder.h>
 #include <gms/third_party/gapbs/command_line.h>
-#include "kbit_adjacency_array.h"
-#include "kbit_adjacency_array_local.h"
+#include "compressed_graph.h"
+#include "representation.h"
 #include <gms/third_party/gapbs/platform_atomics.h>
 #include <gms/third_party/gapbs/pvector.h>
 #include <gms/third_party/gapbs/sliding_queue.h>
@@ -35,6 +40,13 @@ them in parent array as negative numbers. Thus the encoding of parent is:
   parent[x] < 0 implies x is unvisited and parent[x] = -out_degree(x)
   parent[x] >= 0 implies x been visited
 
+Both steps prefetch the neighbourhoods they will decode a few iterations
+ahead: the top-down step those of the vertices 'distance' positions further in
+the queue, the bottom-up step that of vertex u + distance if it is still
+unvisited. The best distance depends on the representation, the graph and the
+machine, so it is tuned at runtime by a PrefetchTuner per kind of step, unless
+it is fixed with -P.
+
 [1] Scott Beamer, Krste Asanović, and David Patterson. "Direction-Optimizing
 	Breadth-First Search." International Conference on High Performance
 	Computing, Networking, Storage and Analysis (SC), Salt Lake City, Utah,
@@ -44,40 +56,119 @@ them in parent array as negative numbers. Thus the encoding of parent is:
 
 using namespace std;
 
-int64_t BUStep(const My_Graph &g, pvector<NodeId> &parent, Bitmap &front,
-			   Bitmap &next) {
+/* Chooses the prefetch distance of one kind of BFS step from the measured
+   time per unit of work (frontier edges or unvisited vertices). Every
+   candidate is measured once, afterwards the cheapest one is used and one of
+   its neighbours is measured again every kProbePeriod steps, so that the
+   choice follows the changing frontiers. The tuner keeps its measurements
+   across the trials of a benchmark. */
+class PrefetchTuner {
+	static constexpr std::array<int, 7> kCandidates = {0, 2, 4, 8, 16, 32, 64};
+	static constexpr int64_t kMinWork = 1 << 12; // smaller steps are too noisy to measure
+	static constexpr int kProbePeriod = 8;
+
+	int fixed_;
+	std::array<double, kCandidates.size()> cost_; // ns per unit of work, < 0 if not measured
+	int best_ = 3;
+	int measuring_ = -1;
+	int64_t work_ = 0;
+	int64_t steps_ = 0;
+
+	public:
+		/* A tuner which always returns 'fixed' if it is not negative */
+		explicit PrefetchTuner(int fixed = -1) : fixed_(fixed) {
+			cost_.fill(-1);
+		}
+
+		/* The distance for a step with the given work, which is measured if large enough */
+		int Begin(int64_t work) {
+			measuring_ = -1;
+			if (fixed_ >= 0) {
+				return fixed_;
+			}
+			if (work < kMinWork) {
+				return kCandidates[best_];
+			}
+			work_ = work;
+			measuring_ = best_;
+			for (size_t i = 0; i < kCandidates.size(); i++) {
+				if (cost_[i] < 0) {
+					measuring_ = i;
+					return kCandidates[i];
+				}
+			}
+			if (++steps_ % kProbePeriod == 0) {
+				int neighbour = (steps_ / kProbePeriod) % 2 ? best_ - 1 : best_ + 1;
+				if (neighbour >= 0 && neighbour < (int) kCandidates.size()) {
+					measuring_ = neighbour;
+				}
+			}
+			return kCandidates[measuring_];
+		}
+
+		/* Records the time of the step started with the last Begin() */
+		void End(double seconds) {
+			if (measuring_ < 0) {
+				return;
+			}
+			double cost = seconds * 1e9 / work_;
+			cost_[measuring_] = cost_[measuring_] < 0 ? cost : (cost_[measuring_] + cost) / 2;
+			for (size_t i = 0; i < kCandidates.size(); i++) {
+				if (cost_[i] >= 0 && (cost_[best_] < 0 || cost_[i] < cost_[best_])) {
+					best_ = i;
+				}
+			}
+		}
+
+		int distance() const {
+			return fixed_ >= 0 ? fixed_ : kCandidates[best_];
+		}
+};
+
+template <class G>
+int64_t BUStep(const G &g, pvector<NodeId> &parent, Bitmap &front,
+			   Bitmap &next, int distance) {
 	int64_t awake_count = 0;
 	next.reset();
 
 	#pragma omp parallel for reduction(+ : awake_count) schedule(dynamic, 1024)
 	for (NodeId u=0; u < g.num_nodes(); u++) {
+		if (distance > 0 && u + distance < g.num_nodes() && parent[u + distance] < 0) {
+			prefetch_out_neigh(g, u + distance);
+		}
 		if (parent[u] < 0) {
-			ITERATE_NEIGHBOURHOOD(v, u,
+			for_each_out_neigh(g, u, [&](NodeId v) {
 				if (front.get_bit(v)) {
 					parent[u] = v;
 					awake_count++;
 					next.set_bit(u);
-					break;
+					return false;
 				}
-			)
+				return true;
+			});
 		}
 	}
   return awake_count;
 }
 
-int64_t TDStep(const My_Graph &g, pvector<NodeId> &parent,
-			   SlidingQueue<NodeId> &queue) {
+template <class G>
+int64_t TDStep(const G &g, pvector<NodeId> &parent,
+			   SlidingQueue<NodeId> &queue, int distance) {
 	int64_t scout_count = 0;
 
  	#pragma omp parallel
 	{
 	QueueBuffer<NodeId> lqueue(queue);
 
+	std::vector<NodeId> neighbours;
+
 	#pragma omp for reduction(+ : scout_count)
 	for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
+		if (distance > 0 && q_iter + distance < queue.end()) {
+			prefetch_out_neigh(g, *(q_iter + distance));
+		}
 		NodeId u = *q_iter;
-     //  	for (NodeId v : g.in_neigh(u)) {
-	 	ITERATE_NEIGHBOURHOOD(v, u,
+		for (NodeId v : decoded_out_neigh(g, u, neighbours)) {
 			NodeId curr_val = parent[v];
 			if (curr_val < 0) {
 		  		if (compare_and_swap(parent[v], curr_val, u)) {
@@ -85,7 +176,7 @@ int64_t TDStep(const My_Graph &g, pvector<NodeId> &parent,
 					scout_count += -curr_val;
 		  		}
 			}
-	  	)
+	  	}
 	}
 	lqueue.flush();
   }
@@ -100,21 +191,41 @@ void QueueToBitmap(const SlidingQueue<NodeId> &queue, Bitmap &bm) {
   }
 }
 
-void BitmapToQueue(const My_Graph &g, const Bitmap &bm,
+/* Collects the set bits of 'bm' into 'queue'. The words are scanned in
+   blocks of four, empty blocks are skipped with one AVX2 test, as the
+   frontier is sparse when the search switches back to top-down. */
+template <class G>
+void BitmapToQueue(const G &g, const Bitmap &bm,
 				   SlidingQueue<NodeId> &queue) {
+  const uint64_t* words = bm.words();
+  const int64_t num_words = bm.num_words();
   #pragma omp parallel
   {
 	QueueBuffer<NodeId> lqueue(queue);
 	#pragma omp for
-	for (NodeId n=0; n < g.num_nodes(); n++)
-	  if (bm.get_bit(n))
-		lqueue.push_back(n);
+	for (int64_t block = 0; block < num_words; block += 4) {
+	  const int64_t last = std::min(block + 4, num_words);
+	  #if defined(__AVX2__)
+		if (last - block == 4) {
+		  __m256i bits = _mm256_loadu_si256((const __m256i*) (words + block));
+		  if (_mm256_testz_si256(bits, bits)) {
+			continue;
+		  }
+		}
+	  #endif
+	  for (int64_t w = block; w < last; w++) {
+		for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+		  lqueue.push_back(w * 64 + __builtin_ctzll(word));
+		}
+	  }
+	}
 	lqueue.flush();
   }
   queue.slide_window();
 }
 
-pvector<NodeId> InitParent(const My_Graph &g) {
+template <class G>
+pvector<NodeId> InitParent(const G &g) {
   pvector<NodeId> parent(g.num_nodes());
   #pragma omp parallel for
   for (NodeId n=0; n < g.num_nodes(); n++)
@@ -122,8 +233,9 @@ pvector<NodeId> InitParent(const My_Graph &g) {
   return parent;
 }
 
-pvector<NodeId> DOBFS(const My_Graph &g, NodeId source, int alpha = 15,
-					  int beta = 18) {
+template <class G>
+pvector<NodeId> DOBFS(const G &g, NodeId source, PrefetchTuner &td_tuner,
+					  PrefetchTuner &bu_tuner, int alpha = 15, int beta = 18) {
 
 	#if PRINT_INFO
 		Timer t;
@@ -146,6 +258,8 @@ pvector<NodeId> DOBFS(const My_Graph &g, NodeId source, int alpha = 15,
 	front.reset();
 	int64_t edges_to_check = g.num_edges_directed();
 	int64_t scout_count = g.out_degree(source);
+	int64_t unvisited = g.num_nodes() - 1;
+	Timer step_timer;
 	while (!queue.empty()) {
 		if (scout_count > edges_to_check / alpha) {
 			int64_t awake_count, old_awake_count;
@@ -162,7 +276,12 @@ pvector<NodeId> DOBFS(const My_Graph &g, NodeId source, int alpha = 15,
 					t.Start();
 				#endif
 				old_awake_count = awake_count;
-				awake_count = BUStep(g, parent, front, curr);
+				int distance = bu_tuner.Begin(unvisited);
+				step_timer.Start();
+				awake_count = BUStep(g, parent, front, curr, distance);
+				step_timer.Stop();
+				bu_tuner.End(step_timer.Seconds());
+				unvisited -= awake_count;
 				front.swap(curr);
 				#if PRINT_INFO
 					t.Stop();
@@ -183,18 +302,29 @@ pvector<NodeId> DOBFS(const My_Graph &g, NodeId source, int alpha = 15,
 	  			t.Start();
 			#endif
 			edges_to_check -= scout_count;
-			scout_count = TDStep(g, parent, queue);
+			int distance = td_tuner.Begin(scout_count);
+			step_timer.Start();
+			scout_count = TDStep(g, parent, queue, distance);
+			step_timer.Stop();
+			td_tuner.End(step_timer.Seconds());
 			queue.slide_window();
+			unvisited -= queue.size();
 			#if PRINT_INFO
 				t.Stop();
 				PrintStep("td", t.Seconds(), queue.size());
 			#endif
 		}
 	}
+	// unvisited vertices still hold their negated degree
+	#pragma omp parallel for
+	for (NodeId n = 0; n < g.num_nodes(); n++)
+		if (parent[n] < -1)
+			parent[n] = -1;
 	return parent;
 }
 
-void PrintBFSStats(const My_Graph &g, const pvector<NodeId> &bfs_tree) {
+template <class G>
+void PrintBFSStats(const G &g, const pvector<NodeId> &bfs_tree) {
 	int64_t tree_size = 0;
 	int64_t n_edges = 0;
 	for (NodeId n : g.vertices()) {
@@ -213,21 +343,23 @@ void PrintBFSStats(const My_Graph &g, const pvector<NodeId> &bfs_tree) {
 // - parent[v] = u  =>  depth[v] = depth[u] + 1 (except for source)
 // - parent[v] = u  => there is edge from u to v
 // - all vertices reachable from source have a parent
-bool BFSVerifier(const My_Graph &g, NodeId source,
+template <class G>
+bool BFSVerifier(const G &g, NodeId source,
 				 const pvector<NodeId> &parent) {
 	pvector<int> depth(g.num_nodes(), -1);
 	depth[source] = 0;
 	vector<NodeId> to_visit;
 	to_visit.reserve(g.num_nodes());
 	to_visit.push_back(source);
+	vector<NodeId> neighbours;
 	for (auto it = to_visit.begin(); it != to_visit.end(); it++) {
 		NodeId u = *it;
-	 	ITERATE_NEIGHBOURHOOD(v, u,
+		for (NodeId v : decoded_out_neigh(g, u, neighbours)) {
 		  	if (depth[v] == -1) {
 				depth[v] = depth[u] + 1;
 				to_visit.push_back(v);
 		  	}
-		)
+		}
 	}
 	for (NodeId u : g.vertices()) {
 		if ((depth[u] != -1) && (parent[u] != -1)) {
@@ -239,7 +371,7 @@ bool BFSVerifier(const My_Graph &g, NodeId source,
 				continue;
 	  		}
 		  	bool parent_found = false;
-			ITERATE_NEIGHBOURHOOD(v, u,
+			for (NodeId v : decoded_out_neigh(g, u, neighbours)) {
 				if (v == parent[u]) {
 			  		if (depth[v] != depth[u] - 1) {
 						cout << "Wrong depths for " << u << " & " << v << endl;
@@ -248,7 +380,7 @@ bool BFSVerifier(const My_Graph &g, NodeId source,
 			  		parent_found = true;
 			  		break;
 				}
-			)
+			}
 		  	if (!parent_found) {
 				cout << "Couldn't find edge from " << parent[u] << " to " << u << endl;
 				return false;
@@ -262,89 +394,61 @@ bool BFSVerifier(const My_Graph &g, NodeId source,
 	return true;
 }
 
+/* Adds the prefetch distance to the options of the BFS benchmark */
+class CLPrefetch : public CLApp {
+	int prefetch_distance_ = -1;
+
+	public:
+		CLPrefetch(int argc, char** argv, std::string name) : CLApp(argc, argv, name) {
+			get_args_ += "P:";
+			AddHelpLine('P', "dist", "prefetch distance, -1 tunes it at runtime", "-1");
+		}
+
+		void HandleArg(signed char opt, char* opt_arg) override {
+			switch (opt) {
+				case 'P': prefetch_distance_ = atoi(opt_arg); break;
+				default: CLApp::HandleArg(opt, opt_arg);
+			}
+		}
+
+		int prefetch_distance() const { return prefetch_distance_; }
+};
+
 int main(int argc, char* argv[]) {
-  	CLApp cli(argc, argv, "breadth-first search");
+  	CLCompressed<CLPrefetch> cli(argc, argv, "breadth-first search");
   	if (!cli.ParseArgs()){
 		return -1;
 	}
 
 	Builder b(cli);
-	// Graph g = b.MakeGraph();
-	// My_Graph graph = b.csrToKbit(b.MakeGraph());
-	// My_Graph graph = b.csrToKbitLocal(b.MakeGraph());
-	// My_Graph graph = b.csrToMyGraph(b.MakeGraph());
-	My_Graph graph = b.make_graph_from_CSR();
-	// My_Graph graph = b.make_kbit_graph();
-	// cout << typeid(My_Graph).name() << endl;
-
-	// My_Graph graph = b.make_graph();
-	// for(int u = 0; u < g.num_nodes(); u++){
-	// 	cout << "u: ";
-	// 	for(NodeId v : g.out_neigh(u)){
-	// 		cout << v << " ";
-	// 	}
-	// 	cout << endl;
-	// }
-	// cout << endl;
-	// for(int u = 0; u < graph.num_nodes(); u++){
-	// 	cout << "u: ";
-	// 	for(NodeId v : graph.out_neigh(u)){
-	// 		cout << v << " ";
-	// 	}
-	// 	cout << endl;
-	// }
-	// int64_t total = 0;
-	// int64_t total_differences = 0;
-	// for(int u = 0; u < graph.num_nodes(); u++){
-	// 	if(graph.degree(u) == 0){
-	// 		continue;
-		// }
-	// 	int largest_in_neighbourhood = 0;
-	// 	int largest_difference = 0;
-	// 	int last = 0;
-	// 	for(NodeId v : graph.in_neigh(u)){
-	// 		if(v > largest_in_neighbourhood){
-	// 			largest_in_neighbourhood = v;
-	// 		}
-	// 		int diff = v-last;
-	// 		if(diff > largest_difference){
-	// 			largest_difference = diff;
-	// 		}
-	// 		last = v;
-	// 	}
-	// 	cout <<"largest valu " << largest_in_neighbourhood << endl;
-	// 	cout <<"largest diff " << largest_difference << endl;
-	// 	int a, b;
-	// 	if(largest_in_neighbourhood == 0){
-	// 		a = graph.degree(u)*1;
-	// 		b = graph.degree(u)*1;
-	// 	}
-	// 	else{
-	// 		a = graph.degree(u)*ceil(log2(largest_in_neighbourhood));
-	// 		b = graph.degree(u)*ceil(log2(largest_difference));
-	// 	}
-	// 	cout << graph.degree(u) <<  " neighbours" << endl ;
-	// 	cout <<"difference in bits here " << a-b << endl;
-	// 	total += a;
-	// 	total_differences += b;
-	// }
-	// cout <<"total bit difference " << total-total_differences << endl;
-	// int64_t size_in_bytes = total % 8 == 0 ? total/8 + 7 : total/8 + 8;
-	// cout << "space in bytes: " << size_in_bytes << endl;
-	// size_in_bytes = total_differences % 8 == 0 ? total_differences/8 + 7 : total_differences/8 + 8;
-	// cout << "space in bytes: " << size_in_bytes << endl;
-	//
-	// return 0;
-
-	SourcePicker<My_Graph> sp(graph, cli.start_vertex());
-	auto BFSBound = [&sp] (const My_Graph &graph) {
-		return DOBFS(graph, sp.PickNext());
-	};
-	SourcePicker<My_Graph> vsp(graph, cli.start_vertex());
-
-	auto VerifierBound = [&vsp] (const My_Graph &graph, const pvector<NodeId> &parent) {
-		  return BFSVerifier(graph, vsp.PickNext(), parent);
-	};
-	BenchmarkKernelLegacy(cli, graph, BFSBound, PrintBFSStats, VerifierBound);
+	CSRGraph csr = permute_graph(b, b.MakeGraph(), cli);
+	with_compressed_graph(b, std::move(csr), cli.representation(), [&cli] (const auto &graph) {
+		using G = std::decay_t<decltype(graph)>;
+		PrefetchTuner td_tuner(cli.prefetch_distance());
+		PrefetchTuner bu_tuner(cli.prefetch_distance());
+		SourcePicker<G> sp(graph, cli.start_vertex());
+		// warmup trials draw sources as well, so the verifier checks the source of the trial it follows
+		NodeId source = -1;
+		graph.PrintStats();
+		// the prefetch distances of the last step of every trial are recorded, they change while tuning
+		int64_t trial = 0;
+		GMS::Benchmark bench(cli);
+		bench.set_type<G>().graph(graph)
+			.info("bfs", cli.representation_name(), SIMPLE_GAP_ENCODING ? "gap" : "no_gap")
+			.run([&] {
+				     source = sp.PickNext();
+				     return DOBFS(graph, source, td_tuner, bu_tuner);
+			     },
+			     [&](const pvector<NodeId> &parent) { return BFSVerifier(graph, source, parent); },
+			     [&](const pvector<NodeId> &parent) {
+				     bench.metric("prefetch_td", td_tuner.distance());
+				     bench.metric("prefetch_bu", bu_tuner.distance());
+				     if (cli.do_analysis() && ++trial == cli.num_trials()) {
+					     PrintBFSStats(graph, parent);
+				     }
+			     });
+		PrintStep("Prefetch TD", static_cast<int64_t>(td_tuner.distance()));
+		PrintStep("Prefetch BU", static_cast<int64_t>(bu_tuner.distance()));
+	});
 	return 0;
 }
@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include <gms/common/benchmark.h>
 #include <gms/third_party/gapbs/benchmark.h>
 #include <gms/third_party/gapbs/bitmap.h>
 #include <gms/third_party/gapbs/builder.h>
@@ -14,7 +15,9 @@
 #include <gms/third_party/gapbs/graph.h>
 #include <gms/third_party/gapbs/pvector.h>
 #include <gms/third_party/gapbs/timer.h>
-#include "kbit_adjacency_array.h"
+#include "afforest.h"
+#include "compressed_graph.h"
+#include "representation.h"
 
 
 /*
@@ -24,8 +27,9 @@ Author: Scott Beamer
 
 Will return comp array labelling each vertex with a connected component ID
 
-This CC implementation makes use of the Shiloach-Vishkin [2] algorithm with
-implementation optimizations from Bader et al. [1].
+This CC implementation makes use of the Afforest [3] algorithm (afforest.h)
+by default. The Shiloach-Vishkin [2] algorithm with implementation
+optimizations from Bader et al. [1] is selected with -A sv.
 
 [1] David A Bader, Guojing Cong, and John Feo. "On the architectural
     requirements for efficient execution of graph algorithms." International
@@ -33,12 +37,17 @@ implementation optimizations from Bader et al. [1].
 
 [2] Yossi Shiloach and Uzi Vishkin. "An o(logn) parallel connectivity algorithm"
     Journal of Algorithms, 3(1):57–67, 1982.
+
+[3] Michael Sutton, Tal Ben-Nun, and Amnon Barak. "Optimizing Parallel Graph
+    Connectivity Computation via Subgraph Sampling." International Parallel
+    and Distributed Processing Symposium (IPDPS), 2018.
 */
 
 
 using namespace std;
 
-pvector<NodeId> ShiloachVishkin(const My_Graph &g) {
+template <class G>
+pvector<NodeId> ShiloachVishkin(const G &g) {
   pvector<NodeId> comp(g.num_nodes());
   #pragma omp parallel for
   for (NodeId n=0; n < g.num_nodes(); n++)
@@ -52,13 +61,13 @@ pvector<NodeId> ShiloachVishkin(const My_Graph &g) {
     for (NodeId u=0; u < g.num_nodes(); u++) {
       NodeId comp_u = comp[u];
     //   for (NodeId v : g.out_neigh(u)) {
-	  ITERATE_NEIGHBOURHOOD(v, u,
+      for_each_out_neigh(g, u, [&](NodeId v) {
         NodeId comp_v = comp[v];
         if ((comp_u < comp_v) && (comp_v == comp[comp_v])) {
           change = true;
           comp[comp_v] = comp_u;
         }
-      )
+      });
     }
     #pragma omp parallel for
     for (NodeId n=0; n < g.num_nodes(); n++) {
@@ -74,7 +83,8 @@ pvector<NodeId> ShiloachVishkin(const My_Graph &g) {
 }
 
 
-void PrintCompStats(const My_Graph &g, const pvector<NodeId> &comp) {
+template <class G>
+void PrintCompStats(const G &g, const pvector<NodeId> &comp) {
   cout << endl;
   unordered_map<NodeId, NodeId> count;
   for (NodeId comp_i : comp)
@@ -97,7 +107,8 @@ void PrintCompStats(const My_Graph &g, const pvector<NodeId> &comp) {
 // - Asserts search does not reach a vertex with a different component label
 // - If the graph is directed, it performs the search as if it was undirected
 // - Asserts every vertex is visited (degree-0 vertex should have own label)
-bool CCVerifier(const My_Graph &g, const pvector<NodeId> &comp) {
+template <class G>
+bool CCVerifier(const G &g, const pvector<NodeId> &comp) {
   unordered_map<NodeId, NodeId> label_to_source;
   for (NodeId n : g.vertices())
     label_to_source[comp[n]] = n;
@@ -105,6 +116,7 @@ bool CCVerifier(const My_Graph &g, const pvector<NodeId> &comp) {
   visited.reset();
   vector<NodeId> frontier;
   frontier.reserve(g.num_nodes());
+  vector<NodeId> neighbours;
   for (auto label_source_pair : label_to_source) {
     NodeId curr_label = label_source_pair.first;
     NodeId source = label_source_pair.second;
@@ -114,24 +126,24 @@ bool CCVerifier(const My_Graph &g, const pvector<NodeId> &comp) {
     for (auto it = frontier.begin(); it != frontier.end(); it++) {
       NodeId u = *it;
     //   for (NodeId v : g.out_neigh(u)) {
-	  ITERATE_NEIGHBOURHOOD(v, u,
+      for (NodeId v : decoded_out_neigh(g, u, neighbours)) {
         if (comp[v] != curr_label)
           return false;
         if (!visited.get_bit(v)) {
           visited.set_bit(v);
           frontier.push_back(v);
         }
-      )
+      }
       if (g.directed()) {
         // for (NodeId v : g.in_neigh(u)) {
-	 	ITERATE_NEIGHBOURHOOD(v, u,
+        for (NodeId v : decoded_out_neigh(g, u, neighbours)) {
           if (comp[v] != curr_label)
             return false;
           if (!visited.get_bit(v)) {
             visited.set_bit(v);
             frontier.push_back(v);
           }
-        )
+        }
       }
     }
   }
@@ -142,13 +154,52 @@ bool CCVerifier(const My_Graph &g, const pvector<NodeId> &comp) {
 }
 
 
+enum class CCAlgorithm {
+  Afforest,
+  ShiloachVishkin,
+};
+
+const std::pair<CCAlgorithm, const char*> cc_algorithm_names[] = {
+  {CCAlgorithm::Afforest,        "afforest"},
+  {CCAlgorithm::ShiloachVishkin, "sv"},
+};
+
+/* Adds the choice of the CC algorithm to the options of the benchmark */
+class CLCC : public CLApp {
+  CCAlgorithm algorithm_ = CCAlgorithm::Afforest;
+
+ public:
+  CLCC(int argc, char** argv, std::string name) : CLApp(argc, argv, name) {
+    get_args_ += "A:";
+    AddHelpLine('A', "algo", "CC algorithm (afforest, sv)", name_of(cc_algorithm_names, algorithm_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'A': algorithm_ = parse_name(cc_algorithm_names, opt_arg, "CC algorithm"); break;
+      default: CLApp::HandleArg(opt, opt_arg);
+    }
+  }
+
+  CCAlgorithm algorithm() const { return algorithm_; }
+};
+
 int main(int argc, char* argv[]) {
-  CLApp cli(argc, argv, "connected-components");
+  CLCompressed<CLCC> cli(argc, argv, "connected-components");
   if (!cli.ParseArgs())
     return -1;
   Builder b(cli);
-  // My_Graph g = b.make_graph();
-  My_Graph g = b.make_graph_from_CSR();
-  BenchmarkKernelLegacy(cli, g, ShiloachVishkin, PrintCompStats, CCVerifier);
+  CSRGraph csr = permute_graph(b, b.MakeGraph(), cli);
+  with_compressed_graph(b, std::move(csr), cli.representation(), [&cli] (const auto &g) {
+    using G = std::decay_t<decltype(g)>;
+    if (cli.algorithm() == CCAlgorithm::Afforest) {
+      auto AfforestBound = [] (const G &g) { return Afforest(g); };
+      BenchmarkKernelLegacy(cli, g, AfforestBound, PrintCompStats<G>, CCVerifier<G>, "cc", "afforest",
+                            cli.representation_name());
+    } else {
+      BenchmarkKernelLegacy(cli, g, ShiloachVishkin<G>, PrintCompStats<G>, CCVerifier<G>, "cc", "sv",
+                            cli.representation_name());
+    }
+  });
   return 0;
 }
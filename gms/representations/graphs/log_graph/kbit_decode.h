@@ -0,0 +1,86 @@
+#ifndef Kbit_Decode_H
+#define Kbit_Decode_H
+
+#include <inttypes.h>
+#include <cstring>
+#if defined(__BMI__) || defined(__BMI2__) || defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+/* Decoding of k-bit values from a bitstream, values are stored LSB first:
+   the value at bit position 'a' occupies the bits a, ..., a+k-1.
+
+   A single value is read with one unaligned 64-bit load at the byte which
+   contains bit 'a', followed by a shift and a mask. As a value starts at most
+   7 bits into the loaded word, k may be up to 57. The shift and the mask are
+   a single BEXTR (BMI1) or SHRX + BZHI (BMI2) instruction if the target
+   supports them.
+   */
+
+/* Returns the 64 bits starting at the byte which contains bit 'bitOffset' */
+inline uint64_t kbit_load(const void* array, int64_t bitOffset){
+	uint64_t word;
+	std::memcpy(&word, (const char*) array + (bitOffset >> 3), sizeof(word));
+	return word;
+}
+
+/* Returns the k-bit value which starts at bit 'bitOffset' */
+inline uint64_t kbit_extract(const void* array, int64_t bitOffset, int k){
+	uint64_t word = kbit_load(array, bitOffset);
+	uint32_t start = bitOffset & 7;
+	#if defined(__BMI2__)
+		return _bzhi_u64(word >> start, k);
+	#elif defined(__BMI__)
+		return _bextr_u64(word, start, k);
+	#else
+		return (word >> start) & ~(~(uint64_t) 0 << k);
+	#endif
+}
+
+/* Decodes 'count' consecutive k-bit values starting at bit 'bitOffset' into
+   'out'.
+
+   With AVX2 and k <= 25, eight values are decoded at once: eight values take
+   exactly k bytes, so the byte offsets and the shifts of the lanes are the same
+   for every group. Each 32-bit lane is filled by a byte shuffle with the four
+   bytes which contain its value, then shifted and masked. The two 128-bit
+   halves are loaded from the bytes of value 0 and value 4 respectively, as
+   the shuffle cannot cross them. Only whole groups whose loads stay inside
+   the bytes of the 'count' values are decoded this way, the rest is decoded
+   one value at a time.
+   */
+inline void kbit_decode(const void* array, int64_t bitOffset, int k, int64_t count, int32_t* out){
+	int64_t i = 0;
+	#if defined(__AVX2__)
+		if (k <= 25 && count >= 8) {
+			const char* base = (const char*) array + (bitOffset >> 3);
+			const int32_t start = bitOffset & 7;
+			const int64_t bytes = (start + count * k + 7) >> 3;
+			const int32_t high = (start + 4 * k) >> 3; // first byte of value 4
+
+			const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+			const __m256i bit = _mm256_add_epi32(_mm256_set1_epi32(start),
+				_mm256_mullo_epi32(lane, _mm256_set1_epi32(k)));
+			const __m256i shift = _mm256_and_si256(bit, _mm256_set1_epi32(7));
+			// first byte of each lane relative to its 128-bit half
+			const __m256i byte = _mm256_sub_epi32(_mm256_srli_epi32(bit, 3),
+				_mm256_setr_epi32(0, 0, 0, 0, high, high, high, high));
+			const __m256i control = _mm256_add_epi32(
+				_mm256_mullo_epi32(byte, _mm256_set1_epi32(0x01010101)),
+				_mm256_set1_epi32(0x03020100));
+			const __m256i mask = _mm256_set1_epi32((int32_t) ((1u << k) - 1));
+
+			for (int64_t group = 0; i + 8 <= count && group + high + 16 <= bytes; i += 8, group += k) {
+				__m256i words = _mm256_loadu2_m128i((const __m128i*) (base + group + high),
+				                                    (const __m128i*) (base + group));
+				__m256i values = _mm256_srlv_epi32(_mm256_shuffle_epi8(words, control), shift);
+				_mm256_storeu_si256((__m256i*) (out + i), _mm256_and_si256(values, mask));
+			}
+		}
+	#endif
+	for (; i < count; i++) {
+		out[i] = kbit_extract(array, bitOffset + i * k, k);
+	}
+}
+
+#endif // Kbit_Decode_H
@@ -0,0 +1,61 @@
+#ifndef Kbit_Encode_H
+#define Kbit_Encode_H
+
+#include <inttypes.h>
+
+/* Encoding of k-bit values into a zeroed bitstream, in the layout read by
+   kbit_decode.h: the value at bit position 'a' occupies the bits a, ..., a+k-1.
+
+   The builders encode the neighbourhoods in parallel, each into its own range
+   of bits. Only the first and the last 64-bit word of a range can be shared
+   with the ranges next to it, so these two words are combined with an atomic
+   or, every word in between is written with a plain store. The values are
+   collected in a register and written one word at a time.
+   */
+class Kbit_Writer {
+	uint64_t* words;
+	int64_t word; // index of the word being filled
+	int64_t first_word; // the first and the last word of the range, these may
+	int64_t last_word;  // be shared with other ranges
+	uint64_t buffer = 0;
+	int fill; // bits of 'buffer' in use
+
+	void store(uint64_t value){
+		if (word == first_word || word == last_word) {
+			__atomic_fetch_or(words + word, value, __ATOMIC_RELAXED);
+		} else {
+			words[word] = value;
+		}
+	}
+
+	public:
+		/* Writes to the bits [bitBegin, bitEnd) of 'array', which has to be
+		   zeroed and 8-byte aligned */
+		Kbit_Writer(void* array, int64_t bitBegin, int64_t bitEnd) :
+			words((uint64_t*) array), word(bitBegin >> 6), first_word(bitBegin >> 6),
+			last_word((bitEnd - 1) >> 6), fill(bitBegin & 63) {}
+
+		/* Appends the k lowest bits of 'value', k <= 64 */
+		void put(uint64_t value, int k){
+			if (k < 64) {
+				value &= ~(~(uint64_t) 0 << k);
+			}
+			buffer |= value << fill;
+			fill += k;
+			if (fill >= 64) {
+				store(buffer);
+				word++;
+				fill -= 64;
+				buffer = fill == 0 ? 0 : value >> (k - fill);
+			}
+		}
+
+		/* Writes the last, partial word. Has to be called after the last value. */
+		void flush(){
+			if (buffer != 0) {
+				store(buffer);
+			}
+		}
+};
+
+#endif // Kbit_Encode_H
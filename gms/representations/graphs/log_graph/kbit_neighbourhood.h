@@ -2,15 +2,17 @@
 #define Kbit_Neighbourhood_H
 
 #include <inttypes.h>
-//#include <xmmintrin.h>
-//#include <ammintrin.h>
-//#include <immintrin.h>
+#include <vector>
 #include <gms/third_party/gapbs/benchmark.h>
 #include "options.h"
+#include "kbit_decode.h"
 
 typedef int32_t NodeId;
 typedef int32_t WeightT;
 
+// number of vertices decoded at once by the bounded decode
+#define KBIT_DECODE_CHUNK 64
+
 using namespace std;
 
 // template<class T, class Tag = void>
@@ -61,23 +63,12 @@ public:
         }
 
         reference operator*() {
-            int32_t* address = adjacencyArray + (exactBitOffset >> 5);
-            int64_t d = exactBitOffset & 31;
-			int64_t value = ((int64_t*) (address))[0];
-
-			// TODO add back (cross platform compatibility issue - replace _bextr_u64)
-			throw std::runtime_error("TODO Temporariliy disabled");
-
-			/*
 			#if SIMPLE_GAP_ENCODING
-				current_vertex += _bextr_u64(value, d, k);
+				current_vertex += kbit_extract(adjacencyArray, exactBitOffset, k);
 				return current_vertex;
 			#else
-				// cout << "bar" << endl;
-            // return (value >> d) & mask;
-            	return _bextr_u64(value, d, k);
+				return kbit_extract(adjacencyArray, exactBitOffset, k);
 			#endif
-			*/
         }
     };
 
@@ -109,6 +100,64 @@ public:
        return iterator(exactBitOffset, adjacencyArray, k, j);
    }
 
+   /* A decoded neighbourhood, i.e. a range of plain vertex IDs */
+   class Decoded {
+       const NodeId* first;
+       const NodeId* last;
+   public:
+       Decoded(const NodeId* first, const NodeId* last) : first(first), last(last) {}
+       const NodeId* begin() const { return first; }
+       const NodeId* end() const { return last; }
+   };
+
+   /* Decodes the whole neighbourhood into 'out', which must have room for
+      'degree' vertices, and returns the end of the decoded vertices */
+   NodeId* decode(NodeId* out) const {
+       kbit_decode(adjacencyArray, exactBitOffset, k, degree, out);
+	   #if SIMPLE_GAP_ENCODING
+	       for (NodeId i = 1; i < degree; i++) {
+	           out[i] += out[i-1];
+	       }
+	   #endif
+       return out + degree;
+   }
+
+   /* Decodes the whole neighbourhood into 'buffer', which is grown if needed.
+      Kernels which scan whole neighbourhoods should prefer this to the
+      iterators, as the bulk decoder handles eight vertices at a time. */
+   Decoded decode(std::vector<NodeId>& buffer) const {
+       if (buffer.size() < (size_t) degree) {
+           buffer.resize(degree);
+       }
+       return Decoded(buffer.data(), decode(buffer.data()));
+   }
+
+   /* Decodes the neighbourhood in chunks until a chunk ends with a vertex
+      greater than 'bound'. The returned range holds all neighbours up to
+      'bound', followed by some larger ones. For sorted neighbourhoods which
+      are only needed up to some vertex, e.g. in triangle counting. */
+   Decoded decode(std::vector<NodeId>& buffer, NodeId bound) const {
+       if (buffer.size() < (size_t) degree) {
+           buffer.resize(degree);
+       }
+       NodeId* out = buffer.data();
+       NodeId decoded = 0;
+       while (decoded < degree) {
+           NodeId count = std::min<NodeId>(KBIT_DECODE_CHUNK, degree - decoded);
+           kbit_decode(adjacencyArray, exactBitOffset + (int64_t) decoded * k, k, count, out + decoded);
+		   #if SIMPLE_GAP_ENCODING
+		       for (NodeId i = decoded == 0 ? 1 : decoded; i < decoded + count; i++) {
+		           out[i] += out[i-1];
+		       }
+		   #endif
+           decoded += count;
+           if (out[decoded - 1] > bound) {
+               break;
+           }
+       }
+       return Decoded(out, out + decoded);
+   }
+
 };
 
 #endif // Kbit_Neighbourhood_H
@@ -5,11 +5,15 @@
 #include <iostream>
 #include <vector>
 
+#include <gms/common/benchmark.h>
 #include <gms/third_party/gapbs/benchmark.h>
 #include <gms/third_party/gapbs/builder.h>
 #include <gms/third_party/gapbs/command_line.h>
 #include <gms/third_party/gapbs/graph.h>
 #include <gms/third_party/gapbs/pvector.h>
+#include "compressed_graph.h"
+#include "pagerank.h"
+#include "representation.h"
 
 
 /*
@@ -22,48 +26,21 @@ Will return pagerank scores for all vertices once total change < epsilon
 This PR implementation uses the traditional iterative approach. This is done
 to ease comparisons to other implementations (often use same algorithm), but
 it is not necesarily the fastest way to implement it. It does perform the
-updates in the pull direction to remove the need for atomics.
+updates in the pull direction to remove the need for atomics. Propagation
+blocking [1] is selected with -A pb, or with -A pb_bf16 for contributions
+binned as bfloat16, which needs a larger tolerance (e.g. -t 1e-3). Both
+kernels are in pagerank.h.
+
+[1] Scott Beamer, Krste Asanović, and David Patterson. "Reducing PageRank
+    Communication via Propagation Blocking." International Parallel and
+    Distributed Processing Symposium (IPDPS), 2017.
 */
 
 
 using namespace std;
 
-typedef float ScoreT;
-const float kDamp = 0.85;
-
-pvector<ScoreT> PageRankPull(const My_Graph &g, int max_iters,
-                             double epsilon = 0) {
-  const ScoreT init_score = 1.0f / g.num_nodes();
-  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
-  pvector<ScoreT> scores(g.num_nodes(), init_score);
-  pvector<ScoreT> outgoing_contrib(g.num_nodes());
-  for (int iter=0; iter < max_iters; iter++) {
-    double error = 0;
-    #pragma omp parallel for
-    for (NodeId n=0; n < g.num_nodes(); n++)
-      outgoing_contrib[n] = scores[n] / g.out_degree(n);
-    #pragma omp parallel for reduction(+ : error) schedule(dynamic, 64)
-    for (NodeId u=0; u < g.num_nodes(); u++) {
-      ScoreT incoming_total = 0;
-    //   for (NodeId v : g.in_neigh(u))
-	  ITERATE_NEIGHBOURHOOD(v, u,
-        incoming_total += outgoing_contrib[v];
-	  )
-      ScoreT old_score = scores[u];
-      scores[u] = base_score + kDamp * incoming_total;
-      error += fabs(scores[u] - old_score);
-    }
-	#if PRINT_INFO
-    	printf(" %2d    %lf\n", iter, error);
-	#endif
-    if (error < epsilon)
-      break;
-  }
-  return scores;
-}
-
-
-void PrintTopScores(const My_Graph &g, const pvector<ScoreT> &scores) {
+template <class G>
+void PrintTopScores(const G &g, const pvector<ScoreT> &scores) {
   vector<pair<NodeId, ScoreT>> score_pairs(g.num_nodes());
   for (NodeId n=0; n < g.num_nodes(); n++) {
     score_pairs[n] = make_pair(n, scores[n]);
@@ -78,7 +55,8 @@ void PrintTopScores(const My_Graph &g, const pvector<ScoreT> &scores) {
 
 // Verifies by asserting a single serial iteration in push direction has
 //   error < target_error
-bool PRVerifier(const My_Graph &g, const pvector<ScoreT> &scores,
+template <class G>
+bool PRVerifier(const G &g, const pvector<ScoreT> &scores,
                         double target_error) {
   const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
   pvector<ScoreT> incomming_sums(g.num_nodes(), 0);
@@ -86,9 +64,9 @@ bool PRVerifier(const My_Graph &g, const pvector<ScoreT> &scores,
   for (NodeId u : g.vertices()) {
     ScoreT outgoing_contrib = scores[u] / g.out_degree(u);
     // for (NodeId v : g.out_neigh(u))
-	ITERATE_NEIGHBOURHOOD(v, u,
+    for_each_out_neigh(g, u, [&](NodeId v) {
       incomming_sums[v] += outgoing_contrib;
-    )
+    });
   }
   for (NodeId n : g.vertices()) {
     error += fabs(base_score + kDamp * incomming_sums[n] - scores[n]);
@@ -101,19 +79,70 @@ bool PRVerifier(const My_Graph &g, const pvector<ScoreT> &scores,
 }
 
 
+enum class PRAlgorithm {
+  Pull,
+  PropagationBlocking,
+  PropagationBlockingBF16,
+};
+
+const std::pair<PRAlgorithm, const char*> pr_algorithm_names[] = {
+  {PRAlgorithm::Pull,                    "pull"},
+  {PRAlgorithm::PropagationBlocking,     "pb"},
+  {PRAlgorithm::PropagationBlockingBF16, "pb_bf16"},
+};
+
+/* Adds the choice of the PageRank algorithm to the options of the benchmark */
+class CLPR : public CLPageRank {
+  PRAlgorithm algorithm_ = PRAlgorithm::Pull;
+
+ public:
+  CLPR(int argc, char** argv, std::string name, double tolerance, int max_iters) :
+    CLPageRank(argc, argv, name, tolerance, max_iters) {
+    get_args_ += "A:";
+    AddHelpLine('A', "algo", "PR algorithm (pull, pb, pb_bf16)", name_of(pr_algorithm_names, algorithm_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'A': algorithm_ = parse_name(pr_algorithm_names, opt_arg, "PR algorithm"); break;
+      default: CLPageRank::HandleArg(opt, opt_arg);
+    }
+  }
+
+  PRAlgorithm algorithm() const { return algorithm_; }
+};
+
 int main(int argc, char* argv[]) {
-  CLPageRank cli(argc, argv, "pagerank", 1e-4, 20);
+  CLCompressed<CLPR> cli(argc, argv, "pagerank", 1e-4, 20);
   if (!cli.ParseArgs())
     return -1;
   Builder b(cli);
-  My_Graph g = b.make_graph_from_CSR();
-  // My_Graph g = b.make_graph();
-  auto PRBound = [&cli] (const My_Graph &g) {
-    return PageRankPull(g, cli.max_iters(), cli.tolerance());
-  };
-  auto VerifierBound = [&cli] (const My_Graph &g, const pvector<ScoreT> &scores) {
-    return PRVerifier(g, scores, cli.tolerance());
-  };
-  BenchmarkKernelLegacy(cli, g, PRBound, PrintTopScores, VerifierBound);
+  CSRGraph csr = permute_graph(b, b.MakeGraph(), cli);
+  with_compressed_graph(b, std::move(csr), cli.representation(), [&cli] (const auto &g) {
+    using G = std::decay_t<decltype(g)>;
+    int64_t bytes = 0;
+    if (cli.algorithm() == PRAlgorithm::Pull)
+      bytes = PRBytesPerIteration<ScoreT>(g.num_nodes(), g.num_edges_directed(), false);
+    else if (cli.algorithm() == PRAlgorithm::PropagationBlocking)
+      bytes = PRBytesPerIteration<ScoreT>(g.num_nodes(), g.num_edges_directed(), true);
+    else
+      bytes = PRBytesPerIteration<BFloat16>(g.num_nodes(), g.num_edges_directed(), true);
+    PrintStep("PR Bytes/Iter", bytes);
+    auto PRBound = [&cli] (const G &g) {
+      switch (cli.algorithm()) {
+        case PRAlgorithm::PropagationBlocking:
+          return PageRankPB(g, cli.max_iters(), cli.tolerance());
+        case PRAlgorithm::PropagationBlockingBF16:
+          return PageRankPB<G, BFloat16>(g, cli.max_iters(), cli.tolerance());
+        default:
+          return PageRankPull(g, cli.max_iters(), cli.tolerance());
+      }
+    };
+    auto VerifierBound = [&cli] (const G &g, const pvector<ScoreT> &scores) {
+      return PRVerifier(g, scores, cli.tolerance());
+    };
+    BenchmarkKernelLegacy(cli, g, PRBound, PrintTopScores<G>, VerifierBound, "pr",
+                          name_of(pr_algorithm_names, cli.algorithm()), cli.representation_name());
+  });
   return 0;
 }
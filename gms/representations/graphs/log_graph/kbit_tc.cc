@@ -6,11 +6,13 @@
 #include <iostream>
 #include <vector>
 
+#include <gms/common/benchmark.h>
 #include <gms/third_party/gapbs/benchmark.h>
 #include <gms/third_party/gapbs/builder.h>
 #include <gms/third_party/gapbs/command_line.h>
-#include "kbit_adjacency_array.h"
 #include <gms/third_party/gapbs/pvector.h>
+#include "compressed_graph.h"
+#include "representation.h"
 
 
 /*
@@ -44,59 +46,40 @@ to relabel the graph, we use the heuristic in WorthRelabelling.
 
 using namespace std;
 
-size_t OrderedCount(const My_Graph &g) {
+// Both neighbourhoods are decoded into plain arrays, so the merge below works
+// on vertex IDs instead of iterators. Only the neighbours up to u and v
+// respectively are needed, so the decoding stops early.
+template <class G>
+size_t OrderedCount(const G &g) {
 	size_t total = 0;
-	#pragma omp parallel for reduction(+ : total) schedule(dynamic, 64)
+	#pragma omp parallel reduction(+ : total)
+	{
+	std::vector<NodeId> neighbours_u, neighbours_v;
+	#pragma omp for schedule(dynamic, 64)
 	for (NodeId u=0; u < g.num_nodes(); u++) {
-		// for (NodeId v : g.out_neigh(u)) {
-		ITERATE_NEIGHBOURHOOD(v, u,
+		auto neigh_u = decoded_out_neigh(g, u, neighbours_u, u);
+		for (NodeId v : neigh_u) {
 			if (v > u){
 				break;
 			}
-			// auto it = g.out_neigh(u).begin();
-			ITERATE_NEIGHBOURHOOD_2(it, u,
-			// for (NodeId w : g.out_neigh(v)) {
-			ITERATE_NEIGHBOURHOOD(w, v,
+			const NodeId* it = neigh_u.begin();
+			for (NodeId w : decoded_out_neigh(g, v, neighbours_v, v)) {
 				if (w > v){
 					break;
 				}
-				// This is an optimization that is needed because iterators
-				// here are not just memory addresses
-				// In the previous implementation '*it' was dereferenced twice,
-				// once in the while loop and once afterwards.
-				// No we derefrence it only once and store it in 'x'
-				NodeId x = *it;
-				while (x < w){
-					x = *(++it);
+				while (*it < w){
+					it++;
 				}
-				if (w == x){
+				if (w == *it){
 					total++;
 				}
-			)
-			)
-		)
+			}
+		}
+	}
 	}
 	return total;
 }
 
-//size_t myCount(const My_Graph &g){
-//    size_t total = 0;
-//
-//  #pragma omp parallel for reduction(+ : total) schedule(dynamic, 64)
-//    for (NodeId u=0; u < g.num_nodes(); u++) {
-//        // for (NodeId w1 : g.out_neigh(u)) {
-//		ITERATE_NEIGHBOURHOOD(w1, u,
-//            // for (NodeId w2 : g.out_neigh(u)) {
-//			ITERATE_NEIGHBOURHOOD(w2, u,
-//                if(g.connected(w1, w2)){
-//                    total ++;
-//                }
-//            )
-//        )
-//    }
-//    return total / 6;
-//}
-
 
 // uses heuristic to see if worth relabeling
 // size_t Hybrid(const Graph &g) {
@@ -108,70 +91,38 @@ size_t OrderedCount(const My_Graph &g) {
 
 
 // uses heuristic to see if worth relabeling
-My_Graph relabelIfNecessary(const CSRGraph &g, Builder b){
+CSRGraph relabelIfNecessary(CSRGraph g){
     if (WorthRelabelling(g)){
-        return b.make_graph_from_CSR(Builder::RelabelByDegree(g));
+        return Builder::RelabelByDegree(g);
     }
     else {
-        return b.make_graph_from_CSR(g);
+        return g;
     }
 }
 
-void PrintTriangleStats(const My_Graph &g, size_t total_triangles) {
+template <class G>
+void PrintTriangleStats(const G &g, size_t total_triangles) {
   cout << total_triangles << " triangles" << endl;
 }
 
 // Compares with simple serial implementation that uses std::set_intersection
-bool TCVerifier(const My_Graph &g, size_t test_total) {
+template <class G>
+bool TCVerifier(const G &g, size_t test_total) {
   size_t total = 0;
   vector<NodeId> intersection;
   intersection.reserve(g.num_nodes());
+  vector<NodeId> neighbours_u, neighbours_v;
   for (NodeId u : g.vertices()) {
-    // for (NodeId v : g.out_neigh(u)) {
-	ITERATE_NEIGHBOURHOOD(v, u,
-      #if BIT_TREE
-		if(g.encoding(u) and g.encoding(v)) {
-	      auto new_end = set_intersection(g.bit_tree_neigh(u).begin(),
-	                                      g.bit_tree_neigh(u).end(),
-	                                      g.bit_tree_neigh(v).begin(),
-	                                      g.bit_tree_neigh(v).end(),
-	                                      intersection.begin());
-      	  intersection.resize(new_end - intersection.begin());
-		}
-		else if(g.encoding(u)) {
-	      auto new_end = set_intersection(g.bit_tree_neigh(u).begin(),
-	                                      g.bit_tree_neigh(u).end(),
-	                                      g.out_neigh(v).begin(),
-	                                      g.out_neigh(v).end(),
-	                                      intersection.begin());
-      	  intersection.resize(new_end - intersection.begin());
-		}
-		else if(g.encoding(v)) {
-	      auto new_end = set_intersection(g.out_neigh(u).begin(),
-	                                      g.out_neigh(u).end(),
-	                                      g.bit_tree_neigh(v).begin(),
-	                                      g.bit_tree_neigh(v).end(),
-	                                      intersection.begin());
-      	  intersection.resize(new_end - intersection.begin());
-		}
-		else{
-	      auto new_end = set_intersection(g.out_neigh(u).begin(),
-	                                      g.out_neigh(u).end(),
-	                                      g.out_neigh(v).begin(),
-	                                      g.out_neigh(v).end(),
-	                                      intersection.begin());
-      	  intersection.resize(new_end - intersection.begin());
-		}
-	  #else
-      auto new_end = set_intersection(g.out_neigh(u).begin(),
-                                      g.out_neigh(u).end(),
-                                      g.out_neigh(v).begin(),
-                                      g.out_neigh(v).end(),
+    // decoded, as gap encoded iterators must not be dereferenced twice
+    auto neigh_u = decoded_out_neigh(g, u, neighbours_u);
+    for (NodeId v : neigh_u) {
+      auto neigh_v = decoded_out_neigh(g, v, neighbours_v);
+      auto new_end = set_intersection(neigh_u.begin(), neigh_u.end(),
+                                      neigh_v.begin(), neigh_v.end(),
                                       intersection.begin());
       intersection.resize(new_end - intersection.begin());
-	  #endif
       total += intersection.size();
-    )
+    }
   }
   total = total / 6;  // each triangle was counted 6 times
   if (total != test_total)
@@ -180,16 +131,20 @@ bool TCVerifier(const My_Graph &g, size_t test_total) {
 }
 
 int main(int argc, char* argv[]) {
-    CLApp cli(argc, argv, "triangle count");
+    CLCompressed<CLApp> cli(argc, argv, "triangle count");
     if (!cli.ParseArgs())
         return -1;
     Builder b(cli);
-    // Kbit_Adjacency_Array g = relabelIfNecessary(b.MakeGraph(), b);
-    My_Graph g = relabelIfNecessary(b.MakeGraph(), b);
-    if (g.directed()) {
+    // a permuter replaces the relabelling by degree
+    CSRGraph csr = permute_graph(b, cli.permuter() ? b.MakeGraph() : relabelIfNecessary(b.MakeGraph()), cli);
+    if (csr.directed()) {
         cout << "Input graph is directed but tc requires undirected" << endl;
         return -2;
     }
-    BenchmarkKernelLegacy(cli, g, OrderedCount, PrintTriangleStats, TCVerifier);
+    with_compressed_graph(b, std::move(csr), cli.representation(), [&cli] (const auto &g) {
+        using G = std::decay_t<decltype(g)>;
+        BenchmarkKernelLegacy(cli, g, OrderedCount<G>, PrintTriangleStats<G>, TCVerifier<G>, "tc",
+                              cli.representation_name());
+    });
     return 0;
 }
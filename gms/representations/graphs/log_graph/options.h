@@ -15,36 +15,8 @@
 	#define BIT_TREE 0
 #endif
 
-#if BIT_TREE
-	#define ITERATE_NEIGHBOURHOOD(ITERATOR, VERTEX, CODE)     \
-		if(g.encoding(VERTEX))                                \
-			for (NodeId ITERATOR: g.bit_tree_neigh(VERTEX)) { \
-				CODE                                          \
-			}                                                 \
-		else                                                  \
-			for (NodeId ITERATOR: g.out_neigh(VERTEX)) {      \
-				CODE                                          \
-			}
-
-	#define ITERATE_NEIGHBOURHOOD_2(ITERATOR, VERTEX, CODE)   \
-		if(g.encoding(VERTEX)) {                              \
-			auto ITERATOR = g.out_neigh(VERTEX).begin();      \
-			CODE                                              \
-		}                                                     \
-		else  {                                               \
-			auto ITERATOR = g.out_neigh(VERTEX).begin();      \
-			CODE                                              \
-		}
-#else
-	#define ITERATE_NEIGHBOURHOOD(ITERATOR, VERTEX, CODE)     \
-		for (NodeId ITERATOR : g.out_neigh(VERTEX)) {         \
-				CODE                                          \
-			}
-
-	#define ITERATE_NEIGHBOURHOOD_2(ITERATOR, VERTEX, CODE)   \
-			auto ITERATOR = g.out_neigh(VERTEX).begin();      \
-				CODE
-#endif
+// The kernels access neighbourhoods through compressed_graph.h, which also
+// handles the bit tree encoded neighbourhoods of Bit_Tree_Graph.
 
 typedef int32_t NodeId;
 typedef int32_t WeightT;
@@ -0,0 +1,216 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <omp.h>
+
+#include <gms/third_party/gapbs/pvector.h>
+#include "compressed_graph.h"
+
+/* PageRank in the pull direction and with propagation blocking, on every
+   representation of compressed_graph.h.
+
+   This PR implementation uses the traditional iterative approach. This is done
+   to ease comparisons to other implementations (often use same algorithm), but
+   it is not necesarily the fastest way to implement it. It does perform the
+   updates in the pull direction to remove the need for atomics.
+
+   The pull direction reads the contribution of every neighbour at random, which
+   is bound by the memory latency once the vertices do not fit in the cache.
+   PageRankPB (-A pb) uses propagation blocking [1] instead: every thread
+   streams the contributions of its sources into bins of kBinWidth consecutive
+   destinations, then every bin is accumulated on its own, with its scores in
+   the cache. The sources are split into ranges of about the same number of
+   edges, so a few high-degree vertices do not leave one thread with most of
+   the binning. The destination of every binned contribution is the same in
+   every iteration, so it is only written once. The contributions can be
+   binned as bfloat16 (-A pb_bf16), which halves the bins but keeps only 8
+   bits of mantissa, so the verifier needs a larger tolerance (e.g. -t 1e-3).
+   The new scores, the error and the contributions of the next iteration are
+   computed in one pass over each bin.
+
+   [1] Scott Beamer, Krste Asanović, and David Patterson. "Reducing PageRank
+       Communication via Propagation Blocking." International Parallel and
+       Distributed Processing Symposium (IPDPS), 2017.
+   */
+
+typedef float ScoreT;
+const float kDamp = 0.85;
+
+template <class G>
+pvector<ScoreT> PageRankPull(const G &g, int max_iters,
+                             double epsilon = 0) {
+  const ScoreT init_score = 1.0f / g.num_nodes();
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  pvector<ScoreT> scores(g.num_nodes(), init_score);
+  pvector<ScoreT> outgoing_contrib(g.num_nodes());
+  for (int iter=0; iter < max_iters; iter++) {
+    double error = 0;
+    #pragma omp parallel for
+    for (NodeId n=0; n < g.num_nodes(); n++)
+      outgoing_contrib[n] = scores[n] / g.out_degree(n);
+    #pragma omp parallel reduction(+ : error)
+    {
+    std::vector<NodeId> neighbours;
+    #pragma omp for schedule(dynamic, 64)
+    for (NodeId u=0; u < g.num_nodes(); u++) {
+      ScoreT incoming_total = 0;
+    //   for (NodeId v : g.in_neigh(u))
+      for (NodeId v : decoded_out_neigh(g, u, neighbours))
+        incoming_total += outgoing_contrib[v];
+      ScoreT old_score = scores[u];
+      scores[u] = base_score + kDamp * incoming_total;
+      error += std::fabs(scores[u] - old_score);
+    }
+    }
+	#if PRINT_INFO
+    	printf(" %2d    %lf\n", iter, error);
+	#endif
+    if (error < epsilon)
+      break;
+  }
+  return scores;
+}
+
+
+const int kBinBits = 16;
+const int64_t kBinWidth = int64_t(1) << kBinBits; // destinations per bin
+
+/* A float truncated to its upper 16 bits, rounded to nearest even */
+class BFloat16 {
+  uint16_t bits_;
+
+ public:
+  BFloat16() = default;
+
+  BFloat16(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    bits_ = (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+  }
+
+  operator float() const {
+    uint32_t x = uint32_t(bits_) << 16;
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+  }
+};
+
+/* Bytes of PageRank state read and written in one iteration, the adjacency
+   data is the same for every kernel and not counted. The pull kernel reads
+   a contribution per edge, the propagation blocking kernel writes and reads
+   a binned contribution and reads its destination per edge. */
+template <class Contrib>
+int64_t PRBytesPerIteration(int64_t num_nodes, int64_t num_edges, bool blocking) {
+  if (!blocking)
+    return num_nodes * (2 * sizeof(ScoreT) + sizeof(ScoreT)) + num_edges * sizeof(ScoreT);
+  return num_nodes * (2 * sizeof(ScoreT) + 2 * sizeof(ScoreT)) +
+         num_edges * (2 * sizeof(Contrib) + sizeof(NodeId));
+}
+
+template <class G, class Contrib = ScoreT>
+pvector<ScoreT> PageRankPB(const G &g, int max_iters, double epsilon = 0) {
+  const ScoreT init_score = 1.0f / g.num_nodes();
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  const int64_t num_bins = (g.num_nodes() + kBinWidth - 1) / kBinWidth;
+  // one source range per thread if the runtime grants them all, the ranges
+  // are shared out with omp for, so every range is binned in any case
+  const int num_ranges = omp_get_max_threads();
+  pvector<ScoreT> scores(g.num_nodes(), init_score);
+  pvector<ScoreT> outgoing_contrib(g.num_nodes());
+  // range r starts at the first vertex whose edges start at or after
+  // r * m / num_ranges, so every range holds about as many edges
+  const pvector<int64_t> edge_offsets = out_edge_offsets(g);
+  std::vector<NodeId> first_sources(num_ranges + 1);
+  for (int r = 0; r <= num_ranges; r++) {
+    const int64_t first_edge = g.num_edges_directed() * r / num_ranges;
+    first_sources[r] = std::lower_bound(edge_offsets.begin(), edge_offsets.end() - 1, first_edge) -
+                       edge_offsets.begin();
+  }
+  first_sources[num_ranges] = g.num_nodes();
+  // the contributions of range r to bin b start at bin_offsets[b * num_ranges + r]
+  pvector<int64_t> bin_offsets(num_bins * num_ranges + 1, 0);
+  #pragma omp parallel
+  {
+    std::vector<NodeId> neighbours;
+    #pragma omp for schedule(static, 1)
+    for (int r = 0; r < num_ranges; r++) {
+      for (NodeId u = first_sources[r]; u < first_sources[r + 1]; u++) {
+        for (NodeId v : decoded_out_neigh(g, u, neighbours))
+          bin_offsets[(v >> kBinBits) * num_ranges + r + 1]++;
+      }
+    }
+  }
+  for (size_t i = 1; i < bin_offsets.size(); i++)
+    bin_offsets[i] += bin_offsets[i - 1];
+  pvector<NodeId> bin_destinations(bin_offsets[num_bins * num_ranges]);
+  pvector<Contrib> bin_contribs(bin_offsets[num_bins * num_ranges]);
+  #pragma omp parallel
+  {
+    std::vector<int64_t> cursors(num_bins);
+    std::vector<NodeId> neighbours;
+    #pragma omp for schedule(static, 1)
+    for (int r = 0; r < num_ranges; r++) {
+      for (int64_t b = 0; b < num_bins; b++)
+        cursors[b] = bin_offsets[b * num_ranges + r];
+      for (NodeId u = first_sources[r]; u < first_sources[r + 1]; u++) {
+        for (NodeId v : decoded_out_neigh(g, u, neighbours))
+          bin_destinations[cursors[v >> kBinBits]++] = v;
+      }
+    }
+  }
+  #pragma omp parallel for
+  for (NodeId n=0; n < g.num_nodes(); n++)
+    outgoing_contrib[n] = init_score / g.out_degree(n);
+  for (int iter=0; iter < max_iters; iter++) {
+    #pragma omp parallel
+    {
+      std::vector<int64_t> cursors(num_bins);
+      std::vector<NodeId> neighbours;
+      #pragma omp for schedule(static, 1)
+      for (int r = 0; r < num_ranges; r++) {
+        for (int64_t b = 0; b < num_bins; b++)
+          cursors[b] = bin_offsets[b * num_ranges + r];
+        for (NodeId u = first_sources[r]; u < first_sources[r + 1]; u++) {
+          Contrib contrib = outgoing_contrib[u];
+          for (NodeId v : decoded_out_neigh(g, u, neighbours))
+            bin_contribs[cursors[v >> kBinBits]++] = contrib;
+        }
+      }
+    }
+    double error = 0;
+    #pragma omp parallel reduction(+ : error)
+    {
+      std::vector<ScoreT> sums(kBinWidth);
+      #pragma omp for schedule(dynamic, 1)
+      for (int64_t b = 0; b < num_bins; b++) {
+        const NodeId first = b * kBinWidth;
+        const NodeId last = std::min<int64_t>(first + kBinWidth, g.num_nodes());
+        std::fill(sums.begin(), sums.begin() + (last - first), 0);
+        for (int64_t i = bin_offsets[b * num_ranges];
+             i < bin_offsets[(b + 1) * num_ranges]; i++)
+          sums[bin_destinations[i] - first] += bin_contribs[i];
+        for (NodeId v = first; v < last; v++) {
+          ScoreT old_score = scores[v];
+          scores[v] = base_score + kDamp * sums[v - first];
+          error += std::fabs(scores[v] - old_score);
+          outgoing_contrib[v] = scores[v] / g.out_degree(v);
+        }
+      }
+    }
+	#if PRINT_INFO
+    	printf(" %2d    %lf\n", iter, error);
+	#endif
+    if (error < epsilon)
+      break;
+  }
+  return scores;
+}
+
+#endif // PAGERANK_H
@@ -0,0 +1,383 @@
+#ifndef Representation_H
+#define Representation_H
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <gms/common/benchmark_report.h>
+#include <gms/third_party/gapbs/builder.h>
+#include <gms/third_party/gapbs/command_line.h>
+#include <gms/representations/graphs/permuters/permuters.h>
+#include "compressed_graph.h"
+#include "compression_report.h"
+
+/* Runtime selection of the graph representation and of the vertex permuter
+   for the Log(Graph) kernels. One executable per kernel runs on every
+   representation, chosen with -c, after relabelling the vertices with the
+   permuter chosen with -o:
+
+     kbit_bfs -g 20 -c stream_vbyte -o out_degree_descending
+
+   With -B the bits per edge of every encoder are printed for the permuted
+   graph, which compares the permuters head to head (see
+   compression_report.h).
+
+   The kernels are run by GMS::Benchmark, the long options --warmup,
+   --format, --output and --counters of the GMS command line
+   (gms/common/cli/cli.h) select the warmup runs, the JSON or CSV records and
+   the hardware counters read around the kernel, e.g.
+
+     kbit_pr -g 20 -c kbit --format=json --output=pr.json --counters=cache
+
+   Gap encoding of the k-bit representations is still a compile-time option
+   (SIMPLE_GAP_ENCODING). The defaults follow the compile-time options of
+   options.h, so executables built with -DLOCAL_APPROACH=1 etc. behave as
+   before.
+   */
+
+enum class Representation {
+	CSR,
+	Kbit,
+	KbitLocal,
+	BitTree,
+	VarintByteBased,
+	VarintWordBased,
+	StreamVByte,
+};
+
+const std::pair<Representation, const char*> representation_names[] = {
+	{Representation::CSR,             "csr"},
+	{Representation::Kbit,            "kbit"},
+	{Representation::KbitLocal,       "kbit_local"},
+	{Representation::BitTree,         "bit_tree"},
+	{Representation::VarintByteBased, "varint_byte_based"},
+	{Representation::VarintWordBased, "varint_word_based"},
+	{Representation::StreamVByte,     "stream_vbyte"},
+};
+
+const std::pair<PermuterVariant, const char*> permuter_names[] = {
+	{PermuterVariant::InDegreeAscending,   "in_degree_ascending"},
+	{PermuterVariant::InDegreeDescending,  "in_degree_descending"},
+	{PermuterVariant::OutDegreeAscending,  "out_degree_ascending"},
+	{PermuterVariant::OutDegreeDescending, "out_degree_descending"},
+	{PermuterVariant::BfsOrder,            "bfs"},
+	{PermuterVariant::RecursiveBisection,  "bp"},
+	{PermuterVariant::Shingle,             "shingle"},
+	{PermuterVariant::LayeredLabelPropagation, "llp"},
+#ifdef CPLEX_ENABLED
+	{PermuterVariant::OptimalDiffNnIlpUnconstr, "optimal_diff_nn_ilp_unconstr"},
+	{PermuterVariant::OptimalDiffNnLpUnconstr,  "optimal_diff_nn_lp_unconstr"},
+	{PermuterVariant::OptimalDiffNnIlpConstr,   "optimal_diff_nn_ilp_constr"},
+	{PermuterVariant::OptimalDiffNnLpConstr,    "optimal_diff_nn_lp_constr"},
+	{PermuterVariant::OptimalDiffVnIlpUnconstr, "optimal_diff_vn_ilp_unconstr"},
+	{PermuterVariant::OptimalDiffVnLpUnconstr,  "optimal_diff_vn_lp_unconstr"},
+	{PermuterVariant::OptimalDiffVnIlpConstr,   "optimal_diff_vn_ilp_constr"},
+	{PermuterVariant::OptimalDiffVnLpConstr,    "optimal_diff_vn_lp_constr"},
+	{PermuterVariant::OIlpNnUnN,                "o_ilp_nn_un_n"},
+	{PermuterVariant::OIlpNnConN,               "o_ilp_nn_con_n"},
+	{PermuterVariant::OIlpVnUnN,                "o_ilp_vn_un_n"},
+	{PermuterVariant::OIlpVnConN,               "o_ilp_vn_con_n"},
+#endif
+};
+
+/* The representation selected by the compile-time options */
+constexpr Representation default_representation() {
+	#if LOCAL_APPROACH
+		return BIT_TREE ? Representation::BitTree : Representation::KbitLocal;
+	#elif COMPRESSED && VARINT_BYTE_BASED
+		return Representation::VarintByteBased;
+	#elif COMPRESSED && VARINT_WORD_BASED
+		return Representation::VarintWordBased;
+	#elif COMPRESSED && STREAM_VBYTE
+		return Representation::StreamVByte;
+	#else
+		return Representation::Kbit;
+	#endif
+}
+
+/* The permuter selected by the compile-time options */
+inline std::optional<PermuterVariant> default_permuter() {
+	#if PERMUTED && OUT_ASCENDING
+		return PermuterVariant::OutDegreeAscending;
+	#elif PERMUTED && OUT_DESCENDING
+		return PermuterVariant::OutDegreeDescending;
+	#elif PERMUTED && IN_ASCENDING
+		return PermuterVariant::InDegreeAscending;
+	#elif PERMUTED && IN_DESCENDING
+		return PermuterVariant::InDegreeDescending;
+	#else
+		return std::nullopt;
+	#endif
+}
+
+/* Looks up 'name' in one of the tables above, exits with the list of valid
+   names if there is no such entry */
+template <class T, size_t N>
+T parse_name(const std::pair<T, const char*> (&names)[N], const std::string& name, const char* what) {
+	for (const auto& entry : names) {
+		if (name == entry.second) {
+			return entry.first;
+		}
+	}
+	std::cout << "Unknown " << what << " '" << name << "', valid are:";
+	for (const auto& entry : names) {
+		std::cout << " " << entry.second;
+	}
+	std::cout << std::endl;
+	std::exit(-1);
+}
+
+template <class T, size_t N>
+const char* name_of(const std::pair<T, const char*> (&names)[N], T value) {
+	for (const auto& entry : names) {
+		if (value == entry.first) {
+			return entry.second;
+		}
+	}
+	return "";
+}
+
+/* Adds the options -c (representation), -o (permuter) and -B (report the bits
+   per edge) to a command line class of the GAP benchmark suite, as well as
+   the long options of the benchmark records (see ReportSpec). getopt only
+   knows short options, so the long ones are taken out of argv first. */
+template <class CLApp_>
+class CLCompressed : public CLApp_, public GMS::ReportOptions {
+	Representation representation_ = default_representation();
+	std::optional<PermuterVariant> permuter_ = default_permuter();
+	bool report_bits_ = false;
+
+	void AddLongHelpLine(const std::string& opt, const std::string& text, const std::string& def) {
+		const int kBufLen = 100;
+		char buf[kBufLen];
+		snprintf(buf, kBufLen, " --%-10s: %-54s%10s", opt.c_str(), text.c_str(),
+		         def.empty() ? "" : ("[" + def + "]").c_str());
+		this->help_strings_.push_back(buf);
+	}
+
+	/* Removes the long options from argv (as --name=value or --name value),
+	   returns the number of remaining arguments */
+	int TakeLongOptions(int argc, char** argv) {
+		int kept = 1;
+		for (int i = 1; i < argc; i++) {
+			std::string arg = argv[i];
+			std::string value;
+			auto match = [&](const std::string& name) {
+				if (arg.rfind(name + "=", 0) == 0) {
+					value = arg.substr(name.size() + 1);
+					return true;
+				}
+				if (arg == name && i + 1 < argc) {
+					value = argv[++i];
+					return true;
+				}
+				return false;
+			};
+			if (match("--warmup")) {
+				report_spec.warmup_trials = std::stoll(value);
+			} else if (match("--format")) {
+				if (!GMS::ReportSpec::valid_format(value)) {
+					std::cout << "Unknown record format '" << value << "', valid are: text json csv" << std::endl;
+					std::exit(-1);
+				}
+				report_spec.format = value;
+			} else if (match("--output")) {
+				report_spec.file = value;
+			} else if (match("--counters")) {
+				report_spec.counters = value;
+			} else {
+				argv[kept++] = argv[i];
+			}
+		}
+		return kept;
+	}
+
+	/* The name of the input in the records, as for the GMS command line */
+	void UpdateGraphName() {
+		if (this->filename_ != "") {
+			report_spec.graph_name = this->filename_;
+		} else {
+			report_spec.graph_name = std::string(this->uniform_ ? "uniform" : "kronecker") + "-" +
+			                         std::to_string(this->scale_) + "-" + std::to_string(this->degree_);
+		}
+	}
+
+	public:
+		template <class... Args>
+		CLCompressed(int argc, char** argv, Args&&... args) : CLApp_(argc, argv, std::forward<Args>(args)...) {
+			this->argc_ = TakeLongOptions(argc, argv);
+			this->get_args_ += "c:o:B";
+			this->AddHelpLine('c', "repr", "graph representation (kbit, stream_vbyte, ...)",
+				name_of(representation_names, representation_));
+			this->AddHelpLine('o', "perm", "vertex permuter (out_degree_ascending, ...)",
+				permuter_ ? name_of(permuter_names, *permuter_) : "none");
+			this->AddHelpLine('B', "", "print the bits per edge of every encoder", "false");
+			AddLongHelpLine("warmup", "number of untimed warmup runs before the trials", "0");
+			AddLongHelpLine("format", "format of the benchmark records: text, json or csv", "text");
+			AddLongHelpLine("output", "append the benchmark records to this file", "stdout");
+			AddLongHelpLine("counters", "hardware counters of the kernel (e.g. cache,TOT_INS)", "none");
+		}
+
+		void HandleArg(signed char opt, char* opt_arg) override {
+			switch (opt) {
+				case 'c':
+					representation_ = parse_name(representation_names, opt_arg, "representation");
+					break;
+				case 'o':
+					if (std::string(opt_arg) == "none") {
+						permuter_ = std::nullopt;
+					} else {
+						permuter_ = parse_name(permuter_names, opt_arg, "permuter");
+					}
+					break;
+				case 'B':
+					report_bits_ = true;
+					break;
+				default:
+					CLApp_::HandleArg(opt, opt_arg);
+					UpdateGraphName();
+			}
+		}
+
+		Representation representation() const { return representation_; }
+		const char* representation_name() const { return name_of(representation_names, representation_); }
+		std::optional<PermuterVariant> permuter() const { return permuter_; }
+		bool report_bits() const { return report_bits_; }
+};
+
+/* Relabels the vertices of 'csr' with the given permuter */
+template <class Builder_, class CSR>
+CSR permute_graph(Builder_& b, CSR csr, std::optional<PermuterVariant> permuter) {
+	if (!permuter) {
+		return csr;
+	}
+	switch (*permuter) {
+		case PermuterVariant::OutDegreeAscending:
+			return b.template permute<PermuterVariant::OutDegreeAscending>(std::move(csr));
+		case PermuterVariant::OutDegreeDescending:
+			return b.template permute<PermuterVariant::OutDegreeDescending>(std::move(csr));
+		case PermuterVariant::InDegreeAscending:
+			return b.template permute<PermuterVariant::InDegreeAscending>(std::move(csr));
+		case PermuterVariant::InDegreeDescending:
+			return b.template permute<PermuterVariant::InDegreeDescending>(std::move(csr));
+		case PermuterVariant::BfsOrder:
+			return b.template permute<PermuterVariant::BfsOrder>(std::move(csr));
+		case PermuterVariant::RecursiveBisection:
+			return b.template permute<PermuterVariant::RecursiveBisection>(std::move(csr));
+		case PermuterVariant::Shingle:
+			return b.template permute<PermuterVariant::Shingle>(std::move(csr));
+		case PermuterVariant::LayeredLabelPropagation:
+			return b.template permute<PermuterVariant::LayeredLabelPropagation>(std::move(csr));
+#ifdef CPLEX_ENABLED
+		case PermuterVariant::OptimalDiffNnIlpUnconstr:
+			return b.template permute<PermuterVariant::OptimalDiffNnIlpUnconstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffNnLpUnconstr:
+			return b.template permute<PermuterVariant::OptimalDiffNnLpUnconstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffNnIlpConstr:
+			return b.template permute<PermuterVariant::OptimalDiffNnIlpConstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffNnLpConstr:
+			return b.template permute<PermuterVariant::OptimalDiffNnLpConstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffVnIlpUnconstr:
+			return b.template permute<PermuterVariant::OptimalDiffVnIlpUnconstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffVnLpUnconstr:
+			return b.template permute<PermuterVariant::OptimalDiffVnLpUnconstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffVnIlpConstr:
+			return b.template permute<PermuterVariant::OptimalDiffVnIlpConstr>(std::move(csr));
+		case PermuterVariant::OptimalDiffVnLpConstr:
+			return b.template permute<PermuterVariant::OptimalDiffVnLpConstr>(std::move(csr));
+		case PermuterVariant::OIlpNnUnN:
+			return b.template permute<PermuterVariant::OIlpNnUnN>(std::move(csr));
+		case PermuterVariant::OIlpNnConN:
+			return b.template permute<PermuterVariant::OIlpNnConN>(std::move(csr));
+		case PermuterVariant::OIlpVnUnN:
+			return b.template permute<PermuterVariant::OIlpVnUnN>(std::move(csr));
+		case PermuterVariant::OIlpVnConN:
+			return b.template permute<PermuterVariant::OIlpVnConN>(std::move(csr));
+#endif
+	}
+	return csr;
+}
+
+/* Relabels the vertices of 'csr' with the permuter chosen on the command
+   line and prints the bits per edge of the encoders if asked to */
+template <class Builder_, class CSR, class CLApp_>
+CSR permute_graph(Builder_& b, CSR csr, const CLCompressed<CLApp_>& cli) {
+	if (cli.permuter()) {
+		Timer t;
+		t.Start();
+		csr = permute_graph(b, std::move(csr), cli.permuter());
+		t.Stop();
+		PrintTime("Permute Time", t.Seconds());
+	}
+	if (cli.report_bits()) {
+		PrintBitsPerEdge<Builder_>(csr);
+	}
+	return csr;
+}
+
+template <class G, class Builder_, class CSR, class F>
+void run_on_representation(Builder_& b, CSR& csr, F& f) {
+	G g = b.template csrToCGraphGeneric<G>(csr);
+	csr = CSR(); // the kernel only needs the compressed graph
+	f(static_cast<const G&>(g));
+}
+
+/* Encodes 'csr' in the given representation and calls f(g) with the encoded
+   graph. f is a generic lambda, so the kernel is compiled once per
+   representation. */
+template <class Builder_, class CSR, class F>
+void with_compressed_graph(Builder_& b, CSR csr, Representation representation, F&& f) {
+	switch (representation) {
+		case Representation::CSR:
+			f(static_cast<const CSR&>(csr));
+			break;
+		case Representation::Kbit:
+			run_on_representation<Kbit_Adjacency_Array>(b, csr, f);
+			break;
+		case Representation::KbitLocal:
+			run_on_representation<Kbit_Adjacency_Array_Local>(b, csr, f);
+			break;
+		case Representation::BitTree:
+			run_on_representation<Bit_Tree_Graph>(b, csr, f);
+			break;
+		case Representation::VarintByteBased:
+			run_on_representation<VarintByteBasedGraph>(b, csr, f);
+			break;
+		case Representation::VarintWordBased:
+			run_on_representation<VarintWordBasedGraph>(b, csr, f);
+			break;
+		case Representation::StreamVByte:
+			run_on_representation<StreamVByteGraph>(b, csr, f);
+			break;
+	}
+}
+
+/* As with_compressed_graph, for weighted graphs. Only the CSR and k-bit
+   representations store weights, so other representations are rejected. */
+template <class WeightedBuilder_, class WCSR, class F>
+bool with_weighted_compressed_graph(WeightedBuilder_& b, const WCSR& csr, Representation representation, F&& f) {
+	switch (representation) {
+		case Representation::CSR:
+			f(csr);
+			return true;
+		case Representation::Kbit: {
+			Kbit_Weighted_Adjacency_Array g = b.csrToWeightedKbit(csr);
+			f(static_cast<const Kbit_Weighted_Adjacency_Array&>(g));
+			return true;
+		}
+		case Representation::KbitLocal: {
+			Kbit_Weighted_Adjacency_Array_Local g = b.csrToWeightedKbitLocal(csr);
+			f(static_cast<const Kbit_Weighted_Adjacency_Array_Local&>(g));
+			return true;
+		}
+		default:
+			std::cout << "Representation '" << name_of(representation_names, representation)
+			          << "' does not support weighted graphs" << std::endl;
+			return false;
+	}
+}
+
+#endif // Representation_H
@@ -0,0 +1,97 @@
+#ifndef BFS_ORDER_PERMUTER_H
+#define BFS_ORDER_PERMUTER_H
+
+#include <limits>
+
+#include "permuter_utils.h"
+
+/* Numbers the vertices in the order in which a breadth-first search visits
+   them, starting at a vertex of maximum degree; the remaining components are
+   searched from their vertex with the smallest ID. Neighbours then get close
+   IDs, which shrinks the gaps that the gap and varint encodings store.
+
+   Every level of the search is expanded in parallel, yet the order is
+   deterministic: a vertex is the child of the frontier vertex with the
+   smallest position that reaches it and the children keep the order of their
+   parents. */
+template <class NodeId_, class DestID_, bool invert>
+class BfsOrderPermuter {
+
+public:
+
+    static pvector<NodeId_> permutation(const CSRGraphBase<NodeId_, DestID_, invert>& graph) {
+        const int64_t n = graph.num_nodes();
+        const NodeId_ unvisited = -1;
+        pvector<NodeId_> new_ids(n, unvisited);
+        pvector<int64_t> parent(n, std::numeric_limits<int64_t>::max());
+        pvector<NodeId_> frontier(n);
+        pvector<NodeId_> next(n);
+        pvector<int64_t> children(n + 1);
+
+        int64_t max_degree = 0;
+        #pragma omp parallel for reduction(max : max_degree)
+        for (NodeId_ v = 0; v < n; v++) {
+            max_degree = std::max<int64_t>(max_degree, graph.out_degree(v));
+        }
+        NodeId_ start = 0;
+        while (start < n && graph.out_degree(start) != max_degree) {
+            start++;
+        }
+
+        int64_t next_id = 0;
+        for (NodeId_ root = start, scan = 0; next_id < n; root = scan++) {
+            if (new_ids[root] != unvisited) {
+                continue;
+            }
+            new_ids[root] = next_id++;
+            frontier[0] = root;
+            int64_t frontier_size = 1;
+            while (frontier_size > 0) {
+                const bool parallel = frontier_size > 64;
+                // claim: the first frontier vertex reaching an unvisited vertex becomes its parent
+                #pragma omp parallel for schedule(dynamic, 64) if(parallel)
+                for (int64_t i = 0; i < frontier_size; i++) {
+                    for (NodeId_ u : graph.out_neigh(frontier[i])) {
+                        if (new_ids[u] == unvisited) {
+                            permuter_detail::write_min(parent[u], i);
+                        }
+                    }
+                }
+                #pragma omp parallel for schedule(dynamic, 64) if(parallel)
+                for (int64_t i = 0; i < frontier_size; i++) {
+                    int64_t count = 0;
+                    for (NodeId_ u : graph.out_neigh(frontier[i])) {
+                        count += new_ids[u] == unvisited && parent[u] == i;
+                    }
+                    children[i] = count;
+                }
+                int64_t total = 0;
+                for (int64_t i = 0; i < frontier_size; i++) {
+                    int64_t count = children[i];
+                    children[i] = total;
+                    total += count;
+                }
+                #pragma omp parallel for schedule(dynamic, 64) if(parallel)
+                for (int64_t i = 0; i < frontier_size; i++) {
+                    int64_t pos = children[i];
+                    for (NodeId_ u : graph.out_neigh(frontier[i])) {
+                        if (new_ids[u] == unvisited && parent[u] == i) {
+                            next[pos++] = u;
+                        }
+                    }
+                }
+                #pragma omp parallel for if(parallel)
+                for (int64_t j = 0; j < total; j++) {
+                    new_ids[next[j]] = next_id + j;
+                }
+                next_id += total;
+                frontier_size = total;
+                frontier.swap(next);
+            }
+        }
+        return new_ids;
+    }
+};
+
+
+#endif //BFS_ORDER_PERMUTER_H
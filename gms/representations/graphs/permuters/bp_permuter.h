@@ -0,0 +1,260 @@
+#ifndef BP_PERMUTER_H
+#define BP_PERMUTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <parallel/algorithm>
+#include <utility>
+#include <vector>
+
+#include <omp.h>
+
+#include "permuter_utils.h"
+
+/* Recursive graph bisection ("BP", Dhulipala et al., "Compressing graphs and
+   indexes with recursive graph bisection").
+
+   The out-neighbourhood of every vertex q is a query, the vertices are the
+   data to be ordered. A segment of the order is split into two halves and
+   vertices are swapped between the halves to minimize
+       sum over q of d1 * log2(n1 / (d1 + 1)) + d2 * log2(n2 / (d2 + 1)),
+   where d1 and d2 are the numbers of out-neighbours of q in the halves of
+   sizes n1 and n2, an estimate of the bits needed to gap encode the
+   neighbourhoods. Each round computes the gain of moving every vertex to
+   the other half, sorts both halves by gain and swaps the best pairs as long
+   as that reduces the cost, for at most 20 rounds or until fewer than 0.1%
+   of the vertices move. Then both halves are split recursively.
+
+   The segments of one level of the recursion are independent: while there
+   are fewer segments than threads, a segment is bisected with parallel
+   loops, afterwards the segments are bisected in parallel. Only prefix sums
+   and the half assignment are serial, O(size) per segment. Bisecting a
+   segment needs 8 bytes of scratch for each of the sorted (query, vertex)
+   pairs, the query lists and their transpose per edge into the segment, at
+   most two of them are alive at a time (16 bytes per edge). */
+template <class NodeId_, class DestID_, bool invert>
+class BpPermuter {
+
+    static constexpr int64_t leaf_size = 32;
+    static constexpr int iterations = 20;
+
+    /* Splits the segment data[0, size) into two halves, the first size/2
+       vertices form the first half */
+    static void bisect(const CSRGraphBase<NodeId_, DestID_, invert>& graph,
+                       NodeId_* data, int64_t size, bool parallel) {
+        // the queries of every vertex, as (query << 32 | local index) sorted by query
+        std::vector<int64_t> data_start(size + 1, 0);
+        for (int64_t i = 0; i < size; i++) {
+            data_start[i + 1] = data_start[i] + graph.in_degree(data[i]);
+        }
+        std::vector<uint64_t> pairs(data_start[size]);
+        #pragma omp parallel for schedule(dynamic, 256) if(parallel)
+        for (int64_t i = 0; i < size; i++) {
+            int64_t pos = data_start[i];
+            for (NodeId_ q : graph.in_neigh(data[i])) {
+                pairs[pos++] = ((uint64_t) q << 32) | (uint64_t) i;
+            }
+        }
+        if (parallel) {
+            __gnu_parallel::sort(pairs.begin(), pairs.end());
+        } else {
+            std::sort(pairs.begin(), pairs.end());
+        }
+
+        // queries with a single vertex in the segment add the same gain to every vertex
+        // of one half, which does not change the sum of a swapped pair, they are dropped.
+        // The runs of equal queries are found per thread, a static schedule keeps them sorted.
+        std::vector<int64_t> run_start;
+        {
+            std::vector<std::vector<int64_t>> local_starts(parallel ? omp_get_max_threads() : 1);
+            #pragma omp parallel if(parallel)
+            {
+                std::vector<int64_t>& starts = local_starts[omp_get_thread_num()];
+                #pragma omp for schedule(static)
+                for (size_t j = 0; j < pairs.size(); j++) {
+                    if (j == 0 || (pairs[j] >> 32) != (pairs[j - 1] >> 32)) {
+                        starts.push_back(j);
+                    }
+                }
+            }
+            for (const auto& starts : local_starts) {
+                run_start.insert(run_start.end(), starts.begin(), starts.end());
+            }
+            run_start.push_back(pairs.size());
+        }
+        const int64_t num_runs = run_start.size() - 1;
+        std::vector<int64_t> query_start;
+        std::vector<int64_t> run_offset(num_runs, -1);
+        int64_t num_query_data = 0;
+        for (int64_t r = 0; r < num_runs; r++) {
+            if (run_start[r + 1] - run_start[r] > 1) {
+                run_offset[r] = num_query_data;
+                query_start.push_back(num_query_data);
+                num_query_data += run_start[r + 1] - run_start[r];
+            }
+        }
+        const int64_t num_queries = query_start.size();
+        query_start.push_back(num_query_data);
+        std::vector<int64_t> query_data(num_query_data);
+        #pragma omp parallel for schedule(dynamic, 256) if(parallel)
+        for (int64_t r = 0; r < num_runs; r++) {
+            if (run_offset[r] >= 0) {
+                for (int64_t k = run_start[r]; k < run_start[r + 1]; k++) {
+                    query_data[run_offset[r] + k - run_start[r]] = pairs[k] & 0xffffffffULL;
+                }
+            }
+        }
+        std::vector<int64_t>().swap(run_start);
+        std::vector<int64_t>().swap(run_offset);
+        std::vector<uint64_t>().swap(pairs);
+
+        // the transpose: the queries of every vertex, scattered with atomic cursors
+        // and sorted afterwards, so the gains are summed in the same order for any schedule
+        std::fill(data_start.begin(), data_start.end(), 0);
+        #pragma omp parallel for if(parallel)
+        for (int64_t j = 0; j < num_query_data; j++) {
+            fetch_and_add(data_start[query_data[j] + 1], int64_t(1));
+        }
+        for (int64_t i = 0; i < size; i++) {
+            data_start[i + 1] += data_start[i];
+        }
+        std::vector<int64_t> data_queries(num_query_data);
+        {
+            std::vector<int64_t> pos(data_start.begin(), data_start.end() - 1);
+            #pragma omp parallel for schedule(dynamic, 256) if(parallel)
+            for (int64_t q = 0; q < num_queries; q++) {
+                for (int64_t j = query_start[q]; j < query_start[q + 1]; j++) {
+                    data_queries[fetch_and_add(pos[query_data[j]], int64_t(1))] = q;
+                }
+            }
+        }
+        if (parallel) {
+            #pragma omp parallel for schedule(dynamic, 256)
+            for (int64_t i = 0; i < size; i++) {
+                std::sort(data_queries.begin() + data_start[i], data_queries.begin() + data_start[i + 1]);
+            }
+        }
+
+        const int64_t n1 = size / 2;
+        const int64_t n2 = size - n1;
+        std::vector<double> log_table(size + 2);
+        for (int64_t d = 0; d < size + 2; d++) {
+            log_table[d] = std::log2((double) d + 1);
+        }
+        const double log_n1 = std::log2((double) n1);
+        const double log_n2 = std::log2((double) n2);
+        auto cost = [&](int64_t d1, int64_t d2) {
+            return d1 * (log_n1 - log_table[d1]) + d2 * (log_n2 - log_table[d2]);
+        };
+
+        std::vector<char> side(size);
+        for (int64_t i = 0; i < size; i++) {
+            side[i] = i >= n1;
+        }
+        // the gain of moving a vertex of the query from the left to the right half and vice versa
+        std::vector<double> gain_to_right(num_queries);
+        std::vector<double> gain_to_left(num_queries);
+        std::vector<double> gain(size);
+        std::vector<std::pair<double, int64_t>> left, right;
+        left.reserve(n1);
+        right.reserve(n2);
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            #pragma omp parallel for schedule(dynamic, 256) if(parallel)
+            for (int64_t q = 0; q < num_queries; q++) {
+                int64_t d2 = 0;
+                for (int64_t j = query_start[q]; j < query_start[q + 1]; j++) {
+                    d2 += side[query_data[j]];
+                }
+                int64_t d1 = query_start[q + 1] - query_start[q] - d2;
+                double current = cost(d1, d2);
+                gain_to_right[q] = d1 > 0 ? current - cost(d1 - 1, d2 + 1) : 0;
+                gain_to_left[q] = d2 > 0 ? current - cost(d1 + 1, d2 - 1) : 0;
+            }
+            #pragma omp parallel for schedule(dynamic, 256) if(parallel)
+            for (int64_t i = 0; i < size; i++) {
+                const std::vector<double>& query_gain = side[i] ? gain_to_left : gain_to_right;
+                double g = 0;
+                for (int64_t j = data_start[i]; j < data_start[i + 1]; j++) {
+                    g += query_gain[data_queries[j]];
+                }
+                gain[i] = g;
+            }
+
+            left.clear();
+            right.clear();
+            for (int64_t i = 0; i < size; i++) {
+                (side[i] ? right : left).emplace_back(-gain[i], i);
+            }
+            if (parallel) {
+                __gnu_parallel::sort(left.begin(), left.end());
+                __gnu_parallel::sort(right.begin(), right.end());
+            } else {
+                std::sort(left.begin(), left.end());
+                std::sort(right.begin(), right.end());
+            }
+            int64_t swaps = 0;
+            for (; swaps < n1 && swaps < n2; swaps++) {
+                if (-left[swaps].first - right[swaps].first <= 0) {
+                    break;
+                }
+                side[left[swaps].second] = 1;
+                side[right[swaps].second] = 0;
+            }
+            if (swaps <= size / 1000) {
+                break;
+            }
+        }
+
+        // both halves keep the relative order of their vertices
+        std::vector<NodeId_> halves(size);
+        int64_t next_left = 0, next_right = n1;
+        for (int64_t i = 0; i < size; i++) {
+            halves[side[i] ? next_right++ : next_left++] = data[i];
+        }
+        std::copy(halves.begin(), halves.end(), data);
+    }
+
+public:
+
+    static pvector<NodeId_> permutation(const CSRGraphBase<NodeId_, DestID_, invert>& graph) {
+        const int64_t n = graph.num_nodes();
+        pvector<NodeId_> order(n);
+        #pragma omp parallel for
+        for (NodeId_ v = 0; v < n; v++) {
+            order[v] = v;
+        }
+
+        std::vector<std::pair<int64_t, int64_t>> segments; // begin and size
+        if (n > leaf_size) {
+            segments.emplace_back(0, n);
+        }
+        while (!segments.empty()) {
+            if ((int64_t) segments.size() >= omp_get_max_threads()) {
+                #pragma omp parallel for schedule(dynamic, 1)
+                for (size_t s = 0; s < segments.size(); s++) {
+                    bisect(graph, order.begin() + segments[s].first, segments[s].second, false);
+                }
+            } else {
+                for (auto segment : segments) {
+                    bisect(graph, order.begin() + segment.first, segment.second, true);
+                }
+            }
+            std::vector<std::pair<int64_t, int64_t>> halves;
+            for (auto segment : segments) {
+                int64_t n1 = segment.second / 2;
+                int64_t n2 = segment.second - n1;
+                if (n1 > leaf_size) {
+                    halves.emplace_back(segment.first, n1);
+                }
+                if (n2 > leaf_size) {
+                    halves.emplace_back(segment.first + n1, n2);
+                }
+            }
+            segments.swap(halves);
+        }
+        return permuter_detail::order_to_permutation(order);
+    }
+};
+
+
+#endif //BP_PERMUTER_H
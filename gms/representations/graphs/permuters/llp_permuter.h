@@ -0,0 +1,152 @@
+#ifndef LLP_PERMUTER_H
+#define LLP_PERMUTER_H
+
+#include <algorithm>
+#include <limits>
+#include <parallel/algorithm>
+#include <tuple>
+#include <vector>
+
+#include "permuter_utils.h"
+
+/* Layered label propagation (Boldi et al., "Layered label propagation: a
+   multiresolution coordinate-free ordering for compressing social networks").
+
+   For every resolution gamma, label propagation clusters the vertices: a
+   vertex takes the label l that maximizes k_l - gamma * (v_l - k_l), where
+   k_l is the number of its neighbours with label l and v_l the number of
+   vertices with label l. The vertex order is then refined so that the
+   clusters are contiguous, a cluster starts where its first vertex was and
+   the vertices within a cluster keep their order. The resolutions go from
+   fine (gamma = 1) to coarse (gamma = 0), so the coarse clusters are laid
+   out as a whole and the fine clusters nest inside them.
+
+   The propagation is asynchronous and parallel, the volumes are updated with
+   atomics. */
+template <class NodeId_, class DestID_, bool invert>
+class LlpPermuter {
+
+    static constexpr int max_iterations = 10;
+
+    /* Label propagation with resolution gamma, returns the label of every vertex */
+    static pvector<NodeId_> propagate(const CSRGraphBase<NodeId_, DestID_, invert>& graph,
+                                      const pvector<NodeId_>& visit_order, double gamma) {
+        const int64_t n = graph.num_nodes();
+        pvector<NodeId_> labels(n);
+        pvector<int64_t> volume(n, 1);
+        #pragma omp parallel for
+        for (NodeId_ v = 0; v < n; v++) {
+            labels[v] = v;
+        }
+
+        for (int iteration = 0; iteration < max_iterations; iteration++) {
+            int64_t changed = 0;
+            #pragma omp parallel reduction(+ : changed)
+            {
+                std::vector<NodeId_> neighbour_labels;
+                #pragma omp for schedule(dynamic, 256)
+                for (int64_t i = 0; i < n; i++) {
+                    NodeId_ v = visit_order[i];
+                    neighbour_labels.clear();
+                    for (NodeId_ u : graph.out_neigh(v)) {
+                        neighbour_labels.push_back(labels[u]);
+                    }
+                    if (graph.directed()) {
+                        for (NodeId_ u : graph.in_neigh(v)) {
+                            neighbour_labels.push_back(labels[u]);
+                        }
+                    }
+                    if (neighbour_labels.empty()) {
+                        continue;
+                    }
+                    std::sort(neighbour_labels.begin(), neighbour_labels.end());
+
+                    const NodeId_ current = labels[v];
+                    auto score = [&](NodeId_ label, int64_t k) {
+                        // v itself does not count towards the volume of its own label
+                        int64_t others = volume[label] - (label == current);
+                        return k - gamma * (others - k);
+                    };
+                    NodeId_ best = current;
+                    double best_score = score(current, 0);
+                    for (size_t j = 0; j < neighbour_labels.size();) {
+                        size_t run = j;
+                        while (run < neighbour_labels.size() && neighbour_labels[run] == neighbour_labels[j]) {
+                            run++;
+                        }
+                        NodeId_ label = neighbour_labels[j];
+                        double s = score(label, run - j);
+                        if (label == current ? s >= best_score : s > best_score) {
+                            best = label;
+                            best_score = s;
+                        }
+                        j = run;
+                    }
+                    if (best != current) {
+                        fetch_and_add(volume[current], -1);
+                        fetch_and_add(volume[best], 1);
+                        labels[v] = best;
+                        changed++;
+                    }
+                }
+            }
+            if (changed <= n / 1000) {
+                break;
+            }
+        }
+        return labels;
+    }
+
+public:
+
+    static pvector<NodeId_> permutation(const CSRGraphBase<NodeId_, DestID_, invert>& graph) {
+        const int64_t n = graph.num_nodes();
+        const double gammas[] = {1.0, 0.5, 0.25, 0.125, 0.0625, 0.0};
+
+        // the propagation visits the vertices in a fixed pseudo-random order
+        pvector<std::pair<uint64_t, NodeId_>> hashed(n);
+        #pragma omp parallel for
+        for (NodeId_ v = 0; v < n; v++) {
+            hashed[v] = std::make_pair(permuter_detail::mix_hash(v, 3), v);
+        }
+        __gnu_parallel::sort(hashed.begin(), hashed.end());
+        pvector<NodeId_> visit_order(n);
+        pvector<NodeId_> order(n);
+        pvector<int64_t> position(n);
+        #pragma omp parallel for
+        for (int64_t i = 0; i < n; i++) {
+            visit_order[i] = hashed[i].second;
+            order[i] = i;
+            position[i] = i;
+        }
+
+        using Key = std::tuple<int64_t, int64_t, NodeId_>;
+        pvector<Key> keys(n);
+        pvector<int64_t> first(n);
+        for (double gamma : gammas) {
+            pvector<NodeId_> labels = propagate(graph, visit_order, gamma);
+            #pragma omp parallel for
+            for (NodeId_ v = 0; v < n; v++) {
+                first[v] = std::numeric_limits<int64_t>::max();
+            }
+            #pragma omp parallel for
+            for (NodeId_ v = 0; v < n; v++) {
+                permuter_detail::write_min(first[labels[v]], position[v]);
+            }
+            #pragma omp parallel for
+            for (NodeId_ v = 0; v < n; v++) {
+                keys[v] = Key(first[labels[v]], position[v], v);
+            }
+            __gnu_parallel::sort(keys.begin(), keys.end());
+            #pragma omp parallel for
+            for (int64_t i = 0; i < n; i++) {
+                order[i] = std::get<2>(keys[i]);
+                position[order[i]] = i;
+            }
+        }
+        return permuter_detail::order_to_permutation(order);
+    }
+};
+
+
+#endif //LLP_PERMUTER_H
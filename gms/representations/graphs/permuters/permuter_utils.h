@@ -0,0 +1,49 @@
+#ifndef PERMUTER_UTILS_H
+#define PERMUTER_UTILS_H
+
+#include <cstdint>
+
+#include <gms/common/random.h>
+#include <gms/third_party/gapbs/platform_atomics.h>
+#include <gms/third_party/gapbs/pvector.h>
+
+/* Helpers of the heuristic permuters (BFS order, recursive bisection,
+   shingle and layered label propagation). These permuters return the new ID
+   of every vertex as a pvector instead of a std::map, so that they scale to
+   graphs with billions of edges. */
+namespace permuter_detail {
+
+    /* Turns a vertex order (order[i] is the i-th vertex) into the new ID of
+       every vertex */
+    template <class NodeId_>
+    pvector<NodeId_> order_to_permutation(const pvector<NodeId_>& order) {
+        pvector<NodeId_> new_ids(order.size());
+        #pragma omp parallel for
+        for (int64_t i = 0; i < (int64_t) order.size(); i++) {
+            new_ids[order[i]] = i;
+        }
+        return new_ids;
+    }
+
+    /* Atomically sets x to min(x, value), returns true if x was changed */
+    template <class T>
+    bool write_min(T& x, T value) {
+        T old = x;
+        while (value < old) {
+            if (compare_and_swap(x, old, value)) {
+                return true;
+            }
+            old = x;
+        }
+        return false;
+    }
+
+    /* Hashes x with the splitmix64 finalizer, different seeds give
+       independent hash functions */
+    inline uint64_t mix_hash(uint64_t x, uint64_t seed) {
+        return GMS::Random::mix64(x + seed * 0x9e3779b97f4a7c15ULL);
+    }
+
+} // namespace permuter_detail
+
+#endif //PERMUTER_UTILS_H
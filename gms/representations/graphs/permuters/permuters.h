@@ -6,6 +6,10 @@
 #include <gms/representations/graphs/permuters/in_degree_descending_permuter.h>
 #include <gms/representations/graphs/permuters/out_degree_ascending_permuter.h>
 #include <gms/representations/graphs/permuters/out_degree_descending_permuter.h>
+#include <gms/representations/graphs/permuters/bfs_order_permuter.h>
+#include <gms/representations/graphs/permuters/bp_permuter.h>
+#include <gms/representations/graphs/permuters/shingle_permuter.h>
+#include <gms/representations/graphs/permuters/llp_permuter.h>
 
 #if CPLEX_ENABLED
 #include <gms/representations/graphs/permuters/optimal_diff_nn_ilp_unconstr_permuter.h>
@@ -27,6 +31,10 @@ enum struct PermuterVariant {
     OutDegreeDescending,
     InDegreeAscending,
     InDegreeDescending,
+    BfsOrder,
+    RecursiveBisection,
+    Shingle,
+    LayeredLabelPropagation,
 #ifdef CPLEX_ENABLED
     OptimalDiffNnIlpUnconstr,
     OptimalDiffNnLpUnconstr,
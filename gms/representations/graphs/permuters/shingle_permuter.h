@@ -0,0 +1,46 @@
+#ifndef SHINGLE_PERMUTER_H
+#define SHINGLE_PERMUTER_H
+
+#include <limits>
+#include <parallel/algorithm>
+#include <tuple>
+
+#include "permuter_utils.h"
+
+/* Shingle ordering (Chierichetti et al., "On compressing social networks"):
+   sorts the vertices by the min-hash of their out-neighbourhood, ties are
+   broken by a second, independent min-hash and then by the ID. Vertices with
+   similar neighbourhoods, which likely share a min-hash, get consecutive IDs,
+   so their neighbours are close as well. */
+template <class NodeId_, class DestID_, bool invert>
+class ShinglePermuter {
+
+public:
+
+    static pvector<NodeId_> permutation(const CSRGraphBase<NodeId_, DestID_, invert>& graph) {
+        const int64_t n = graph.num_nodes();
+        using Key = std::tuple<uint64_t, uint64_t, NodeId_>;
+        pvector<Key> keys(n);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeId_ v = 0; v < n; v++) {
+            uint64_t shingle1 = std::numeric_limits<uint64_t>::max();
+            uint64_t shingle2 = std::numeric_limits<uint64_t>::max();
+            for (NodeId_ u : graph.out_neigh(v)) {
+                shingle1 = std::min(shingle1, permuter_detail::mix_hash(u, 1));
+                shingle2 = std::min(shingle2, permuter_detail::mix_hash(u, 2));
+            }
+            keys[v] = Key(shingle1, shingle2, v);
+        }
+        __gnu_parallel::sort(keys.begin(), keys.end());
+
+        pvector<NodeId_> order(n);
+        #pragma omp parallel for
+        for (int64_t i = 0; i < n; i++) {
+            order[i] = std::get<2>(keys[i]);
+        }
+        return permuter_detail::order_to_permutation(order);
+    }
+};
+
+
+#endif //SHINGLE_PERMUTER_H
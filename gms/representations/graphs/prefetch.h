@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cinttypes>
+
+/**
+ * Number of cache lines that prefetch_bytes() requests at most. The hardware
+ * prefetcher follows a sequential stream on its own once it has been started,
+ * so prefetching all of a large neighbourhood only wastes load slots.
+ */
+constexpr int64_t PREFETCH_MAX_LINES = 4;
+
+/**
+ * Requests the cache lines of [address, address + bytes), at most PREFETCH_MAX_LINES of them.
+ * Used by the prefetch_neighbourhood(v) methods of the compressed graphs.
+ */
+inline void prefetch_bytes(const void *address, int64_t bytes)
+{
+    constexpr int64_t line = 64;
+    const char *first = (const char *) ((uintptr_t) address & ~(uintptr_t) (line - 1));
+    const char *last = (const char *) address + bytes;
+    for (int64_t i = 0; i < PREFETCH_MAX_LINES && first < last; i++, first += line) {
+        __builtin_prefetch(first, 0, 3);
+    }
+}
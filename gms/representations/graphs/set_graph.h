@@ -6,6 +6,9 @@
 #include <gms/representations/sets/sorted_set_ref.h>
 #include <gms/representations/sets/roaring_set.h>
 #include <gms/representations/sets/robin_hood_set.h>
+#include <gms/representations/sets/kbit_set.h>
+#include <gms/representations/sets/varint_set.h>
+#include "degree_weights.h"
 
 template <class SetType>
 class SetGraph {
@@ -58,9 +61,8 @@ public:
             std::sort(edge_list.begin(), edge_list.end());
         }
 
-        SetGraph graph(num_nodes);
-
-        graph.neighborhoods.reserve(num_nodes);
+        std::vector<Set> neighborhoods;
+        neighborhoods.reserve(num_nodes);
         auto edge_iterator = edge_list.begin();
         std::vector<SetElement> neigh;
         for (int64_t u = 0; u < num_nodes; ++u) {
@@ -69,10 +71,10 @@ public:
                 neigh.push_back(edge_iterator->second);
                 ++edge_iterator;
             }
-            graph.neighborhoods.push_back(Set(neigh.begin(), neigh.size()));
+            neighborhoods.push_back(Set(neigh.data(), neigh.size()));
         }
 
-        return graph;
+        return SetGraph(std::move(neighborhoods));
     }
 
     /**
@@ -106,6 +108,9 @@ public:
 
     /**
      * Mutable neighborhood access is experimental, and might change in the future.
+     *
+     * Changing a neighborhood through this doesn't update the degree weights, call invalidate_degree_weights()
+     * (or build_degree_weights()) afterwards.
      */
     Set &out_neigh(NodeId vertex)
     {
@@ -117,6 +122,35 @@ public:
         return num_nodes_;
     }
 
+    /**
+     * Precomputes the degree based weights used by the Adamic Adar and Resource Allocation similarities.
+     *
+     * The table is not updated when neighborhoods are modified, call this again after mutating the graph.
+     */
+    void build_degree_weights()
+    {
+        degree_weights_ = DegreeWeights::FromGraph(*this);
+    }
+
+    /**
+     * Drops the degree weights, they are stale as soon as a degree changes.
+     */
+    void invalidate_degree_weights()
+    {
+        degree_weights_ = DegreeWeights();
+    }
+
+    bool has_degree_weights() const
+    {
+        return degree_weights_.num_nodes() == num_nodes_ && num_nodes_ > 0;
+    }
+
+    const DegreeWeights &degree_weights() const
+    {
+        assert(has_degree_weights());
+        return degree_weights_;
+    }
+
     /**
      * Checks whether the graph is directed or not.
      *
@@ -140,6 +174,7 @@ public:
 protected:
     std::vector<Set> neighborhoods;
     int64_t num_nodes_;
+    DegreeWeights degree_weights_;
 
 private:
     /**
@@ -235,3 +270,6 @@ private:
 using SortedSetGraph = SetGraph<SortedSet>;
 using RoaringGraph = SetGraph<RoaringSet>;
 using RobinHoodGraph = SetGraph<RobinHoodSet>;
+// Compressed neighborhoods, for graphs which only fit into memory compressed.
+using KbitSetGraph = SetGraph<KbitSet>;
+using VarintSetGraph = SetGraph<VarintSet>;
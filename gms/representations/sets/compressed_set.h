@@ -0,0 +1,591 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include <gms/common/instrumentation.h>
+#include <gms/common/types.h>
+
+#include "sorted_set_operations.h"
+
+/**
+ * Number of elements per block of a CompressedSetBase. Blocks are the unit of decoding and of skipping.
+ */
+constexpr size_t COMPRESSED_SET_BLOCK = 64;
+
+/**
+ * @brief Set implementation which keeps its elements encoded, for graphs which only fit into memory compressed.
+ *
+ * The sorted elements are split into blocks of COMPRESSED_SET_BLOCK elements, which the Codec encodes
+ * (see KbitSet and VarintSet). The Codec has to provide
+ *
+ *  - encode(const SetElement *sorted, size_t count, std::vector<uint8_t> &out)
+ *  - block_first(const uint8_t *data, size_t count, size_t block) -> SetElement, the first element of a block
+ *  - decode_block(const uint8_t *data, size_t count, size_t block, SetElement *out), decodes the elements of a
+ *    block (COMPRESSED_SET_BLOCK, fewer for the last block)
+ *
+ * Reading operations (intersect_count, intersect_sum, intersect, difference, contains and iteration) work on the
+ * encoded data: the blocks are decoded one at a time while merging, and blocks which can't contain a match are
+ * skipped by a binary search over their first elements without decoding them. Operations which modify the set
+ * decode it, apply the operation and encode the result again, so they are linear in the size of the set.
+ */
+template <class Codec>
+class CompressedSetBase
+{
+public:
+    using SetElement = NodeId;
+    using Container = std::vector<SetElement>;
+    using Block = std::array<SetElement, COMPRESSED_SET_BLOCK>;
+
+    /**
+     * Forward iterator decoding one block at a time.
+     */
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = SetElement;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const SetElement *;
+        using reference = const SetElement &;
+
+        const_iterator() = default;
+
+        const_iterator(const CompressedSetBase *set, size_t index) : set(set), index(index)
+        {
+            if (index < set->count) {
+                set->decode_block(index / COMPRESSED_SET_BLOCK, values.data());
+            }
+        }
+
+        reference operator*() const
+        {
+            return values[index % COMPRESSED_SET_BLOCK];
+        }
+
+        const_iterator &operator++()
+        {
+            return *this += 1;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        const_iterator &operator+=(difference_type n)
+        {
+            size_t block = index / COMPRESSED_SET_BLOCK;
+            index += n;
+            if (index < set->count && index / COMPRESSED_SET_BLOCK != block) {
+                set->decode_block(index / COMPRESSED_SET_BLOCK, values.data());
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return index == other.index;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return index != other.index;
+        }
+
+    private:
+        const CompressedSetBase *set = nullptr;
+        size_t index = 0;
+        Block values;
+    };
+
+    /**
+     * Instantiate an empty set.
+     */
+    CompressedSetBase() = default;
+
+    CompressedSetBase(CompressedSetBase &&other) noexcept = default;
+    CompressedSetBase &operator=(CompressedSetBase &&) = default;
+
+    // Note: Use clone() if you want a copy of a set.
+    CompressedSetBase(const CompressedSetBase &) = delete;
+    // Note: Use clone() if you want a copy of a set.
+    CompressedSetBase &operator=(const CompressedSetBase &) = delete;
+
+    /**
+     * Instantiate from an existing vector.
+     * This method isn't part of the set interface.
+     *
+     * @param _data
+     * @param is_sorted true if the elements are guaranteed to be sorted and unique,
+     *                  false otherwise (and if unknown)
+     */
+    CompressedSetBase(Container &&_data, bool is_sorted) : count(0)
+    {
+        Container elements(std::move(_data));
+        if (!is_sorted) {
+            std::sort(elements.begin(), elements.end());
+            elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+        } else {
+            assert(std::is_sorted(elements.begin(), elements.end()));
+        }
+        encode(elements);
+    }
+
+    /**
+     * @brief Create an instance encoding a sorted copy of the referenced data.
+     *
+     * @param start first item of the set
+     * @param count number of set elements
+     */
+    CompressedSetBase(const SetElement *start, size_t count) :
+        CompressedSetBase(Container(start, start + count), false)
+    {}
+
+    explicit CompressedSetBase(const std::vector<SetElement> &data) :
+        CompressedSetBase(data.data(), data.size())
+    {}
+
+    explicit CompressedSetBase(const std::initializer_list<SetElement> &data) :
+        CompressedSetBase(Container(data), false)
+    {}
+
+    /**
+     * Create a set instance containing only the provided element.
+     *
+     * @param element
+     */
+    explicit CompressedSetBase(SetElement element) :
+        CompressedSetBase(Container(1, element), true)
+    {}
+
+    CompressedSetBase clone() const
+    {
+        CompressedSetBase copy;
+        copy.data = data;
+        copy.count = count;
+        return copy;
+    }
+
+    size_t cardinality() const
+    {
+        return count;
+    }
+
+    /**
+     * Number of bytes of the encoded elements.
+     * This method isn't part of the set interface.
+     */
+    size_t encoded_size() const
+    {
+        return data.size();
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, count);
+    }
+
+    template <typename Set>
+    CompressedSetBase union_with(const Set &set) const
+    {
+        GMS_INSTR_SET_OP(Union, cardinality(), set.cardinality());
+        set.check_is_sorted();
+        auto elements = decode();
+        return CompressedSetBase(vec_set_union<Container>(elements.begin(), elements.end(), set.begin(), set.end()),
+                                 true);
+    }
+
+    CompressedSetBase union_with(SetElement element) const
+    {
+        auto result = clone();
+        result.union_inplace(element);
+        return result;
+    }
+
+    template <typename Set>
+    void union_inplace(const Set &other)
+    {
+        *this = union_with(other);
+    }
+
+    void union_inplace(SetElement element)
+    {
+        if (contains(element)) {
+            return;
+        }
+        auto elements = decode();
+        elements.insert(std::lower_bound(elements.begin(), elements.end(), element), element);
+        encode(elements);
+    }
+
+    template <typename Set>
+    size_t union_count(const Set &other) const
+    {
+        return cardinality() + other.cardinality() - intersect_count(other);
+    }
+
+    template <typename Set>
+    CompressedSetBase intersect(const Set &set) const
+    {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), set.cardinality());
+        Container elements;
+        for_each_common(set, [&elements](SetElement x) { elements.push_back(x); });
+        return CompressedSetBase(std::move(elements), true);
+    }
+
+    template <class Set>
+    void intersect_inplace(const Set &other)
+    {
+        *this = intersect(other);
+    }
+
+    template <typename Set>
+    size_t intersect_count(const Set &set) const
+    {
+        GMS_INSTR_SET_OP(IntersectCount, cardinality(), set.cardinality());
+        size_t result = 0;
+        for_each_common(set, [&result](SetElement) { result++; });
+        return result;
+    }
+
+    /**
+     * Sums weight(x) over the intersection with another set, without allocating it.
+     *
+     * @param set
+     * @param weight callable as weight(SetElement) -> double
+     * @return
+     */
+    template <typename Set, typename Weight>
+    double intersect_sum(const Set &set, Weight &&weight) const
+    {
+        double sum = 0;
+        for_each_common(set, [&sum, &weight](SetElement x) { sum += weight(x); });
+        return sum;
+    }
+
+    template <typename Set>
+    CompressedSetBase difference(const Set &set) const
+    {
+        GMS_INSTR_SET_OP(Difference, cardinality(), set.cardinality());
+        if constexpr (std::is_same_v<Set, CompressedSetBase>) {
+            Container elements;
+            elements.reserve(count);
+            BlockCursor other(set);
+            bool exhausted = other.empty();
+            for (SetElement x : *this) {
+                exhausted = exhausted || !other.seek(x);
+                if (exhausted || other.value() != x) {
+                    elements.push_back(x);
+                }
+            }
+            return CompressedSetBase(std::move(elements), true);
+        } else {
+            set.check_is_sorted();
+            auto elements = decode();
+            return CompressedSetBase(
+                vec_set_difference<Container>(elements.begin(), elements.end(), set.begin(), set.end()), true);
+        }
+    }
+
+    CompressedSetBase difference(SetElement element) const
+    {
+        auto set = clone();
+        set.difference_inplace(element);
+        return set;
+    }
+
+    template <typename Set>
+    void difference_inplace(const Set &set)
+    {
+        *this = difference(set);
+    }
+
+    void difference_inplace(SetElement element)
+    {
+        if (!contains(element)) {
+            return;
+        }
+        auto elements = decode();
+        elements.erase(std::lower_bound(elements.begin(), elements.end(), element));
+        encode(elements);
+    }
+
+    bool contains(const SetElement x) const
+    {
+        GMS_INSTR_SET_OP(Contains, cardinality(), 1);
+        // the last block which starts at or before x
+        size_t lo = 0;
+        size_t hi = num_blocks();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (block_first(mid) <= x) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0) {
+            return false;
+        }
+        Block values;
+        size_t size = block_size(lo - 1);
+        decode_block(lo - 1, values.data());
+        return std::binary_search(&values[0], &values[0] + size, x);
+    }
+
+    void add(SetElement element)
+    {
+        union_inplace(element);
+    }
+
+    void remove(SetElement element)
+    {
+        difference_inplace(element);
+    }
+
+    void toArray(SetElement *array) const
+    {
+        for (size_t block = 0; block < num_blocks(); ++block) {
+            decode_block(block, array + block * COMPRESSED_SET_BLOCK);
+        }
+    }
+
+    bool operator==(const CompressedSetBase &other) const
+    {
+        // The encoding of a set is unique.
+        return count == other.count && data == other.data;
+    }
+
+    bool operator!=(const CompressedSetBase &other) const
+    {
+        return !(*this == other);
+    }
+
+    /**
+     * Instantiates the set {0, 1, ..., bound - 1}.
+     *
+     * @param bound
+     * @return
+     */
+    static CompressedSetBase Range(unsigned int bound)
+    {
+        std::vector<SetElement> temp(bound);
+        std::iota(temp.begin(), temp.end(), 0);
+        return CompressedSetBase(std::move(temp), true);
+    }
+
+    // The elements are sorted by construction.
+    void check_is_sorted() const
+    {}
+
+private:
+    /**
+     * Position in a set, holding the decoded block which contains it.
+     */
+    class BlockCursor
+    {
+    public:
+        explicit BlockCursor(const CompressedSetBase &set) : set(set), blocks(set.num_blocks())
+        {
+            if (blocks > 0) {
+                load(0);
+            }
+        }
+
+        bool empty() const
+        {
+            return blocks == 0;
+        }
+
+        SetElement value() const
+        {
+            return values[pos];
+        }
+
+        /**
+         * Moves to the first element >= x, which must not be smaller than the current element.
+         * Blocks in between are skipped without decoding them.
+         *
+         * @return false if there is no such element
+         */
+        bool seek(SetElement x)
+        {
+            if (pos < size && values[pos] >= x) {
+                return true;
+            }
+            if (pos < size && values[size - 1] >= x) {
+                pos = std::lower_bound(&values[pos], &values[size], x) - &values[0];
+                return true;
+            }
+            // the first of the following blocks which starts after x
+            size_t lo = block + 1;
+            size_t hi = blocks;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (set.block_first(mid) <= x) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            if (lo > block + 1) {
+                // x is in the block before, unless it is greater than its last element
+                load(lo - 1);
+                pos = std::lower_bound(&values[0], &values[size], x) - &values[0];
+                if (pos < size) {
+                    return true;
+                }
+            }
+            if (lo == blocks) {
+                pos = size;
+                return false;
+            }
+            load(lo);
+            return true;
+        }
+
+        /**
+         * Merges the decoded parts of the current blocks of two cursors, calls f(x) for every common element.
+         * Stops at the end of either block.
+         */
+        template <class F>
+        void merge_blocks(BlockCursor &other, F &f)
+        {
+            const SetElement *a = &values[pos];
+            const SetElement *a_end = &values[0] + size;
+            const SetElement *b = &other.values[other.pos];
+            const SetElement *b_end = &other.values[0] + other.size;
+            while (a != a_end && b != b_end) {
+                SetElement value_a = *a;
+                SetElement value_b = *b;
+                if (value_a == value_b) {
+                    f(value_a);
+                }
+                a += value_a <= value_b;
+                b += value_b <= value_a;
+            }
+            pos = a - &values[0];
+            other.pos = b - &other.values[0];
+        }
+
+        bool at_block_end() const
+        {
+            return pos == size;
+        }
+
+        /**
+         * The smallest element which may follow the current block.
+         */
+        SetElement next_bound() const
+        {
+            return pos < size ? values[pos] : values[size - 1] + 1;
+        }
+
+    private:
+        void load(size_t b)
+        {
+            block = b;
+            size = set.block_size(b);
+            pos = 0;
+            set.decode_block(b, values.data());
+        }
+
+        const CompressedSetBase &set;
+        size_t blocks;
+        size_t block = 0;
+        size_t size = 0;
+        size_t pos = 0;
+        Block values;
+    };
+
+    /**
+     * Calls f(x) for every element x of the intersection in ascending order.
+     */
+    template <class Set, class F>
+    void for_each_common(const Set &set, F &&f) const
+    {
+        if constexpr (std::is_same_v<Set, CompressedSetBase>) {
+            BlockCursor a(*this);
+            BlockCursor b(set);
+            if (a.empty() || b.empty()) {
+                return;
+            }
+            while (true) {
+                a.merge_blocks(b, f);
+                if (a.at_block_end() && !a.seek(b.next_bound())) {
+                    return;
+                }
+                if (b.at_block_end() && !b.seek(a.next_bound())) {
+                    return;
+                }
+            }
+        } else {
+            set.check_is_sorted();
+            auto elements = decode();
+            auto it = set.begin();
+            auto end = set.end();
+            for (SetElement x : elements) {
+                while (it != end && *it < x) {
+                    ++it;
+                }
+                if (it == end) {
+                    return;
+                }
+                if (*it == x) {
+                    f(x);
+                }
+            }
+        }
+    }
+
+    size_t num_blocks() const
+    {
+        return (count + COMPRESSED_SET_BLOCK - 1) / COMPRESSED_SET_BLOCK;
+    }
+
+    size_t block_size(size_t block) const
+    {
+        return std::min(COMPRESSED_SET_BLOCK, count - block * COMPRESSED_SET_BLOCK);
+    }
+
+    SetElement block_first(size_t block) const
+    {
+        return Codec::block_first(data.data(), count, block);
+    }
+
+    void decode_block(size_t block, SetElement *out) const
+    {
+        Codec::decode_block(data.data(), count, block, out);
+    }
+
+    Container decode() const
+    {
+        Container elements(count);
+        toArray(elements.data());
+        return elements;
+    }
+
+    void encode(const Container &elements)
+    {
+        count = elements.size();
+        Codec::encode(elements.data(), count, data);
+    }
+
+    std::vector<uint8_t> data;
+    size_t count = 0;
+};
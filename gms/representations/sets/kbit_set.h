@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gms/representations/graphs/log_graph/kbit_decode.h>
+
+#include "compressed_set.h"
+
+/**
+ * @brief Codec of KbitSet: the elements are stored relative to the smallest one, with k bits each.
+ *
+ * k is the number of bits of the difference between the greatest and the smallest element, as in the local approach
+ * of Log(Graph). Every element can be read directly (kbit_extract), which makes the first element of a block
+ * available without decoding, and a block is decoded with kbit_decode (AVX2 if available).
+ *
+ * Layout: smallest element (4 bytes), k (1 byte), the k-bit values, 8 bytes padding for the 64-bit loads.
+ */
+struct KbitSetCodec
+{
+    static constexpr size_t HEADER_SIZE = sizeof(NodeId) + 1;
+    static constexpr size_t PADDING = sizeof(uint64_t);
+
+    static void encode(const NodeId *sorted, size_t count, std::vector<uint8_t> &out)
+    {
+        out.clear();
+        if (count == 0) {
+            return;
+        }
+        NodeId base = sorted[0];
+        uint32_t range = uint32_t(sorted[count - 1]) - uint32_t(base);
+        int k = range == 0 ? 0 : 32 - __builtin_clz(range);
+
+        out.assign(HEADER_SIZE + (count * k + 7) / 8 + PADDING, 0);
+        std::memcpy(out.data(), &base, sizeof(base));
+        out[sizeof(base)] = k;
+        uint8_t *bits = out.data() + HEADER_SIZE;
+        for (size_t i = 0; i < count; ++i) {
+            size_t bit = i * k;
+            uint64_t word;
+            std::memcpy(&word, bits + bit / 8, sizeof(word));
+            word |= uint64_t(uint32_t(sorted[i]) - uint32_t(base)) << (bit % 8);
+            std::memcpy(bits + bit / 8, &word, sizeof(word));
+        }
+    }
+
+    static NodeId block_first(const uint8_t *data, size_t, size_t block)
+    {
+        int k = data[sizeof(NodeId)];
+        return add_base(data, kbit_extract(data + HEADER_SIZE, int64_t(block * COMPRESSED_SET_BLOCK) * k, k));
+    }
+
+    static void decode_block(const uint8_t *data, size_t count, size_t block, NodeId *out)
+    {
+        int k = data[sizeof(NodeId)];
+        size_t first = block * COMPRESSED_SET_BLOCK;
+        size_t size = std::min(COMPRESSED_SET_BLOCK, count - first);
+        kbit_decode(data + HEADER_SIZE, int64_t(first) * k, k, size, out);
+        NodeId base;
+        std::memcpy(&base, data, sizeof(base));
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = NodeId(uint32_t(out[i]) + uint32_t(base));
+        }
+    }
+
+private:
+    static NodeId add_base(const uint8_t *data, uint64_t value)
+    {
+        NodeId base;
+        std::memcpy(&base, data, sizeof(base));
+        return NodeId(uint32_t(value) + uint32_t(base));
+    }
+};
+
+using KbitSet = CompressedSetBase<KbitSetCodec>;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 #include <gms/third_party/roaring/roaring.hh>
 #include <type_traits>
@@ -106,6 +107,7 @@ public:
 
     RoaringSetBase union_with(const RoaringSetBase &other) const
     {
+        GMS_INSTR_SET_OP(Union, cardinality(), other.cardinality());
         return RoaringSetBase(set | other.set);
     }
 
@@ -118,31 +120,37 @@ public:
 
     void union_inplace(const RoaringSetBase &other)
     {
+        GMS_INSTR_SET_OP(Union, cardinality(), other.cardinality());
         set |= other.set;
     }
 
     void union_inplace(const SetElement other)
     {
+        GMS_INSTR_SET_OP(Insert, cardinality(), 1);
         set.add(RoaringElement(other));
     }
 
     size_t union_count(const RoaringSetBase &other) const
     {
+        GMS_INSTR_SET_OP(UnionCount, cardinality(), other.cardinality());
         return set.or_cardinality(other.set);
     }
 
     RoaringSetBase intersect(const RoaringSetBase &other) const
     {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), other.cardinality());
         return RoaringSetBase(set & other.set);
     }
 
     void intersect_inplace(const RoaringSetBase &other)
     {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), other.cardinality());
         set &= other.set;
     }
 
     size_t intersect_count(const RoaringSetBase &other) const
     {
+        GMS_INSTR_SET_OP(IntersectCount, cardinality(), other.cardinality());
         if constexpr (std::is_same<R, Roaring>::value) {
             return set.and_cardinality(other.set);
         } else {
@@ -151,8 +159,33 @@ public:
         }
     }
 
+    /**
+     * Sums weight(x) over the intersection with another set, without allocating it.
+     *
+     * The smaller set is iterated and probed against the larger one.
+     *
+     * @param other
+     * @param weight callable as weight(SetElement) -> double
+     * @return
+     */
+    template <class Weight>
+    double intersect_sum(const RoaringSetBase &other, Weight &&weight) const
+    {
+        const R &minor = cardinality() <= other.cardinality() ? set : other.set;
+        const R &major = cardinality() <= other.cardinality() ? other.set : set;
+
+        double sum = 0;
+        for (RoaringElement x : minor) {
+            if (major.contains(x)) {
+                sum += weight(SetElement(x));
+            }
+        }
+        return sum;
+    }
+
     RoaringSetBase difference(const RoaringSetBase &other) const
     {
+        GMS_INSTR_SET_OP(Difference, cardinality(), other.cardinality());
         return RoaringSetBase(set - other.set);
     }
 
@@ -165,16 +198,19 @@ public:
 
     void difference_inplace(const RoaringSetBase &other)
     {
+        GMS_INSTR_SET_OP(Difference, cardinality(), other.cardinality());
         set -= other.set;
     }
 
     void difference_inplace(const SetElement other)
     {
+        GMS_INSTR_SET_OP(Erase, cardinality(), 1);
         set.remove(RoaringElement(other));
     }
 
     bool contains(const SetElement x) const
     {
+        GMS_INSTR_SET_OP(Contains, cardinality(), 1);
         return set.contains(RoaringElement(x));
     }
 
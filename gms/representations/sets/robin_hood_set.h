@@ -2,6 +2,7 @@
 #pragma once
 
 #include <vector>
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 #include <gms/third_party/robin_hood.h>
 #include <type_traits>
@@ -106,11 +107,13 @@ public:
 
     void union_inplace(const RobinHoodSetBase &other)
     {
+        GMS_INSTR_SET_OP(Union, cardinality(), other.cardinality());
         set.insert(other.begin(), other.end());
     }
 
     void union_inplace(const SetElement other)
     {
+        GMS_INSTR_SET_OP(Insert, cardinality(), 1);
         set.insert(other);
     }
 
@@ -122,19 +125,20 @@ public:
 
     RobinHoodSetBase intersect(const RobinHoodSetBase &other) const
     {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), other.cardinality());
         bool should_swap = cardinality() > other.cardinality();
 
         Container result = should_swap ? other.set : set;
 
         if (!should_swap) {
             for (SetElement el : *this) {
-                if (!other.contains(el)) {
+                if (!other.set.contains(el)) {
                     result.erase(el);
                 }
             }
         } else {
             for (SetElement el : other) {
-                if (!contains(el)) {
+                if (!set.contains(el)) {
                     result.erase(el);
                 }
             }
@@ -152,6 +156,7 @@ public:
 
     size_t intersect_count(const RobinHoodSetBase &other) const
     {
+        GMS_INSTR_SET_OP(IntersectCount, cardinality(), other.cardinality());
         bool q = cardinality() >= other.cardinality();
         const Container &minor = q ? other.set : set;
         const Container &major = q ? set : other.set;
@@ -166,6 +171,29 @@ public:
         return count;
     }
 
+    /**
+     * Sums weight(x) over the intersection with another set, without allocating it.
+     *
+     * @param other
+     * @param weight callable as weight(SetElement) -> double
+     * @return
+     */
+    template <class Weight>
+    double intersect_sum(const RobinHoodSetBase &other, Weight &&weight) const
+    {
+        bool q = cardinality() >= other.cardinality();
+        const Container &minor = q ? other.set : set;
+        const Container &major = q ? set : other.set;
+
+        double sum = 0;
+        for (SetElement e : minor) {
+            if (major.find(e) != major.end()) {
+                sum += weight(e);
+            }
+        }
+        return sum;
+    }
+
     RobinHoodSetBase difference(const RobinHoodSetBase &other) const
     {
         auto result = clone();
@@ -182,6 +210,7 @@ public:
 
     void difference_inplace(const RobinHoodSetBase &other)
     {
+        GMS_INSTR_SET_OP(Difference, cardinality(), other.cardinality());
         for (SetElement el : other) {
             set.erase(el);
         }
@@ -190,11 +219,13 @@ public:
 
     void difference_inplace(const SetElement element)
     {
+        GMS_INSTR_SET_OP(Erase, cardinality(), 1);
         set.erase(element);
     }
 
     bool contains(const SetElement x) const
     {
+        GMS_INSTR_SET_OP(Contains, cardinality(), 1);
         return set.contains(x);
     }
 
@@ -0,0 +1,414 @@
+// Microbenchmark of the set algebra: the operations of every set type on synthetic inputs and on neighbourhoods
+// of the input graph, reported per element of the inputs. Run it before and after changing a set kernel.
+//
+// Example: set_operations --format json -p sets=SortedSet,RoaringSet sizes=64,4096 -g uniform 12
+
+#include <chrono>
+#include <iomanip>
+#include <unordered_set>
+
+#include <gms/common/cli/cli.h>
+#include <gms/common/benchmark_report.h>
+#include <gms/common/instrumentation.h>
+#include <gms/common/papi/counters.h>
+#include <gms/common/random.h>
+#include <gms/representations/sets/sorted_set.h>
+#include <gms/representations/sets/sorted_set_ref.h>
+#include <gms/representations/sets/roaring_set.h>
+#include <gms/representations/sets/robin_hood_set.h>
+#include <gms/representations/sets/varint_set.h>
+#include <gms/representations/sets/kbit_set.h>
+
+using namespace GMS;
+
+namespace {
+
+enum class Op { Intersect, IntersectCount, Union, Difference, Contains, Construction };
+
+const std::vector<std::pair<std::string, Op>> kOps = {
+    {"intersect", Op::Intersect},
+    {"intersect_count", Op::IntersectCount},
+    {"union", Op::Union},
+    {"difference", Op::Difference},
+    {"contains", Op::Contains},
+    {"construction", Op::Construction},
+};
+
+// keeps the compiler from dropping the results of the measured operations
+volatile uint64_t result_sink = 0;
+
+std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::vector<double> split_numbers(const std::string &list) {
+    std::vector<double> numbers;
+    for (const std::string &item : split(list)) {
+        numbers.push_back(std::stod(item));
+    }
+    return numbers;
+}
+
+bool selected(const std::vector<std::string> &selection, const std::string &name) {
+    return std::find(selection.begin(), selection.end(), "all") != selection.end()
+        || std::find(selection.begin(), selection.end(), name) != selection.end();
+}
+
+/**
+ * Pairs of sorted element lists, the operations are applied to a[i] and b[i]. a[i] is the smaller one.
+ * Synthetic inputs consist of as many pairs as needed for about 2^18 elements, so that a single pair doesn't
+ * fit into the branch predictor or the caches.
+ */
+struct Input {
+    std::string name;
+    bool from_graph = false;
+    std::vector<std::vector<NodeId>> a;
+    std::vector<std::vector<NodeId>> b;
+};
+
+/// k distinct values of [0, n) (Floyd's algorithm).
+std::unordered_set<uint64_t> sample_distinct(Random::CounterRng &rng, uint64_t n, uint64_t k) {
+    std::unordered_set<uint64_t> sample;
+    sample.reserve(k);
+    for (uint64_t j = n - k; j < n; j++) {
+        uint64_t t = rng.bounded(j + 1);
+        if (!sample.insert(t).second) {
+            sample.insert(j);
+        }
+    }
+    return sample;
+}
+
+/**
+ * A pair of a large set of size * ratio elements, which cover the given density of the universe, and of a small
+ * set of size elements, of which the overlap fraction is contained in the large set.
+ *
+ * The sets are drawn in runs of width consecutive elements: 1 for uniformly distributed elements, larger ones for
+ * clustered elements as in graphs with a locality preserving labelling.
+ */
+void add_synthetic_pair(Input &input, Random::CounterRng &rng, uint64_t size, double ratio, double density,
+                        double overlap, uint64_t width) {
+    const uint64_t small_runs = std::max<uint64_t>(1, size / width);
+    const uint64_t large_runs = std::max<uint64_t>(small_runs, std::llround(small_runs * ratio));
+    const uint64_t universe_runs = std::max<uint64_t>(large_runs, std::ceil(large_runs / density));
+
+    std::unordered_set<uint64_t> large = sample_distinct(rng, universe_runs, large_runs);
+    std::vector<uint64_t> large_list(large.begin(), large.end());
+    std::sort(large_list.begin(), large_list.end());
+
+    // the overlapping runs are a random subset of the large set, the others are outside of it
+    const uint64_t common = std::min<uint64_t>(std::llround(small_runs * overlap), large_runs);
+    const uint64_t others = std::min<uint64_t>(small_runs - common, universe_runs - large_runs);
+    std::vector<uint64_t> small_list;
+    for (uint64_t i = 0; i < common; i++) {
+        std::swap(large_list[i], large_list[i + rng.bounded(large_runs - i)]);
+        small_list.push_back(large_list[i]);
+    }
+    std::unordered_set<uint64_t> outside;
+    while (outside.size() < others) {
+        uint64_t run = rng.bounded(universe_runs);
+        if (large.count(run) == 0) {
+            outside.insert(run);
+        }
+    }
+    small_list.insert(small_list.end(), outside.begin(), outside.end());
+
+    auto expand = [width](std::vector<uint64_t> &runs) {
+        std::sort(runs.begin(), runs.end());
+        std::vector<NodeId> elements;
+        elements.reserve(runs.size() * width);
+        for (uint64_t run : runs) {
+            for (uint64_t j = 0; j < width; j++) {
+                elements.push_back(NodeId(run * width + j));
+            }
+        }
+        return elements;
+    };
+    input.a.push_back(expand(small_list));
+    input.b.push_back(expand(large_list));
+}
+
+Input synthetic_input(uint64_t seed, const std::string &distribution, uint64_t size, double ratio, double density,
+                      double overlap) {
+    const uint64_t width = (distribution == "clustered") ? 32 : 1;
+    std::ostringstream name;
+    name << distribution << " size=" << size << " ratio=" << ratio << " density=" << density
+         << " overlap=" << overlap;
+
+    Input input;
+    input.name = name.str();
+    const uint64_t elements = size + size * ratio;
+    const uint64_t pairs = std::clamp<uint64_t>((UINT64_C(1) << 18) / std::max<uint64_t>(elements, 1), 1, 1024);
+    Random::CounterRng rng(seed, std::hash<std::string>()(input.name));
+    for (uint64_t i = 0; i < pairs; i++) {
+        add_synthetic_pair(input, rng, size, ratio, density, overlap, width);
+    }
+    return input;
+}
+
+/// The neighbourhoods of the endpoints of randomly sampled edges, as intersected by triangle counting or BK.
+Input graph_input(const CSRGraph &g, uint64_t seed, int64_t samples) {
+    Input input;
+    input.name = "graph edges=" + std::to_string(samples);
+    input.from_graph = true;
+    if (g.num_edges() == 0) {
+        return input;
+    }
+    Random::CounterRng rng(seed);
+    while ((int64_t) input.a.size() < samples) {
+        NodeId u = rng.bounded(g.num_nodes());
+        if (g.out_degree(u) == 0) {
+            continue;
+        }
+        NodeId v = *(g.out_neigh(u).begin() + rng.bounded(g.out_degree(u)));
+        std::vector<NodeId> nu(g.out_neigh(u).begin(), g.out_neigh(u).end());
+        std::vector<NodeId> nv(g.out_neigh(v).begin(), g.out_neigh(v).end());
+        if (nu.size() > nv.size()) {
+            std::swap(nu, nv);
+        }
+        input.a.push_back(std::move(nu));
+        input.b.push_back(std::move(nv));
+    }
+    return input;
+}
+
+/**
+ * The sets of an input. The element lists are copied, as SortedSetRef references them and construction reads
+ * them. They are sorted, as the neighbourhoods of a CSRGraph from which the set graphs are built.
+ */
+template <class Set>
+struct SetPairs {
+    std::vector<std::vector<NodeId>> elements_a;
+    std::vector<std::vector<NodeId>> elements_b;
+    std::vector<Set> a;
+    std::vector<Set> b;
+
+    explicit SetPairs(const Input &input) : elements_a(input.a), elements_b(input.b) {
+        for (size_t i = 0; i < elements_a.size(); i++) {
+            a.emplace_back(elements_a[i].data(), elements_a[i].size());
+            b.emplace_back(elements_b[i].data(), elements_b[i].size());
+        }
+    }
+
+    /// The elements processed by one run of the operation: the sizes of both inputs, or the queries of contains.
+    uint64_t elements(Op op) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < elements_a.size(); i++) {
+            total += elements_a[i].size() + (op == Op::Contains ? 0 : elements_b[i].size());
+        }
+        return total;
+    }
+
+    uint64_t run(Op op) {
+        uint64_t result = 0;
+        const size_t pairs = a.size();
+        switch (op) {
+        case Op::Intersect:
+            for (size_t i = 0; i < pairs; i++) {
+                result += a[i].intersect(b[i]).cardinality();
+            }
+            break;
+        case Op::IntersectCount:
+            for (size_t i = 0; i < pairs; i++) {
+                result += a[i].intersect_count(b[i]);
+            }
+            break;
+        case Op::Union:
+            for (size_t i = 0; i < pairs; i++) {
+                result += a[i].union_with(b[i]).cardinality();
+            }
+            break;
+        case Op::Difference:
+            for (size_t i = 0; i < pairs; i++) {
+                result += a[i].difference(b[i]).cardinality();
+            }
+            break;
+        case Op::Contains:
+            // the overlap of the input is the fraction of hits
+            for (size_t i = 0; i < pairs; i++) {
+                for (NodeId x : elements_a[i]) {
+                    result += b[i].contains(x);
+                }
+            }
+            break;
+        case Op::Construction:
+            for (size_t i = 0; i < pairs; i++) {
+                Set sa(elements_a[i].data(), elements_a[i].size());
+                Set sb(elements_b[i].data(), elements_b[i].size());
+                result += sa.cardinality() + sb.cardinality();
+            }
+            break;
+        }
+        return result;
+    }
+};
+
+/**
+ * Measures an operation on the sets of an input: the number of repetitions is doubled until a trial takes
+ * min_seconds, then every trial runs that many repetitions.
+ *
+ * Reports the median time per element in nanoseconds and in cycles of the time stamp counter, which ticks at
+ * the nominal frequency. With --counters, the counters per element are reported as well (e.g. TOT_CYC for the
+ * core cycles).
+ */
+template <class Set>
+void measure(const CLI::Args &args, const std::string &set_name, const std::string &op_name, Op op,
+             SetPairs<Set> &sets, const Input &input, const CSRGraph &g, double min_seconds,
+             PAPIW::CounterSet &counters) {
+    const uint64_t elements = sets.elements(op);
+    if (elements == 0) {
+        return;
+    }
+    auto time_reps = [&](uint64_t reps) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t result = 0;
+        for (uint64_t r = 0; r < reps; r++) {
+            result += sets.run(op);
+        }
+        result_sink = result;
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    uint64_t reps = 1;
+    while (time_reps(reps) < min_seconds && reps < (UINT64_C(1) << 30)) {
+        reps *= 2;
+    }
+
+    ReportSpec spec = args.report;
+    if (!input.from_graph) {
+        spec.graph_name = "synthetic";
+    }
+    BenchmarkReport report(spec, {"set_ops", set_name, op_name, input.name});
+    report.set_type(type_name<Set>());
+    if (input.from_graph) {
+        report.set_graph(g);
+    }
+
+    std::vector<double> ns_per_element, cycles_per_element;
+    const double per_run = double(elements) * reps;
+    for (int64_t trial = 0; trial < args.report.warmup_trials + args.num_trials; trial++) {
+        report.begin_trial();
+        counters.start();
+        const uint64_t start_cycles = Instrumentation::cycles();
+        const double seconds = time_reps(reps);
+        const uint64_t cycles = Instrumentation::cycles() - start_cycles;
+        counters.stop();
+
+        report.add_time("kernel", seconds);
+        report.add_metric("elements", per_run);
+        report.add_metric("ns_per_element", seconds * 1e9 / per_run);
+        report.add_metric("cycles_per_element", cycles / per_run);
+        for (size_t i = 0; i < counters.names().size(); i++) {
+            report.add_metric("counter." + counters.names()[i] + "_per_element", counters.values()[i] / per_run);
+        }
+        if (!report.warmup()) {
+            ns_per_element.push_back(seconds * 1e9 / per_run);
+            cycles_per_element.push_back(cycles / per_run);
+        }
+        report.end_trial();
+    }
+
+    std::cout << std::left << std::setw(14) << set_name << std::setw(17) << op_name << std::setw(58) << input.name
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << BenchmarkStats::From(ns_per_element).median
+              << std::setw(14) << BenchmarkStats::From(cycles_per_element).median << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    report.write_record();
+}
+
+template <class Set>
+void benchmark_set(const CLI::Args &args, const std::string &set_name, const std::vector<std::string> &ops,
+                   const std::vector<Input> &inputs, const CSRGraph &g, double min_seconds,
+                   PAPIW::CounterSet &counters) {
+    for (const Input &input : inputs) {
+        SetPairs<Set> sets(input);
+        for (const auto &[op_name, op] : kOps) {
+            if (selected(ops, op_name)) {
+                measure(args, set_name, op_name, op, sets, input, g, min_seconds, counters);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    CLI::Parser parser;
+    auto param_sets = parser.add_param("sets", std::nullopt, "all",
+        "set types: SortedSet, SortedSetRef, RoaringSet, RobinHoodSet, VarintSet, KbitSet or all");
+    auto param_ops = parser.add_param("ops", std::nullopt, "all",
+        "operations: intersect, intersect_count, union, difference, contains, construction or all");
+    auto param_inputs = parser.add_param("inputs", std::nullopt, "synthetic,graph",
+        "synthetic sets and/or neighbourhoods of sampled edges of the graph");
+    auto param_distributions = parser.add_param("distributions", std::nullopt, "uniform,clustered",
+        "element distributions of the synthetic sets: uniform or clustered (runs of 32 elements)");
+    auto param_sizes = parser.add_param("sizes", std::nullopt, "16,256,4096", "cardinalities of the smaller set");
+    auto param_ratios = parser.add_param("ratios", std::nullopt, "1,16", "size ratios of the larger to the smaller set");
+    auto param_densities = parser.add_param("densities", std::nullopt, "0.5,0.01",
+        "fractions of the universe covered by the larger set, in (0, 1]");
+    auto param_overlaps = parser.add_param("overlaps", std::nullopt, "0,0.5",
+        "fractions of the smaller set contained in the larger set");
+    auto param_samples = parser.add_param("samples", std::nullopt, "1000", "number of sampled edges of the graph");
+    auto param_min_time = parser.add_param("min-time", std::nullopt, "0.002", "minimum seconds of a trial");
+    auto param_seed = parser.add_param("seed", std::nullopt, std::to_string(Random::DefaultSeed),
+        "seed of the synthetic sets and of the sampled edges");
+    auto [args, g] = parser.parse_and_load(argc, argv);
+
+    const uint64_t seed = std::stoull(param_seed.value());
+    const std::vector<std::string> inputs_selected = split(param_inputs.value());
+    std::vector<Input> inputs;
+    if (selected(inputs_selected, "synthetic")) {
+        for (const std::string &distribution : split(param_distributions.value())) {
+            for (double size : split_numbers(param_sizes.value())) {
+                for (double ratio : split_numbers(param_ratios.value())) {
+                    for (double density : split_numbers(param_densities.value())) {
+                        if (density <= 0 || density > 1 || ratio < 1 || size < 1) {
+                            std::cerr << "invalid synthetic input: size " << size << ", ratio " << ratio
+                                      << ", density " << density << std::endl;
+                            return 100;
+                        }
+                        // the universe has to fit into NodeId
+                        if (size * ratio / density >= (double) std::numeric_limits<NodeId>::max()) {
+                            continue;
+                        }
+                        for (double overlap : split_numbers(param_overlaps.value())) {
+                            inputs.push_back(synthetic_input(seed, distribution, size, ratio, density, overlap));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (selected(inputs_selected, "graph")) {
+        inputs.push_back(graph_input(g, seed, param_samples.to_int()));
+    }
+
+    const std::vector<std::string> sets = split(param_sets.value());
+    const std::vector<std::string> ops = split(param_ops.value());
+    const double min_seconds = param_min_time.to_double();
+    PAPIW::CounterSet counters(args.report.counters);
+
+    std::cout << std::left << std::setw(14) << "set" << std::setw(17) << "op" << std::setw(58) << "input"
+              << std::right << std::setw(10) << "ns/elem" << std::setw(14) << "cycles/elem" << std::endl;
+    if (selected(sets, "SortedSet"))
+        benchmark_set<SortedSet>(args, "SortedSet", ops, inputs, g, min_seconds, counters);
+    if (selected(sets, "SortedSetRef"))
+        benchmark_set<SortedSetRef>(args, "SortedSetRef", ops, inputs, g, min_seconds, counters);
+    if (selected(sets, "RoaringSet"))
+        benchmark_set<RoaringSet>(args, "RoaringSet", ops, inputs, g, min_seconds, counters);
+    if (selected(sets, "RobinHoodSet"))
+        benchmark_set<RobinHoodSet>(args, "RobinHoodSet", ops, inputs, g, min_seconds, counters);
+    if (selected(sets, "VarintSet"))
+        benchmark_set<VarintSet>(args, "VarintSet", ops, inputs, g, min_seconds, counters);
+    if (selected(sets, "KbitSet"))
+        benchmark_set<KbitSet>(args, "KbitSet", ops, inputs, g, min_seconds, counters);
+
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <numeric>
 
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 
 #include "sorted_set_operations.h"
@@ -103,6 +104,7 @@ public:
 
     SortedSetBase union_with(const SortedSetBase &set) const
     {
+        GMS_INSTR_SET_OP(Union, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return SortedSetBase(vec_set_union<Container>(this->begin(), this->end(), set.begin(), set.end()), true);
@@ -119,6 +121,7 @@ public:
 
     void union_inplace(const SortedSetBase &other)
     {
+        GMS_INSTR_SET_OP(Union, cardinality(), other.cardinality());
         check_is_sorted();
         other.check_is_sorted();
         // TODO
@@ -127,6 +130,7 @@ public:
 
     void union_inplace(SetElement element)
     {
+        GMS_INSTR_SET_OP(Insert, cardinality(), 1);
         auto it = std::lower_bound(begin(), end(), element);
         if (it != end() && *it == element)
             return;
@@ -138,6 +142,7 @@ public:
     }
 
     size_t union_count(const SortedSetBase &other) const {
+        GMS_INSTR_SET_OP(UnionCount, cardinality(), other.cardinality());
         size_t count = 0;
         auto it0 = begin();
         auto it1 = other.begin();
@@ -160,6 +165,7 @@ public:
     template <typename Set>
     SortedSetBase intersect(const Set &set) const
     {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return SortedSetBase(vec_set_intersect<Container>(this->begin(), this->end(), set.begin(), set.end()), true);
@@ -167,6 +173,7 @@ public:
 
     template <class Set>
     void intersect_inplace(const Set &other) {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), other.cardinality());
         check_is_sorted();
         other.check_is_sorted();
         // TODO
@@ -176,13 +183,30 @@ public:
     template <typename Set>
     size_t intersect_count(const Set &set) const
     {
+        GMS_INSTR_SET_OP(IntersectCount, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return vec_set_intersect_count(this->begin(), this->end(), set.begin(), set.end());
     }
 
+    /**
+     * Sums weight(x) over the intersection with another set, without allocating it.
+     *
+     * @param set
+     * @param weight callable as weight(SetElement) -> double
+     * @return
+     */
+    template <typename Set, typename Weight>
+    double intersect_sum(const Set &set, Weight &&weight) const
+    {
+        this->check_is_sorted();
+        set.check_is_sorted();
+        return vec_set_intersect_sum(this->begin(), this->end(), set.begin(), set.end(), weight);
+    }
+
     SortedSetBase difference(const SortedSetBase &set) const
     {
+        GMS_INSTR_SET_OP(Difference, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return SortedSetBase(vec_set_difference<Container>(this->begin(), this->end(), set.begin(), set.end()), true);
@@ -198,6 +222,7 @@ public:
 
     void difference_inplace(const SortedSetBase &set)
     {
+        GMS_INSTR_SET_OP(Difference, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         // TODO this could be optimized since in some cases it might turn out faster to not allocate one more vector,
@@ -206,6 +231,7 @@ public:
     }
 
     void difference_inplace(SetElement element) {
+        GMS_INSTR_SET_OP(Erase, cardinality(), 1);
         this->check_is_sorted();
         auto position = std::lower_bound(begin(), end(), element);
         if (position != end() && *position == element) {
@@ -217,6 +243,7 @@ public:
 
     bool contains(const SetElement x) const
     {
+        GMS_INSTR_SET_OP(Contains, cardinality(), 1);
         auto it = std::lower_bound(begin(), end(), x);
         return !(it == end() || *it != x);
     }
@@ -70,6 +70,32 @@ inline size_t vec_set_intersect_count(IterL lstart, IterL lend, IterR rstart, It
     return count;
 }
 
+/**
+ * Sums weight(x) over all elements x of the intersection without materializing it.
+ *
+ * The merge advances both sides without branching on the comparison, which keeps the loop free of
+ * mispredictions for random neighborhoods.
+ */
+template <typename IterL, typename IterR, typename Weight>
+inline double vec_set_intersect_sum(IterL lstart, IterL lend, IterR rstart, IterR rend, Weight &&weight)
+{
+    double sum = 0;
+    while (lstart != lend && rstart != rend)
+    {
+        auto value_a = *lstart;
+        auto value_b = *rstart;
+
+        if (value_a == value_b)
+        {
+            sum += weight(value_a);
+        }
+        lstart += value_a <= value_b;
+        rstart += value_b <= value_a;
+    }
+
+    return sum;
+}
+
 template <class Container, typename IterL, typename IterR>
 inline Container vec_set_difference(IterL lstart, IterL lend, IterR rstart, IterR rend)
 {
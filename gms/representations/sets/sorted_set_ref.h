@@ -1,5 +1,6 @@
 #pragma once
 
+#include <gms/common/instrumentation.h>
 #include <gms/common/types.h>
 
 #include "sorted_set_operations.h"
@@ -36,6 +37,7 @@ public:
     template <typename Set>
     SortedSet union_with(const Set &set) const
     {
+        GMS_INSTR_SET_OP(Union, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return SortedSet(vec_set_union<Container>(this->begin(), this->end(), set.begin(), set.end()), true);
@@ -43,6 +45,7 @@ public:
     template <typename Set>
     SortedSet intersect(const Set &set) const
     {
+        GMS_INSTR_SET_OP(Intersect, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return SortedSet(vec_set_intersect<Container>(this->begin(), this->end(), set.begin(), set.end()), true);
@@ -50,13 +53,30 @@ public:
     template <typename Set>
     size_t intersect_count(const Set &set) const
     {
+        GMS_INSTR_SET_OP(IntersectCount, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return vec_set_intersect_count(this->begin(), this->end(), set.begin(), set.end());
     }
+    /**
+     * Sums weight(x) over the intersection with another set, without allocating it.
+     *
+     * @param set
+     * @param weight callable as weight(SetElement) -> double
+     * @return
+     */
+    template <typename Set, typename Weight>
+    double intersect_sum(const Set &set, Weight &&weight) const
+    {
+        this->check_is_sorted();
+        set.check_is_sorted();
+        return vec_set_intersect_sum(this->begin(), this->end(), set.begin(), set.end(), weight);
+    }
+
     template <typename Set>
     SortedSet difference(const Set &set) const
     {
+        GMS_INSTR_SET_OP(Difference, cardinality(), set.cardinality());
         this->check_is_sorted();
         set.check_is_sorted();
         return SortedSet(vec_set_difference<Container>(this->begin(), this->end(), set.begin(), set.end()), true);
@@ -69,6 +89,7 @@ public:
 
     bool contains(const SetElement x) const
     {
+        GMS_INSTR_SET_OP(Contains, cardinality(), 1);
         return std::lower_bound(begin(), end(), x) != end();
     }
 
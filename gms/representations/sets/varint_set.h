@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "compressed_set.h"
+
+/**
+ * @brief Codec of VarintSet: gap encoding with varints and a skip table.
+ *
+ * The skip table holds the first element of every block and the offset of the block in the varint stream. The other
+ * elements of a block are stored as gaps to their predecessor (minus one, as the elements are distinct), 7 bits per
+ * byte with the high bit set on all but the last byte. Blocks are independent, so the first element of a block is
+ * read from the table and only the blocks which are merged are decoded.
+ *
+ * Layout: the skip table (4 byte element, 4 byte offset per block), the varint stream.
+ */
+struct VarintSetCodec
+{
+    static constexpr size_t SKIP_ENTRY_SIZE = 2 * sizeof(uint32_t);
+
+    static void encode(const NodeId *sorted, size_t count, std::vector<uint8_t> &out)
+    {
+        out.clear();
+        size_t blocks = (count + COMPRESSED_SET_BLOCK - 1) / COMPRESSED_SET_BLOCK;
+        out.resize(blocks * SKIP_ENTRY_SIZE);
+        for (size_t block = 0; block < blocks; ++block) {
+            size_t first = block * COMPRESSED_SET_BLOCK;
+            size_t last = std::min(first + COMPRESSED_SET_BLOCK, count);
+            uint32_t entry[2] = {uint32_t(sorted[first]), uint32_t(out.size() - blocks * SKIP_ENTRY_SIZE)};
+            std::memcpy(out.data() + block * SKIP_ENTRY_SIZE, entry, SKIP_ENTRY_SIZE);
+            for (size_t i = first + 1; i < last; ++i) {
+                uint32_t gap = uint32_t(sorted[i]) - uint32_t(sorted[i - 1]) - 1;
+                while (gap >= 0x80) {
+                    out.push_back(uint8_t(gap) | 0x80);
+                    gap >>= 7;
+                }
+                out.push_back(uint8_t(gap));
+            }
+        }
+    }
+
+    static NodeId block_first(const uint8_t *data, size_t, size_t block)
+    {
+        uint32_t first;
+        std::memcpy(&first, data + block * SKIP_ENTRY_SIZE, sizeof(first));
+        return NodeId(first);
+    }
+
+    static void decode_block(const uint8_t *data, size_t count, size_t block, NodeId *out)
+    {
+        size_t blocks = (count + COMPRESSED_SET_BLOCK - 1) / COMPRESSED_SET_BLOCK;
+        size_t size = std::min(COMPRESSED_SET_BLOCK, count - block * COMPRESSED_SET_BLOCK);
+        uint32_t entry[2];
+        std::memcpy(entry, data + block * SKIP_ENTRY_SIZE, SKIP_ENTRY_SIZE);
+        const uint8_t *in = data + blocks * SKIP_ENTRY_SIZE + entry[1];
+        uint32_t value = entry[0];
+        out[0] = NodeId(value);
+        for (size_t i = 1; i < size; ++i) {
+            uint32_t gap = *in & 0x7F;
+            for (int shift = 7; *in++ & 0x80; shift += 7) {
+                gap |= uint32_t(*in & 0x7F) << shift;
+            }
+            value += gap + 1;
+            out[i] = NodeId(value);
+        }
+    }
+};
+
+using VarintSet = CompressedSetBase<VarintSetCodec>;
@@ -102,56 +102,8 @@ bool VerifyUnimplemented(...)
   return false;
 }
 
-// Calls (and times) kernel according to command line arguments
-//
-// This function shouldn't be used for new code.
-template<typename GraphT_, typename GraphFunc, typename AnalysisFunc,
-        typename VerifierFunc>
-void BenchmarkKernelLegacy(const CLApp &cli, const GraphT_ &g,
-                     GraphFunc kernel, AnalysisFunc stats,
-                     VerifierFunc verify) {
-    g.PrintStats();
-    //cout << cli.GetName() << endl;
-    double total_seconds = 0;
-    Timer trial_timer;
-    vector<double> times = vector<double>();
-    for (int iter=0; iter < cli.num_trials(); iter++) {
-        trial_timer.Start();
-        auto result = kernel(g);
-        trial_timer.Stop();
-#if PRINT_LABELS
-        PrintTime("Trial Time", trial_timer.Seconds());
-#else
-        printf("%3.5lf\n", trial_timer.Seconds());
-#endif
-        times.push_back(trial_timer.Seconds());
-        total_seconds += trial_timer.Seconds();
-        if (cli.do_analysis() && (iter == (cli.num_trials()-1))){
-            stats(g, result);
-        }
-        if (cli.do_verify()) {
-#if PRINT_LABELS
-            trial_timer.Start();
-			PrintLabel("Verification",
-			verify(std::ref(g), std::ref(result)) ? "PASS" : "FAIL");
-	    	trial_timer.Stop();
-	    	PrintTime("Verification Time", trial_timer.Seconds());
-#else
-            if(!verify(std::ref(g), std::ref(result))){
-                PrintLabel("VERIFICATION FAILED!", "");
-                PrintLabel("aborting...", "");
-                break;
-            }
-#endif
-        }
-    }
-    // Here we also print the median, which is the n/2 best measurement.
-    if(cli.num_trials() > 0){
-        sort(times.begin(), times.end());
-        PrintTime("Median Time", times[times.size()/2]);
-    }
-    PrintTime("Average Time", total_seconds / cli.num_trials());
-}
+// BenchmarkKernelLegacy, the original BenchmarkKernel of this file, is a wrapper of GMS::Benchmark now, see
+// gms/common/benchmark.h.
 
 
 // heuristic to see if sufficently dense power-law graph
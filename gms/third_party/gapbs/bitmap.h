@@ -52,6 +52,15 @@ class Bitmap {
     return (start_[word_offset(pos)] >> bit_offset(pos)) & 1l;
   }
 
+  // the bits as words, bit i is bit (i % 64) of word i / 64
+  const uint64_t* words() const {
+    return start_;
+  }
+
+  size_t num_words() const {
+    return end_ - start_;
+  }
+
   void swap(Bitmap &other) {
     std::swap(start_, other.start_);
     std::swap(end_, other.end_);
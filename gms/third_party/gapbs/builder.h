@@ -30,10 +30,12 @@
 #include <gms/representations/graphs/log_graph/kbit_weighted_adjacency_array.h>
 #include <gms/representations/graphs/log_graph/kbit_weighted_adjacency_array_local.h>
 #include <gms/representations/graphs/log_graph/bit_tree_graph.h>
-#include <gms/representations/graphs/log_graph/my_bitmap.h>
+#include <gms/representations/graphs/log_graph/bit_tree_encode.h>
+#include <gms/representations/graphs/log_graph/kbit_encode.h>
 #include <gms/representations/graphs/log_graph/options.h>
 #include <gms/representations/graphs/coders/varint_byte_based_graph.h>
 #include <gms/representations/graphs/coders/varint_word_based_graph.h>
+#include <gms/representations/graphs/coders/stream_vbyte_graph.h>
 #include <gms/representations/graphs/permuters/permuters.h>
 
 // I'd like to put the following typedefs into 'benchmark.h',
@@ -51,6 +53,8 @@
         typedef VarintByteBasedGraph My_Graph;
         #elif VARINT_WORD_BASED
         typedef VarintWordBasedGraph My_Graph;
+        #elif STREAM_VBYTE
+        typedef StreamVByteGraph My_Graph;
         #endif
 	#else
 	typedef Kbit_Adjacency_Array My_Graph;
@@ -167,8 +171,9 @@ class BuilderBase {
 	return sums;
   }
 
+  template <typename Sizes>
   static
-  pvector<SGOffset> ParallelPrefixSum(const pvector<NodeId_> &degrees) {
+  pvector<SGOffset> ParallelPrefixSum(const Sizes &degrees) {
 	const size_t block_size = 1<<20;
 	const size_t num_blocks = (degrees.size() + block_size - 1) / block_size;
 	pvector<SGOffset> local_sums(num_blocks);
@@ -309,62 +314,69 @@ class BuilderBase {
   }
 
 /* Allocates memory, given a number of entries and the desired bitlength.
-   The number of bits allocated is at least 'entries'*'bitlength' large
-   and is rounded up to the next number divisible by 64.
-   This amount of unused memory is negligible but needed for a safe memory access.
+   The number of bits allocated is at least 'entries'*'bitlength' large,
+   rounded up to the next number divisible by 64, plus one extra 64-bit word.
+   The extra word is needed because a value is read with a 64-bit load
+   starting at the byte which holds its first bit (see kbit_decode.h).
    */
 void* allocate_memory(int64_t entries, int32_t bitlength){
 	// The calculation is made such as to avoid large numbers like m*k to
 	// avoid overflowing 64 bits
-	int64_t size;
-	size = entries % 64 == 0 ?
-	(entries/64)*bitlength :
-	(entries/64)*bitlength + ((entries%64)*bitlength)/64 + 2;
+	int64_t size = (entries/64)*bitlength + ((entries%64)*bitlength + 63)/64 + 1;
 	cout << "creating kbit adjacency array with " << size*sizeof(int64_t) << " bytes" << endl;
     return calloc(size, sizeof(int64_t));
 }
 
+/* The Log(Graph) builders encode in two passes over the vertices, both in
+   parallel: the first computes the size of every encoded neighbourhood, a
+   prefix sum turns the sizes into offsets and the second pass encodes every
+   neighbourhood at its offset into the final buffer. The k-bit encodings
+   share words at the borders of the neighbourhoods, see Kbit_Writer. */
+
+/* The out-degrees of all vertices */
+pvector<SGOffset> OutDegrees(const CSRGraphBase<NodeId_, DestID_, invert> &csr){
+	pvector<SGOffset> degrees(csr.num_nodes());
+	#pragma omp parallel for
+	for(NodeId_ u=0; u < csr.num_nodes(); u++){
+		degrees[u] = csr.out_degree(u);
+	}
+	return degrees;
+}
+
 /* Takes a CSRGraph and turns it into a Kbit_Adjacency_Array */
 Kbit_Adjacency_Array csrToKbit(const CSRGraphBase<NodeId_, DestID_, invert> &csr){
 	int64_t n = csr.num_nodes(); // number of vertices
 	int64_t m = csr.num_edges(); // number of vertices
 	bool directed = !symmetrize_;
 	#if SIMPLE_GAP_ENCODING
-		int8_t k = ceil(log2(FindMaxGap(csr)));
+		int8_t k = ceil(log2(FindMaxGap(csr) + 1)); // the gap itself has to fit
 	#else
 		int8_t k = ceil(log2(n)); // bitlength for vertex ID encoding
 	#endif
-	int64_t mask = ~((int64_t) -1 << k);
 
 	// allocate structures
 	cout << "creating offset array with " << (n+1)*sizeof(int64_t) << " bytes" << endl;
+	pvector<SGOffset> offsets = ParallelPrefixSum(OutDegrees(csr));
 	int64_t* offsetArray = (int64_t*) calloc(n+1, sizeof(int64_t));
+	std::copy(offsets.begin(), offsets.end(), offsetArray);
     int32_t* adjacencyArray = directed ?
 		(int32_t*) allocate_memory(m, k) : (int32_t*) allocate_memory(2*m, k);
-	for(int i=1; i<=n; i++){
-		offsetArray[i] = offsetArray[i-1] + csr.out_degree(i-1);
-	}
 
-	for(NodeId u : csr.vertices()){
-		int pos = 0;
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(NodeId u=0; u < n; u++){
+		Kbit_Writer writer(adjacencyArray, k*offsetArray[u], k*offsetArray[u+1]);
 		#if SIMPLE_GAP_ENCODING
 			int64_t current_vertex = 0;
 		#endif
 		for(NodeId v : csr.out_neigh(u)){
-			int64_t a, b, d, w;
-			char* addr;
 			int64_t to_store = v;
-			a = k * (offsetArray[u] + pos++); // exact bit position where the first neighbour is stored
-			b = a >> 3;
-			d = a & 7;
-			addr = (char*)adjacencyArray + b;
-			w = ((int64_t*) addr)[0]; // 64-bit value currently stored here
 			#if SIMPLE_GAP_ENCODING
 				to_store = to_store - current_vertex;
 				current_vertex = v;
 			#endif
-			((int64_t*) addr)[0] = w | ((to_store & mask) << d);
+			writer.put(to_store, k);
 		}
+		writer.flush();
 	}
 	return Kbit_Adjacency_Array(n, k, m, directed, offsetArray, adjacencyArray);
 }
@@ -376,6 +388,7 @@ Kbit_Adjacency_Array_Local csrToKbitLocal(const CSRGraphBase<NodeId_, DestID_, i
 	bool directed = !symmetrize_;
 
 	vector<NodeId> W = vector<NodeId>(n, 0); // bit-lengths for neighbourhoods
+	pvector<SGOffset> bit_size(n); // bits of the encoded neighbourhoods
 	#pragma omp parallel for
     for (NodeId u=0; u < csr.num_nodes(); u++) {
 		#if SIMPLE_GAP_ENCODING
@@ -389,48 +402,35 @@ Kbit_Adjacency_Array_Local csrToKbitLocal(const CSRGraphBase<NodeId_, DestID_, i
 				W[u] = max(W[u], v);
 			}
 		#endif
-	}
-	#pragma omp parallel for
-	for(unsigned int i=0; i<W.size(); i++){
-		W[i] = W[i] == 0 ? 1 : ceil(log2(W[i]+1));
+		W[u] = W[u] == 0 ? 1 : ceil(log2(W[u]+1));
+		bit_size[u] = csr.out_degree(u)*W[u];
 	}
 
 	// allocate structures
-	vector<int64_t> bit_offset(n+1, 0); // bit offset of neighbourhood in adjacency array
 	cout << "creating offset array with " << (n+1)*sizeof(int64_t) << " bytes" << endl;
-	for(int i=1; i<=n; i++){
-		bit_offset[i] = bit_offset[i-1] + csr.out_degree(i-1)*W[i-1];
-	}
+	pvector<SGOffset> bit_offset = ParallelPrefixSum(bit_size); // bit offset of neighbourhood in adjacency array
     int32_t* adjacencyArray = (int32_t*) allocate_memory(bit_offset[n], 1);
 
-	for(NodeId u : csr.vertices()){
-		int pos = 0;
+	int64_t* O = (int64_t*) calloc(2*n, sizeof(int64_t));
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(NodeId u=0; u < n; u++){
+		Kbit_Writer writer(adjacencyArray, bit_offset[u], bit_offset[u+1]);
 		#if SIMPLE_GAP_ENCODING
 			NodeId current_vertex = 0;
 		#endif
 		for(NodeId v : csr.out_neigh(u)){
-			int64_t a, b, d, w;
-			int64_t k = W[u];
-			int64_t mask = ~((int64_t) -1 << k);
-			char* addr;
 			NodeId to_store = v;
-			a = bit_offset[u] + k*(pos++); // exact bit position where theneighbour is stored
-			b = a >> 3;
-			d = a & 7;
-			addr = (char*)adjacencyArray + b;
-			w = ((int64_t*) addr)[0]; // 64-bit value currently stored here
 			#if SIMPLE_GAP_ENCODING
 				to_store = v - current_vertex;
 				current_vertex = v;
 			#endif
-			((int64_t*) addr)[0] = w | ((to_store & mask) << d);
+			writer.put(to_store, W[u]);
 		}
-	}
-	int64_t* O = (int64_t*) calloc(2*n, sizeof(int64_t));
-	for(int i=0; i<n; i++){
-		* (int32_t*) (O + 2*i) = (int32_t) csr.out_degree(i);
-		*((int32_t*) (O + 2*i) + 1) = (int32_t)W[i];
-		*(O + 2*i +1) = bit_offset[i];
+		writer.flush();
+
+		* (int32_t*) (O + 2*u) = (int32_t) csr.out_degree(u);
+		*((int32_t*) (O + 2*u) + 1) = (int32_t)W[u];
+		*(O + 2*u +1) = bit_offset[u];
 	}
 	return Kbit_Adjacency_Array_Local(n, m, directed,
 		adjacencyArray, O);
@@ -442,44 +442,37 @@ Kbit_Weighted_Adjacency_Array csrToWeightedKbit(const CSRGraphBase<NodeId_, Dest
 	int64_t m = csr.num_edges(); // number of edges
 	bool directed = !symmetrize_;
 	#if SIMPLE_GAP_ENCODING
-		int k = ceil(log2(FindMaxGap(csr)));
+		int k = ceil(log2(FindMaxGap(csr) + 1));
 	#else
 		int8_t k = ceil(log2(n)); // bitlength for vertex ID encoding
 	#endif
 	int8_t w = ceil(log2(FindMaxWeight(csr))); // bitlength for weight encoding
 	int8_t kw = k+w; // bitlength for edge encoding
-	int64_t mask = ~((int64_t) -1 << kw);
 
 	// allocate structures
 	cout << "creating offset array with " << (n+0)*sizeof(int64_t) << " bytes" << endl;
+	pvector<SGOffset> offsets = ParallelPrefixSum(OutDegrees(csr));
 	int64_t* offsetArray = (int64_t*) calloc(n+1, sizeof(int64_t));
-	for(int i=1; i<=n; i++){
-		offsetArray[i] = offsetArray[i-1] + csr.out_degree(i-1);
-	}
+	std::copy(offsets.begin(), offsets.end(), offsetArray);
     int32_t* adjacencyArray = directed ?
 		(int32_t*) allocate_memory(m, kw) : (int32_t*) allocate_memory(2*m, kw);
 
 	// now we copy the edge information to log(Graph)
-	for(NodeId u : csr.vertices()){
-		int64_t pos = 0;
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(NodeId u=0; u < n; u++){
+		Kbit_Writer writer(adjacencyArray, kw*offsetArray[u], kw*offsetArray[u+1]);
 		#if SIMPLE_GAP_ENCODING
 			NodeId current_vertex = 0;
 		#endif
 		for(DestID_ v : csr.out_neigh(u)){
-			int64_t a, b, d, orig;
-			char* addr;
-			a = kw * (offsetArray[u] + pos++); // exact bit position where the first neighbour is stored
-			b = a >> 3;
-			d = a & 7;
 			int64_t to_store = ((int64_t)v.v << w) | v.w; // value to store
-			addr = (char*)adjacencyArray + b;
-			orig = ((int64_t*) addr)[0]; // 64-bit value currently stored here
 			#if SIMPLE_GAP_ENCODING
 				to_store = ((int64_t)(v.v - current_vertex) << w) | v.w; // value to store
 				current_vertex = v.v;
 			#endif
-			((int64_t*) addr)[0] = orig | ((to_store & mask) << d);
+			writer.put(to_store, kw);
 		}
+		writer.flush();
 	}
 	return Kbit_Weighted_Adjacency_Array(n, k, w, m, directed, offsetArray, adjacencyArray);
 }
@@ -492,6 +485,8 @@ Kbit_Weighted_Adjacency_Array_Local csrToWeightedKbitLocal(const CSRGraphBase<No
 
 	vector<NodeId> id_bitlength(n, 0); // per-neighbourhood bitlength for vertex IDs
 	vector<NodeId> weight_bitlength(n, 0); // per-neighoburhood bitlength for weights
+	pvector<SGOffset> bit_size(n); // bits of the encoded neighbourhoods
+	#pragma omp parallel for
     for (NodeId u=0; u < csr.num_nodes(); u++) {
 		#if SIMPLE_GAP_ENCODING
 			NodeId current_vertex = 0;
@@ -506,255 +501,153 @@ Kbit_Weighted_Adjacency_Array_Local csrToWeightedKbitLocal(const CSRGraphBase<No
 				weight_bitlength[u] = std::max(weight_bitlength[u], v.w);
 			}
 		#endif
-	}
-	#pragma omp parallel for
-	for(unsigned int i=0; i<n; i++){
-		id_bitlength[i] = id_bitlength[i] == 0 ? 1 : ceil(log2(id_bitlength[i]+1));
-		weight_bitlength[i] = weight_bitlength[i] == 0 ? 1 : ceil(log2(weight_bitlength[i]+1));
+		id_bitlength[u] = id_bitlength[u] == 0 ? 1 : ceil(log2(id_bitlength[u]+1));
+		weight_bitlength[u] = weight_bitlength[u] == 0 ? 1 : ceil(log2(weight_bitlength[u]+1));
+		bit_size[u] = csr.out_degree(u)*(id_bitlength[u]+weight_bitlength[u]);
 	}
 
 	// allocate structures
 	cout << "creating offset array with " << (n+1)*sizeof(int64_t) << " bytes" << endl;
-	vector<int64_t> bit_offset(n+1, 0); // bit offset of neighbourhood in adjacency array
-	for(int i=1; i<=n; i++){
-		bit_offset[i] = bit_offset[i-1] + csr.out_degree(i-1)*(id_bitlength[i-1]+weight_bitlength[i-1]);
-	}
+	pvector<SGOffset> bit_offset = ParallelPrefixSum(bit_size); // bit offset of neighbourhood in adjacency array
     int32_t* adjacencyArray = (int32_t*) allocate_memory(bit_offset[n], 1);
 
-	for(NodeId u : csr.vertices()){
-		int pos = 0;
+	int64_t* O = (int64_t*) calloc(2*n, sizeof(int64_t));
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for(NodeId u=0; u < n; u++){
+		Kbit_Writer writer(adjacencyArray, bit_offset[u], bit_offset[u+1]);
+		int64_t kw = id_bitlength[u] + weight_bitlength[u];
 		#if SIMPLE_GAP_ENCODING
 			NodeId current_vertex = 0;
 		#endif
 		for(DestID_ v : csr.out_neigh(u)){
-			int64_t ebo, b, d, orig;
-			int64_t kw = id_bitlength[u] + weight_bitlength[u];
-			int64_t mask = ~((int64_t) -1 << kw);
-			char* addr;
 			int64_t to_store = ((int64_t)v.v << weight_bitlength[u]) | v.w; // value to store
-			ebo = bit_offset[u] + kw*(pos++); // exact bit offset where theneighbour is stored
-			b = ebo >> 3;
-			d = ebo & 7;
-			addr = (char*)adjacencyArray + b;
-			orig = ((int64_t*) addr)[0]; // 64-bit value currently stored here
 			#if SIMPLE_GAP_ENCODING
 				to_store = ((int64_t)(v.v - current_vertex) << weight_bitlength[u]) | v.w; // value to store
 				current_vertex = v;
 			#endif
-			((int64_t*) addr)[0] = orig | ((to_store & mask) << d);
+			writer.put(to_store, kw);
 		}
-	}
+		writer.flush();
 
-	int64_t* O = (int64_t*) calloc(2*n, sizeof(int64_t));
-	for(int i=0; i<n; i++){
-		* (int32_t*) (O + 2*i) = (int32_t) csr.out_degree(i);
-		*((int8_t*) (O + 2*i) + 4) = (int8_t)id_bitlength[i];
-		*((int8_t*) (O + 2*i) + 5) = (int8_t)weight_bitlength[i];
-		*(O + 2*i +1) = bit_offset[i];
+		* (int32_t*) (O + 2*u) = (int32_t) csr.out_degree(u);
+		*((int8_t*) (O + 2*u) + 4) = (int8_t)id_bitlength[u];
+		*((int8_t*) (O + 2*u) + 5) = (int8_t)weight_bitlength[u];
+		*(O + 2*u +1) = bit_offset[u];
 	}
 	return Kbit_Weighted_Adjacency_Array_Local(n, m, directed, adjacencyArray, O);
 }
 
+/* Varint encoding of the neighbourhood of v as in the varint graphs: the
+   degree, the first neighbour relative to v (after a byte for the direction)
+   and the gaps between the following neighbours. Returns the number of bytes,
+   if 'out' is null they are only counted. */
+template <class Neighbourhood>
+static uint64_t encodeVarintNeighbourhood(NodeId v, uint64_t degree, Neighbourhood neighbourhood,
+		unsigned char* out) {
+	unsigned char scratch[BYTES_IN_64BIT_WORD + 1];
+	auto dest = [&](uint64_t pos) { return out ? out + pos : scratch; };
+
+	uint64_t itr = toVarint(degree, dest(0));
+	NodeId prev_v = v;
+	bool first_neigh = true;
+	for (auto v2 : neighbourhood) {
+		uint64_t diff;
+		if (first_neigh) {
+			if (v2 < prev_v) {
+				*dest(itr) = NEXT_VAL_SMALLER;
+				diff = prev_v - v2;
+			} else {
+				*dest(itr) = NEXT_VAL_GREATER;
+				diff = v2 - prev_v;
+			}
+			itr++;
+			first_neigh = false;
+		} else {
+			diff = v2 - prev_v;
+		}
+		itr += toVarint(diff, dest(itr));
+		prev_v = v2;
+	}
+	return itr;
+}
 
+/* Encodes the out- or in-neighbourhoods of all vertices with varints, each
+   padded to a multiple of 'alignment' bytes. Returns the encoding, 'offsets'
+   receives the byte offset of every neighbourhood. */
+template <class Neighbourhoods>
+static unsigned char* encodeVarintNeighbourhoods(const CSRGraphBase<NodeId_, DestID_, invert> &csr,
+		Neighbourhoods neighbourhoods, uint64_t alignment, pvector<SGOffset> &offsets) {
+	pvector<SGOffset> sizes(csr.num_nodes());
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for (NodeId v = 0; v < csr.num_nodes(); v++) {
+		auto neighbourhood = neighbourhoods(v);
+		uint64_t bytes = encodeVarintNeighbourhood(v, neighbourhood.end() - neighbourhood.begin(), neighbourhood, nullptr);
+		sizes[v] = (bytes + alignment - 1) / alignment * alignment;
+	}
+	offsets = ParallelPrefixSum(sizes);
+
+	unsigned char* adj_data = new unsigned char[offsets[csr.num_nodes()]];
+	#pragma omp parallel for schedule(dynamic, 1024)
+	for (NodeId v = 0; v < csr.num_nodes(); v++) {
+		assert(std::is_sorted(neighbourhoods(v).begin(), neighbourhoods(v).end()));
+		auto neighbourhood = neighbourhoods(v);
+		uint64_t bytes = encodeVarintNeighbourhood(v, neighbourhood.end() - neighbourhood.begin(), neighbourhood,
+		                                           adj_data + offsets[v]);
+		std::memset(adj_data + offsets[v] + bytes, 0, offsets[v+1] - offsets[v] - bytes); // padding
+	}
+	return adj_data;
+}
 
 VarintByteBasedGraph csrToVarintByteBased(const CSRGraphBase<NodeId_, DestID_, invert> &csr) {
-
 	bool directed = csr.directed();
-	int64_t num_nodes = csr.num_nodes();
-	int64_t num_edges = csr.num_edges();
+	pvector<SGOffset> offsets_out, offsets_in;
+	unsigned char* new_adj_data_out = encodeVarintNeighbourhoods(csr,
+		[&](NodeId v) { return csr.out_neigh(v); }, 1, offsets_out);
+	unsigned char* new_adj_data_in = encodeVarintNeighbourhoods(csr,
+		[&](NodeId v) { return csr.in_neigh(v); }, 1, offsets_in);
 
 	uint64_t* new_offsets_out = new uint64_t[csr.num_nodes()];
 	uint64_t* new_offsets_in = new uint64_t[csr.num_nodes()];
-    // Pessimistic estimate of required memory: at most 8 bytes per edge, and 9 per node (at most 8 bytes for varint
-    // neighborhood degree, and 1 fixed byte for ascending/descending information).
-	uint64_t new_adj_data_size = csr.num_edges() * 8 + csr.num_nodes() * 9;
-	unsigned char* new_adj_data_out_tmp = new unsigned char[new_adj_data_size];
-	unsigned char* new_adj_data_in_tmp = new unsigned char[new_adj_data_size];
-
-	uint64_t itr_out = 0;
-	uint64_t itr_in = 0;
-
-	for (auto v : csr.vertices()) {
-        assert(std::is_sorted(csr.out_neigh(v).begin(), csr.out_neigh(v).end()));
-
-        new_offsets_out[v] = itr_out;
-		new_offsets_in[v] = itr_in;
-		uint64_t v_deg_out = csr.out_degree(v);
-		uint64_t v_deg_in = csr.in_degree(v);
-		int next_out = toVarint(v_deg_out, &new_adj_data_out_tmp[itr_out]);
-		int next_in = toVarint(v_deg_in, &new_adj_data_in_tmp[itr_in]);
-		itr_out += next_out;
-		itr_in += next_in;
-
-		NodeId prev_v = v;
-		bool first_neigh = true;
-		for (auto v2 : csr.out_neigh(v)) {
-			uint64_t diff;
-			if (first_neigh) {
-				if (v2 < prev_v) {
-					new_adj_data_out_tmp[itr_out] = NEXT_VAL_SMALLER;
-					diff = prev_v - v2;
-				} else {
-					new_adj_data_out_tmp[itr_out] = NEXT_VAL_GREATER;
-					diff = v2 - prev_v;
-				}
-				itr_out++;
-
-				next_out = toVarint(diff, &new_adj_data_out_tmp[itr_out]);
-				itr_out += next_out;
-				first_neigh = false;
-				prev_v = v2;
-				continue;
-			}
-
-			diff = v2 - prev_v;
-			next_out = toVarint(diff, &new_adj_data_out_tmp[itr_out]);
-			itr_out += next_out;
-			prev_v = v2;
-		}
-
-		prev_v = v;
-		first_neigh = true;
-		for (auto v2 : csr.in_neigh(v)) {
-			uint64_t diff;
-			if (first_neigh) {
-				if (v2 < prev_v) {
-					new_adj_data_in_tmp[itr_in] = NEXT_VAL_SMALLER;
-					diff = prev_v - v2;
-				} else {
-					new_adj_data_in_tmp[itr_in] = NEXT_VAL_GREATER;
-					diff = v2 - prev_v;
-				}
-				itr_in++;
-
-				next_in = toVarint(diff, &new_adj_data_in_tmp[itr_in]);
-				itr_in += next_in;
-				first_neigh = false;
-				prev_v = v2;
-				continue;
-			}
-
-			diff = v2 - prev_v;
-			next_in = toVarint(diff, &new_adj_data_in_tmp[itr_in]);
-			itr_in += next_in;
-			prev_v = v2;
-		}
+	#pragma omp parallel for
+	for (NodeId v = 0; v < csr.num_nodes(); v++) {
+		new_offsets_out[v] = offsets_out[v];
+		new_offsets_in[v] = offsets_in[v];
 	}
-
-	unsigned char* new_adj_data_out = new unsigned char[itr_out];
-	unsigned char* new_adj_data_in = new unsigned char[itr_in];
-	memcpy(&new_adj_data_out[0], &new_adj_data_out_tmp[0], itr_out);
-	memcpy(&new_adj_data_in[0], &new_adj_data_in_tmp[0], itr_in);
-	delete [] new_adj_data_out_tmp;
-	delete [] new_adj_data_in_tmp;
-
-	return VarintByteBasedGraph(num_nodes, num_edges, directed, new_offsets_out, new_offsets_in, new_adj_data_out, new_adj_data_in);
+	return VarintByteBasedGraph(csr.num_nodes(), csr.num_edges(), directed, new_offsets_out, new_offsets_in, new_adj_data_out, new_adj_data_in);
 }
 
-
+/* Takes a CSRGraph with sorted neighbourhoods and turns it into a StreamVByteGraph.
+   The in-neighbourhoods are only encoded for directed graphs. */
+StreamVByteGraph csrToStreamVByte(const CSRGraphBase<NodeId_, DestID_, invert> &csr) {
+	bool directed = csr.directed();
+	auto out = StreamVByteGraph::Adjacency::Encode(csr.num_nodes(),
+		[&](NodeId_ v) { return csr.out_neigh(v); });
+	StreamVByteGraph::Adjacency in;
+	if (directed) {
+		in = StreamVByteGraph::Adjacency::Encode(csr.num_nodes(),
+			[&](NodeId_ v) { return csr.in_neigh(v); });
+	}
+	return StreamVByteGraph(csr.num_nodes(), csr.num_edges(), directed, std::move(out), std::move(in));
+}
 
 VarintWordBasedGraph csrToVarintWordBased(const CSRGraphBase<NodeId_, DestID_, invert> &csr) {
+	bool directed = csr.directed();
+	// every neighbourhood starts at a 64-bit word, the offsets count words
+	pvector<SGOffset> offsets_out, offsets_in;
+	unsigned char* new_adj_data_out = encodeVarintNeighbourhoods(csr,
+		[&](NodeId v) { return csr.out_neigh(v); }, BYTES_IN_64BIT_WORD, offsets_out);
+	unsigned char* new_adj_data_in = encodeVarintNeighbourhoods(csr,
+		[&](NodeId v) { return csr.in_neigh(v); }, BYTES_IN_64BIT_WORD, offsets_in);
 
-		bool directed = csr.directed();
-		int64_t num_nodes = csr.num_nodes();
-		int64_t num_edges = csr.num_edges();
-
-		uint64_t* new_offsets_out = new uint64_t[csr.num_nodes()];
-		uint64_t* new_offsets_in = new uint64_t[csr.num_nodes()];
-		// Pessimistic estimate of required memory: at most 8 bytes per edge, and 9 per node but rounded to 16 to
-		// account for word padding.
-		uint64_t new_adj_data_size = csr.num_edges() * 8 + csr.num_nodes() * 16;
-		unsigned char* new_adj_data_out_tmp = new unsigned char[new_adj_data_size];
-		unsigned char* new_adj_data_in_tmp = new unsigned char[new_adj_data_size];
-
-		uint64_t itr_out = 0;
-		uint64_t itr_in = 0;
-
-		for (auto v : csr.vertices()) {
-
-			new_offsets_out[v] = itr_out >> 3;
-			new_offsets_in[v] = itr_in >> 3;
-			uint64_t v_deg_out = csr.out_degree(v);
-			uint64_t v_deg_in = csr.in_degree(v);
-			int next_out = toVarint(v_deg_out, &new_adj_data_out_tmp[itr_out]);
-			int next_in = toVarint(v_deg_in, &new_adj_data_in_tmp[itr_in]);
-			itr_out += next_out;
-			itr_in += next_in;
-
-			NodeId prev_v = v;
-			bool first_neigh = true;
-			for (auto v2 : csr.out_neigh(v)) {
-				uint64_t diff;
-				if (first_neigh) {
-					if (v2 < prev_v) {
-						new_adj_data_out_tmp[itr_out] = NEXT_VAL_SMALLER;
-						diff = prev_v - v2;
-					} else {
-						new_adj_data_out_tmp[itr_out] = NEXT_VAL_GREATER;
-						diff = v2 - prev_v;
-					}
-					itr_out++;
-
-					next_out = toVarint(diff, &new_adj_data_out_tmp[itr_out]);
-					itr_out += next_out;
-					first_neigh = false;
-					prev_v = v2;
-					continue;
-				}
-
-				diff = v2 - prev_v;
-				next_out = toVarint(diff, &new_adj_data_out_tmp[itr_out]);
-				itr_out += next_out;
-				prev_v = v2;
-			}
-
-			if(itr_out % BYTES_IN_64BIT_WORD != 0) {
-				int add_bytes = ( BYTES_IN_64BIT_WORD - (itr_out % BYTES_IN_64BIT_WORD));
-				itr_out += add_bytes;
-			}
-
-			prev_v = v;
-			first_neigh = true;
-			for (auto v2 : csr.in_neigh(v)) {
-				uint64_t diff;
-				if (first_neigh) {
-					if (v2 < prev_v) {
-						new_adj_data_in_tmp[itr_in] = NEXT_VAL_SMALLER;
-						diff = prev_v - v2;
-					} else {
-						new_adj_data_in_tmp[itr_in] = NEXT_VAL_GREATER;
-						diff = v2 - prev_v;
-					}
-					itr_in++;
-
-					next_in = toVarint(diff, &new_adj_data_in_tmp[itr_in]);
-					itr_in += next_in;
-					first_neigh = false;
-					prev_v = v2;
-					continue;
-				}
-
-				diff = v2 - prev_v;
-				next_in = toVarint(diff, &new_adj_data_in_tmp[itr_in]);
-				itr_in += next_in;
-				prev_v = v2;
-			}
-
-			if(itr_in % BYTES_IN_64BIT_WORD != 0) {
-				int add_bytes = ( BYTES_IN_64BIT_WORD - (itr_in % BYTES_IN_64BIT_WORD));
-				itr_in += add_bytes;
-			}
-		}
-
-		unsigned char* new_adj_data_out = new unsigned char[itr_out];
-		unsigned char* new_adj_data_in = new unsigned char[itr_in];
-		std::memcpy(&new_adj_data_out[0], &new_adj_data_out_tmp[0], itr_out);
-		std::memcpy(&new_adj_data_in[0], &new_adj_data_in_tmp[0], itr_in);
-		delete [] new_adj_data_out_tmp;
-		delete [] new_adj_data_in_tmp;
-
-		return VarintWordBasedGraph(num_nodes, num_edges, directed, new_offsets_out, new_offsets_in, new_adj_data_out, new_adj_data_in);
+	uint64_t* new_offsets_out = new uint64_t[csr.num_nodes()];
+	uint64_t* new_offsets_in = new uint64_t[csr.num_nodes()];
+	#pragma omp parallel for
+	for (NodeId v = 0; v < csr.num_nodes(); v++) {
+		new_offsets_out[v] = offsets_out[v] >> 3;
+		new_offsets_in[v] = offsets_in[v] >> 3;
 	}
+	return VarintWordBasedGraph(csr.num_nodes(), csr.num_edges(), directed, new_offsets_out, new_offsets_in, new_adj_data_out, new_adj_data_in);
+}
 
 //Ignore Compiler-Warning of 3rd party Code (GMS team)
 #pragma GCC diagnostic push
@@ -767,6 +660,8 @@ VarintWordBasedGraph csrToVarintWordBased(const CSRGraphBase<NodeId_, DestID_, i
             return csrToVarintByteBased(csr_graph);
         } else if constexpr (std::is_same_v<CGraph, VarintWordBasedGraph>) {
             return csrToVarintWordBased(csr_graph);
+        } else if constexpr (std::is_same_v<CGraph, StreamVByteGraph>) {
+            return csrToStreamVByte(csr_graph);
         } else if constexpr (std::is_same_v<CGraph, Kbit_Adjacency_Array>) {
             bool symm_backup = symmetrize_;
             symmetrize_ = !csr_graph.directed();
@@ -779,187 +674,43 @@ VarintWordBasedGraph csrToVarintWordBased(const CSRGraphBase<NodeId_, DestID_, i
             auto g = csrToKbitLocal(csr_graph);
             symmetrize_ = symm_backup;
             return std::move(g);
+        } else if constexpr (std::is_same_v<CGraph, Bit_Tree_Graph>) {
+            bool symm_backup = symmetrize_;
+            symmetrize_ = !csr_graph.directed();
+            auto g = csrToBitTree(csr_graph, true);
+            symmetrize_ = symm_backup;
+            return std::move(g);
         } else {
             static_assert(GMS::always_false<CGraph>, "class not supported");
         }
     }
 #pragma GCC diagnostic pop
 
-struct Tree {
-	Tree* left = 0; // left subtree
-	Tree* right = 0; // right subtree
-	Tree* parent = 0; // parent tree
-	int32_t left_complete = 0; // the left subtree is complete
-
-	Tree(){
-	}
-
-	Tree(Tree* parent_){
-		parent = parent_;
-	}
-};
-
-void remove_tree(Tree* current){
-	if(current->left){
-		remove_tree(current->left);
-	}
-	if(current->right){
-		remove_tree(current->right);
-	}
-	delete current;
-}
-
-My_Bitmap* encode_as_bit_tree(
-        const CSRGraphBase<NodeId_, DestID_, invert> &csr, NodeId u, int8_t k){
-
-	if(csr.out_degree(u) == 0){
-		return new My_Bitmap(0);
-	}
-	// cout << "neighbourhood of " << u << " is: " << endl;
-	// for(int v : csr.in_neigh(u)){
-	// 	cout << v << " " ;
-	// }
-	// cout << endl;
-
-	// this is were we create and encode a bit tree
-	// First we construct an actual tree with pointers
-	Tree* root = new Tree();
-	Tree* current = root;
-	vector<Tree*> leafs = vector<Tree*>();
-	// cout << "STEP 1: " << endl;
-	int32_t size = 1; // this variable counts the number of nodes in the tree
-	for(NodeId v : csr.out_neigh(u)){
-		// cout << "looking at vertex " << v << endl;
-		current = root;
-		for(int i=0; i<k; i++){
-			if((v >> (k-i-1)) & 1){
-				if(!current->right){
-					current->right = new Tree(current);
-					// cout << "inserting right" << endl;
-					size ++;
-				}
-				current = current->right;
-			}
-			else{
-				if(!current->left){
-					current->left = new Tree(current);
-					// cout << "inserting left " << endl;
-					size ++;
-				}
-				current = current->left;
-			}
-		}
-		leafs.push_back(current);
-	}
-	// cout << "STEP 2: " << endl;
-	// Optimization: We remove all complete subtrees
-	for(Tree* leaf : leafs){
-		// If 'leaf' is the left child of its parent, we mark that
-		// the parent has a left subtree that is complete
-		// If 'leaf' is the right child and the parent has a left
-		// child, then we know that the parent is the root of a
-		// complete subtree and we can apply the same algorithm
-		// recursively on the parent as being the 'leaf'
-		current = leaf;
-		while(true){
-			if(current->parent->left == current){
-				current->parent->left_complete = true;
-				break;
-			}
-			else if(current->parent->left_complete){
-				current = current->parent;
-				if(current->right != leaf){
-					size -= 2;
-				}
-				// cout << "removing vertices" << endl;
-				remove_tree(current->left);
-				remove_tree(current->right);
-				current->left = 0;
-				current->right= 0;
-			}
-			else{
-				break;
-			}
-		}
-	}
-	// cout << "STEP 3: " << endl;
-	// Then we do a DFS and encode the tree
-	vector<pair<Tree*, int> > stack = vector<pair<Tree*, int> >();
-	My_Bitmap* encoding = new My_Bitmap(2*(size-leafs.size()));
-	// encoding->reset(); // this was needed when using Beamer's Bitmap
-	int32_t pos = 0;
-	stack.push_back({root, 1});
-	while(!stack.empty()){
-		Tree* current = stack.back().first;
-		int height = stack.back().second;
-		stack.pop_back();
-		if(current->right){
-			// encoding->set_bit(pos+1);
-			encoding->set_bit(pos); // because of endian
-			if(height < k){
-				stack.push_back({current->right, height + 1});
-			}
-		}
-		if(current->left){
-			// encoding->set_bit(pos);
-			encoding->set_bit(pos +1); // because of endian
-			if(height < k){
-				stack.push_back({current->left, height + 1});
-			}
-		}
-		pos += 2;
-	}
-
-
-	// #if REPORT_BITTREE_SIZE
-		// cout << "bittree size: " << encoding->get_size() << "bits" << endl;
-		// cout << "size if encoded with Log(Graph) : " << k*csr.out_degree(u) << "bits" << endl;
-		// cout << "bit tree encoding saved : " << (k*csr.out_degree(u)) - encoding->get_size() << " bits" << endl;
-		bits_saved_with_bittree_encoding += (k*csr.out_degree(u)) - encoding->get_size();
-		if(k*csr.out_degree(u) - encoding->get_size() <= 0){
-			cout << "LOOSING space while encoding neighbourhood " << u << "!!!!" << endl;
-		}
-		bittree_encoding_space += encoding->get_size();
-	// #endif
-	// cout << "done" << endl;
-	// encoding->id = u;
-	remove_tree(root);
-	return encoding;
-}
-
-/* Takes a CSRGraph and turns it into a Kbit_Adjacency_Array */
-Bit_Tree_Graph csrToBitTree(const CSRGraphBase<NodeId_, DestID_, invert> &csr){
+/* Takes a CSRGraph and turns it into a Bit_Tree_Graph. Without 'use_bit_trees'
+   every neighbourhood is k-bit encoded as in a Kbit_Adjacency_Array_Local.
+   The bit trees are laid out in the adjacency array like the k-bit encoded
+   neighbourhoods, so there is no allocation per neighbourhood. */
+Bit_Tree_Graph csrToBitTree(const CSRGraphBase<NodeId_, DestID_, invert> &csr, bool use_bit_trees = BIT_TREE){
 	int64_t n = csr.num_nodes(); // number of vertices
 	int64_t m = csr.num_edges(); // number of vertices
 	bool directed = !symmetrize_;
 
 	vector<NodeId> bitlength = vector<NodeId>(n, 0); // bit-lengths for neighbourhoods
-	#if BIT_TREE
-		vector<bool> bit_tree_encoding = vector<bool>(n, 0); // whether to use bit_tree encoding
-		double alpha = 1.0/(pow(2.0,((log2(n)-2.0)/2.0))); // heuristic
+	vector<int8_t> bit_tree_encoding = vector<int8_t>(n, 0); // whether to use bit_tree encoding
+	pvector<SGOffset> bit_size(n); // bits of the encoded neighbourhoods
+	double alpha = 1.0/(pow(2.0,((log2(n)-2.0)/2.0))); // heuristic
+	if(use_bit_trees){
 		cout << "alpha: " << alpha << endl;
-	#endif
+	}
 
-	// #pragma omp parallel for
-	// very strange race condition...
-	// I do this sequentially for now
-	int number_of_bittree_neighbourhoods = 0;
+	int64_t number_of_bittree_neighbourhoods = 0;
+	#pragma omp parallel for reduction(+ : number_of_bittree_neighbourhoods)
     for (NodeId u=0; u < csr.num_nodes(); u++) {
 		// the following equation defines whether to use Bit Tree Encoding
-		#if BIT_TREE
-			// double alpha = alpha_heuristics[(int)ceil(log2(n))];
-			// alpha = ALPHA;
-			// double alpha = 0.0156;
-			if((double)csr.out_degree(u) / (double)n >= alpha){
-				bit_tree_encoding[u] = true;
-				number_of_bittree_neighbourhoods ++;
-				// cout << u << "!!!" <<  (double)csr.out_degree(u) / (double)n << endl;
-			}
-			// else{
-				// cout << u << "!!!" <<  (double)csr.out_degree(u) / (double)n << endl;
-
-			// }
-		#endif
+		if(use_bit_trees && (double)csr.out_degree(u) / (double)n >= alpha){
+			bit_tree_encoding[u] = true;
+			number_of_bittree_neighbourhoods ++;
+		}
 		#if SIMPLE_GAP_ENCODING
 			NodeId current_vertex = 0;
 			for(DestID_ v : csr.out_neigh(u)){
@@ -971,69 +722,54 @@ Bit_Tree_Graph csrToBitTree(const CSRGraphBase<NodeId_, DestID_, invert> &csr){
 				bitlength[u] = max(bitlength[u], v);
 			}
 		#endif
-	}
-	#pragma omp parallel for
-	for(unsigned int i=0; i<n; i++){
-		bitlength[i] = bitlength[i] == 0 ? 1 : ceil(log2(bitlength[i]+1));
+		bitlength[u] = bitlength[u] == 0 ? 1 : ceil(log2(bitlength[u]+1));
+		bit_size[u] = bit_tree_encoding[u] ?
+			bit_tree_bits(csr.out_neigh(u).begin(), csr.out_neigh(u).end(), bitlength[u]) :
+			csr.out_degree(u)*bitlength[u];
 	}
 
 	// allocate structures
-	vector<int64_t> bit_offset(n+1, 0); // bit offset of neighbourhood in adjacency array
-	for(int i=1; i<=n; i++){
-		#if BIT_TREE
-		if(bit_tree_encoding[i-1])
-			bit_offset[i] = bit_offset[i-1];
-		else
-		#endif
-			bit_offset[i] = bit_offset[i-1] + csr.out_degree(i-1)*bitlength[i-1];
-	}
+	pvector<SGOffset> bit_offset = ParallelPrefixSum(bit_size); // bit offset of neighbourhood in adjacency array
     int32_t* adjacencyArray = (int32_t*) allocate_memory(bit_offset[n], 1);
 	Offset_Array_Entry* O = (Offset_Array_Entry*) calloc(n, sizeof(Offset_Array_Entry));
 	cout << "creating offset array with " << (n)*sizeof(Offset_Array_Entry) << " bytes" << endl;
 
-	for(NodeId u : csr.vertices()){
+	int64_t bittree_space = 0;
+	int64_t bits_saved = 0;
+	#pragma omp parallel for schedule(dynamic, 1024) reduction(+ : bittree_space, bits_saved)
+	for(NodeId u=0; u < n; u++){
 		int64_t k = bitlength[u];
-		#if BIT_TREE
-			if(bit_tree_encoding[u]){
-				O[u].offset_or_tree.tree = encode_as_bit_tree(csr, u, k);
-				continue;
-			}
-		#endif
-		int pos = 0;
+		O[u].degree = (int32_t) csr.out_degree(u);
+		O[u].bitlength = (int8_t) k;
+		O[u].encoding = bit_tree_encoding[u];
+		O[u].offset = bit_offset[u];
+		Kbit_Writer writer(adjacencyArray, bit_offset[u], bit_offset[u+1]);
+		if(bit_tree_encoding[u]){
+			encode_bit_tree(csr.out_neigh(u).begin(), csr.out_neigh(u).end(), k, writer);
+			writer.flush();
+			bittree_space += bit_size[u];
+			bits_saved += k*csr.out_degree(u) - bit_size[u];
+			continue;
+		}
 		#if SIMPLE_GAP_ENCODING
 			NodeId current_vertex = 0;
 		#endif
 		for(NodeId v : csr.out_neigh(u)){
-			int64_t a, b, d, w;
-			int64_t mask = ~((int64_t) -1 << k);
-			char* addr;
 			NodeId to_store = v;
-			a = bit_offset[u] + k*(pos++); // exact bit position where theneighbour is stored
-			b = a >> 3;
-			d = a & 7;
-			addr = (char*)adjacencyArray + b;
-			w = ((int64_t*) addr)[0]; // 64-bit value currently stored here
 			#if SIMPLE_GAP_ENCODING
 				to_store = v - current_vertex;
 				current_vertex = v;
 			#endif
-			((int64_t*) addr)[0] = w | ((to_store & mask) << d);
+			writer.put(to_store, k);
 		}
+		writer.flush();
 	}
+	bittree_encoding_space += bittree_space;
+	bits_saved_with_bittree_encoding += bits_saved;
 
-	for(int i=0; i<n; i++){
-		O[i].degree = (int32_t) csr.out_degree(i);
-		O[i].bitlength = (int8_t) bitlength[i];
-		#if BIT_TREE
-			O[i].encoding = (int8_t) bit_tree_encoding[i];
-			if (!bit_tree_encoding[i])
-		#endif
-		O[i].offset_or_tree.offset = bit_offset[i];
-	}
 	cout << "Bytes for bittree encoded neighourhoods: " << bittree_encoding_space/8 << endl;
 	cout << "Bytes saved with bittree encoding: " << (bits_saved_with_bittree_encoding / 8) << endl;
 	cout << "Percentage of bittree neighbourhoods: " << ((double)number_of_bittree_neighbourhoods/n) << endl;
-	// cout << "done encoding the graph" << endl;
 	return Bit_Tree_Graph(n, m, directed,
 		adjacencyArray, O);
 }
@@ -1195,192 +931,156 @@ void remove_duplicates(EdgeList& el, pvector<NodeId_>& degrees, int64_t& m){
 		return result_map;
 	}
 
+	/* Turns the map of a permuter into the new ID of every vertex */
+	static pvector<NodeId_> permutation_from_map(const std::map<NodeId, NodeId>& permutation, int64_t n) {
+		pvector<NodeId_> new_ids(n);
+		for (auto entry : permutation) {
+			new_ids[entry.first] = entry.second;
+		}
+		return new_ids;
+	}
+
+	/* Rebuilds the neighbourhoods of one direction for RelabelByPermutation:
+	   the neighbourhood of v is neighbourhoods(old_ids[v]) with every
+	   neighbour u renamed to new_ids[u], sorted again */
+	template <class Neighbourhoods>
+	static std::pair<DestID_**, DestID_*> RelabelNeighbourhoods(const pvector<NodeId_>& old_ids,
+			const pvector<NodeId_>& new_ids, Neighbourhoods neighbourhoods) {
+		int64_t n = old_ids.size();
+		pvector<SGOffset> degrees(n);
+		#pragma omp parallel for
+		for (NodeId_ v = 0; v < n; v++) {
+			auto neighbourhood = neighbourhoods(old_ids[v]);
+			degrees[v] = neighbourhood.end() - neighbourhood.begin();
+		}
+		pvector<SGOffset> offsets = ParallelPrefixSum(degrees);
+		DestID_* neighs = new DestID_[offsets[n]];
+		DestID_** index = CSRGraphBase<NodeId_, DestID_>::GenIndex(offsets, neighs);
+		#pragma omp parallel for schedule(dynamic, 1024)
+		for (NodeId_ v = 0; v < n; v++) {
+			DestID_* out = index[v];
+			for (auto u : neighbourhoods(old_ids[v])) {
+				*out++ = new_ids[u];
+			}
+			std::sort(index[v], index[v+1]);
+		}
+		return std::make_pair(index, neighs);
+	}
+
+	/* Rebuilds 'graph' with every vertex v renamed to new_ids[v], in parallel */
+	static CSRGraphBase<NodeId_, DestID_, invert> RelabelByPermutation(
+			const CSRGraphBase<NodeId_, DestID_, invert>& graph, const pvector<NodeId_>& new_ids) {
+		pvector<NodeId_> old_ids(graph.num_nodes());
+		#pragma omp parallel for
+		for (NodeId_ v = 0; v < graph.num_nodes(); v++) {
+			old_ids[new_ids[v]] = v;
+		}
+		auto out = RelabelNeighbourhoods(old_ids, new_ids, [&](NodeId_ v) { return graph.out_neigh(v); });
+		if (graph.directed()) {
+			auto in = RelabelNeighbourhoods(old_ids, new_ids, [&](NodeId_ v) { return graph.in_neigh(v); });
+			return CSRGraphBase<NodeId_, DestID_, invert>(graph.num_nodes(), out.first, out.second, in.first, in.second);
+		}
+		return CSRGraphBase<NodeId_, DestID_, invert>(graph.num_nodes(), out.first, out.second);
+	}
+
 	template <PermuterVariant TVariant>
     const CSRGraphBase<NodeId_, DestID_, invert> permute(CSRGraphBase<NodeId_, DestID_, invert> graph) {
 
-        std::map<NodeId, NodeId> permutation;
+        pvector<NodeId_> new_ids;
 
         if constexpr (TVariant == PermuterVariant::OutDegreeAscending) {
-            permutation = OutDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OutDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OutDegreeDescending) {
-            permutation = OutDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OutDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::InDegreeAscending) {
-            permutation = InDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(InDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::InDegreeDescending) {
-            permutation = InDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(InDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
+        } else if constexpr (TVariant == PermuterVariant::BfsOrder) {
+            new_ids = BfsOrderPermuter<NodeId_, DestID_, invert>::permutation(graph);
+        } else if constexpr (TVariant == PermuterVariant::RecursiveBisection) {
+            new_ids = BpPermuter<NodeId_, DestID_, invert>::permutation(graph);
+        } else if constexpr (TVariant == PermuterVariant::Shingle) {
+            new_ids = ShinglePermuter<NodeId_, DestID_, invert>::permutation(graph);
+        } else if constexpr (TVariant == PermuterVariant::LayeredLabelPropagation) {
+            new_ids = LlpPermuter<NodeId_, DestID_, invert>::permutation(graph);
         }
 #ifdef CPLEX_ENABLED
         else if constexpr (TVariant == PermuterVariant::OptimalDiffNnIlpUnconstr) {
-            permutation = OptimalDiffNNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffNNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffNnLpUnconstr) {
-            permutation = OptimalDiffNNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffNNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffNnIlpConstr) {
-            permutation = OptimalDiffNNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffNNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffNnLpConstr) {
-            permutation = OptimalDiffNNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffNNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffVnIlpUnconstr) {
-            permutation = OptimalDiffVNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffVNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffVnLpUnconstr) {
-            permutation = OptimalDiffVNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffVNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffVnIlpConstr) {
-            permutation = OptimalDiffVNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffVNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OptimalDiffVnLpConstr) {
-            permutation = OptimalDiffVNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OptimalDiffVNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OIlpNnUnN) {
-            permutation = OIlpNNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OIlpNNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OIlpNnConN) {
-            permutation = OIlpNNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OIlpNNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OIlpVnUnN) {
-            permutation = OIlpVNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OIlpVNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         } else if constexpr (TVariant == PermuterVariant::OIlpVnConN) {
-            permutation = OIlpVNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+            new_ids = permutation_from_map(OIlpVNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         }
 #endif // CPLEX_ENABLED
         else {
             static_assert(GMS::always_false<TVariant>, "should be unreachable");
         }
 
-        DestID_** new_out_index = new DestID_*[graph.num_nodes() + 1]();
-        DestID_* new_out_neighbours = new DestID_[graph.num_edges() * (graph.directed() ? 1 : 2)];
-
-        std::map<NodeId, NodeId> reverse_permutation;
-        reverse_permutation = get_reverse_permutation(permutation);
-
-
-        uint64_t offset_index = 0;
-        uint64_t neigh_index = 0;
-        for (auto v : graph.vertices()) {
-            NodeId v_old = reverse_permutation[v];
-            new_out_index[offset_index] = (new_out_neighbours + neigh_index);
-
-            for (auto u_old : graph.out_neigh(v_old)) {
-                new_out_neighbours[neigh_index] = permutation[u_old];
-                neigh_index++;
-            }
-
-            std::sort(new_out_index[offset_index], new_out_neighbours + neigh_index);
-            offset_index++;
-        }
-        new_out_index[graph.num_nodes()] = new_out_neighbours + (graph.num_edges() * (graph.directed() ? 1 : 2));
-
-
-        if (graph.directed()) {
-            DestID_** new_in_index = new DestID_*[graph.num_nodes() + 1]();
-            DestID_* new_in_neighbours = new DestID_[graph.num_edges() * (graph.directed() ? 1 : 2)];
-
-            offset_index = 0;
-            neigh_index = 0;
-            for (auto v : graph.vertices()) {
-                NodeId v_old = reverse_permutation[v];
-                new_in_index[offset_index] = (new_in_neighbours + neigh_index);
-
-                for (auto u_old : graph.in_neigh(v_old)) {
-                    new_in_neighbours[neigh_index] = permutation[u_old];
-                    neigh_index++;
-                }
-
-                std::sort(new_in_index[offset_index], new_in_neighbours + neigh_index);
-                offset_index++;
-            }
-            new_in_index[graph.num_nodes()] = new_in_neighbours + (graph.num_edges() * (graph.directed() ? 1 : 2));
-
-            return CSRGraphBase<NodeId_, DestID_, invert>(graph.num_nodes(), new_out_index, new_out_neighbours, new_in_index, new_in_neighbours);
-        } else {
-
-            return CSRGraphBase<NodeId_, DestID_, invert>(graph.num_nodes(), new_out_index, new_out_neighbours);
-        }
+        return RelabelByPermutation(graph, new_ids);
     }
 
-    // TODO deprecate or forward to the template permute function
+    // TODO deprecate in favour of the template permute function
 	const CSRGraphBase<NodeId_, DestID_, invert> permute(CSRGraphBase<NodeId_, DestID_, invert> graph) {
 
-		std::map<NodeId, NodeId> permutation;
+		pvector<NodeId_> new_ids;
 
 		#if OUT_ASCENDING
-			permutation = OutDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+			new_ids = permutation_from_map(OutDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         #elif OUT_DESCENDING
-			permutation = OutDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+			new_ids = permutation_from_map(OutDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         #elif IN_ASCENDING
-			permutation = InDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+			new_ids = permutation_from_map(InDegreeAscendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
         #elif IN_DESCENDING
-			permutation = InDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+			new_ids = permutation_from_map(InDegreeDescendingPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 		#elif CPLEX_ENABLED
 			#if OPTIMAL_DIFF_NN_ILP_UNCONSTR
-				permutation = OptimalDiffNNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffNNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_NN_LP_UNCONSTR
-				permutation = OptimalDiffNNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffNNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_NN_ILP_CONSTR
-				permutation = OptimalDiffNNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffNNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_NN_LP_CONSTR
-				permutation = OptimalDiffNNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffNNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_VN_ILP_UNCONSTR
-				permutation = OptimalDiffVNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffVNIlpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_VN_LP_UNCONSTR
-				permutation = OptimalDiffVNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffVNLpUnconstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_VN_ILP_CONSTR
-				permutation = OptimalDiffVNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffVNIlpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif OPTIMAL_DIFF_VN_LP_CONSTR
-				permutation = OptimalDiffVNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OptimalDiffVNLpConstrPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif O_ILP_NN_UN_N
-				permutation = OIlpNNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OIlpNNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif O_ILP_NN_CON_N
-				permutation = OIlpNNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OIlpNNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif O_ILP_VN_UN_N
-				permutation = OIlpVNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OIlpVNUnNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#elif O_ILP_VN_CON_N
-				permutation = OIlpVNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph);
+				new_ids = permutation_from_map(OIlpVNConNPermuter<NodeId_, DestID_, invert>::permutation_map(graph), graph.num_nodes());
 			#endif
 		#endif
 
-		DestID_** new_out_index = new DestID_*[graph.num_nodes() + 1]();
-		DestID_* new_out_neighbours = new DestID_[graph.num_edges() * (graph.directed() ? 1 : 2)];
-
-		std::map<NodeId, NodeId> reverse_permutation;
-		reverse_permutation = get_reverse_permutation(permutation);
-
-
-		uint64_t offset_index = 0;
-		uint64_t neigh_index = 0;
-		for (auto v : graph.vertices()) {
-			NodeId v_old = reverse_permutation[v];
-			new_out_index[offset_index] = (new_out_neighbours + neigh_index);
-
-			for (auto u_old : graph.out_neigh(v_old)) {
-                new_out_neighbours[neigh_index] = permutation[u_old];
-				neigh_index++;
-			}
-
-			std::sort(new_out_index[offset_index], new_out_neighbours + neigh_index);
-			offset_index++;
-		}
-		new_out_index[graph.num_nodes()] = new_out_neighbours + (graph.num_edges() * (graph.directed() ? 1 : 2));
-
-
-		if (graph.directed()) {
-			DestID_** new_in_index = new DestID_*[graph.num_nodes() + 1]();
-			DestID_* new_in_neighbours = new DestID_[graph.num_edges() * (graph.directed() ? 1 : 2)];
-
-			offset_index = 0;
-			neigh_index = 0;
-			for (auto v : graph.vertices()) {
-				NodeId v_old = reverse_permutation[v];
-				new_in_index[offset_index] = (new_in_neighbours + neigh_index);
-
-				for (auto u_old : graph.in_neigh(v_old)) {
-                    new_in_neighbours[neigh_index] = permutation[u_old];
-					neigh_index++;
-				}
-
-				std::sort(new_in_index[offset_index], new_in_neighbours + neigh_index);
-				offset_index++;
-			}
-			new_in_index[graph.num_nodes()] = new_in_neighbours + (graph.num_edges() * (graph.directed() ? 1 : 2));
-
-			return CSRGraphBase<NodeId_, DestID_, invert>(graph.num_nodes(), new_out_index, new_out_neighbours, new_in_index, new_in_neighbours);
-		} else {
-
-			return CSRGraphBase<NodeId_, DestID_, invert>(graph.num_nodes(), new_out_index, new_out_neighbours);
-		}
+		return RelabelByPermutation(graph, new_ids);
 	}
 
 
@@ -1406,6 +1106,8 @@ void remove_duplicates(EdgeList& el, pvector<NodeId_>& degrees, int64_t& m){
 					return csrToVarintByteBased(csr);
                 #elif VARINT_WORD_BASED
 					return csrToVarintWordBased(csr);
+                #elif STREAM_VBYTE
+					return csrToStreamVByte(csr);
                 #endif
             #else
 			return csrToKbit(csr);
@@ -0,0 +1,231 @@
+#include "test_helper.h"
+#include <gms/common/benchmark.h>
+#include <gms/common/papi/counters.h>
+#include <gms/representations/graphs/set_graph.h>
+#include <optional>
+
+using namespace GMS;
+
+TEST(BenchmarkStats, Summary) {
+    BenchmarkStats stats = BenchmarkStats::From({4.0, 1.0, 3.0, 2.0});
+    EXPECT_EQ(stats.count, 4);
+    EXPECT_DOUBLE_EQ(stats.min, 1.0);
+    EXPECT_DOUBLE_EQ(stats.median, 2.5);
+    EXPECT_DOUBLE_EQ(stats.mean, 2.5);
+    EXPECT_NEAR(stats.stddev, 1.2909944, 1e-6);
+    // t(0.975, 3) * stddev / sqrt(4)
+    EXPECT_NEAR(stats.ci95_high - stats.mean, 3.182 * 1.2909944 / 2, 1e-6);
+    EXPECT_NEAR(stats.mean - stats.ci95_low, 3.182 * 1.2909944 / 2, 1e-6);
+
+    BenchmarkStats single = BenchmarkStats::From({0.5});
+    EXPECT_DOUBLE_EQ(single.median, 0.5);
+    EXPECT_DOUBLE_EQ(single.stddev, 0);
+    EXPECT_DOUBLE_EQ(single.ci95_low, 0.5);
+    EXPECT_DOUBLE_EQ(single.ci95_high, 0.5);
+}
+
+TEST(BenchmarkFingerprint, DependsOnDegreeSequence) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    CSRGraph h = loadGraphFromFile("tomitaExample.el");
+    EXPECT_EQ(graph_fingerprint(g), graph_fingerprint(loadGraphFromFile("eppsteinExample.el")));
+    EXPECT_NE(graph_fingerprint(g), graph_fingerprint(h));
+    // the set graphs provide the same degrees
+    EXPECT_EQ(graph_fingerprint(g), graph_fingerprint(SortedSetGraph::FromCGraph(g)));
+}
+
+TEST(Benchmark, RunsStagesAndSkipsWarmup) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    CLI::Args args;
+    args.num_trials = 3;
+    args.verify = true;
+    args.report.warmup_trials = 2;
+
+    int setups = 0, preprocesses = 0, kernels = 0, verifies = 0, teardowns = 0;
+    BenchmarkReport report = Benchmark(args).graph(g).info("test", "stages")
+        .setup([&]() { setups++; })
+        .preprocess([&]() { preprocesses++; })
+        .teardown([&]() { teardowns++; })
+        .run([&]() { return ++kernels; },
+             [&](int result) { verifies++; return result > 2; });
+
+    EXPECT_EQ(setups, 1);
+    EXPECT_EQ(preprocesses, 5);
+    EXPECT_EQ(kernels, 5);
+    EXPECT_EQ(verifies, 3);
+    EXPECT_EQ(teardowns, 1);
+    EXPECT_EQ(report.stats("kernel").count, 3);
+    EXPECT_EQ(report.stats("preprocess").count, 3);
+    EXPECT_EQ(report.stats("verify").count, 3);
+    EXPECT_EQ(report.stats("setup").count, 1);
+    EXPECT_EQ(report.label(), "test stages");
+}
+
+TEST(Benchmark, Records) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    CLI::Args args;
+    args.num_trials = 2;
+    args.verify = true;
+    args.report.graph_name = "eppstein, \"example\"";
+
+    Benchmark bench(args);
+    bench.graph(g).set_type<SortedSetGraph>().info("records");
+    BenchmarkReport report = bench.run([]() { return 1; }, [](int) { return false; },
+                                       [&](int result) { bench.metric("result", result); });
+
+    const std::string json = report.json_record();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '\n');
+    EXPECT_NE(json.find("\"label\":\"records\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"eppstein, \\\"example\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"nodes\":" + std::to_string(g.num_nodes())), std::string::npos);
+    EXPECT_NE(json.find("\"set_type\":\"SetGraph<SortedSet"), std::string::npos);
+    EXPECT_NE(json.find("\"git_sha\":"), std::string::npos);
+    EXPECT_NE(json.find("\"verification\":\"FAIL\""), std::string::npos);
+    EXPECT_NE(json.find("\"kernel\":{"), std::string::npos);
+    EXPECT_NE(json.find("\"result\":{\"min\":1"), std::string::npos);
+
+    const std::string csv = report.csv_rows();
+    // one row per stage (kernel and verify) and one per metric
+    EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), 3);
+    EXPECT_EQ(csv.rfind("records,\"eppstein, \"\"example\"\"\",", 0), 0u);
+    EXPECT_NE(csv.find(",stage,kernel,"), std::string::npos);
+    EXPECT_NE(csv.find(",metric,result,1,1,1,"), std::string::npos);
+    const std::string header = BenchmarkReport::csv_header();
+    EXPECT_EQ(std::count(header.begin(), header.end(), ','), 18);
+}
+
+class LegacyCLI : public CLApp, public ReportOptions {
+public:
+    LegacyCLI() : CLApp(0, {}, "legacy") {
+        num_trials_ = 2;
+        do_analysis_ = true;
+    }
+};
+
+TEST(Benchmark, LegacyKernelWritesRecords) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    LegacyCLI cli;
+    cli.report_spec.format = "json";
+    cli.report_spec.file = testing::TempDir() + "legacy_records.json";
+    std::remove(cli.report_spec.file.c_str());
+
+    int kernels = 0, analyses = 0;
+    BenchmarkKernelLegacy(cli, g, [&](const CSRGraph &) { return ++kernels; },
+                          [&](const CSRGraph &, int result) { analyses++; EXPECT_EQ(result, 2); },
+                          VerifyUnimplemented, "legacy");
+    EXPECT_EQ(kernels, 2);
+    // the stats are only printed for the last trial
+    EXPECT_EQ(analyses, 1);
+
+    std::ifstream in(cli.report_spec.file);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_NE(json.find("\"label\":\"legacy\""), std::string::npos);
+    EXPECT_NE(json.find("\"trials\":2"), std::string::npos);
+    std::remove(cli.report_spec.file.c_str());
+}
+
+class WarmupVerifyCLI : public CLApp, public ReportOptions {
+public:
+    WarmupVerifyCLI() : CLApp(0, {}, "warmup") {
+        num_trials_ = 3;
+        do_verify_ = true;
+        report_spec.warmup_trials = 2;
+    }
+};
+
+TEST(Benchmark, WarmupTrialsKeepVerifiedSources) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    WarmupVerifyCLI cli;
+    cli.report_spec.format = "json";
+    cli.report_spec.file = testing::TempDir() + "warmup_records.json";
+    std::remove(cli.report_spec.file.c_str());
+
+    // the pattern of the bfs and sssp drivers: the verifier checks the source of the trial it follows
+    SourcePicker<CSRGraph> sp(g);
+    NodeId source = -1;
+    int verifies = 0;
+    BenchmarkKernelLegacy(cli, g, [&](const CSRGraph &) { return source = sp.PickNext(); },
+                          [](const CSRGraph &, NodeId) {},
+                          [&](const CSRGraph &, NodeId picked) { verifies++; return picked == source; },
+                          "single");
+    EXPECT_EQ(verifies, 3);
+
+    // the pattern of the bc drivers: the verifier replays the sources the kernel drew
+    SourcePicker<CSRGraph> msp(g);
+    std::optional<SourcePicker<CSRGraph>> vsp;
+    BenchmarkKernelLegacy(cli, g,
+                          [&](const CSRGraph &) {
+                              vsp.emplace(msp);
+                              return std::vector<NodeId>{msp.PickNext(), msp.PickNext()};
+                          },
+                          [](const CSRGraph &, const std::vector<NodeId> &) {},
+                          [&](const CSRGraph &, const std::vector<NodeId> &picked) {
+                              return picked[0] == vsp->PickNext() && picked[1] == vsp->PickNext();
+                          },
+                          "multi");
+
+    std::ifstream in(cli.report_spec.file);
+    int records = 0;
+    for (std::string line; std::getline(in, line); records++) {
+        EXPECT_NE(line.find("\"verification\":\"PASS\""), std::string::npos) << line;
+    }
+    EXPECT_EQ(records, 2);
+    std::remove(cli.report_spec.file.c_str());
+}
+
+TEST(Benchmark, CsvFileHoldsStagesAndMetrics) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    CLI::Args args;
+    args.num_trials = 2;
+    args.report.format = "csv";
+    args.report.file = testing::TempDir() + "records.csv";
+    std::remove(args.report.file.c_str());
+
+    Benchmark bench(args);
+    bench.graph(g).info("csv");
+    bench.run([]() { return 3; }, nullptr, [&](int result) { bench.metric("instr.result", result); });
+
+    std::ifstream in(args.report.file);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0] + "\n", BenchmarkReport::csv_header());
+    EXPECT_NE(lines[1].find(",stage,kernel,"), std::string::npos);
+    EXPECT_NE(lines[2].find(",metric,instr.result,3,3,3,0,"), std::string::npos);
+    std::remove(args.report.file.c_str());
+}
+
+TEST(BenchmarkCounters, ParsesEventsAndPresets) {
+    EXPECT_THAT(PAPIW::parse_counters("PAPI_L2_TCM,TOT_INS"), testing::ElementsAre("L2_TCM", "TOT_INS"));
+    EXPECT_THAT(PAPIW::parse_counters("branch,,BR_INS,ipc"),
+                testing::ElementsAre("BR_INS", "BR_MSP", "TOT_INS", "TOT_CYC"));
+    EXPECT_TRUE(PAPIW::parse_counters("").empty());
+    EXPECT_TRUE(PAPIW::CounterSet("").empty());
+}
+
+TEST(BenchmarkCounters, ReportedPerTrial) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    CLI::Args args;
+    args.num_trials = 2;
+    // the software event is available in virtual machines as well, unless perf_event_open is not permitted
+    args.report.counters = "PAGE_FAULTS,NO_SUCH_EVENT";
+
+    PAPIW::CounterSet counters(args.report.counters);
+    BenchmarkReport report = Benchmark(args).graph(g).run([]() {
+        std::vector<char> pages(1 << 22, 1);
+        return pages.back();
+    });
+
+    const std::string json = report.json_record();
+    EXPECT_EQ(json.find("NO_SUCH_EVENT"), std::string::npos);
+    if (counters.empty()) {
+        GTEST_SKIP() << "perf_event_open is not available";
+    }
+    EXPECT_THAT(counters.names(), testing::ElementsAre("PAGE_FAULTS"));
+    const size_t at = json.find("\"counter.PAGE_FAULTS\":{\"min\":");
+    ASSERT_NE(at, std::string::npos);
+    EXPECT_GT(std::stod(json.substr(at + 29)), 0);
+    EXPECT_NE(report.csv_rows().find(",metric,counter.PAGE_FAULTS,"), std::string::npos);
+}
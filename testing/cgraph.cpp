@@ -1,4 +1,11 @@
 #include "test_helper.h"
+#include <gms/representations/graphs/log_graph/compressed_graph.h>
+#include <gms/representations/graphs/log_graph/afforest.h>
+#include <gms/representations/graphs/log_graph/brandes.h>
+#include <gms/representations/graphs/log_graph/delta_stepping.h>
+#include <gms/representations/graphs/log_graph/pagerank.h>
+#include <omp.h>
+#include <queue>
 
 template <class TSet>
 class CGraphTest : public testing::Test
@@ -13,8 +20,10 @@ testing::Types<
         CSRGraph,
         Kbit_Adjacency_Array,
         Kbit_Adjacency_Array_Local,
+        Bit_Tree_Graph,
         VarintByteBasedGraph,
-        VarintWordBasedGraph
+        VarintWordBasedGraph,
+        StreamVByteGraph
 >;
 
 TYPED_TEST_SUITE(CGraphTest, Implementations);
@@ -89,3 +98,440 @@ TYPED_TEST(CGraphTest, Neighborhood)
     }
     ASSERT_THAT(neigh, UnorderedElementsAre(0));
 }
+
+TEST(KbitDecode, MatchesBitwiseReference)
+{
+    std::vector<uint64_t> words(64);
+    uint64_t state = 42;
+    for (uint64_t &w : words) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        w = state ^ (state >> 29);
+    }
+    const char *bits = (const char *) words.data();
+    auto reference = [&](int64_t offset, int k) {
+        uint32_t value = 0;
+        for (int b = 0; b < k; ++b) {
+            value |= uint32_t((bits[(offset + b) >> 3] >> ((offset + b) & 7)) & 1) << b;
+        }
+        return (int32_t) value;
+    };
+
+    for (int k = 1; k <= 31; ++k) {
+        for (int64_t offset = 0; offset < 16; ++offset) {
+            // leave room for the trailing 64-bit loads
+            const int64_t count = (int64_t(words.size() - 2) * 64 - offset) / k;
+            std::vector<int32_t> decoded(count);
+            kbit_decode(words.data(), offset, k, count, decoded.data());
+            for (int64_t i = 0; i < count; ++i) {
+                ASSERT_EQ(decoded[i], reference(offset + i * k, k)) << "k=" << k << " offset=" << offset;
+                ASSERT_EQ((int32_t) kbit_extract(words.data(), offset + i * k, k), decoded[i]);
+            }
+        }
+    }
+}
+
+template <class KGraph>
+void ExpectKbitNeighbourhoodsMatch(const char *graph_file)
+{
+    CSRGraph csr = loadGraphFromFile(graph_file);
+    CLBase cli(0, {}, "dummy");
+    Builder builder(cli);
+    KGraph g = builder.csrToCGraphGeneric<KGraph>(csr);
+
+    std::vector<NodeId> buffer;
+    for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+        std::vector<NodeId> expected(csr.out_neigh(u).begin(), csr.out_neigh(u).end());
+        std::vector<NodeId> iterated;
+        for (NodeId v : g.out_neigh(u)) {
+            iterated.push_back(v);
+        }
+        auto decoded = g.out_neigh(u).decode(buffer);
+        ASSERT_EQ(iterated, expected);
+        ASSERT_EQ(std::vector<NodeId>(decoded.begin(), decoded.end()), expected);
+    }
+}
+
+TEST(KbitNeighbourhood, DecodeMatchesCSR)
+{
+    ExpectKbitNeighbourhoodsMatch<Kbit_Adjacency_Array>("smallRandom1.el");
+    ExpectKbitNeighbourhoodsMatch<Kbit_Adjacency_Array_Local>("smallRandom1.el");
+}
+
+template <class CGraph>
+void ExpectCompressedGraphAccessMatches(const CSRGraph &csr, const CGraph &g)
+{
+    static_assert(is_compressed_graph_v<CGraph>);
+    std::vector<NodeId> buffer;
+    for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+        std::vector<NodeId> expected(csr.out_neigh(u).begin(), csr.out_neigh(u).end());
+        std::vector<NodeId> iterated;
+        for_each_out_neigh(g, u, [&](NodeId v) { iterated.push_back(v); });
+        ASSERT_EQ(iterated, expected);
+
+        auto decoded = decoded_out_neigh(g, u, buffer);
+        ASSERT_EQ(std::vector<NodeId>(decoded.begin(), decoded.end()), expected);
+
+        // a bounded decode holds at least the neighbours up to the bound
+        auto bounded = decoded_out_neigh(g, u, buffer, u);
+        auto upto_u = std::upper_bound(expected.begin(), expected.end(), u) - expected.begin();
+        ASSERT_GE(bounded.size(), upto_u);
+        ASSERT_TRUE(std::equal(bounded.begin(), bounded.end(), expected.begin()));
+
+        int64_t visited = 0;
+        for_each_out_neigh(g, u, [&](NodeId) { return ++visited < 2; });
+        ASSERT_EQ(visited, std::min<int64_t>(expected.size(), 2));
+    }
+}
+
+TYPED_TEST(CGraphTest, CompressedGraphAccessMatchesCSR)
+{
+    CSRGraph csr = loadGraphFromFile("smallRandom1.el");
+    if constexpr (std::is_same_v<TypeParam, CSRGraph>) {
+        ExpectCompressedGraphAccessMatches(csr, csr);
+    } else {
+        CLBase cli(0, {}, "dummy");
+        Builder builder(cli);
+        ExpectCompressedGraphAccessMatches(csr, builder.csrToCGraphGeneric<TypeParam>(csr));
+    }
+}
+
+TYPED_TEST(CGraphTest, AfforestFindsComponents)
+{
+    CSRGraph csr = loadGraphFromFile("smallRandom1.el", true);
+    // reference labels: the smallest vertex of each component
+    pvector<NodeId> expected(csr.num_nodes(), -1);
+    for (NodeId s = 0; s < csr.num_nodes(); ++s) {
+        if (expected[s] != -1) {
+            continue;
+        }
+        std::vector<NodeId> stack = {s};
+        expected[s] = s;
+        while (!stack.empty()) {
+            NodeId u = stack.back();
+            stack.pop_back();
+            for (NodeId v : csr.out_neigh(u)) {
+                if (expected[v] == -1) {
+                    expected[v] = s;
+                    stack.push_back(v);
+                }
+            }
+        }
+    }
+    pvector<NodeId> comp;
+    if constexpr (std::is_same_v<TypeParam, CSRGraph>) {
+        comp = Afforest(csr);
+    } else {
+        CLBase cli(0, {}, "dummy");
+        Builder builder(cli);
+        comp = Afforest(builder.csrToCGraphGeneric<TypeParam>(csr));
+    }
+    for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+        ASSERT_EQ(comp[u], expected[u]);
+    }
+}
+
+static CSRGraph generate_kronecker(int64_t scale, int64_t degree)
+{
+    GMS::CLI::Args args;
+    args.graph_spec.is_generator = true;
+    args.graph_spec.name = "kronecker";
+    args.graph_spec.gen_scale = scale;
+    args.graph_spec.gen_avgdeg = degree;
+    return args.load_graph();
+}
+
+TYPED_TEST(CGraphTest, MultiSourceBrandesMatchesBrandes)
+{
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    CSRGraph csr = generate_kronecker(10, 8);
+    // a full batch of 64 sources and a partial one
+    const NodeId num_sources = 70;
+    auto compare = [&](const auto &g) {
+        using G = std::decay_t<decltype(g)>;
+        SourcePicker<G> sp(g), ms_sp(g);
+        const pvector<ScoreT> expected = Brandes(g, sp, num_sources);
+        const pvector<ScoreT> scores = MSBrandes(g, ms_sp, num_sources);
+        for (NodeId u = 0; u < g.num_nodes(); ++u) {
+            ASSERT_FLOAT_EQ(scores[u], expected[u]) << "vertex " << u;
+        }
+    };
+    if constexpr (std::is_same_v<TypeParam, CSRGraph>) {
+        compare(csr);
+    } else {
+        CLBase cli(0, {}, "dummy");
+        Builder builder(cli);
+        compare(builder.csrToCGraphGeneric<TypeParam>(csr));
+    }
+    omp_set_num_threads(threads);
+}
+
+template <class G>
+void ExpectPropagationBlockingMatchesPull(const G &g)
+{
+    const int iterations = 20;
+    const pvector<ScoreT> expected = PageRankPull(g, iterations);
+    const pvector<ScoreT> scores = PageRankPB(g, iterations);
+    const pvector<ScoreT> bf16_scores = PageRankPB<G, BFloat16>(g, iterations);
+    double error = 0, bf16_error = 0;
+    for (NodeId u = 0; u < g.num_nodes(); ++u) {
+        error += std::fabs(scores[u] - expected[u]);
+        bf16_error += std::fabs(bf16_scores[u] - expected[u]);
+    }
+    // the total error which kbit_pr accepts for float and for bfloat16 contributions
+    EXPECT_LT(error, 1e-4);
+    EXPECT_LT(bf16_error, 1e-3);
+    EXPECT_GT(bf16_error, error);
+}
+
+TEST(PageRank, PropagationBlockingMatchesPull)
+{
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    // more than one bin of kBinWidth destinations
+    CSRGraph csr = generate_kronecker(17, 4);
+    ASSERT_GT(csr.num_nodes(), kBinWidth);
+    ExpectPropagationBlockingMatchesPull(csr);
+    CLBase cli(0, {}, "dummy");
+    Builder builder(cli);
+    ExpectPropagationBlockingMatchesPull(builder.csrToCGraphGeneric<Kbit_Adjacency_Array>(csr));
+    omp_set_num_threads(threads);
+}
+
+TEST(PageRank, PropagationBlockingWithFewerThreadsThanRanges)
+{
+    const int threads = omp_get_max_threads();
+    const int levels = omp_get_max_active_levels();
+    omp_set_num_threads(4);
+    omp_set_max_active_levels(1);
+    CSRGraph csr = generate_kronecker(12, 8);
+    const pvector<ScoreT> expected = PageRankPull(csr, 20);
+    pvector<ScoreT> scores;
+    // the kernel plans 4 ranges, but its nested regions only get one thread
+    #pragma omp parallel num_threads(2)
+    {
+        #pragma omp single
+        scores = PageRankPB(csr, 20);
+    }
+    double error = 0;
+    for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+        error += std::fabs(scores[u] - expected[u]);
+    }
+    EXPECT_LT(error, 1e-4);
+    omp_set_max_active_levels(levels);
+    omp_set_num_threads(threads);
+}
+
+template <class WeightedGraph>
+void ExpectWeightedAccessMatches(const WGraph &csr, const WeightedGraph &g)
+{
+    for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+        std::vector<std::pair<NodeId, WeightT>> expected, iterated;
+        for (WNode wn : csr.out_neigh(u)) {
+            expected.emplace_back(wn.v, wn.w);
+        }
+        for_each_weighted_out_neigh(g, u, [&](NodeId v, WeightT w) { iterated.emplace_back(v, w); });
+        ASSERT_EQ(iterated, expected);
+    }
+}
+
+TEST(WeightedGraphs, WeightedAccessMatchesCSR)
+{
+    CSRGraph unweighted = loadGraphFromFile("smallRandom1.el");
+    pvector<EdgePair<NodeId, WNode>> el;
+    for (NodeId u = 0; u < unweighted.num_nodes(); ++u) {
+        for (NodeId v : unweighted.out_neigh(u)) {
+            el.push_back(EdgePair<NodeId, WNode>(u, WNode(v)));
+        }
+    }
+    CLBase cli(0, {}, "dummy");
+    WeightedBuilder builder(cli);
+    WGraph csr = builder.MakeGraphFromEL(el);
+    ExpectWeightedAccessMatches(csr, csr);
+    ExpectWeightedAccessMatches(csr, builder.csrToWeightedKbit(csr));
+    ExpectWeightedAccessMatches(csr, builder.csrToWeightedKbitLocal(csr));
+}
+
+/* A weighted copy of g, where the weights are spread over 1..max_weight */
+static WGraph with_hashed_weights(const CSRGraph &g, WeightT max_weight)
+{
+    pvector<EdgePair<NodeId, WNode>> el;
+    for (NodeId u = 0; u < g.num_nodes(); ++u) {
+        for (NodeId v : g.out_neigh(u)) {
+            uint64_t hash = GMS::Random::mix64((uint64_t(u) << 32) | uint64_t(v));
+            el.push_back(EdgePair<NodeId, WNode>(u, WNode(v, 1 + WeightT(hash % max_weight))));
+        }
+    }
+    CLBase cli(0, {}, "dummy");
+    WeightedBuilder builder(cli);
+    return builder.MakeGraphFromEL(el);
+}
+
+static pvector<WeightT> dijkstra(const WGraph &g, NodeId source)
+{
+    pvector<WeightT> dist(g.num_nodes(), kDistInf);
+    dist[source] = 0;
+    using WN = std::pair<WeightT, NodeId>;
+    std::priority_queue<WN, std::vector<WN>, std::greater<WN>> queue;
+    queue.push({0, source});
+    while (!queue.empty()) {
+        auto [d, u] = queue.top();
+        queue.pop();
+        if (d != dist[u]) {
+            continue;
+        }
+        for (WNode wn : g.out_neigh(u)) {
+            if (d + wn.w < dist[wn.v]) {
+                dist[wn.v] = d + wn.w;
+                queue.push({dist[wn.v], wn.v});
+            }
+        }
+    }
+    return dist;
+}
+
+template <class WeightedGraph>
+void ExpectDeltaSteppingMatches(const WGraph &csr, const WeightedGraph &g, NodeId source)
+{
+    const pvector<WeightT> expected = dijkstra(csr, source);
+    // delta 1 puts every distance in a bin of its own, the largest one puts everything in a single bin
+    for (WeightT delta : {WeightT(1), WeightT(7), WeightT(64), AutoDelta(g), WeightT(1 << 20)}) {
+        const pvector<WeightT> dist = DeltaStep(g, source, delta);
+        for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+            ASSERT_EQ(dist[u], expected[u]) << "delta " << delta << ", vertex " << u;
+        }
+    }
+}
+
+TEST(WeightedGraphs, DeltaSteppingMatchesDijkstra)
+{
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    WGraph csr = with_hashed_weights(generate_kronecker(10, 8), 1000);
+    NodeId source = 0;
+    while (csr.out_degree(source) == 0) {
+        ++source;
+    }
+    CLBase cli(0, {}, "dummy");
+    WeightedBuilder builder(cli);
+    ExpectDeltaSteppingMatches(csr, csr, source);
+    ExpectDeltaSteppingMatches(csr, builder.csrToWeightedKbit(csr), source);
+    ExpectDeltaSteppingMatches(csr, builder.csrToWeightedKbitLocal(csr), source);
+    omp_set_num_threads(threads);
+}
+
+TEST(BitTreeEncoding, DecodeMatchesInput)
+{
+    const int k = 6;
+    std::vector<std::vector<NodeId>> neighbourhoods = {
+        {0},
+        {63},
+        {0, 1},           // complete leaf pair
+        {4, 5, 6, 7, 9},  // complete subtree and a single leaf
+        {1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, 40, 62},
+    };
+    std::vector<NodeId> all(1 << k);
+    std::iota(all.begin(), all.end(), 0); // the whole tree is complete
+    neighbourhoods.push_back(all);
+    std::vector<NodeId> even;
+    for (NodeId v = 0; v < (1 << k); v += 2) {
+        even.push_back(v);
+    }
+    neighbourhoods.push_back(even);
+
+    std::vector<NodeId> buffer;
+    for (const auto &expected : neighbourhoods) {
+        // at an odd bit offset, behind another tree, as in the adjacency array
+        const NodeId *first = expected.data(), *last = expected.data() + expected.size();
+        int64_t begin = 3 + bit_tree_bits(first, last, k);
+        int64_t end = begin + bit_tree_bits(first, last, k);
+        std::vector<uint64_t> words(end / 64 + 2, 0);
+        Kbit_Writer before(words.data(), 3, begin);
+        encode_bit_tree(first, last, k, before);
+        before.flush();
+        Kbit_Writer writer(words.data(), begin, end);
+        encode_bit_tree(first, last, k, writer);
+        writer.flush();
+
+        Bit_Tree_Neighbourhood neighbourhood((const int32_t *) words.data(), begin, expected.size(), k);
+        std::vector<NodeId> iterated;
+        for (NodeId v : neighbourhood) {
+            iterated.push_back(v);
+        }
+        ASSERT_EQ(iterated, expected);
+        auto decoded = neighbourhood.decode(buffer);
+        ASSERT_EQ(std::vector<NodeId>(decoded.begin(), decoded.end()), expected);
+
+        // a bounded decode holds at least the neighbours up to the bound
+        auto bounded = neighbourhood.decode(buffer, 9);
+        auto upto_bound = std::upper_bound(expected.begin(), expected.end(), 9) - expected.begin();
+        ASSERT_GE(bounded.end() - bounded.begin(), upto_bound);
+        ASSERT_TRUE(std::equal(bounded.begin(), bounded.end(), expected.begin()));
+    }
+}
+
+TEST(BitTreeEncoding, SmallIDs)
+{
+    // trees over IDs of fewer bits than a table lookup covers
+    std::vector<NodeId> buffer;
+    for (int k = 1; k <= 4; k++) {
+        for (uint32_t set = 1; set < (1u << (1 << k)) && set < (1u << 16); set++) {
+            std::vector<NodeId> expected;
+            for (NodeId v = 0; v < (1 << k); v++) {
+                if (set & (1u << v)) {
+                    expected.push_back(v);
+                }
+            }
+            int64_t bits = bit_tree_bits(expected.data(), expected.data() + expected.size(), k);
+            std::vector<uint64_t> words(bits / 64 + 2, 0);
+            Kbit_Writer writer(words.data(), 0, bits);
+            encode_bit_tree(expected.data(), expected.data() + expected.size(), k, writer);
+            writer.flush();
+            Bit_Tree_Neighbourhood neighbourhood((const int32_t *) words.data(), 0, expected.size(), k);
+            std::vector<NodeId> iterated(neighbourhood.begin(), neighbourhood.end());
+            ASSERT_EQ(iterated, expected);
+            auto decoded = neighbourhood.decode(buffer);
+            ASSERT_EQ(std::vector<NodeId>(decoded.begin(), decoded.end()), expected);
+        }
+    }
+}
+
+template <class Permuter>
+void ExpectPermutationRelabels(const CSRGraph &csr)
+{
+    pvector<NodeId> new_ids = Permuter::permutation(csr);
+    ASSERT_EQ(new_ids.size(), csr.num_nodes());
+    std::vector<bool> taken(csr.num_nodes(), false);
+    for (NodeId v : new_ids) {
+        ASSERT_TRUE(v >= 0 && v < csr.num_nodes() && !taken[v]);
+        taken[v] = true;
+    }
+
+    CSRGraph permuted = Builder::RelabelByPermutation(csr, new_ids);
+    ASSERT_EQ(permuted.num_edges(), csr.num_edges());
+    for (NodeId u = 0; u < csr.num_nodes(); ++u) {
+        std::vector<NodeId> expected, expected_in;
+        for (NodeId v : csr.out_neigh(u)) {
+            expected.push_back(new_ids[v]);
+        }
+        for (NodeId v : csr.in_neigh(u)) {
+            expected_in.push_back(new_ids[v]);
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(expected_in.begin(), expected_in.end());
+        NodeId w = new_ids[u];
+        ASSERT_EQ(std::vector<NodeId>(permuted.out_neigh(w).begin(), permuted.out_neigh(w).end()), expected);
+        ASSERT_EQ(std::vector<NodeId>(permuted.in_neigh(w).begin(), permuted.in_neigh(w).end()), expected_in);
+    }
+}
+
+TEST(Permuters, RelabelPreservesEdges)
+{
+    for (bool symmetrize : {true, false}) {
+        CSRGraph csr = loadGraphFromFile("smallRandom1.el", symmetrize);
+        ExpectPermutationRelabels<BfsOrderPermuter<NodeId, NodeId, true>>(csr);
+        ExpectPermutationRelabels<BpPermuter<NodeId, NodeId, true>>(csr);
+        ExpectPermutationRelabels<ShinglePermuter<NodeId, NodeId, true>>(csr);
+        ExpectPermutationRelabels<LlpPermuter<NodeId, NodeId, true>>(csr);
+    }
+}
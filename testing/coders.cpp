@@ -1,5 +1,6 @@
 #include "test_helper.h"
 #include <gms/representations/graphs/coders/coders-utils/varint_utils.h>
+#include <gms/representations/graphs/coders/coders-utils/stream_vbyte_utils.h>
 
 using testing::UnorderedElementsAre;
 
@@ -63,6 +64,78 @@ TEST(CodersUtils, ToVarint64Bit)
     ASSERT_EQ(decoded[0], 4398046511104);
 }
 
+TEST(CodersUtils, StreamVByteDeltaRoundTrip) {
+    // gaps of every byte length, the count is not a multiple of the group size
+    std::vector<uint32_t> gaps;
+    for (uint32_t i = 0; i < 103; ++i) {
+        gaps.push_back(i % 4 == 0 ? i : i % 4 == 1 ? 300 + i : i % 4 == 2 ? 70000 + i : (1u << 24) + i);
+    }
+    std::vector<unsigned char> control(svbControlSize(gaps.size()));
+    std::vector<unsigned char> data(svbDataSize(gaps.data(), gaps.size()) + SVB_DATA_PADDING);
+    uint64_t written = svbEncode(gaps.data(), gaps.size(), control.data(), data.data());
+    ASSERT_EQ(written, data.size() - SVB_DATA_PADDING);
+
+    std::vector<uint32_t> decoded(gaps.size());
+    const unsigned char *end = svbDecodeDelta(control.data(), data.data(), gaps.size(), 5, decoded.data());
+    ASSERT_EQ(end, data.data() + written);
+    uint32_t expected = 5;
+    for (size_t i = 0; i < gaps.size(); ++i) {
+        expected += gaps[i];
+        ASSERT_EQ(decoded[i], expected);
+    }
+}
+
+TEST(CodersUtils, Zigzag) {
+    for (int32_t x : {0, 1, -1, 1000, -1000, INT32_MAX, INT32_MIN}) {
+        ASSERT_EQ(svbUnzigzag(svbZigzag(x)), x);
+    }
+    ASSERT_EQ(svbZigzag(-1), 1);
+    ASSERT_EQ(svbZigzag(1), 2);
+}
+
+TEST(CodersNeighborhoods, StreamVByteMatchesCSR) {
+    using namespace GMS::CLI;
+    Args args;
+    args.symmetrize = true;
+    Builder builder((GapbsCompat(args)));
+    pvector<EdgePair<NodeId, NodeId>> el;
+    // vertex 500 has neighbours on both sides, with gaps of one to three bytes, and spans several skip blocks
+    for (NodeId u = 0; u < 300; ++u) {
+        el.push_back(EdgePair(NodeId(500), u * u % 100003));
+    }
+    el.push_back(EdgePair(NodeId(3), NodeId(2)));
+    el.push_back(EdgePair(NodeId(7), NodeId(70000)));
+
+    auto csrgraph = builder.MakeGraphFromEL(el);
+    auto svbgraph = builder.csrToCGraphGeneric<StreamVByteGraph>(csrgraph);
+    ASSERT_EQ(svbgraph.num_nodes(), csrgraph.num_nodes());
+    ASSERT_EQ(svbgraph.num_edges(), csrgraph.num_edges());
+
+    std::vector<NodeId> buffer;
+    for (NodeId v = 0; v < csrgraph.num_nodes(); ++v) {
+        std::vector<NodeId> expected(csrgraph.out_neigh(v).begin(), csrgraph.out_neigh(v).end());
+        ASSERT_EQ(svbgraph.out_degree(v), (int64_t) expected.size());
+        std::vector<NodeId> iterated(svbgraph.out_neigh(v).begin(), svbgraph.out_neigh(v).end());
+        ASSERT_EQ(iterated, expected);
+        auto decoded = svbgraph.out_neigh(v).decode(buffer);
+        ASSERT_EQ(std::vector<NodeId>(decoded.begin(), decoded.end()), expected);
+        if (expected.size() > 0 && v % 97 == 0) {
+            for (size_t j = 0; j < expected.size(); ++j) {
+                ASSERT_EQ(svbgraph.out_neigh(v).get(j), expected[j]);
+            }
+        }
+    }
+
+    auto neigh = svbgraph.out_neigh(500);
+    std::vector<NodeId> expected(csrgraph.out_neigh(500).begin(), csrgraph.out_neigh(500).end());
+    for (size_t j = 0; j < expected.size(); ++j) {
+        ASSERT_EQ(neigh.get(j), expected[j]);
+        ASSERT_TRUE(neigh.contains(expected[j]));
+        ASSERT_EQ(neigh.contains(expected[j] + 1), std::binary_search(expected.begin(), expected.end(), expected[j] + 1));
+    }
+    ASSERT_FALSE(neigh.contains(100003));
+}
+
 TEST(CodersNeighborhoods, VarintNeighborhoodFromCSR) {
     using namespace GMS::CLI;
     Args args;
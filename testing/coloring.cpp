@@ -0,0 +1,99 @@
+#include "test_helper.h"
+#include <gms/algorithms/non_set_based/coloring/coloring_balance.h>
+#include <gms/algorithms/non_set_based/coloring/coloring_distance_two.h>
+#include <gms/algorithms/non_set_based/coloring/coloring_jones_v2.h>
+#include <omp.h>
+
+using namespace GMS;
+
+static CSRGraph generate(const std::string &name, int64_t scale, int64_t degree) {
+    CLI::Args args;
+    args.graph_spec.is_generator = true;
+    args.graph_spec.name = name;
+    args.graph_spec.gen_scale = scale;
+    args.graph_spec.gen_avgdeg = degree;
+    return args.load_graph();
+}
+
+static const std::vector<std::string> graph_names = {"kronecker", "barabasi-albert", "geometric"};
+
+// The greedy choice of a vertex is at most one more than the number of vertices within two hops.
+static void expect_greedy_bound(const CSRGraph &g, const std::vector<int32_t> &coloring) {
+    std::vector<NodeId> within;
+    for (NodeId v = 0; v < g.num_nodes(); v++) {
+        within.clear();
+        for (NodeId w : g.out_neigh(v)) {
+            within.push_back(w);
+            for (NodeId u : g.out_neigh(w)) {
+                if (u != v) {
+                    within.push_back(u);
+                }
+            }
+        }
+        std::sort(within.begin(), within.end());
+        const int64_t distinct = std::unique(within.begin(), within.end()) - within.begin();
+        ASSERT_LE(coloring[v], distinct + 1) << "vertex " << v;
+    }
+}
+
+TEST(Coloring, DistanceTwoPassesVerifier) {
+    const int threads = omp_get_max_threads();
+    for (const std::string &name : graph_names) {
+        CSRGraph g = generate(name, 10, 8);
+        for (int t : {1, 4}) {
+            omp_set_num_threads(t);
+            std::vector<int32_t> coloring(g.num_nodes());
+            const int32_t maxColor = Coloring::graph_coloring_distance_two(g, coloring);
+            EXPECT_TRUE(Coloring::GCVerifierDistanceTwo(g, coloring, maxColor)) << name << ", " << t << " threads";
+            expect_greedy_bound(g, coloring);
+        }
+    }
+    omp_set_num_threads(threads);
+}
+
+TEST(Coloring, DistanceTwoRecoloringIgnoresEarlierRounds) {
+    // a star: the leaves 1..4 are within two hops of each other
+    pvector<EdgePair<NodeId, NodeId>> el;
+    for (NodeId leaf = 1; leaf <= 4; leaf++) {
+        el.push_back(EdgePair<NodeId, NodeId>(0, leaf));
+        el.push_back(EdgePair<NodeId, NodeId>(leaf, 0));
+    }
+    CLBase cli(0, {}, "dummy");
+    Builder builder(cli);
+    CSRGraph g = builder.MakeGraphFromEL(el);
+    ASSERT_EQ(g.num_nodes(), 5);
+
+    std::vector<int64_t> taken;
+    std::vector<int32_t> coloring = {1, 0, 2, 3, 4};
+    EXPECT_EQ(Coloring::smallest_free_color_distance_two(g, 1, coloring, taken, 0 * 5 + 1), 5);
+    // the colors 2..4 are free again when vertex 1 is recolored in the next round
+    coloring = {1, 0, 0, 0, 0};
+    EXPECT_EQ(Coloring::smallest_free_color_distance_two(g, 1, coloring, taken, 1 * 5 + 1), 2);
+}
+
+TEST(Coloring, DistanceTwoBalancedPassesVerifier) {
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    for (const std::string &name : graph_names) {
+        CSRGraph g = generate(name, 10, 8);
+        std::vector<int32_t> coloring(g.num_nodes());
+        Coloring::graph_coloring_distance_two_balanced(g, coloring);
+        const int32_t maxColor = *std::max_element(coloring.begin(), coloring.end());
+        EXPECT_TRUE((Coloring::GCVerifierBalanced<CSRGraph, 2>(g, coloring, maxColor))) << name;
+    }
+    omp_set_num_threads(threads);
+}
+
+TEST(Coloring, BalancedPassesVerifier) {
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    for (const std::string &name : graph_names) {
+        CSRGraph g = generate(name, 10, 8);
+        std::vector<int32_t> coloring(g.num_nodes());
+        Coloring::JonesV2::graph_coloring_jones(g, coloring);
+        Coloring::balance_coloring(g, coloring);
+        const int32_t maxColor = *std::max_element(coloring.begin(), coloring.end());
+        EXPECT_TRUE(Coloring::GCVerifierBalanced(g, coloring, maxColor)) << name;
+    }
+    omp_set_num_threads(threads);
+}
@@ -0,0 +1,144 @@
+#include "test_helper.h"
+#include <gms/common/generators.h>
+#include <omp.h>
+
+using namespace GMS;
+
+static std::vector<std::pair<NodeId, NodeId>> edges_of(const Generators::EdgeList &el) {
+    std::vector<std::pair<NodeId, NodeId>> edges;
+    for (const auto &e : el) {
+        edges.emplace_back(e.u, e.v);
+    }
+    return edges;
+}
+
+static CSRGraph generate(const std::string &name, int64_t scale, int64_t degree,
+                         const Generators::Params &params = Generators::Params()) {
+    CLI::Args args;
+    args.graph_spec.is_generator = true;
+    args.graph_spec.name = name;
+    args.graph_spec.gen_scale = scale;
+    args.graph_spec.gen_avgdeg = degree;
+    args.graph_spec.gen_params = params;
+    return args.load_graph();
+}
+
+TEST(Generators, IndependentOfTheNumberOfThreads) {
+    const int threads = omp_get_max_threads();
+    for (const std::string &name : Generators::names()) {
+        Generators::Params params;
+        params.scale = 10;
+        params.average = 8;
+        omp_set_num_threads(1);
+        auto sequential = edges_of(Generators::generate(name, params));
+        omp_set_num_threads(4);
+        auto parallel = edges_of(Generators::generate(name, params));
+        EXPECT_EQ(sequential, parallel) << name;
+        EXPECT_FALSE(sequential.empty()) << name;
+
+        params.seed++;
+        EXPECT_NE(sequential, edges_of(Generators::generate(name, params))) << name;
+    }
+    omp_set_num_threads(threads);
+}
+
+TEST(Generators, BarabasiAlbertAttachesToEarlierVertices) {
+    Generators::EdgeList el = Generators::barabasi_albert(1 << 12, 3, Random::DefaultSeed);
+    ASSERT_EQ(el.size(), 3 << 12);
+    for (const auto &e : el) {
+        ASSERT_LE(e.v, e.u);
+    }
+    CSRGraph g = generate("barabasi-albert", 12, 3);
+    int64_t max_degree = 0;
+    for (NodeId u = 0; u < g.num_nodes(); u++) {
+        max_degree = std::max(max_degree, g.out_degree(u));
+    }
+    // scale-free: the hubs have a degree far above the average of about 6
+    EXPECT_GT(max_degree, 60);
+    EXPECT_NEAR(double(g.num_edges_directed()) / g.num_nodes(), 6, 1);
+}
+
+TEST(Generators, ChungLuHasTheExpectedDegrees) {
+    std::vector<double> degrees(2000, 4.0);
+    for (int i = 0; i < 20; i++) {
+        degrees[i] = 50;
+    }
+    Generators::EdgeList el = Generators::chung_lu(degrees, Random::DefaultSeed);
+    std::vector<int64_t> observed(degrees.size(), 0);
+    for (const auto &e : el) {
+        observed[e.u]++;
+        observed[e.v]++;
+    }
+    double hubs = 0, others = 0;
+    for (size_t u = 0; u < degrees.size(); u++) {
+        (u < 20 ? hubs : others) += observed[u];
+    }
+    EXPECT_NEAR(hubs / 20, 50, 5);
+    EXPECT_NEAR(others / 1980, 4, 0.5);
+
+    CSRGraph g = generate("chung-lu", 12, 8);
+    EXPECT_NEAR(double(g.num_edges_directed()) / g.num_nodes(), 16, 3);
+}
+
+TEST(Generators, LfrMostEdgesWithinCommunities) {
+    const double average = 16, mu = 0.2;
+    const int64_t n = 1 << 12;
+    Generators::EdgeList el = Generators::lfr(n, average, 2.5, mu, Random::DefaultSeed);
+    const std::vector<int64_t> sizes = Generators::community_sizes(n, 32, 320, Random::DefaultSeed);
+    EXPECT_EQ(std::accumulate(sizes.begin(), sizes.end(), int64_t(0)), n);
+    std::vector<int64_t> community(n);
+    for (size_t c = 0, u = 0; c < sizes.size(); c++) {
+        for (int64_t i = 0; i < sizes[c]; i++) {
+            community[u++] = c;
+        }
+    }
+    int64_t within = 0;
+    for (const auto &e : el) {
+        within += community[e.u] == community[e.v];
+    }
+    EXPECT_GT(double(within) / el.size(), 0.7);
+    EXPECT_LT(double(within) / el.size(), 0.9);
+}
+
+TEST(Generators, GeometricEdgesAreShort) {
+    const int64_t n = 1 << 12;
+    Generators::EdgeList el = Generators::random_geometric(n, 10, Random::DefaultSeed);
+    const double radius = Generators::geometric_radius(n, 10);
+    for (const auto &e : el) {
+        auto [ux, uy] = Generators::geometric_position(e.u, Random::DefaultSeed);
+        auto [vx, vy] = Generators::geometric_position(e.v, Random::DefaultSeed);
+        ASSERT_LT(std::hypot(ux - vx, uy - vy), radius);
+    }
+    // fewer neighbours near the border
+    EXPECT_NEAR(2.0 * el.size() / n, 10, 1.5);
+}
+
+TEST(Generators, PlantedCliqueIsPresent) {
+    Generators::Params params;
+    params.clique_size = 12;
+    params.seed = 42;
+    CSRGraph g = generate("planted-clique", 10, 4, params);
+    const std::vector<NodeId> clique = Generators::planted_clique_vertices(g.num_nodes(), 12, 42);
+    ASSERT_EQ(clique.size(), 12u);
+    for (NodeId u : clique) {
+        for (NodeId v : clique) {
+            if (u != v) {
+                ASSERT_TRUE(std::binary_search(g.out_neigh(u).begin(), g.out_neigh(u).end(), v));
+            }
+        }
+    }
+}
+
+TEST(Generators, SelectedWithGen) {
+    const char *argv[] = {"test", "-g", "lfr", "8", "--deg", "4", "--seed", "7", "--mu", "0.3"};
+    CLI::Args args = CLI::Parser().parse(10, const_cast<char **>(argv));
+    ASSERT_EQ(args.error, 0);
+    EXPECT_EQ(args.graph_spec.name, "lfr");
+    EXPECT_EQ(args.graph_spec.gen_params.seed, 7u);
+    EXPECT_DOUBLE_EQ(args.graph_spec.gen_params.mu, 0.3);
+    EXPECT_DOUBLE_EQ(args.graph_spec.gen_params.exponent, 2.5);
+
+    CSRGraph g = args.load_graph();
+    EXPECT_EQ(g.num_nodes(), 256);
+    EXPECT_FALSE(g.directed());
+}
@@ -0,0 +1,116 @@
+// The instrumentation is compiled out unless enabled, this test checks the enabled path.
+#define GMS_INSTRUMENTATION
+
+#include "test_helper.h"
+#include <gms/common/benchmark.h>
+#include <gms/representations/sets/sorted_set.h>
+#include <gms/representations/graphs/set_graph.h>
+#include <gms/algorithms/set_based/maximal_clique_enum/bron_kerbosch.h>
+#include <gms/algorithms/set_based/triangle_count/parallel/total.h>
+
+using namespace GMS;
+
+static double metric_of(const std::vector<std::pair<std::string, double>> &metrics, const std::string &name) {
+    for (const auto &[n, value] : metrics) {
+        if (n == name) {
+            return value;
+        }
+    }
+    return -1;
+}
+
+TEST(Instrumentation, CountsSetOpsBySize) {
+    Instrumentation::reset();
+    SortedSet a({1, 2, 3, 4, 5, 6, 7, 8});
+    SortedSet b({2, 4});
+    EXPECT_EQ(a.intersect_count(b), 2u);
+    EXPECT_EQ(a.intersect_count(a), 8u);
+    auto c = a.difference(b);
+    c.union_inplace(2);
+    EXPECT_TRUE(c.contains(2));
+
+    Instrumentation::Summary summary = Instrumentation::collect();
+    const auto &intersect_count = summary.set_ops[Instrumentation::IntersectCount];
+    EXPECT_STREQ(intersect_count.name, "intersect_count");
+    EXPECT_EQ(intersect_count.calls, 2u);
+    EXPECT_EQ(intersect_count.elements, 26u);
+    // the smaller inputs have 2 and 8 elements
+    EXPECT_EQ(intersect_count.sizes[1], 1u);
+    EXPECT_EQ(intersect_count.sizes[3], 1u);
+    EXPECT_EQ(summary.set_ops[Instrumentation::Difference].calls, 1u);
+    EXPECT_EQ(summary.set_ops[Instrumentation::Insert].calls, 1u);
+    EXPECT_EQ(summary.set_ops[Instrumentation::Contains].calls, 1u);
+    EXPECT_EQ(summary.set_ops[Instrumentation::Union].calls, 0u);
+
+    auto metrics = summary.metrics();
+    EXPECT_EQ(metric_of(metrics, "instr.intersect_count.calls"), 2);
+    EXPECT_EQ(metric_of(metrics, "instr.intersect_count.size.2^3"), 1);
+    EXPECT_EQ(metric_of(metrics, "instr.union.calls"), -1);
+
+    Instrumentation::reset();
+    EXPECT_EQ(Instrumentation::collect().set_ops[Instrumentation::IntersectCount].calls, 0u);
+}
+
+TEST(Instrumentation, RecordsRecursionOfBronKerbosch) {
+    CSRGraph g = loadGraphFromFile("tomitaExample.el");
+    Instrumentation::reset();
+    auto cliques = BkTomita::mce<RoaringGraph>(g);
+
+    Instrumentation::Summary summary = Instrumentation::collect();
+    EXPECT_GE(summary.max_depth(), 2);
+    ASSERT_FALSE(summary.depths.empty());
+    // a single call at the root
+    EXPECT_EQ(summary.depths[0], 1u);
+    auto metrics = summary.metrics();
+    EXPECT_EQ(metric_of(metrics, "instr.event.bk/maximal_cliques"), cliques.size());
+    EXPECT_GT(metric_of(metrics, "instr.phase.bk/pivot.calls"), 0);
+    EXPECT_GT(summary.set_ops[Instrumentation::Intersect].calls, 0u);
+}
+
+TEST(Instrumentation, NestedPhasesAndBusyTime) {
+    Instrumentation::reset();
+    {
+        GMS_INSTR_REGION();
+        #pragma omp parallel
+        {
+            GMS_INSTR_BUSY();
+            GMS_INSTR_PHASE("test/outer");
+            for (int i = 0; i < 3; i++) {
+                GMS_INSTR_PHASE("test/inner");
+                GMS_INSTR_EVENT("test/iterations");
+            }
+        }
+    }
+    Instrumentation::Summary summary = Instrumentation::collect();
+    ASSERT_EQ(summary.phase_seconds.size(), 2u);
+    EXPECT_EQ(summary.phase_seconds[0].first, "test/outer");
+    EXPECT_GE(summary.phase_seconds[0].second, summary.phase_seconds[1].second);
+    EXPECT_EQ(summary.phase_calls[1].second, 3u * omp_get_max_threads());
+    ASSERT_EQ(summary.events.size(), 1u);
+    EXPECT_EQ(summary.events[0].second, 3u * omp_get_max_threads());
+    EXPECT_EQ(summary.busy.size(), (size_t) omp_get_max_threads());
+    EXPECT_GT(summary.region_seconds, 0);
+    EXPECT_GE(summary.idle_fraction(), 0);
+    EXPECT_LE(summary.idle_fraction(), 1);
+    EXPECT_GE(summary.imbalance(), 1 - 1e-9);
+}
+
+TEST(Instrumentation, ReportedByBenchmark) {
+    CSRGraph g = loadGraphFromFile("eppsteinExample.el");
+    SortedSetGraph sg = SortedSetGraph::FromCGraph(g);
+    CLI::Args args;
+    args.num_trials = 2;
+    args.report.warmup_trials = 1;
+
+    BenchmarkReport report = Benchmark(args).graph(g).info("instrumented")
+        .run([&]() { return TriangleCount::Par::count_total(sg); });
+
+    EXPECT_EQ(report.stats("kernel").count, 2);
+    // one intersection per edge, in both trials but not in the warmup
+    const std::string json = report.json_record();
+    EXPECT_NE(json.find("\"instr.intersect_count.calls\":{\"min\":" + std::to_string(g.num_edges())),
+              std::string::npos);
+    EXPECT_NE(json.find("\"samples\":[" + std::to_string(g.num_edges()) + "," + std::to_string(g.num_edges()) + "]"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"instr.idle_fraction\":{"), std::string::npos);
+}
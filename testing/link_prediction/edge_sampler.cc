@@ -29,4 +29,86 @@ TEST(EdgeSampler, NecessaryConditionComplement) {
         ASSERT_TRUE(0 <= e.second && e.second < num_nodes);
         ASSERT_FALSE(graph.out_neigh(e.first).contains(e.second));
     }
-}
\ No newline at end of file
+}
+TEST(EdgeSampler, NecessaryConditionRoaring) {
+    auto graph = RoaringGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    EdgeSampler sampler(graph);
+
+    std::mt19937_64 rnd;
+    for (int it = 0; it < 1000; ++it) {
+        auto e = sampler.sample(rnd);
+        ASSERT_TRUE(graph.out_neigh(e.first).contains(e.second));
+        auto c = sampler.sample_complement(rnd);
+        ASSERT_LT(c.first, c.second);
+        ASSERT_FALSE(graph.out_neigh(c.first).contains(c.second));
+    }
+}
+
+TEST(EdgeSampler, AddAndRemoveEdges) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    EdgeSampler sampler(graph);
+    int64_t num_edges = sampler.num_edges();
+
+    std::mt19937_64 rnd;
+    UndirectedEdge removed = sampler.sample(rnd);
+    UndirectedEdge added = sampler.sample_complement(rnd);
+    sampler.remove_edge(removed);
+    sampler.add_edge(added);
+    ASSERT_EQ(sampler.num_edges(), num_edges);
+    ASSERT_FALSE(sampler.contains(removed));
+    ASSERT_TRUE(sampler.contains(added));
+
+    for (int it = 0; it < 1000; ++it) {
+        ASSERT_NE(sampler.sample(rnd), removed);
+        ASSERT_NE(sampler.sample_complement(rnd), added);
+    }
+}
+
+TEST(EdgeSampler, BatchIsIndependentOfThreadCount) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    EdgeSampler sampler(graph);
+
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    auto sequential = sampler.sample_batch(5000);
+    auto sequential_complement = sampler.sample_complement_batch(5000);
+    omp_set_num_threads(4);
+    auto parallel = sampler.sample_batch(5000);
+    auto parallel_complement = sampler.sample_complement_batch(5000);
+    omp_set_num_threads(maxThreads);
+
+    ASSERT_EQ(sequential, parallel);
+    ASSERT_EQ(sequential_complement, parallel_complement);
+    for (const auto &e : parallel) {
+        ASSERT_TRUE(graph.out_neigh(e.first).contains(e.second));
+    }
+    for (const auto &e : parallel_complement) {
+        ASSERT_FALSE(graph.out_neigh(e.first).contains(e.second));
+    }
+}
+
+TEST(EdgeSampler, MembershipBuiltInParallel) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+    EdgeSampler sampler(graph);
+    for (NodeId u = 0; u < graph.num_nodes(); ++u) {
+        for (NodeId v = u; v < graph.num_nodes(); ++v) {
+            ASSERT_EQ(sampler.contains(UndirectedEdge(u, v)), graph.out_neigh(u).contains(v));
+        }
+    }
+    omp_set_num_threads(maxThreads);
+}
+
+TEST(EdgeSampler, ComplementMembershipBuiltUpFront) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    // built before the parallel sampling loops, where it would run on one thread
+    EdgeSampler complement_sampler(graph, false, true);
+    EXPECT_TRUE(complement_sampler.membership_built());
+    EdgeSampler primary_sampler(graph, true, false);
+    EXPECT_FALSE(primary_sampler.membership_built());
+    EXPECT_TRUE(primary_sampler.contains(primary_sampler.sample_batch(1)[0]));
+    EXPECT_TRUE(primary_sampler.membership_built());
+    complement_sampler.rebuild();
+    EXPECT_TRUE(complement_sampler.membership_built());
+}
@@ -0,0 +1,158 @@
+#include "../test_helper.h"
+#include <gms/algorithms/set_based/link_prediction/link_prediction.h>
+#include <gms/algorithms/set_based/link_prediction/evaluation.h>
+#include <gms/representations/graphs/set_graph.h>
+
+using namespace GMS;
+using namespace GMS::LinkPrediction;
+
+template <VertexSim::Metric metric>
+void ExpectParallelMatchesSerial(const char *graph_file, int64_t q) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile(graph_file));
+    int64_t n = graph.num_nodes();
+
+    // The serial version considers all pairs, but only positive scores are comparable.
+    auto serial = link_prediction_similarity<metric>(graph, n * n);
+    std::vector<double> expected;
+    for (double score : serial.scores) {
+        if (score > 0.0) {
+            expected.push_back(score);
+        }
+    }
+    std::sort(expected.rbegin(), expected.rend());
+    if (expected.size() > q) {
+        expected.resize(q);
+    }
+
+    auto parallel = link_prediction_similarity_parallel<metric>(graph, q);
+    ASSERT_EQ(parallel.scores.size(), expected.size());
+    ASSERT_TRUE(std::is_sorted(parallel.scores.begin(), parallel.scores.end()));
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_NEAR(parallel.scores[parallel.scores.size() - 1 - i], expected[i], 1e-9);
+    }
+    for (size_t i = 0; i < parallel.edges.size(); ++i) {
+        auto [u, v] = parallel.edges[i];
+        ASSERT_LT(u, v);
+        ASSERT_FALSE(graph.out_neigh(u).contains(v));
+        ASSERT_NEAR(parallel.scores[i], VertexSim::vertex_similarity<metric>(u, v, graph), 1e-9);
+    }
+}
+
+TEST(LinkPredictionParallel, Jaccard) {
+    ExpectParallelMatchesSerial<VertexSim::Metric::Jaccard>("smallRandom1.el", 5);
+    ExpectParallelMatchesSerial<VertexSim::Metric::Jaccard>("eppsteinExample.el", 1000);
+}
+
+TEST(LinkPredictionParallel, Overlap) {
+    ExpectParallelMatchesSerial<VertexSim::Metric::Overlap>("eppsteinExample.el", 7);
+}
+
+TEST(LinkPredictionParallel, AdamicAdar) {
+    ExpectParallelMatchesSerial<VertexSim::Metric::AdamicAdar>("smallRandom1.el", 1000);
+    ExpectParallelMatchesSerial<VertexSim::Metric::AdamicAdar>("tomitaExample.el", 3);
+}
+
+TEST(LinkPredictionParallel, Resource) {
+    ExpectParallelMatchesSerial<VertexSim::Metric::Resource>("tomitaExample.el", 1000);
+}
+
+TEST(LinkPredictionParallel, CommNeigh) {
+    ExpectParallelMatchesSerial<VertexSim::Metric::CommNeigh>("eppsteinExample.el", 10);
+}
+
+TEST(TrainTestSplit, PartitionsTheEdges) {
+    CSRGraph g = loadGraphFromFile("smallRandom1.el");
+    int64_t num_test_edges = g.num_edges() / 4;
+    auto split = split_train_test(g, num_test_edges);
+
+    ASSERT_EQ(split.test.num_edges(), num_test_edges);
+    ASSERT_EQ(split.train.num_edges() + split.test.num_edges(), g.num_edges());
+    auto train = SortedSetGraph::FromCGraph(split.train);
+    auto test = SortedSetGraph::FromCGraph(split.test);
+    for (NodeId u = 0; u < g.num_nodes(); ++u) {
+        for (NodeId v : g.out_neigh(u)) {
+            // every edge is in exactly one of the graphs, in both directions
+            bool in_train = train.out_neigh(u).contains(v);
+            bool in_test = test.out_neigh(u).contains(v);
+            ASSERT_NE(in_train, in_test);
+            ASSERT_EQ(in_train, train.out_neigh(v).contains(u));
+            ASSERT_EQ(in_test, test.out_neigh(v).contains(u));
+        }
+    }
+}
+
+TEST(TrainTestSplit, IndependentOfThreadCount) {
+    CSRGraph g = loadGraphFromFile("smallRandom1.el");
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    auto sequential = split_train_test(g, g.num_edges() / 3);
+    omp_set_num_threads(4);
+    auto parallel = split_train_test(g, g.num_edges() / 3);
+    omp_set_num_threads(maxThreads);
+
+    for (NodeId u = 0; u < g.num_nodes(); ++u) {
+        ASSERT_TRUE(std::equal(sequential.test.out_neigh(u).begin(), sequential.test.out_neigh(u).end(),
+                               parallel.test.out_neigh(u).begin(), parallel.test.out_neigh(u).end()));
+    }
+}
+
+TEST(Auc, IndependentOfThreadCount) {
+    CSRGraph g = loadGraphFromFile("smallRandom1.el");
+    auto split = split_train_test(g, g.num_edges() / 5);
+    auto g_true = SortedSetGraph::FromCGraph(g);
+    auto g_train = SortedSetGraph::FromCGraph(split.train);
+    auto g_test = SortedSetGraph::FromCGraph(split.test);
+
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    double sequential = score_link_prediction_auc<VertexSim::Metric::AdamicAdar>(g_true, g_train, g_test, 2000);
+    omp_set_num_threads(4);
+    double parallel = score_link_prediction_auc<VertexSim::Metric::AdamicAdar>(g_true, g_train, g_test, 2000);
+    omp_set_num_threads(maxThreads);
+    ASSERT_EQ(sequential, parallel);
+    ASSERT_GE(sequential, 0.0);
+    ASSERT_LE(sequential, 1.0);
+}
+
+template <class SGraph>
+double jaccard_auc(const CSRGraph &g, const TrainTestSplit &split) {
+    auto g_train = SGraph::FromCGraph(split.train);
+    add_false_links(g_train, g.num_edges() / 20, SGraph::FromCGraph(split.test));
+    return score_link_prediction_auc<VertexSim::Metric::Jaccard>(SGraph::FromCGraph(g), g_train,
+                                                                  SGraph::FromCGraph(split.test), 2000);
+}
+
+TEST(Auc, SameForCompressedSets) {
+    CSRGraph g = loadGraphFromFile("smallRandom1.el");
+    auto split = split_train_test(g, g.num_edges() / 5);
+    double sorted = jaccard_auc<SortedSetGraph>(g, split);
+    ASSERT_EQ(jaccard_auc<KbitSetGraph>(g, split), sorted);
+    ASSERT_EQ(jaccard_auc<VarintSetGraph>(g, split), sorted);
+}
+
+TEST(Auc, FalseLinksInvalidateDegreeWeights) {
+    CSRGraph g = loadGraphFromFile("smallRandom1.el");
+    auto split = split_train_test(g, g.num_edges() / 5);
+    auto g_train = SortedSetGraph::FromCGraph(split.train);
+    auto g_test = SortedSetGraph::FromCGraph(split.test);
+
+    g_train.build_degree_weights();
+    ASSERT_TRUE(g_train.has_degree_weights());
+    add_false_links(g_train, 10, g_test);
+    ASSERT_FALSE(g_train.has_degree_weights());
+}
+
+TEST(LinkPredictionMinHash, ScoresCandidateNonEdges) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    VertexSim::MinHashParams params;
+    params.rows_per_band = 1;
+    auto result = link_prediction_minhash(graph, 10, params);
+    ASSERT_LE(result.edges.size(), 10);
+    ASSERT_TRUE(std::is_sorted(result.scores.begin(), result.scores.end()));
+    for (size_t i = 0; i < result.edges.size(); ++i) {
+        auto [u, v] = result.edges[i];
+        ASSERT_LT(u, v);
+        ASSERT_FALSE(graph.out_neigh(u).contains(v));
+        ASSERT_DOUBLE_EQ(result.scores[i], VertexSim::vertex_similarity_jaccard(u, v, graph));
+    }
+}
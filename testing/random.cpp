@@ -0,0 +1,102 @@
+#include "test_helper.h"
+#include <gms/common/random.h>
+#include <gms/algorithms/non_set_based/coloring/coloring_johansson.h>
+#include <gms/algorithms/non_set_based/coloring/coloring_dense_sparse.h>
+
+using namespace GMS;
+
+TEST(CounterRng, SameStreamIsReproducible) {
+    Random::CounterRng a(Random::DefaultSeed, 7, 3);
+    Random::CounterRng b(Random::DefaultSeed, 7, 3);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(a(), b());
+    }
+}
+
+TEST(CounterRng, KeysAndRoundsSelectDifferentStreams) {
+    Random::CounterRng base(Random::DefaultSeed, 7, 3);
+    Random::CounterRng otherKey(Random::DefaultSeed, 8, 3);
+    Random::CounterRng otherRound(Random::DefaultSeed, 7, 4);
+    Random::CounterRng otherSeed(Random::DefaultSeed + 1, 7, 3);
+    uint64_t first = base();
+    ASSERT_NE(first, otherKey());
+    ASSERT_NE(first, otherRound());
+    ASSERT_NE(first, otherSeed());
+}
+
+TEST(CounterRng, BoundedStaysInRange) {
+    Random::CounterRng rng(Random::DefaultSeed);
+    std::vector<int> histogram(7, 0);
+    for (int i = 0; i < 7000; ++i) {
+        uint64_t x = rng.bounded(7);
+        ASSERT_LT(x, 7);
+        histogram[x]++;
+    }
+    for (int count : histogram) {
+        ASSERT_GT(count, 800);
+        ASSERT_LT(count, 1200);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        int64_t x = rng.uniform_int(-3, 3);
+        ASSERT_GE(x, -3);
+        ASSERT_LE(x, 3);
+        double d = rng.uniform_01();
+        ASSERT_GE(d, 0.0);
+        ASSERT_LT(d, 1.0);
+    }
+}
+
+TEST(CounterRng, ColoringIsIndependentOfThreadCount) {
+    CSRGraph g = loadGraphFromFile("smallRandom1.el");
+    const int maxThreads = omp_get_max_threads();
+
+    omp_set_num_threads(1);
+    std::vector<int32_t> sequential(g.num_nodes(), 0);
+    Coloring::graph_coloring_johansson(g, sequential);
+
+    omp_set_num_threads(4);
+    std::vector<int32_t> parallel(g.num_nodes(), 0);
+    Coloring::graph_coloring_johansson(g, parallel);
+
+    omp_set_num_threads(maxThreads);
+    ASSERT_EQ(sequential, parallel);
+}
+
+// Runs the phases of graph_coloring_dense_sparse, returns the number of dense vertices.
+static NodeId dense_sparse_coloring(CSRGraph &g, std::vector<int32_t> &coloring, double epsilon) {
+    Coloring::Coloring_Dense_Sparse cds(g, coloring, epsilon);
+    cds.decomposition();
+    cds.initial_coloring();
+    cds.coloring_steps();
+    cds.barenboim();
+    return cds.n_dense();
+}
+
+TEST(CounterRng, DenseSparseColoringIsIndependentOfThreadCount) {
+    CLI::Args args;
+    args.graph_spec.is_generator = true;
+    args.graph_spec.name = "planted-clique";
+    args.graph_spec.gen_scale = 8;
+    args.graph_spec.gen_avgdeg = 1;
+    args.graph_spec.gen_params.clique_size = 48;
+    CSRGraph g = args.load_graph();
+    const int maxThreads = omp_get_max_threads();
+
+    // with the epsilon of the paper, no vertex is dense here; with the largest one it allows, the clique is
+    for (double epsilon : {0.0, 0.2}) {
+        omp_set_num_threads(1);
+        std::vector<int32_t> sequential(g.num_nodes(), 0);
+        const NodeId nDense = dense_sparse_coloring(g, sequential, epsilon);
+
+        omp_set_num_threads(4);
+        std::vector<int32_t> parallel(g.num_nodes(), 0);
+        EXPECT_EQ(dense_sparse_coloring(g, parallel, epsilon), nDense);
+
+        if (epsilon > 0) {
+            EXPECT_GE(nDense, 48);
+        }
+        EXPECT_TRUE(Coloring::GCVerifierWeak(g, parallel, 0));
+        ASSERT_EQ(sequential, parallel) << "epsilon " << epsilon;
+    }
+    omp_set_num_threads(maxThreads);
+}
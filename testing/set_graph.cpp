@@ -13,7 +13,9 @@ testing::Types<
     SortedSetBase<std::int32_t>,
     SortedSetBase<std::int64_t>,
     RobinHoodSetBase<std::int32_t>,
-    RobinHoodSetBase<std::int64_t>
+    RobinHoodSetBase<std::int64_t>,
+    KbitSet,
+    VarintSet
 >;
 
 TYPED_TEST_SUITE(SetGraphTest, SetImpls);
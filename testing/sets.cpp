@@ -1,6 +1,8 @@
 #include <gms/representations/sets/sorted_set.h>
 #include <gms/representations/sets/roaring_set.h>
 #include <gms/representations/sets/robin_hood_set.h>
+#include <gms/representations/sets/kbit_set.h>
+#include <gms/representations/sets/varint_set.h>
 #include "test_helper.h"
 
 // More information on parameterized tests:
@@ -20,7 +22,9 @@ using Implementations =
         SortedSetBase<std::int32_t>,
         SortedSetBase<std::int64_t>,
         RobinHoodSetBase<std::int32_t>,
-        RobinHoodSetBase<std::int64_t>
+        RobinHoodSetBase<std::int64_t>,
+        KbitSet,
+        VarintSet
     >;
 
 TYPED_TEST_SUITE(SetsTest, Implementations);
@@ -112,6 +116,14 @@ static void test_intersect(const S &a, const S &b, const S &expected)
     ASSERT_EQ(b.intersect(a), expected);
     ASSERT_EQ(a.intersect_count(b), expected.cardinality());
     ASSERT_EQ(b.intersect_count(a), expected.cardinality());
+
+    auto weight = [](typename S::SetElement x) { return 0.5 * x + 1.0; };
+    double expected_sum = 0;
+    for (auto x : expected) {
+        expected_sum += weight(x);
+    }
+    ASSERT_DOUBLE_EQ(a.intersect_sum(b, weight), expected_sum);
+    ASSERT_DOUBLE_EQ(b.intersect_sum(a, weight), expected_sum);
 }
 
 TYPED_TEST(SetsTest, Intersect_EmptyEmpty)
@@ -140,6 +152,32 @@ TYPED_TEST(SetsTest, Intersect_TotalOverlap)
     test_intersect(Set({ 1, 2, 3, 4, 5 }), Set({ 1, 2, 3, 4, 5 }), Set{ 1, 2, 3, 4, 5 });
 }
 
+TYPED_TEST(SetsTest, Intersect_Large)
+{
+    // Large enough to span many blocks of the compressed sets, the sparse set skips most of them.
+    std::vector<typename Set::SetElement> multiples_3, multiples_5, multiples_15, sparse, sparse_common;
+    for (typename Set::SetElement x = 0; x < 6000; ++x) {
+        if (x % 3 == 0) multiples_3.push_back(x);
+        if (x % 5 == 0) multiples_5.push_back(x);
+        if (x % 15 == 0) multiples_15.push_back(x);
+    }
+    for (typename Set::SetElement x : {1, 30, 1000, 1001, 4500, 5999, 100000}) {
+        sparse.push_back(x);
+        if (x < 6000 && x % 3 == 0) sparse_common.push_back(x);
+    }
+    test_intersect(Set(multiples_3), Set(multiples_5), Set(multiples_15));
+    test_intersect(Set(multiples_3), Set(sparse), Set(sparse_common));
+
+    Set set(multiples_3);
+    ASSERT_TRUE(set.contains(0));
+    ASSERT_TRUE(set.contains(4500));
+    ASSERT_TRUE(set.contains(5997));
+    ASSERT_FALSE(set.contains(4501));
+    ASSERT_FALSE(set.contains(6000));
+    ASSERT_EQ(set.difference(Set(multiples_5)).cardinality(), multiples_3.size() - multiples_15.size());
+    ASSERT_EQ(set.union_count(Set(multiples_5)), multiples_3.size() + multiples_5.size() - multiples_15.size());
+}
+
 
 template <class S>
 static void test_intersect_inplace(const S &a, const S &b, const S &expected)
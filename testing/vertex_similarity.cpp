@@ -0,0 +1,168 @@
+#include "test_helper.h"
+#include <gms/algorithms/set_based/vertex_similarity/common_neighbors.h>
+#include <gms/algorithms/set_based/vertex_similarity/minhash.h>
+#include <gms/representations/graphs/set_graph.h>
+
+using namespace GMS;
+using namespace GMS::VertexSim;
+
+template <class SGraph>
+void ExpectAllMetricsMatch(const PairSimilarity &pair, const SGraph &graph) {
+    NodeId u = pair.u;
+    NodeId v = pair.v;
+    ASSERT_NEAR(pair.get<Metric::Jaccard>(), vertex_similarity<Metric::Jaccard>(u, v, graph), 1e-9);
+    ASSERT_NEAR(pair.get<Metric::Overlap>(), vertex_similarity<Metric::Overlap>(u, v, graph), 1e-9);
+    ASSERT_NEAR(pair.get<Metric::AdamicAdar>(), vertex_similarity<Metric::AdamicAdar>(u, v, graph), 1e-9);
+    ASSERT_NEAR(pair.get<Metric::Resource>(), vertex_similarity<Metric::Resource>(u, v, graph), 1e-9);
+    ASSERT_NEAR(pair.get<Metric::CommNeigh>(), vertex_similarity<Metric::CommNeigh>(u, v, graph), 1e-9);
+    ASSERT_NEAR(pair.get<Metric::TotalNeigh>(), vertex_similarity<Metric::TotalNeigh>(u, v, graph), 1e-9);
+    ASSERT_NEAR(pair.get<Metric::PrefAtt>(), vertex_similarity<Metric::PrefAtt>(u, v, graph), 1e-9);
+}
+
+template <class Accumulator>
+void ExpectAllPairsMatch(const char *graph_file, PairMask mask) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile(graph_file));
+    auto pairs = all_pairs_similarity<Accumulator>(graph, mask);
+
+    // every pair with a common neighbor must be reported exactly once
+    size_t expected = 0;
+    for (NodeId u = 0; u < graph.num_nodes(); ++u) {
+        for (NodeId v = u + 1; v < graph.num_nodes(); ++v) {
+            bool skip = mask == PairMask::NonEdges && graph.out_neigh(u).contains(v);
+            if (!skip && graph.out_neigh(u).intersect_count(graph.out_neigh(v)) > 0) {
+                ++expected;
+            }
+        }
+    }
+    ASSERT_EQ(pairs.size(), expected);
+    for (const PairSimilarity &pair : pairs) {
+        ASSERT_LT(pair.u, pair.v);
+        ExpectAllMetricsMatch(pair, graph);
+    }
+}
+
+TEST(CommonNeighborProduct, DenseAccumulator) {
+    ExpectAllPairsMatch<DenseAccumulator>("smallRandom1.el", PairMask::NonEdges);
+    ExpectAllPairsMatch<DenseAccumulator>("eppsteinExample.el", PairMask::UpperTriangle);
+    ExpectAllPairsMatch<DenseAccumulator>("tomitaExample.el", PairMask::NonEdges);
+}
+
+TEST(CommonNeighborProduct, HashAccumulator) {
+    ExpectAllPairsMatch<HashAccumulator>("smallRandom1.el", PairMask::UpperTriangle);
+    ExpectAllPairsMatch<HashAccumulator>("eppsteinExample.el", PairMask::NonEdges);
+    ExpectAllPairsMatch<HashAccumulator>("tomitaExample.el", PairMask::UpperTriangle);
+}
+
+TEST(CommonNeighborProduct, CandidatePairs) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("eppsteinExample.el"));
+    std::vector<std::pair<NodeId, NodeId>> candidates;
+    for (NodeId u = 0; u < graph.num_nodes(); ++u) {
+        for (NodeId v = graph.num_nodes() - 1; v > u; v -= 2) {
+            candidates.emplace_back(u, v);
+        }
+    }
+    auto pairs = candidate_pairs_similarity(graph, candidates);
+    ASSERT_EQ(pairs.size(), candidates.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        ASSERT_EQ(pairs[i].u, candidates[i].first);
+        ASSERT_EQ(pairs[i].v, candidates[i].second);
+        if (pairs[i].sums.count > 0) {
+            ExpectAllMetricsMatch(pairs[i], graph);
+        } else {
+            ASSERT_EQ(graph.out_neigh(pairs[i].u).intersect_count(graph.out_neigh(pairs[i].v)), 0);
+        }
+    }
+}
+
+template <class SGraph>
+void ExpectDegreeWeightsMatch(const char *graph_file) {
+    auto graph = SGraph::FromCGraph(loadGraphFromFile(graph_file));
+    std::vector<double> adamic_adar, resource;
+    for (NodeId u = 0; u < graph.num_nodes(); ++u) {
+        for (NodeId v = u + 1; v < graph.num_nodes(); ++v) {
+            adamic_adar.push_back(vertex_similarity<Metric::AdamicAdar>(u, v, graph));
+            resource.push_back(vertex_similarity<Metric::Resource>(u, v, graph));
+        }
+    }
+
+    graph.build_degree_weights();
+    ASSERT_TRUE(graph.has_degree_weights());
+    size_t i = 0;
+    for (NodeId u = 0; u < graph.num_nodes(); ++u) {
+        for (NodeId v = u + 1; v < graph.num_nodes(); ++v, ++i) {
+            ASSERT_NEAR(vertex_similarity<Metric::AdamicAdar>(u, v, graph), adamic_adar[i], 1e-9);
+            ASSERT_NEAR(vertex_similarity<Metric::Resource>(u, v, graph), resource[i], 1e-9);
+        }
+    }
+}
+
+TEST(DegreeWeights, MatchOnTheFlyWeights) {
+    ExpectDegreeWeightsMatch<SortedSetGraph>("smallRandom1.el");
+    ExpectDegreeWeightsMatch<RoaringGraph>("eppsteinExample.el");
+    ExpectDegreeWeightsMatch<RobinHoodGraph>("tomitaExample.el");
+}
+
+void ExpectEstimatesClose(int bits, double tolerance) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    MinHashParams params;
+    params.num_hashes = 1024;
+    params.bits = bits;
+    auto signatures = MinHashSignatures::Build(graph, params);
+    ASSERT_EQ(signatures.num_hashes(), 1024);
+
+    double error = 0;
+    int64_t num_pairs = 0;
+    for (NodeId u = 0; u < graph.num_nodes(); ++u) {
+        ASSERT_DOUBLE_EQ(signatures.estimate_jaccard(u, u), 1.0);
+        for (NodeId v = u + 1; v < graph.num_nodes(); ++v) {
+            error += std::abs(signatures.estimate_jaccard(u, v) - vertex_similarity_jaccard(u, v, graph));
+            ++num_pairs;
+        }
+    }
+    ASSERT_LT(error / num_pairs, tolerance);
+}
+
+TEST(MinHash, EstimatesJaccard) {
+    ExpectEstimatesClose(32, 0.03);
+    ExpectEstimatesClose(4, 0.05);
+    ExpectEstimatesClose(1, 0.1);
+}
+
+TEST(MinHash, IdenticalNeighborhoodsAreCandidates) {
+    // 0 and 1 have the same neighborhood, as do 4 and 5
+    std::vector<std::pair<NodeId, NodeId>> edges = {{0, 2}, {0, 3}, {1, 2}, {1, 3}, {4, 6}, {5, 6}, {4, 7}, {5, 7},
+                                                    {4, 8}, {5, 8}};
+    std::vector<std::pair<NodeId, NodeId>> symmetric;
+    for (auto [u, v] : edges) {
+        symmetric.emplace_back(u, v);
+        symmetric.emplace_back(v, u);
+    }
+    auto graph = SortedSetGraph::FromEL(symmetric, 9, false);
+
+    auto similar = similar_pairs_minhash(graph, 1.0);
+    auto exact = similar_pairs_exact(graph, 1.0);
+    ASSERT_EQ(similar.size(), exact.size());
+    for (size_t i = 0; i < exact.size(); ++i) {
+        ASSERT_EQ(similar[i].u, exact[i].u);
+        ASSERT_EQ(similar[i].v, exact[i].v);
+    }
+
+    auto quality = evaluate_minhash(graph, 1.0);
+    ASSERT_EQ(quality.recall, 1.0);
+    ASSERT_NEAR(quality.mean_abs_error, 0.0, 1e-12);
+}
+
+TEST(MinHash, ReportedPairsAreVerified) {
+    auto graph = SortedSetGraph::FromCGraph(loadGraphFromFile("smallRandom1.el"));
+    MinHashParams params;
+    params.rows_per_band = 2;
+    auto similar = similar_pairs_minhash(graph, 0.3, params);
+    for (const SimilarPair &pair : similar) {
+        ASSERT_LT(pair.u, pair.v);
+        ASSERT_GE(pair.similarity, 0.3);
+        ASSERT_DOUBLE_EQ(pair.similarity, vertex_similarity_jaccard(pair.u, pair.v, graph));
+    }
+    auto quality = evaluate_minhash(graph, 0.3, params);
+    ASSERT_EQ(quality.found_pairs, similar.size());
+    ASSERT_GE(quality.recall, 0.8);
+}